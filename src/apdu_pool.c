@@ -0,0 +1,137 @@
+/*! \file apdu_pool.c
+ *
+ *  \brief APDU buffer pool
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <string.h>
+
+#include "apdu_pool.h"
+#include "rfal_platform/rfal_platform.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define APDU_POOL_SLOT_WORDS        (APDU_POOL_SLOT_LEN / sizeof(uint32_t))
+
+#if ((APDU_POOL_SLOT_LEN % 4U) != 0U) || (APDU_POOL_SLOTS > 0xFFFFU)
+    #error "APDU pool: invalid APDU_POOL_SLOT_LEN or APDU_POOL_SLOTS"
+#endif
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Pool, one per reader */
+typedef struct
+{
+    uint32_t      mem[APDU_POOL_SLOTS][APDU_POOL_SLOT_WORDS];
+    uint16_t      run[APDU_POOL_SLOTS];     /*!< Slots of the buffer starting here, 0: free or inside a buffer */
+    bool          used[APDU_POOL_SLOTS];
+    apduPoolStats stats;
+} apduPoolCtx;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static apduPoolCtx gApInstances[PLTF_READERS];
+
+#define gAp          (gApInstances[pltf_reader_get()])  /*!< Pool of the calling task's reader */
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+uint8_t *apduPoolAlloc( uint32_t len )
+{
+    uint32_t need;
+    uint16_t start;
+    uint16_t i;
+
+    need = ((len + APDU_POOL_SLOT_LEN) - 1U) / APDU_POOL_SLOT_LEN;
+    if( (need == 0U) || (need > APDU_POOL_SLOTS) )
+    {
+        gAp.stats.fails++;
+        return NULL;
+    }
+
+    /* First fit */
+    for( start = 0; (start + need) <= APDU_POOL_SLOTS; start = (uint16_t)(i + 1U) )
+    {
+        for( i = start; (i < (start + need)) && !gAp.used[i]; i++ )
+        {
+            /* Free slot */
+        }
+        if( i == (start + need) )
+        {
+            memset( &gAp.used[start], true, need );
+            gAp.run[start]        = (uint16_t)need;
+            gAp.stats.allocs++;
+            gAp.stats.slotsUsed   = (uint16_t)(gAp.stats.slotsUsed + need);
+            gAp.stats.slotsPeak   = ((gAp.stats.slotsUsed > gAp.stats.slotsPeak) ? gAp.stats.slotsUsed : gAp.stats.slotsPeak);
+            return (uint8_t*)gAp.mem[start];
+        }
+    }
+
+    gAp.stats.fails++;
+    return NULL;
+}
+
+
+/*******************************************************************************/
+rfalIsoDepApduBufFormat *apduPoolAllocApdu( uint32_t apduLen )
+{
+    return (rfalIsoDepApduBufFormat*)apduPoolAlloc( APDU_POOL_APDU_LEN( apduLen ) );
+}
+
+
+/*******************************************************************************/
+rfalIsoDepBufFormat *apduPoolAllocBlock( void )
+{
+    return (rfalIsoDepBufFormat*)apduPoolAlloc( sizeof(rfalIsoDepBufFormat) );
+}
+
+
+/*******************************************************************************/
+void apduPoolFree( const void *buf )
+{
+    uintptr_t off;
+    uint16_t  slot;
+
+    if( buf == NULL )
+    {
+        return;
+    }
+
+    off  = ((uintptr_t)buf - (uintptr_t)gAp.mem[0]);
+    slot = (uint16_t)(off / APDU_POOL_SLOT_LEN);
+    if( ((uintptr_t)buf < (uintptr_t)gAp.mem[0]) || (slot >= APDU_POOL_SLOTS) || ((off % APDU_POOL_SLOT_LEN) != 0U) || (gAp.run[slot] == 0U) )
+    {
+        return;                                                                     /* Not a buffer of this pool */
+    }
+
+    memset( &gAp.used[slot], false, gAp.run[slot] );
+    gAp.stats.slotsUsed = (uint16_t)(gAp.stats.slotsUsed - gAp.run[slot]);
+    gAp.run[slot]       = 0;
+}
+
+
+/*******************************************************************************/
+void apduPoolGetStats( apduPoolStats *stats )
+{
+    *stats = gAp.stats;
+}
@@ -0,0 +1,126 @@
+/*! \file apdu_pool.h
+ *
+ *  \brief APDU buffer pool
+ *
+ *  Hands out the buffers of an ISO-DEP APDU exchange done with
+ *  rfalIsoDepStartApduTransceive() directly, instead of the fixed size
+ *  buffers of rfal_nfc (RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN): each buffer is
+ *  as large as the APDU it holds, a short C-APDU takes one slot while a
+ *  bulk R-APDU (extended Le) may be several KB, and the memory is shared by
+ *  the exchanges that do not run at the same time.
+ *
+ *  Each reader has its own pool of APDU_POOL_SLOTS slots of
+ *  APDU_POOL_SLOT_LEN bytes, a buffer takes the first run of free slots long
+ *  enough for it. Buffers are freed in any order.
+ *
+ */
+
+#ifndef APDU_POOL_H
+#define APDU_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rfal_core/rfal_isoDep.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#ifndef APDU_POOL_SLOT_LEN
+#define APDU_POOL_SLOT_LEN          64U     /*!< Allocation unit in bytes, a multiple of 4      */
+#endif
+
+#ifndef APDU_POOL_SLOTS
+#define APDU_POOL_SLOTS             112U    /*!< Slots per reader: 7 KB                         */
+#endif
+
+/*! Bytes of a buffer holding an APDU of len bytes behind the ISO-DEP prologue */
+#define APDU_POOL_APDU_LEN( len )   ((uint32_t)RFAL_ISODEP_PROLOGUE_SIZE + (uint32_t)(len))
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Pool counters */
+typedef struct
+{
+    uint32_t allocs;                        /*!< Buffers handed out                             */
+    uint32_t fails;                         /*!< Requests that did not fit                      */
+    uint16_t slotsUsed;                     /*!< Slots taken now                                */
+    uint16_t slotsPeak;                     /*!< Most slots taken at once                       */
+} apduPoolStats;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Allocates a buffer
+ *
+ * \param[in]  len : bytes, see APDU_POOL_APDU_LEN() for an APDU buffer
+ *
+ * \return the buffer, 4 byte aligned, NULL if no free run of slots is long
+ *         enough
+ *****************************************************************************
+ */
+uint8_t *apduPoolAlloc( uint32_t len );
+
+/*!
+ *****************************************************************************
+ * \brief  Allocates an APDU buffer
+ *
+ * \param[in]  apduLen : APDU bytes the buffer holds
+ *
+ * \return the buffer, NULL if the pool has no room
+ *****************************************************************************
+ */
+rfalIsoDepApduBufFormat *apduPoolAllocApdu( uint32_t apduLen );
+
+/*!
+ *****************************************************************************
+ * \brief  Allocates an I-Block buffer (rfalIsoDepApduTxRxParam.tmpBuf)
+ *
+ * \return the buffer, NULL if the pool has no room
+ *****************************************************************************
+ */
+rfalIsoDepBufFormat *apduPoolAllocBlock( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Frees a buffer
+ *
+ * \param[in]  buf : buffer of apduPoolAlloc*(), NULL is ignored
+ *****************************************************************************
+ */
+void apduPoolFree( const void *buf );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the pool counters of the calling task's reader
+ *
+ * \param[out]  stats : counters
+ *****************************************************************************
+ */
+void apduPoolGetStats( apduPoolStats *stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APDU_POOL_H */
@@ -15,6 +15,10 @@
     #define SPI_SCK     (uint8_t)42
     #define SPI_SS      (uint8_t)15  //Default is 42 
     #define IRQ_PIN     (uint8_t)17
+
+    // One entry per ST25R3911 (PLTF_READERS), the first one is SPI_SS/IRQ_PIN
+    #define READER_SS_PINS  { SPI_SS,  (uint8_t)14, (uint8_t)13, (uint8_t)12 }
+    #define READER_IRQ_PINS { IRQ_PIN, (uint8_t)4,  (uint8_t)5,  (uint8_t)6  }
     
     #define MCU_LED1    (uint8_t)18
     #define MCU_LED2    (uint8_t)1
@@ -28,6 +32,10 @@
     #define SPI_SCK     (uint8_t)37
     #define SPI_SS      (uint8_t)15  //Default is 42 
     #define IRQ_PIN     (uint8_t)17
+
+    // One entry per ST25R3911 (PLTF_READERS), the first one is SPI_SS/IRQ_PIN
+    #define READER_SS_PINS  { SPI_SS,  (uint8_t)14, (uint8_t)13, (uint8_t)12 }
+    #define READER_IRQ_PINS { IRQ_PIN, (uint8_t)4,  (uint8_t)5,  (uint8_t)6  }
     
     #define MCU_LED1    (uint8_t)18
     #define MCU_LED2    (uint8_t)1
@@ -0,0 +1,517 @@
+/*! \file evt_log.c
+ *
+ *  \brief Zero allocation, non blocking binary event log
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdio.h>
+#include <string.h>
+#include "evt_log.h"
+#include "rfal_platform/rfal_platform.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define EVT_LOG_MASK                (EVT_LOG_DEPTH - 1U)
+
+/* The indexes run freely, head - tail is the depth even across the wrap */
+#define evtLogLoad(p)               __atomic_load_n( (p), __ATOMIC_ACQUIRE )
+#define evtLogStore(p, v)           __atomic_store_n( (p), (v), __ATOMIC_RELEASE )
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Ring of a reader, zero initialized is empty */
+typedef struct
+{
+    evtLogRecord buf[EVT_LOG_DEPTH];
+    uint32_t     head;                      /*!< Next slot to write, producer only              */
+    uint32_t     tail;                      /*!< Next slot to read, consumer only               */
+    uint32_t     records;                   /*!< Records put, producer only                     */
+    uint32_t     drops;                     /*!< Records dropped on a full ring, producer only  */
+    uint32_t     depthMax;                  /*!< Highest depth seen on put, producer only       */
+} evtLogRing;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static evtLogRing gEvtLogRings[PLTF_READERS];
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static uint32_t evtLogGetU32( const uint8_t *p )
+{
+    return ((uint32_t)p[0] | ((uint32_t)p[1] << 8U) | ((uint32_t)p[2] << 16U) | ((uint32_t)p[3] << 24U));
+}
+
+
+/*******************************************************************************/
+static int evtLogFormatHex( const uint8_t *buf, uint8_t len, char *out, size_t size )
+{
+    int     n;
+    uint8_t i;
+
+    n = 0;
+    for( i = 0; (i < len) && ((size_t)(n + 2) < size); i++ )
+    {
+        n += snprintf( &out[n], (size - (size_t)n), "%02X", buf[i] );
+    }
+    return n;
+}
+
+
+/*******************************************************************************/
+static const char *evtLogTechName( uint8_t tech )
+{
+    static const char * const techNames[] = { "NFC-A", "NFC-B", "NFC-F", "NFC-V" };
+
+    return ((tech < (sizeof(techNames) / sizeof(techNames[0]))) ? techNames[tech] : "?");
+}
+
+
+/*******************************************************************************/
+static const char *evtLogBrName( uint8_t br )
+{
+    static const char * const brNames[] = { "106", "212", "424", "848" };
+
+    return ((br < (sizeof(brNames) / sizeof(brNames[0]))) ? brNames[br] : "?");
+}
+
+
+/*******************************************************************************/
+static const char *evtLogIsoDepTypeName( uint8_t type )
+{
+    static const char * const typeNames[] = { "NDEF", "payment", "other" };     /* isoDepRateType */
+
+    return ((type < (sizeof(typeNames) / sizeof(typeNames[0]))) ? typeNames[type] : "?");
+}
+
+
+/*******************************************************************************/
+static const char *evtLogNdefTypeName( uint8_t type )
+{
+    static const char * const typeNames[] = { "-", "T2T", "T4T", "T5T" };       /* ndefReadType */
+
+    return ((type < (sizeof(typeNames) / sizeof(typeNames[0]))) ? typeNames[type] : "?");
+}
+
+
+/*******************************************************************************/
+static const char *evtLogNdefCcName( uint8_t src )
+{
+    static const char * const srcNames[] = { "CC read", "CC cached", "CC of model" };  /* ndefReadCcSrc */
+
+    return ((src < (sizeof(srcNames) / sizeof(srcNames[0]))) ? srcNames[src] : "?");
+}
+
+
+/*******************************************************************************/
+static const char *evtLogSpiCostName( uint8_t kind, uint8_t idx )
+{
+    static const char * const phaseNames[] = { "other", "init", "setMode", "setBitRate", "field", "transceive", "worker", "irq", "wakeup" };  /* ST25R3911_TRACE_PHASE_* */
+    static const char * const opNames[]    = { "reg rd", "reg wr", "test rd", "test wr", "fifo rd", "fifo ld", "cmd" };                      /* ST25R3911_TRACE_OP_*    */
+
+    if( kind == EVT_LOG_SPI_COST_PHASE )
+    {
+        return ((idx < (sizeof(phaseNames) / sizeof(phaseNames[0]))) ? phaseNames[idx] : "?");
+    }
+    return ((idx < (sizeof(opNames) / sizeof(opNames[0]))) ? opNames[idx] : "?");
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void evtLogBegin( evtLogRecord *rec, evtLogId id )
+{
+    rec->timeMs = platformGetSysTick();
+    rec->id     = (uint8_t)id;
+    rec->reader = pltf_reader_get();
+    rec->len    = 0U;
+}
+
+
+/*******************************************************************************/
+void evtLogU8( evtLogRecord *rec, uint8_t v )
+{
+    evtLogBytes( rec, &v, 1U );
+}
+
+
+/*******************************************************************************/
+void evtLogU32( evtLogRecord *rec, uint32_t v )
+{
+    uint8_t buf[4];
+
+    buf[0] = (uint8_t)v;
+    buf[1] = (uint8_t)(v >> 8U);
+    buf[2] = (uint8_t)(v >> 16U);
+    buf[3] = (uint8_t)(v >> 24U);
+    evtLogBytes( rec, buf, sizeof(buf) );
+}
+
+
+/*******************************************************************************/
+void evtLogBytes( evtLogRecord *rec, const uint8_t *buf, uint8_t len )
+{
+    uint8_t n;
+
+    n = (uint8_t)((len <= (EVT_LOG_PAYLOAD_MAX - rec->len)) ? len : (EVT_LOG_PAYLOAD_MAX - rec->len));
+    memcpy( &rec->payload[rec->len], buf, n );
+    rec->len += n;
+}
+
+
+/*******************************************************************************/
+bool evtLogCommit( const evtLogRecord *rec )
+{
+    evtLogRing *ring;
+    uint32_t    head;
+    uint32_t    depth;
+
+    ring  = &gEvtLogRings[(rec->reader < PLTF_READERS) ? rec->reader : 0U];
+    head  = ring->head;
+    depth = (head - evtLogLoad( &ring->tail ));
+
+    if( depth >= EVT_LOG_DEPTH )
+    {
+        ring->drops++;
+        return false;
+    }
+
+    ring->buf[head & EVT_LOG_MASK] = *rec;
+    evtLogStore( &ring->head, (head + 1U) );                                          /* Slot written before it is published */
+
+    ring->records++;
+    ring->depthMax = (((depth + 1U) > ring->depthMax) ? (depth + 1U) : ring->depthMax);
+    return true;
+}
+
+
+/*******************************************************************************/
+bool evtLogGet( uint8_t reader, evtLogRecord *rec )
+{
+    evtLogRing *ring;
+    uint32_t    tail;
+
+    ring = &gEvtLogRings[reader];
+    tail = ring->tail;
+    if( tail == evtLogLoad( &ring->head ) )
+    {
+        return false;
+    }
+
+    *rec = ring->buf[tail & EVT_LOG_MASK];
+    evtLogStore( &ring->tail, (tail + 1U) );                                          /* Slot read before it is given back */
+    return true;
+}
+
+
+/*******************************************************************************/
+void evtLogGetStats( uint8_t reader, evtLogStats *stats )
+{
+    const evtLogRing *ring;
+
+    ring = &gEvtLogRings[reader];
+    stats->depth    = (evtLogLoad( &ring->head ) - evtLogLoad( &ring->tail ));
+    stats->depthMax = ring->depthMax;
+    stats->records  = ring->records;
+    stats->drops    = ring->drops;
+}
+
+
+/*******************************************************************************/
+uint8_t evtLogEncode( const evtLogRecord *rec, uint8_t *frame )
+{
+    uint8_t check;
+    uint8_t len;
+    uint8_t i;
+
+    frame[0] = EVT_LOG_SYNC;
+    frame[1] = rec->id;
+    frame[2] = rec->len;
+    frame[3] = (uint8_t)rec->timeMs;
+    frame[4] = (uint8_t)(rec->timeMs >> 8U);
+    frame[5] = (uint8_t)(rec->timeMs >> 16U);
+    frame[6] = (uint8_t)(rec->timeMs >> 24U);
+    frame[7] = rec->reader;
+    memcpy( &frame[EVT_LOG_HDR_LEN], rec->payload, rec->len );
+
+    len   = (uint8_t)(EVT_LOG_HDR_LEN + rec->len);
+    check = 0U;
+    for( i = 1U; i < len; i++ )
+    {
+        check ^= frame[i];
+    }
+    frame[len] = check;
+    return (uint8_t)(len + 1U);
+}
+
+
+/*******************************************************************************/
+bool evtLogDecode( const uint8_t *buf, size_t len, size_t *used, evtLogRecord *rec )
+{
+    size_t  pos;
+    size_t  frameLen;
+    uint8_t check;
+    size_t  i;
+
+    for( pos = 0U; pos < len; pos++ )
+    {
+        if( buf[pos] != EVT_LOG_SYNC )
+        {
+            continue;
+        }
+        if( (len - pos) < (EVT_LOG_HDR_LEN + 1U) )
+        {
+            break;                                                                    /* Header not complete yet */
+        }
+        if( buf[pos + 2U] > EVT_LOG_PAYLOAD_MAX )
+        {
+            continue;                                                                 /* Not a frame */
+        }
+
+        frameLen = (EVT_LOG_HDR_LEN + buf[pos + 2U] + 1U);
+        if( (len - pos) < frameLen )
+        {
+            break;
+        }
+
+        check = 0U;
+        for( i = 1U; i < frameLen; i++ )
+        {
+            check ^= buf[pos + i];
+        }
+        if( check != 0U )
+        {
+            continue;                                                                 /* Broken frame or a stray sync byte: resync on the next one */
+        }
+
+        rec->id     = buf[pos + 1U];
+        rec->len    = buf[pos + 2U];
+        rec->timeMs = evtLogGetU32( &buf[pos + 3U] );
+        rec->reader = buf[pos + 7U];
+        memcpy( rec->payload, &buf[pos + EVT_LOG_HDR_LEN], rec->len );
+
+        *used = (pos + frameLen);
+        return true;
+    }
+
+    *used = pos;
+    return false;
+}
+
+
+/*******************************************************************************/
+int evtLogFormat( const evtLogRecord *rec, char *buf, size_t size )
+{
+    const uint8_t *p;
+    uint32_t       wakes;
+    uint32_t       falseWakes;
+    uint32_t       rxOk;
+    uint32_t       rxErrors;
+    int            n;
+
+    p = rec->payload;
+
+    switch( rec->id )
+    {
+        case EVT_LOG_TAG_ARRIVED:
+            if( (rec->len < 2U) || (rec->len < (2U + p[1])) )
+            {
+                break;
+            }
+            n  = snprintf( buf, size, "Tag arrived: %s UID: ", evtLogTechName( p[0] ) );
+            if( (n < 0) || ((size_t)n >= size) )
+            {
+                return n;
+            }
+            n += evtLogFormatHex( &p[2], p[1], &buf[n], (size - (size_t)n) );
+            return n;
+
+        case EVT_LOG_TAG_LEFT:
+            if( (rec->len < 6U) || (rec->len < (6U + p[5])) )
+            {
+                break;
+            }
+            n  = snprintf( buf, size, "Tag left: %s UID: ", evtLogTechName( p[0] ) );
+            if( (n < 0) || ((size_t)n >= size) )
+            {
+                return n;
+            }
+            n += evtLogFormatHex( &p[6], p[5], &buf[n], (size - (size_t)n) );
+            n += snprintf( &buf[n], (size - (size_t)n), " after %lu ms", (unsigned long)evtLogGetU32( &p[1] ) );
+            return n;
+
+        case EVT_LOG_DISCOVER_ERR:
+            if( rec->len < 4U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "Discovery start failed: %lu", (unsigned long)evtLogGetU32( &p[0] ) );
+
+        case EVT_LOG_WAKEUP_CAL_ERR:
+            if( rec->len < 4U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "Wake-up calibration failed: %lu", (unsigned long)evtLogGetU32( &p[0] ) );
+
+        case EVT_LOG_WAKEUP:
+            if( rec->len < 20U )
+            {
+                break;
+            }
+            wakes      = evtLogGetU32( &p[0] );
+            falseWakes = evtLogGetU32( &p[4] );
+            return snprintf( buf, size, "Wake-up: %lu wakes, %lu false (%lu%%), latency avg %lu ms max %lu ms, asleep %lu ms",
+                             (unsigned long)wakes, (unsigned long)falseWakes, (unsigned long)((wakes != 0U) ? ((falseWakes * 100U) / wakes) : 0U),
+                             (unsigned long)evtLogGetU32( &p[8] ), (unsigned long)evtLogGetU32( &p[12] ), (unsigned long)evtLogGetU32( &p[16] ) );
+
+        case EVT_LOG_WAKEUP_REF:
+            if( rec->len < 16U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "  amp 0x%02X+-%u pha 0x%02X+-%u, %lu timer events, %lu ref updates, %lu calibrations",
+                             p[0], p[1], p[2], p[3], (unsigned long)evtLogGetU32( &p[4] ), (unsigned long)evtLogGetU32( &p[8] ),
+                             (unsigned long)evtLogGetU32( &p[12] ) );
+
+        case EVT_LOG_TECH_STATS:
+            if( rec->len < 21U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "Tech %s: %lu polls, %lu hits, %lu skips, avg %lu us max %lu us", evtLogTechName( p[0] ),
+                             (unsigned long)evtLogGetU32( &p[1] ), (unsigned long)evtLogGetU32( &p[5] ), (unsigned long)evtLogGetU32( &p[9] ),
+                             (unsigned long)evtLogGetU32( &p[13] ), (unsigned long)evtLogGetU32( &p[17] ) );
+
+        case EVT_LOG_RING:
+            if( rec->len < 20U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "Log ring %u: %lu records, %lu dropped, depth %lu max %lu/%lu", rec->reader,
+                             (unsigned long)evtLogGetU32( &p[0] ), (unsigned long)evtLogGetU32( &p[4] ), (unsigned long)evtLogGetU32( &p[8] ),
+                             (unsigned long)evtLogGetU32( &p[12] ), (unsigned long)evtLogGetU32( &p[16] ) );
+
+        case EVT_LOG_DPO_STATS:
+            if( rec->len < 18U )
+            {
+                break;
+            }
+            rxOk     = evtLogGetU32( &p[10] );
+            rxErrors = evtLogGetU32( &p[14] );
+            return snprintf( buf, size, "Power level %u (RFO 0x%02X): %lu cycles, %lu steps in, %lu frames, %lu errors (%lu.%lu%%)", p[0], p[1],
+                             (unsigned long)evtLogGetU32( &p[2] ), (unsigned long)evtLogGetU32( &p[6] ), (unsigned long)(rxOk + rxErrors),
+                             (unsigned long)rxErrors, (unsigned long)(((rxOk + rxErrors) != 0U) ? ((rxErrors * 100U) / (rxOk + rxErrors)) : 0U),
+                             (unsigned long)(((rxOk + rxErrors) != 0U) ? (((rxErrors * 1000U) / (rxOk + rxErrors)) % 10U) : 0U) );
+
+        case EVT_LOG_ISODEP_STATS:
+            if( rec->len < 22U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "ISO-DEP %s at %s kbit/s: %lu sessions, %lu failed, %lu APDUs, %lu bytes/s, avg %lu us per APDU",
+                             evtLogIsoDepTypeName( p[0] ), evtLogBrName( p[1] ), (unsigned long)evtLogGetU32( &p[2] ), (unsigned long)evtLogGetU32( &p[6] ),
+                             (unsigned long)evtLogGetU32( &p[10] ), (unsigned long)evtLogGetU32( &p[14] ), (unsigned long)evtLogGetU32( &p[18] ) );
+
+        case EVT_LOG_ISODEP_FALLBACK:
+            if( (rec->len < 3U) || (rec->len < (3U + p[2])) )
+            {
+                break;
+            }
+            n  = snprintf( buf, size, "ISO-DEP fallback %s -> %s kbit/s UID: ", evtLogBrName( p[0] ), evtLogBrName( p[1] ) );
+            if( (n < 0) || ((size_t)n >= size) )
+            {
+                return n;
+            }
+            n += evtLogFormatHex( &p[3], p[2], &buf[n], (size - (size_t)n) );
+            return n;
+
+        case EVT_LOG_ISODEP_RATE:
+            if( rec->len < 16U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "  %lu fallbacks, %lu probes, %lu PPS failures, %lu cards", (unsigned long)evtLogGetU32( &p[0] ),
+                             (unsigned long)evtLogGetU32( &p[4] ), (unsigned long)evtLogGetU32( &p[8] ), (unsigned long)evtLogGetU32( &p[12] ) );
+
+        case EVT_LOG_NDEF:
+            if( (rec->len < 14U) || (rec->len < (14U + p[13])) )
+            {
+                break;
+            }
+            if( p[2] == 0U )
+            {
+                n = snprintf( buf, size, "NDEF %s: %lu bytes, %u records, %u commands, %lu us (%s) UID: ", evtLogNdefTypeName( p[0] ),
+                              (unsigned long)evtLogGetU32( &p[5] ), p[4], p[3], (unsigned long)evtLogGetU32( &p[9] ), evtLogNdefCcName( p[1] ) );
+            }
+            else
+            {
+                n = snprintf( buf, size, "NDEF %s: error %u, %u commands, %lu us (%s) UID: ", evtLogNdefTypeName( p[0] ), p[2], p[3],
+                              (unsigned long)evtLogGetU32( &p[9] ), evtLogNdefCcName( p[1] ) );
+            }
+            if( (n < 0) || ((size_t)n >= size) )
+            {
+                return n;
+            }
+            n += evtLogFormatHex( &p[14], p[13], &buf[n], (size - (size_t)n) );
+            return n;
+
+        case EVT_LOG_NDEF_STATS:
+            if( rec->len < 24U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "NDEF reads: %lu, %lu with the tag's CC cached, %lu with the model's, %lu CC reads, %lu stale, %lu failed",
+                             (unsigned long)evtLogGetU32( &p[0] ), (unsigned long)evtLogGetU32( &p[4] ), (unsigned long)evtLogGetU32( &p[8] ),
+                             (unsigned long)evtLogGetU32( &p[12] ), (unsigned long)evtLogGetU32( &p[16] ), (unsigned long)evtLogGetU32( &p[20] ) );
+
+        case EVT_LOG_SPI_CYCLE:
+            if( rec->len < 12U )
+            {
+                break;
+            }
+            return snprintf( buf, size, "SPI cycle: %lu frames, %lu bytes, %lu us", (unsigned long)evtLogGetU32( &p[0] ),
+                             (unsigned long)evtLogGetU32( &p[4] ), (unsigned long)evtLogGetU32( &p[8] ) );
+
+        case EVT_LOG_SPI_COST:
+            if( rec->len < 14U )
+            {
+                break;
+            }
+            if( p[0] == EVT_LOG_SPI_COST_REG )
+            {
+                return snprintf( buf, size, "  reg 0x%02X   %5lu frames %6lu bytes %7lu us", p[1], (unsigned long)evtLogGetU32( &p[2] ),
+                                 (unsigned long)evtLogGetU32( &p[6] ), (unsigned long)evtLogGetU32( &p[10] ) );
+            }
+            return snprintf( buf, size, "  %-10s %5lu frames %6lu bytes %7lu us", evtLogSpiCostName( p[0], p[1] ), (unsigned long)evtLogGetU32( &p[2] ),
+                             (unsigned long)evtLogGetU32( &p[6] ), (unsigned long)evtLogGetU32( &p[10] ) );
+
+        default:
+            break;
+    }
+
+    return snprintf( buf, size, "Record %u, %u bytes", rec->id, rec->len );               /* Unknown or short: still visible */
+}
@@ -0,0 +1,223 @@
+/*! \file evt_log.h
+ *
+ *  \brief Zero allocation, non blocking binary event log
+ *
+ *  Replaces the serial prints of the poll path: the pollers put compact
+ *  binary records (an ID, a time stamp and a few packed arguments) into a
+ *  preallocated ring per reader and go on, the output task drains the rings
+ *  and either formats the records as text or sends them as binary frames,
+ *  decoded on the host (host_main --log-decode).
+ *
+ *  Each ring has exactly one producer (the poller of the reader) and one
+ *  consumer (the output task). The producer only writes the head, the
+ *  consumer only the tail: no lock is needed, the indexes are published
+ *  with release/acquire ordering after (before) the slot is written (read).
+ *  A record put into a full ring is dropped and counted, the poller never
+ *  waits.
+ *
+ *  Binary frame, little endian:
+ *    EVT_LOG_SYNC | id | len | time ms (4) | reader | payload (len) | check
+ *  where check is the XOR of all the bytes from id to the end of the payload.
+ *
+ */
+
+#ifndef EVT_LOG_H
+#define EVT_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#ifndef EVT_LOG_DEPTH
+#define EVT_LOG_DEPTH               32U     /*!< Records buffered per reader, power of 2        */
+#endif
+
+#if ((EVT_LOG_DEPTH & (EVT_LOG_DEPTH - 1U)) != 0U)
+#error "EVT_LOG_DEPTH must be a power of 2"
+#endif
+
+#define EVT_LOG_PAYLOAD_MAX         24U     /*!< Longest record payload                         */
+#define EVT_LOG_SYNC                0xA5U   /*!< First byte of a binary frame                   */
+#define EVT_LOG_HDR_LEN             8U      /*!< Frame bytes before the payload                 */
+#define EVT_LOG_FRAME_MAX           (EVT_LOG_HDR_LEN + EVT_LOG_PAYLOAD_MAX + 1U) /*!< Longest binary frame */
+
+#define EVT_LOG_SPI_COST_PHASE      0U      /*!< EVT_LOG_SPI_COST of an RFAL phase              */
+#define EVT_LOG_SPI_COST_OP         1U      /*!< EVT_LOG_SPI_COST of an operation               */
+#define EVT_LOG_SPI_COST_REG        2U      /*!< EVT_LOG_SPI_COST of a register                 */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Record IDs and their payload (u8/u32 packed little endian, in this order) */
+typedef enum
+{
+    EVT_LOG_TAG_ARRIVED    = 1,             /*!< tech u8, uidLen u8, uid                        */
+    EVT_LOG_TAG_LEFT       = 2,             /*!< tech u8, presentMs u32, uidLen u8, uid         */
+    EVT_LOG_DISCOVER_ERR   = 3,             /*!< err u32: rfalNfcDiscover() failed              */
+    EVT_LOG_WAKEUP_CAL_ERR = 4,             /*!< err u32: wake-up calibration failed            */
+    EVT_LOG_WAKEUP         = 5,             /*!< wakes, falseWakes, latencyAvgMs, latencyMaxMs, sleepMs u32 */
+    EVT_LOG_WAKEUP_REF     = 6,             /*!< ampRef, ampDelta, phaRef, phaDelta u8, timerEvents, refUpdates, calibrations u32 */
+    EVT_LOG_TECH_STATS     = 7,             /*!< tech u8, polls, hits, skips, avgUs, maxUs u32  */
+    EVT_LOG_RING           = 8,             /*!< records, drops, depth, depthMax, size u32      */
+    EVT_LOG_DPO_STATS      = 9,             /*!< level, rfo u8, adjusts, steps, rxOk, rxErrors u32 */
+    EVT_LOG_ISODEP_STATS   = 10,            /*!< type, br u8, sessions, failures, apdus, bytesPerS, avgApduUs u32 */
+    EVT_LOG_ISODEP_FALLBACK = 11,           /*!< fromBr, toBr u8, uidLen u8, uid                */
+    EVT_LOG_ISODEP_RATE    = 12,            /*!< fallbacks, probes, ppsFails, cards u32         */
+    EVT_LOG_NDEF           = 13,            /*!< type, ccSrc, err, cmds, records u8, msgLen, timeUs u32, uidLen u8, uid */
+    EVT_LOG_NDEF_STATS     = 14,            /*!< reads, tagHits, modelHits, misses, stale, failures u32 */
+    EVT_LOG_SPI_CYCLE      = 15,            /*!< frames, bytes, timeUs u32: SPI cost of a poll cycle */
+    EVT_LOG_SPI_COST       = 16             /*!< kind (phase, op, reg), idx u8, frames, bytes, timeUs u32 */
+} evtLogId;
+
+/*! Log record */
+typedef struct
+{
+    uint32_t timeMs;                        /*!< Record time (platform ms tick)                 */
+    uint8_t  id;                            /*!< evtLogId                                       */
+    uint8_t  reader;                        /*!< Reader the record is about                     */
+    uint8_t  len;                           /*!< Payload length                                 */
+    uint8_t  payload[EVT_LOG_PAYLOAD_MAX];  /*!< Packed arguments                               */
+} evtLogRecord;
+
+/*! Ring counters */
+typedef struct
+{
+    uint32_t depth;                         /*!< Records waiting now                            */
+    uint32_t depthMax;                      /*!< Highest depth seen                             */
+    uint32_t records;                       /*!< Records put                                    */
+    uint32_t drops;                         /*!< Records dropped on a full ring                 */
+} evtLogStats;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Starts a record on the caller's stack
+ *
+ * Time stamps the record and binds it to the reader of the calling task.
+ *
+ * \param[out]  rec : record
+ * \param[in]   id  : evtLogId
+ *****************************************************************************
+ */
+void evtLogBegin( evtLogRecord *rec, evtLogId id );
+
+/*!
+ *****************************************************************************
+ * \brief  Appends arguments to a record payload
+ *
+ * Arguments that do not fit in EVT_LOG_PAYLOAD_MAX are cut.
+ *
+ * \param[in,out]  rec : record
+ * \param[in]      v   : value (evtLogU8, evtLogU32)
+ * \param[in]      buf : bytes (evtLogBytes)
+ * \param[in]      len : byte count (evtLogBytes)
+ *****************************************************************************
+ */
+void evtLogU8( evtLogRecord *rec, uint8_t v );
+void evtLogU32( evtLogRecord *rec, uint32_t v );
+void evtLogBytes( evtLogRecord *rec, const uint8_t *buf, uint8_t len );
+
+/*!
+ *****************************************************************************
+ * \brief  Puts a record into the ring of its reader, producer side
+ *
+ * \param[in]  rec : record, copied
+ *
+ * \return true if queued, false if the ring was full and the record dropped
+ *****************************************************************************
+ */
+bool evtLogCommit( const evtLogRecord *rec );
+
+/*!
+ *****************************************************************************
+ * \brief  Takes the oldest record of a reader's ring, consumer side
+ *
+ * \param[in]   reader : reader
+ * \param[out]  rec    : record
+ *
+ * \return true if a record was taken, false if the ring is empty
+ *****************************************************************************
+ */
+bool evtLogGet( uint8_t reader, evtLogRecord *rec );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the counters of a reader's ring, from any task
+ *
+ * The counters are read without a lock, each one is consistent on its own.
+ *
+ * \param[in]   reader : reader
+ * \param[out]  stats  : counters
+ *****************************************************************************
+ */
+void evtLogGetStats( uint8_t reader, evtLogStats *stats );
+
+/*!
+ *****************************************************************************
+ * \brief  Encodes a record as a binary frame
+ *
+ * \param[in]   rec   : record
+ * \param[out]  frame : EVT_LOG_FRAME_MAX bytes
+ *
+ * \return frame length
+ *****************************************************************************
+ */
+uint8_t evtLogEncode( const evtLogRecord *rec, uint8_t *frame );
+
+/*!
+ *****************************************************************************
+ * \brief  Decodes the first binary frame of a byte stream
+ *
+ * Bytes that do not start a valid frame (text, a broken frame) are
+ * skipped, so that a capture mixing text and frames still decodes.
+ *
+ * \param[in]   buf  : stream
+ * \param[in]   len  : stream length
+ * \param[out]  used : bytes consumed, frame and skipped bytes
+ * \param[out]  rec  : record
+ *
+ * \return true if a record was decoded, false if more bytes are needed
+ *****************************************************************************
+ */
+bool evtLogDecode( const uint8_t *buf, size_t len, size_t *used, evtLogRecord *rec );
+
+/*!
+ *****************************************************************************
+ * \brief  Formats a record as a text line, without reader prefix nor EOL
+ *
+ * \param[in]   rec  : record
+ * \param[out]  buf  : text
+ * \param[in]   size : text buffer size
+ *
+ * \return text length, as snprintf()
+ *****************************************************************************
+ */
+int evtLogFormat( const evtLogRecord *rec, char *buf, size_t size );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVT_LOG_H */
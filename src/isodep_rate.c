@@ -0,0 +1,197 @@
+/*! \file isodep_rate.c
+ *
+ *  \brief ISO-DEP bit rate selection with per card fallback
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <string.h>
+
+#include "isodep_rate.h"
+#include "rfal_platform/rfal_platform.h"
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Cap of a card */
+typedef struct
+{
+    uint8_t     uid[ISODEP_RATE_UID_MAX];
+    uint8_t     uidLen;                     /*!< 0: free                                        */
+    rfalBitRate cap;                        /*!< Highest bit rate to negotiate                  */
+    uint8_t     errs;                       /*!< Consecutive failed sessions                    */
+    uint8_t     clean;                      /*!< Clean sessions since the last change           */
+    bool        probing;                    /*!< Cap just raised, not confirmed yet             */
+    uint32_t    seq;                        /*!< Last use, least recently seen is replaced      */
+} isoDepRateCard;
+
+/*! Rate context, one per reader */
+typedef struct
+{
+    rfalBitRate        maxBR;
+    uint32_t           seq;
+    isoDepRateCard     cards[ISODEP_RATE_CARDS];
+    isoDepRateStats    stats[ISODEP_RATE_TYPES][ISODEP_RATE_BRS];
+    isoDepRateCounters cnt;
+} isoDepRateCtx;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static isoDepRateCtx gIdrInstances[PLTF_READERS];
+
+#define gIdr         (gIdrInstances[pltf_reader_get()])  /*!< Context of the calling task's reader */
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static isoDepRateCard *isoDepRateFind( const uint8_t *uid, uint8_t uidLen, bool add )
+{
+    isoDepRateCard *card;
+    uint8_t         i;
+
+    card = NULL;
+    for( i = 0; i < ISODEP_RATE_CARDS; i++ )
+    {
+        if( (gIdr.cards[i].uidLen == uidLen) && (memcmp( gIdr.cards[i].uid, uid, uidLen ) == 0) )
+        {
+            gIdr.cards[i].seq = ++gIdr.seq;
+            return &gIdr.cards[i];
+        }
+        if( (card == NULL) || (gIdr.cards[i].uidLen == 0U) || ((card->uidLen != 0U) && (gIdr.cards[i].seq < card->seq)) )
+        {
+            card = &gIdr.cards[i];                                                    /* Free entry first, least recently seen otherwise */
+        }
+    }
+
+    if( !add )
+    {
+        return NULL;
+    }
+
+    memset( card, 0x00, sizeof(isoDepRateCard) );
+    memcpy( card->uid, uid, uidLen );
+    card->uidLen = uidLen;
+    card->cap    = gIdr.maxBR;
+    card->seq    = ++gIdr.seq;
+    return card;
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void isoDepRateInit( rfalBitRate maxBR )
+{
+    memset( &gIdr, 0x00, sizeof(gIdr) );
+    gIdr.maxBR = ((maxBR > RFAL_BR_848) ? RFAL_BR_848 : maxBR);
+}
+
+
+/*******************************************************************************/
+rfalBitRate isoDepRateGet( const uint8_t *uid, uint8_t uidLen )
+{
+    const isoDepRateCard *card;
+
+    card = (((uidLen == 0U) || (uidLen > ISODEP_RATE_UID_MAX)) ? NULL : isoDepRateFind( uid, uidLen, false ));
+    return ((card != NULL) ? card->cap : gIdr.maxBR);
+}
+
+
+/*******************************************************************************/
+bool isoDepRateReport( const uint8_t *uid, uint8_t uidLen, const isoDepRateSession *ses )
+{
+    isoDepRateStats *st;
+    isoDepRateCard  *card;
+    bool             ppsFailed;
+
+    if( (ses->type < ISODEP_RATE_TYPES) && (ses->br < ISODEP_RATE_BRS) )
+    {
+        st            = &gIdr.stats[ses->type][ses->br];
+        st->sessions++;
+        st->failures += (ses->ok ? 0U : 1U);
+        st->apdus    += ses->apdus;
+        st->bytes    += ses->bytes;
+        st->timeUs   += ses->timeUs;
+    }
+
+    ppsFailed          = (ses->br < ses->tried);
+    gIdr.cnt.ppsFails += (ppsFailed ? 1U : 0U);
+
+    if( (uidLen == 0U) || (uidLen > ISODEP_RATE_UID_MAX) )
+    {
+        return false;
+    }
+    card = isoDepRateFind( uid, uidLen, true );
+
+    if( ses->ok && !ppsFailed )
+    {
+        card->errs    = 0;
+        card->probing = false;
+        if( (card->cap < gIdr.maxBR) && (++card->clean >= ISODEP_RATE_PROBE_SESSIONS) )
+        {
+            card->cap++;
+            card->clean   = 0;
+            card->probing = true;
+            gIdr.cnt.probes++;
+        }
+        return false;
+    }
+
+    /* A failed probe falls back at once, anything else after ERR_LIMIT failures in a row */
+    card->clean = 0;
+    card->errs++;
+    if( (ses->tried == RFAL_BR_106) || ((card->errs < ISODEP_RATE_ERR_LIMIT) && !card->probing) )
+    {
+        return false;
+    }
+
+    card->cap     = (rfalBitRate)(ses->tried - 1U);
+    card->errs    = 0;
+    card->probing = false;
+    gIdr.cnt.fallbacks++;
+    return true;
+}
+
+
+/*******************************************************************************/
+bool isoDepRateGetStats( isoDepRateType type, rfalBitRate br, isoDepRateStats *stats )
+{
+    if( (type >= ISODEP_RATE_TYPES) || (br >= ISODEP_RATE_BRS) )
+    {
+        return false;
+    }
+
+    *stats = gIdr.stats[type][br];
+    return true;
+}
+
+
+/*******************************************************************************/
+void isoDepRateGetCounters( isoDepRateCounters *cnt )
+{
+    uint8_t i;
+
+    *cnt       = gIdr.cnt;
+    cnt->cards = 0;
+    for( i = 0; i < ISODEP_RATE_CARDS; i++ )
+    {
+        cnt->cards += ((gIdr.cards[i].uidLen != 0U) ? 1U : 0U);
+    }
+}
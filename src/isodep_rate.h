@@ -0,0 +1,174 @@
+/*! \file isodep_rate.h
+ *
+ *  \brief ISO-DEP bit rate selection with per card fallback
+ *
+ *  Provides the max bit rate the ISO-DEP activation negotiates (PPS for
+ *  NFC-A, ATTRIB for NFC-B, see rfalNfcDiscoverParam.maxBRCb) for each card
+ *  and learns from the outcome of the sessions run with it:
+ *   - a card not seen before gets the configured max bit rate, the
+ *     activation then agrees on the highest one both sides offer
+ *   - ISODEP_RATE_ERR_LIMIT consecutive sessions of a card ending in a
+ *     transmission error (or a PPS not answered) at a bit rate above 106
+ *     lower its cap by one step
+ *   - after ISODEP_RATE_PROBE_SESSIONS clean sessions below the max bit
+ *     rate the cap is raised by one step again, a probe: if its first
+ *     session fails the cap falls back at once
+ *
+ *  The caps of the last ISODEP_RATE_CARDS cards are kept, identified by
+ *  their UID (NFCID1 / PUPI); the least recently seen one is replaced.
+ *
+ *  The sessions are also accounted per card type and bit rate: APDUs,
+ *  bytes and exchange time, i.e. the effective APDU throughput.
+ *
+ */
+
+#ifndef ISODEP_RATE_H
+#define ISODEP_RATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rfal_core/rfal_rf.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#ifndef ISODEP_RATE_CARDS
+#define ISODEP_RATE_CARDS           8U      /*!< Cards whose cap is kept                        */
+#endif
+
+#ifndef ISODEP_RATE_ERR_LIMIT
+#define ISODEP_RATE_ERR_LIMIT       2U      /*!< Consecutive failed sessions before falling back */
+#endif
+
+#ifndef ISODEP_RATE_PROBE_SESSIONS
+#define ISODEP_RATE_PROBE_SESSIONS  16U     /*!< Clean sessions before probing one step higher  */
+#endif
+
+#define ISODEP_RATE_UID_MAX         10U     /*!< Longest UID (NFC-A triple size)                */
+#define ISODEP_RATE_BRS             4U      /*!< Bit rates accounted: 106, 212, 424, 848        */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Card types, by the application found */
+typedef enum
+{
+    ISODEP_RATE_TYPE_NDEF  = 0,             /*!< Type 4 Tag NDEF application                    */
+    ISODEP_RATE_TYPE_PAY   = 1,             /*!< Payment application (PPSE)                     */
+    ISODEP_RATE_TYPE_OTHER = 2,             /*!< Neither of them, or no answer to the first one */
+    ISODEP_RATE_TYPES      = 3
+} isoDepRateType;
+
+/*! Outcome of a session with an activated card */
+typedef struct
+{
+    isoDepRateType type;                    /*!< Card type                                      */
+    rfalBitRate    tried;                   /*!< Bit rate aimed at: cap and card offer          */
+    rfalBitRate    br;                      /*!< Bit rate agreed, below tried if PPS failed     */
+    bool           ok;                      /*!< No transmission error                          */
+    uint32_t       apdus;                   /*!< APDUs exchanged                                */
+    uint32_t       bytes;                   /*!< C-APDU and R-APDU bytes                        */
+    uint32_t       timeUs;                  /*!< Exchange time                                  */
+} isoDepRateSession;
+
+/*! Statistics of a card type at a bit rate */
+typedef struct
+{
+    uint32_t sessions;                      /*!< Sessions run                                   */
+    uint32_t failures;                      /*!< Sessions ended by a transmission error         */
+    uint32_t apdus;                         /*!< APDUs exchanged                                */
+    uint32_t bytes;                         /*!< C-APDU and R-APDU bytes                        */
+    uint32_t timeUs;                        /*!< Exchange time                                  */
+} isoDepRateStats;
+
+/*! Cap counters */
+typedef struct
+{
+    uint32_t fallbacks;                     /*!< Caps lowered                                   */
+    uint32_t probes;                        /*!< Caps raised again                              */
+    uint32_t ppsFails;                      /*!< Activations that stayed below the rate aimed at */
+    uint32_t cards;                         /*!< Cards whose cap is kept now                    */
+} isoDepRateCounters;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Initializes the caps and statistics
+ *
+ * \param[in]  maxBR : highest bit rate to negotiate, RFAL_BR_106 .. RFAL_BR_848
+ *****************************************************************************
+ */
+void isoDepRateInit( rfalBitRate maxBR );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the cap of a card
+ *
+ * \param[in]  uid    : UID
+ * \param[in]  uidLen : UID length
+ *
+ * \return the cap, the max bit rate for a card not seen before
+ *****************************************************************************
+ */
+rfalBitRate isoDepRateGet( const uint8_t *uid, uint8_t uidLen );
+
+/*!
+ *****************************************************************************
+ * \brief  Reports the outcome of a session and adapts the card's cap
+ *
+ * \param[in]  uid    : UID
+ * \param[in]  uidLen : UID length
+ * \param[in]  ses    : session outcome
+ *
+ * \return true if the cap of the card was lowered
+ *****************************************************************************
+ */
+bool isoDepRateReport( const uint8_t *uid, uint8_t uidLen, const isoDepRateSession *ses );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the statistics of a card type at a bit rate
+ *
+ * \param[in]   type  : card type
+ * \param[in]   br    : bit rate, RFAL_BR_106 .. RFAL_BR_848
+ * \param[out]  stats : statistics since #isoDepRateInit
+ *
+ * \return false if type or bit rate are out of range
+ *****************************************************************************
+ */
+bool isoDepRateGetStats( isoDepRateType type, rfalBitRate br, isoDepRateStats *stats );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the cap counters
+ *
+ * \param[out]  cnt : counters since #isoDepRateInit
+ *****************************************************************************
+ */
+void isoDepRateGetCounters( isoDepRateCounters *cnt );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ISODEP_RATE_H */
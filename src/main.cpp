@@ -5,12 +5,20 @@
 #include "SPI.h"
 
 #include "rfal_platform/rfal_platform.h"
+#include "evt_log.h"
+#include "tag_tracker.h"
+#include "wakeup_ctrl.h"
+#include "isodep_rate.h"
+#include "apdu_pool.h"
+#include "ndef_read.h"
 
 
 extern "C" {
 #include "rfal_core/rfal_nfc.h"             // Includes all of "rfal_nfc[a|b|f|v].h", "rfal_isoDep.h" and "rfal_nfcDep.h".
 #include "rfal_core/rfal_t2t.h"
 #include "rfal_core/rfal_analogConfig.h"
+#include "rfal_core/rfal_dpo.h"
+#include "rfal_core/st25r3911/st25r3911_trace.h"
 }
 
 
@@ -51,14 +59,102 @@ extern "C" {
 * GLOBAL DEFINES
 ******************************************************************************
 */
-#define EXAMPLE_RFAL_POLLER_DEVICES      10    /* Number of devices supported */
-#define EXAMPLE_RFAL_POLLER_RF_BUF_LEN   255   /* RF buffer length            */
+#define EXAMPLE_RFAL_POLLER_FIELD_OFF_MS 10    /* Minimum field Off time to reset the devices nearby (> tRESET 5.1ms) */
+#define EXAMPLE_RFAL_POLLER_IDLE_MS      30    /* Field Off/idle window between two poll cycles, bounds the detection latency */
 
-#define EXAMPLE_RFAL_POLLER_FOUND_NONE   0x00  /* No device found Flag        */
-#define EXAMPLE_RFAL_POLLER_FOUND_A      0x01  /* NFC-A device found Flag     */
-#define EXAMPLE_RFAL_POLLER_FOUND_B      0x02  /* NFC-B device found Flag     */
-#define EXAMPLE_RFAL_POLLER_FOUND_F      0x04  /* NFC-F device found Flag     */
-#define EXAMPLE_RFAL_POLLER_FOUND_V      0x08  /* NFC-V device Flag           */
+#define EXAMPLE_RFAL_POLLER_NFCF_NFCID2_POS  (RFAL_FELICA_LEN_LEN + RFAL_NFCF_CMD_LEN)  /* NFCID2 offset in a SENSF_RES poll response */
+
+/* Discovery profiles, select one with -DEXAMPLE_RFAL_POLLER_PROFILE=<n> */
+#define EXAMPLE_RFAL_POLLER_PROFILE_ALL  0     /* NFC-A/B/F/V, resolve every device in the field             */
+#define EXAMPLE_RFAL_POLLER_PROFILE_FAST 1     /* NFC-A/B/F/V, bail out after the first technology found     */
+#define EXAMPLE_RFAL_POLLER_PROFILE_NFCA 2     /* NFC-A only                                                 */
+#define EXAMPLE_RFAL_POLLER_PROFILE_NFCV 3     /* NFC-V only                                                 */
+
+#ifndef EXAMPLE_RFAL_POLLER_PROFILE
+#define EXAMPLE_RFAL_POLLER_PROFILE      EXAMPLE_RFAL_POLLER_PROFILE_ALL
+#endif
+
+#if (EXAMPLE_RFAL_POLLER_PROFILE == EXAMPLE_RFAL_POLLER_PROFILE_ALL)
+#define EXAMPLE_RFAL_POLLER_TECHS        (RFAL_NFC_POLL_TECH_A | RFAL_NFC_POLL_TECH_B | RFAL_NFC_POLL_TECH_F | RFAL_NFC_POLL_TECH_V)
+#define EXAMPLE_RFAL_POLLER_TECHS_BAIL   RFAL_NFC_TECH_NONE
+#define EXAMPLE_RFAL_POLLER_DEV_LIMIT    5U    /* RFAL_NFC_MAX_DEVICES */
+#elif (EXAMPLE_RFAL_POLLER_PROFILE == EXAMPLE_RFAL_POLLER_PROFILE_FAST)
+#define EXAMPLE_RFAL_POLLER_TECHS        (RFAL_NFC_POLL_TECH_A | RFAL_NFC_POLL_TECH_B | RFAL_NFC_POLL_TECH_F | RFAL_NFC_POLL_TECH_V)
+#define EXAMPLE_RFAL_POLLER_TECHS_BAIL   (RFAL_NFC_POLL_TECH_A | RFAL_NFC_POLL_TECH_B | RFAL_NFC_POLL_TECH_F)
+#define EXAMPLE_RFAL_POLLER_DEV_LIMIT    1U
+#elif (EXAMPLE_RFAL_POLLER_PROFILE == EXAMPLE_RFAL_POLLER_PROFILE_NFCA)
+#define EXAMPLE_RFAL_POLLER_TECHS        RFAL_NFC_POLL_TECH_A
+#define EXAMPLE_RFAL_POLLER_TECHS_BAIL   RFAL_NFC_TECH_NONE
+#define EXAMPLE_RFAL_POLLER_DEV_LIMIT    5U
+#elif (EXAMPLE_RFAL_POLLER_PROFILE == EXAMPLE_RFAL_POLLER_PROFILE_NFCV)
+#define EXAMPLE_RFAL_POLLER_TECHS        RFAL_NFC_POLL_TECH_V
+#define EXAMPLE_RFAL_POLLER_TECHS_BAIL   RFAL_NFC_TECH_NONE
+#define EXAMPLE_RFAL_POLLER_DEV_LIMIT    5U
+#else
+#error "EXAMPLE_RFAL_POLLER_PROFILE: unknown discovery profile"
+#endif
+
+#ifndef EXAMPLE_RFAL_POLLER_WAKEUP
+#define EXAMPLE_RFAL_POLLER_WAKEUP       0     /* 1: sleep in the low power Wake-Up mode while no device is known, see wakeup_ctrl.h */
+#endif
+
+#ifndef EXAMPLE_RFAL_POLLER_SCHED
+#define EXAMPLE_RFAL_POLLER_SCHED        1     /* 1: adaptive technology scheduler, NFC-A first and never skipped, NFC-V next */
+#endif
+
+#define EXAMPLE_RFAL_POLLER_SCHED_REPORT 100U  /* Poll cycles between two technology statistics reports */
+
+#ifndef EXAMPLE_RFAL_POLLER_DPO
+#define EXAMPLE_RFAL_POLLER_DPO          1     /* 1: Dynamic Power Output, the field strength follows the antenna load, see exampleRfalPollerDpoTable */
+#endif
+
+#define EXAMPLE_RFAL_POLLER_DPO_REPORT   100U  /* Poll cycles between two power level statistics reports */
+
+#ifndef EXAMPLE_RFAL_POLLER_ISODEP
+#define EXAMPLE_RFAL_POLLER_ISODEP       1     /* 1: read the ISO-DEP cards found (T4T NDEF, payment PPSE) at the highest bit rate both sides hold, see isodep_rate.h */
+#endif
+
+#define EXAMPLE_RFAL_POLLER_ISODEP_MAX_BR   RFAL_BR_848 /* Highest bit rate negotiated with PPS (NFC-A) / ATTRIB (NFC-B), RFAL_BR_106: no PPS */
+#define EXAMPLE_RFAL_POLLER_ISODEP_TRIES    4U    /* Sessions per activation: a failed one is retried after a DESELECT and a new activation */
+#define EXAMPLE_RFAL_POLLER_ISODEP_READ_MAX 1024U /* NDEF message bytes read per session */
+#define EXAMPLE_RFAL_POLLER_ISODEP_REPORT   100U  /* Poll cycles between two ISO-DEP statistics reports */
+
+#ifndef EXAMPLE_RFAL_POLLER_NDEF
+#define EXAMPLE_RFAL_POLLER_NDEF         1     /* 1: read the NDEF message of the T2T / T5T activated and log every NDEF read, see ndef_read.h */
+#endif
+
+#define EXAMPLE_RFAL_POLLER_NDEF_READ_MAX   256U  /* T2T / T5T NDEF message bytes read */
+#define EXAMPLE_RFAL_POLLER_NDEF_REPORT     100U  /* Poll cycles between two NDEF cache statistics reports */
+
+#define EXAMPLE_RFAL_POLLER_TOTAL_DURATION 10U /* Worker Poll + Listen period: rfalNfcDeactivate() keeps the field Off until it ends, the idle window follows anyway */
+
+#define EXAMPLE_RFAL_POLLER_TASK_STACK   8192  /* Poller task of the readers other than the first one (PLTF_READERS > 1) */
+#define EXAMPLE_RFAL_POLLER_TASK_PRIO    3     /* RF pollers, the Arduino loopTask (first reader) is raised to it */
+#define EXAMPLE_RFAL_POLLER_RF_CORE      ARDUINO_RUNNING_CORE  /* Core of the loopTask, all the pollers run on it */
+
+#define EXAMPLE_RFAL_POLLER_OUTPUT_STACK 4096  /* Output task: log record formatting, serial output, LEDs */
+#define EXAMPLE_RFAL_POLLER_OUTPUT_PRIO  1     /* Below the pollers, only matters on a single core */
+#if defined(CONFIG_FREERTOS_UNICORE) && CONFIG_FREERTOS_UNICORE
+#define EXAMPLE_RFAL_POLLER_OUTPUT_CORE  0
+#else
+#define EXAMPLE_RFAL_POLLER_OUTPUT_CORE  (1 - EXAMPLE_RFAL_POLLER_RF_CORE)  /* The other core: output never delays a poll cycle */
+#endif
+#define EXAMPLE_RFAL_POLLER_OUTPUT_REPORT_MS 10000U /* Period of the log ring report, if records were put */
+
+#ifndef EXAMPLE_RFAL_POLLER_LOG_BINARY
+#define EXAMPLE_RFAL_POLLER_LOG_BINARY   0     /* 1: send the log records as binary frames (evt_log.h), decoded by host_main --log-decode */
+#endif
+#ifndef EXAMPLE_RFAL_POLLER_LOG_USB
+#define EXAMPLE_RFAL_POLLER_LOG_USB      0     /* 1: log to the USB CDC port (Serial) instead of the UART (Serial0) */
+#endif
+#ifndef EXAMPLE_RFAL_POLLER_LOG_BAUD
+#define EXAMPLE_RFAL_POLLER_LOG_BAUD     115200 /* UART baud rate, raise it (e.g. 921600) to drain the log faster */
+#endif
+#if EXAMPLE_RFAL_POLLER_LOG_USB
+#define EXAMPLE_RFAL_POLLER_LOG_PORT     Serial
+#else
+#define EXAMPLE_RFAL_POLLER_LOG_PORT     Serial0
+#endif
 
 
 /*
@@ -70,107 +166,38 @@ extern "C" {
 /*! Main state                                                                          */
 typedef enum{
     EXAMPLE_RFAL_POLLER_STATE_INIT                =  0,  /* Initialize state            */
-    EXAMPLE_RFAL_POLLER_STATE_TECHDETECT          =  1,  /* Technology Detection state  */
-    EXAMPLE_RFAL_POLLER_STATE_COLAVOIDANCE        =  2,  /* Collision Avoidance state   */
-    EXAMPLE_RFAL_POLLER_STATE_ACTIVATION          =  3,  /* Activation state            */
-    EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_START  =  4,  /* Data Exchange Start state   */
-    EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_CHECK  =  5,  /* Data Exchange Check state   */
+    EXAMPLE_RFAL_POLLER_STATE_DISCOVERY           =  1,  /* rfalNfcWorker discovery     */
     EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION        =  9   /* Deactivation state          */
 }exampleRfalPollerState;
 
 
-/*! Device type                                                                         */
-typedef enum{
-    EXAMPLE_RFAL_POLLER_TYPE_NFCA  =  0,                 /* NFC-A device type           */
-    EXAMPLE_RFAL_POLLER_TYPE_NFCB  =  1,                 /* NFC-B device type           */
-    EXAMPLE_RFAL_POLLER_TYPE_NFCF  =  2,                 /* NFC-F device type           */
-    EXAMPLE_RFAL_POLLER_TYPE_NFCV  =  3                  /* NFC-V device type           */
-}exampleRfalPollerDevType;
-
-
-/*! Device interface                                                                    */
-typedef enum{
-    EXAMPLE_RFAL_POLLER_INTERFACE_RF     = 0,            /* RF Frame interface          */
-    EXAMPLE_RFAL_POLLER_INTERFACE_ISODEP = 1,            /* ISO-DEP interface           */
-    EXAMPLE_RFAL_POLLER_INTERFACE_NFCDEP = 2             /* NFC-DEP interface           */
-}exampleRfalPollerRfInterface;
-
-
-/*! Device struct containing all its details                                            */
-typedef struct{
-    exampleRfalPollerDevType type;                      /* Device's type                */
-    union{
-        rfalNfcaListenDevice nfca;                      /* NFC-A Listen Device instance */
-        rfalNfcbListenDevice nfcb;                      /* NFC-B Listen Device instance */
-        rfalNfcfListenDevice nfcf;                      /* NFC-F Listen Device instance */
-        rfalNfcvListenDevice nfcv;                      /* NFC-V Listen Device instance */
-    }dev;                                               /* Device's instance            */
-    
-    exampleRfalPollerRfInterface rfInterface;           /* Device's interface           */
-    union{
-        rfalIsoDepDevice isoDep;                        /* ISO-DEP instance             */
-        rfalNfcDepDevice nfcDep;                        /* NFC-DEP instance             */
-    }proto;                                             /* Device's protocol            */
-    
-}exampleRfalPollerDevice;
-
-
 /*
  ******************************************************************************
  * LOCAL VARIABLES
  ******************************************************************************
  */
-static uint8_t                 t1tReadReq[]    = { 0x01, 0x00, 0x00, 0x11, 0x22, 0x33, 0x44 };                                                   /* T1T READ Block:0 Byte:0 */
-static uint8_t                 t2tReadReq[]    = { 0x30, 0x00 };                                                                                 /* T2T READ Block:0 */
-static uint8_t                 t3tCheckReq[]   = { 0x06, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x01, 0x09, 0x00, 0x01, 0x80, 0x00 };   /* T3T Check/Read command */
-static uint8_t                 t4tSelectReq[]  = { 0x00, 0xA4, 0x00, 0x00, 0x00 };                                                               /* T4T Select MF, DF or EF APDU  */
-static uint8_t                 t5tSysInfoReq[] = { 0x02, 0x2B };                                                                                 /* NFC-V Get SYstem Information command*/
-static uint8_t                 nfcbReq[]       = { 0x00 };                                                                                       /* NFC-B proprietary command */
-static uint8_t                 llcpSymm[]      = { 0x00, 0x00 };                                                                                 /* LLCP SYMM command */
-
-static uint8_t                 gNfcid3[]       = {0x01, 0xFE, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A };                                  /* NFCID3 used for ATR_REQ */
-static uint8_t                 gGenBytes[]     = { 0x46, 0x66, 0x6d, 0x01, 0x01, 0x11, 0x02, 0x02, 0x07, 0x80, 0x03, 0x02, 0x00, 0x03, 0x04, 0x01, 0x32, 0x07, 0x01, 0x03 }; /* P2P General Bytes: LCCP Connect */
-
-/*******************************************************************************/
-
-static uint8_t                 gDevCnt;                                 /* Number of devices found                         */
-static exampleRfalPollerDevice gDevList[EXAMPLE_RFAL_POLLER_DEVICES];   /* Device List                                     */
-static exampleRfalPollerState  gState;                                  /* Main state                                      */
-static uint8_t                 gTechsFound;                             /* Technologies found bitmask                      */
-exampleRfalPollerDevice        *gActiveDev;                             /* Active device pointer                           */
-static uint16_t                gRcvLen;                                 /* Received length                                 */
-static bool                    gRxChaining;                             /* Rx chaining flag                                */
-
-/*! Transmit buffers union, only one interface is used at a time                                                           */
-static union{
-    uint8_t                 rfTxBuf[EXAMPLE_RFAL_POLLER_RF_BUF_LEN];    /* RF Tx buffer (not used on this demo)            */
-    rfalIsoDepBufFormat     isoDepTxBuf;                                /* ISO-DEP Tx buffer format (with header/prologue) */
-    rfalNfcDepBufFormat     nfcDepTxBuf;                                /* NFC-DEP Rx buffer format (with header/prologue) */
-}gTxBuf;
-
-
-/*! Receive buffers union, only one interface is used at a time                                                            */
-static union {
-    uint8_t                 rfRxBuf[EXAMPLE_RFAL_POLLER_RF_BUF_LEN];    /* RF Rx buffer                                    */
-    rfalIsoDepBufFormat     isoDepRxBuf;                                /* ISO-DEP Rx buffer format (with header/prologue) */
-    rfalNfcDepBufFormat     nfcDepRxBuf;                                /* NFC-DEP Rx buffer format (with header/prologue) */
-}gRxBuf;
-
-
-
-
+/* One poller per reader (PLTF_READERS), each in its own task bound to the reader, see pltf_reader_select() */
+static exampleRfalPollerState  gStateInstances[PLTF_READERS];           /* Main state                                      */
+static TaskHandle_t            gPollerTaskInstances[PLTF_READERS];      /* Task running the poller (Arduino loopTask for the first reader) */
+static rfalNfcDiscoverParam    discParamInstances[PLTF_READERS];        /* NFC discovery parameters                        */
+static bool                    multiSelInstances[PLTF_READERS];         /* Handling of multiple NFC-tags simultaneously    */
+
+#define gState                 (gStateInstances[pltf_reader_get()])
+#define gPollerTask            (gPollerTaskInstances[pltf_reader_get()])
+#define discParam              (discParamInstances[pltf_reader_get()])
+#define multiSel               (multiSelInstances[pltf_reader_get()])
+
+/* Poll path output goes through the log rings of evt_log.c, drained by the output task */
+static TaskHandle_t            gOutputTask;                             /* Task printing the log records                   */
 /* P2P communication data */
 static uint8_t NFCID3[] = {0x01, 0xFE, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A};
 static uint8_t GB[] = {0x46, 0x66, 0x6d, 0x01, 0x01, 0x11, 0x02, 0x02, 0x07, 0x80, 0x03, 0x02, 0x00, 0x03, 0x04, 0x01, 0x32, 0x07, 0x01, 0x03};
 
 /* APDUs communication data */
 #if RFAL_FEATURE_ISO_DEP_POLL
-static uint8_t ndefSelectApp[] = { 0x00, 0xA4, 0x04, 0x00, 0x07, 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01, 0x00 };
-static uint8_t ccSelectFile[] = { 0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE1, 0x03};
-static uint8_t readBinary[] = { 0x00, 0xB0, 0x00, 0x00, 0x0F };
-
-/* For a Payment application a Select PPSE would be needed: 
-   ppseSelectApp[] = { 0x00, 0xA4, 0x04, 0x00, 0x0E, 0x32, 0x50, 0x41, 0x59, 0x2E, 0x53, 0x59, 0x53, 0x2E, 0x44, 0x44, 0x46, 0x30, 0x31, 0x00 } */
+/* For a Payment application a Select PPSE is needed, the first record then read */
+static uint8_t ppseSelectApp[] = { 0x00, 0xA4, 0x04, 0x00, 0x0E, 0x32, 0x50, 0x41, 0x59, 0x2E, 0x53, 0x59, 0x53, 0x2E, 0x44, 0x44, 0x46, 0x30, 0x31, 0x00 };
+static uint8_t readRecord[] = { 0x00, 0xB2, 0x01, 0x0C, 0x00 };
 #endif /* RFAL_FEATURE_ISO_DEP_POLL */
 
 #if RFAL_FEATURE_NFC_DEP
@@ -203,14 +230,22 @@ static uint8_t ceNFCF_SENSF_RES[]  = {0x01,
 #endif /* RFAL_SUPPORT_MODE_LISTEN_NFCF */
 #endif /* RFAL_SUPPORT_CE && RFAL_FEATURE_LISTEN_MODE */
 
-
-static rfalNfcDiscoverParam discParam;      // NFC discovery parameters.
-
-bool multiSel = false;                      // Handling of multiple NFC-tags simultaneously.
+#if EXAMPLE_RFAL_POLLER_DPO
+/* Power levels of this antenna, strongest first: amplitude ~0x78 unloaded at full drive, ~8 LSB less per RFO step.
+ * A tag lying on the antenna drops it below 'dec' and is overloaded at full drive, the levels step down until the
+ * amplitude is back within [dec, inc]. The windows of neighbouring levels overlap by 16 LSB: the hysteresis. */
+static rfalDpoEntry exampleRfalPollerDpoTable[] = {
+    /* rfoRes  inc   dec */
+    {  0x00U, 255U,  80U },
+    {  0x02U,  96U,  60U },
+    {  0x04U,  80U,  30U },
+    {  0x06U,  64U,   0U },
+};
+#endif /* EXAMPLE_RFAL_POLLER_DPO */
 
 
 // Helpers:
-static char UID_hex_string[40] = {0};       // Safely hold up to NFCID3 values, i.e. 10-byte (requires 21-byte char-arr)
+static char UID_hex_string[40] = {0};       // Safely hold up to NFCID3 values, i.e. 10-byte (requires 21-byte char-arr).
 
 static char *hex2str(uint8_t *number, uint8_t length)
 {
@@ -398,12 +433,52 @@ static void demoNfcv( rfalNfcvListenDevice *nfcvDev )
 * LOCAL FUNCTION PROTOTYPES
 ******************************************************************************
 */
-static bool exampleRfalPollerTechDetetection( void );
-static bool exampleRfalPollerCollResolution( void );
-static bool exampleRfalPollerActivation( uint8_t devIt );
-static bool exampleRfalPollerNfcDepActivate( exampleRfalPollerDevice *device );
-static ReturnCode exampleRfalPollerDataExchange( void );
-static bool exampleRfalPollerDeactivate( void );
+static uint16_t exampleRfalPollerPresence( void );
+static bool exampleRfalPollerPresenceNfca( void );
+static bool exampleRfalPollerPresenceNfcf( void );
+static bool exampleRfalPollerPresenceNfcv( void );
+static void exampleRfalPollerReport( void );
+static void exampleRfalPollerNotify( rfalNfcState st );
+static void exampleRfalPollerTagEvent( tagTrackerEvt evt, const tagTrackerTag *tag );
+static void exampleRfalPollerLog( const evtLogRecord *rec );
+static void exampleRfalPollerOutputRecord( const evtLogRecord *rec );
+static void exampleRfalPollerOutputReport( void );
+static void exampleRfalPollerOutputTask( void *arg );
+static void exampleRfalPollerIrqNotify( void );
+static void exampleRfalPollerIdle( void );
+static void exampleRfalPollerInit( void );
+static void exampleRfalPollerRun( void );
+#if PLTF_READERS > 1
+static void exampleRfalPollerTask( void *arg );
+#endif /* PLTF_READERS > 1 */
+#if EXAMPLE_RFAL_POLLER_WAKEUP
+static bool exampleRfalPollerWakeUpPrepare( void );
+static void exampleRfalPollerWakeUpResult( bool found );
+#endif /* EXAMPLE_RFAL_POLLER_WAKEUP */
+#if EXAMPLE_RFAL_POLLER_SCHED
+static void exampleRfalPollerSchedReport( void );
+#endif /* EXAMPLE_RFAL_POLLER_SCHED */
+#if EXAMPLE_RFAL_POLLER_DPO
+static void exampleRfalPollerDpoReport( void );
+#endif /* EXAMPLE_RFAL_POLLER_DPO */
+#if EXAMPLE_RFAL_POLLER_ISODEP
+static rfalBitRate exampleRfalPollerIsoDepMaxBR( const rfalNfcDevice *dev );
+static rfalBitRate exampleRfalPollerIsoDepOffered( const rfalNfcDevice *dev );
+static ReturnCode exampleRfalPollerIsoDepApdu( uint8_t *capdu, uint16_t capduLen, uint8_t **rapdu, uint16_t *sw, isoDepRateSession *ses );
+static bool exampleRfalPollerIsoDepSession( const rfalNfcDevice *dev, isoDepRateSession *ses );
+static bool exampleRfalPollerIsoDepReactivate( uint8_t devIdx );
+static void exampleRfalPollerIsoDep( void );
+static void exampleRfalPollerIsoDepReport( void );
+#endif /* EXAMPLE_RFAL_POLLER_ISODEP */
+#if EXAMPLE_RFAL_POLLER_NDEF
+static void exampleRfalPollerNdefLog( const rfalNfcDevice *dev, ReturnCode err, const ndefReadMsg *msg, const ndefReadStats *stats );
+static void exampleRfalPollerNdef( void );
+static void exampleRfalPollerNdefReport( void );
+#endif /* EXAMPLE_RFAL_POLLER_NDEF */
+#ifdef ST25R_COM_TRACE
+static void exampleRfalPollerTraceCost( uint8_t kind, uint8_t idx, const st25r3911TraceCost *cost );
+static void exampleRfalPollerTraceDump( void );
+#endif /* ST25R_COM_TRACE */
 
 
 /*
@@ -413,796 +488,1388 @@ static bool exampleRfalPollerDeactivate( void );
 */
 /*!
  ******************************************************************************
- * \brief Poller Technology Detection
- * 
- * This method implements the Technology Detection / Poll for different 
- * device technologies.
- * 
- * \return true         : One or more devices have been detected
- * \return false         : No device have been detected
- * 
- ******************************************************************************
- */
-static bool exampleRfalPollerTechDetetection( void )
-{
-    ReturnCode           err;
-    rfalNfcaSensRes      sensRes;
-    rfalNfcbSensbRes     sensbRes;
-    rfalNfcvInventoryRes invRes;
-    uint8_t              sensbResLen;
-    
-    gTechsFound = EXAMPLE_RFAL_POLLER_FOUND_NONE;
-    
-    /*******************************************************************************/
-    /* NFC-A Technology Detection                                                  */
-    /*******************************************************************************/
-    
-    rfalNfcaPollerInitialize();                                                       /* Initialize RFAL for NFC-A */
-    rfalFieldOnAndStartGT();                                                          /* Turns the Field On and starts GT timer */
-    
-    err = rfalNfcaPollerTechnologyDetection( RFAL_COMPLIANCE_MODE_NFC, &sensRes ); /* Poll for NFC-A devices */
-    if( err == RFAL_ERR_NONE )
-    {
-        gTechsFound |= EXAMPLE_RFAL_POLLER_FOUND_A;
-    }
-    
-    
-    /*******************************************************************************/
-    /* NFC-B Technology Detection                                                  */
-    /*******************************************************************************/
-    
-    rfalNfcbPollerInitialize();                                                       /* Initialize RFAL for NFC-B */
-    rfalFieldOnAndStartGT();                                                          /* As field is already On only starts GT timer */
-    
-    err = rfalNfcbPollerTechnologyDetection( RFAL_COMPLIANCE_MODE_NFC, &sensbRes, &sensbResLen ); /* Poll for NFC-B devices */
-    if( err == RFAL_ERR_NONE )
-    {
-        gTechsFound |= EXAMPLE_RFAL_POLLER_FOUND_B;
-    }
-    
-    
-    /*******************************************************************************/
-    /* NFC-F Technology Detection                                                  */
-    /*******************************************************************************/
-    
-    rfalNfcfPollerInitialize( RFAL_BR_212 );                                          /* Initialize RFAL for NFC-F */
-    rfalFieldOnAndStartGT();                                                          /* As field is already On only starts GT timer */
-    
-    err = rfalNfcfPollerCheckPresence();                                              /* Poll for NFC-F devices */
-    if( err == RFAL_ERR_NONE )
-    {
-        gTechsFound |= EXAMPLE_RFAL_POLLER_FOUND_F;
-    }
-    
-    
-    /*******************************************************************************/
-    /* NFC-V Technology Detection                                                  */
-    /*******************************************************************************/
-    
-    rfalNfcvPollerInitialize();                                                       /* Initialize RFAL for NFC-V */
-    rfalFieldOnAndStartGT();                                                          /* As field is already On only starts GT timer */
-    
-    err = rfalNfcvPollerCheckPresence( &invRes );                                     /* Poll for NFC-V devices */
-    if( err == RFAL_ERR_NONE )
-    {
-        gTechsFound |= EXAMPLE_RFAL_POLLER_FOUND_V;
-    }
-    
-    return (gTechsFound != EXAMPLE_RFAL_POLLER_FOUND_NONE);
-}
-
-/*!
- ******************************************************************************
- * \brief Poller Collision Resolution
+ * \brief Poller presence check
  * 
- * This method implements the Collision Resolution on all technologies that
- * have been detected before.
+ * For the technologies of the discovery profile with known devices (see 
+ * tag_tracker.h) a presence check confirms the known devices. Only if an 
+ * unknown device answers the technology is left to the rfalNfcWorker 
+ * discovery, which then runs the full Technology Detection and Collision 
+ * Resolution for it.
  * 
- * \return true         : One or more devices identified 
- * \return false        : No device have been identified
+ * \return the technologies (RFAL_NFC_POLL_TECH_*) to be discovered
  * 
  ******************************************************************************
  */
-static bool exampleRfalPollerCollResolution( void )
+static uint16_t exampleRfalPollerPresence( void )
 {
-    uint8_t    i;
-    uint8_t    devCnt;
-    ReturnCode err;
-    
+    uint16_t techs;
     
-    /*******************************************************************************/
-    /* NFC-A Collision Resolution                                                  */
-    /*******************************************************************************/
-    if( gTechsFound & EXAMPLE_RFAL_POLLER_FOUND_A )                                   /* If a NFC-A device was found/detected, perform Collision Resolution */
-    {
-        rfalNfcaListenDevice nfcaDevList[EXAMPLE_RFAL_POLLER_DEVICES];
-        
-        rfalNfcaPollerInitialize();
-        rfalFieldOnAndStartGT();                                                      /* Ensure GT again as other technologies have also been polled */
-        err = rfalNfcaPollerFullCollisionResolution( RFAL_COMPLIANCE_MODE_NFC, (EXAMPLE_RFAL_POLLER_DEVICES - gDevCnt), nfcaDevList, &devCnt );
-        if( (err == RFAL_ERR_NONE) && (devCnt != 0) )
-        {
-            for( i=0; i<devCnt; i++ )                                                 /* Copy devices found form local Nfca list into global device list */
-            {
-                gDevList[gDevCnt].type     = EXAMPLE_RFAL_POLLER_TYPE_NFCA;
-                gDevList[gDevCnt].dev.nfca = nfcaDevList[i];
-                gDevCnt++;
-            }
-        }
-    }
+    techs = EXAMPLE_RFAL_POLLER_TECHS;
     
-    /*******************************************************************************/
-    /* NFC-B Collision Resolution                                                  */
-    /*******************************************************************************/
-    if( gTechsFound & EXAMPLE_RFAL_POLLER_FOUND_B )                                   /* If a NFC-A device was found/detected, perform Collision Resolution */
+    if( ((techs & RFAL_NFC_POLL_TECH_A) != 0U) && (tagTrackerCount( RFAL_NFC_LISTEN_TYPE_NFCA ) != 0U) )
     {
-        rfalNfcbListenDevice nfcbDevList[EXAMPLE_RFAL_POLLER_DEVICES];
-        
-        rfalNfcbPollerInitialize();
-        rfalFieldOnAndStartGT();                                                      /* Ensure GT again as other technologies have also been polled */
-        err = rfalNfcbPollerCollisionResolution( RFAL_COMPLIANCE_MODE_NFC, (EXAMPLE_RFAL_POLLER_DEVICES - gDevCnt), nfcbDevList, &devCnt );
-        if( (err == RFAL_ERR_NONE) && (devCnt != 0) )
+        rfalNfcaPollerInitialize();                                                   /* Initialize RFAL for NFC-A */
+        rfalFieldOnAndStartGT();                                                      /* Turns the Field On and starts GT timer */
+        if( !exampleRfalPollerPresenceNfca() )
         {
-            for( i=0; i<devCnt; i++ )                                                 /* Copy devices found form local Nfcb list into global device list */
-            {
-                gDevList[gDevCnt].type     = EXAMPLE_RFAL_POLLER_TYPE_NFCB;
-                gDevList[gDevCnt].dev.nfcb = nfcbDevList[i];
-                gDevCnt++;
-            }
+            techs &= ~RFAL_NFC_POLL_TECH_A;
         }
     }
     
-    
-    /*******************************************************************************/
-    /* NFC-F Collision Resolution                                                  */
-    /*******************************************************************************/
-    if( gTechsFound & EXAMPLE_RFAL_POLLER_FOUND_F )                                   /* If a NFC-F device was found/detected, perform Collision Resolution */
+    if( ((techs & RFAL_NFC_POLL_TECH_F) != 0U) && (tagTrackerCount( RFAL_NFC_LISTEN_TYPE_NFCF ) != 0U) )
     {
-        rfalNfcfListenDevice nfcfDevList[EXAMPLE_RFAL_POLLER_DEVICES];
-        
-        rfalNfcfPollerInitialize( RFAL_BR_212 );
-        rfalFieldOnAndStartGT();                                                      /* Ensure GT again as other technologies have also been polled */
-        err = rfalNfcfPollerCollisionResolution( RFAL_COMPLIANCE_MODE_NFC, (EXAMPLE_RFAL_POLLER_DEVICES - gDevCnt), nfcfDevList, &devCnt );
-        if( (err == RFAL_ERR_NONE) && (devCnt != 0) )
+        rfalNfcfPollerInitialize( RFAL_BR_212 );                                      /* Initialize RFAL for NFC-F */
+        rfalFieldOnAndStartGT();                                                      /* As field is already On only starts GT timer */
+        if( !exampleRfalPollerPresenceNfcf() )
         {
-            for( i=0; i<devCnt; i++ )                                                 /* Copy devices found form local Nfcf list into global device list */
-            {
-                gDevList[gDevCnt].type     = EXAMPLE_RFAL_POLLER_TYPE_NFCF;
-                gDevList[gDevCnt].dev.nfcf = nfcfDevList[i];
-                gDevCnt++;
-            }
+            techs &= ~RFAL_NFC_POLL_TECH_F;
         }
     }
     
-    /*******************************************************************************/
-    /* NFC-V Collision Resolution                                                  */
-    /*******************************************************************************/
-    if( gTechsFound & EXAMPLE_RFAL_POLLER_FOUND_V )                                   /* If a NFC-F device was found/detected, perform Collision Resolution */
+    if( ((techs & RFAL_NFC_POLL_TECH_V) != 0U) && (tagTrackerCount( RFAL_NFC_LISTEN_TYPE_NFCV ) != 0U) )
     {
-        rfalNfcvListenDevice nfcvDevList[EXAMPLE_RFAL_POLLER_DEVICES];
-        
-        rfalNfcvPollerInitialize();
-        rfalFieldOnAndStartGT();                                                      /* Ensure GT again as other technologies have also been polled */
-        err = rfalNfcvPollerCollisionResolution(RFAL_COMPLIANCE_MODE_NFC, (EXAMPLE_RFAL_POLLER_DEVICES - gDevCnt), nfcvDevList, &devCnt );
-        if( (err == RFAL_ERR_NONE) && (devCnt != 0) )
+        rfalNfcvPollerInitialize();                                                   /* Initialize RFAL for NFC-V */
+        rfalFieldOnAndStartGT();                                                      /* As field is already On only starts GT timer */
+        if( !exampleRfalPollerPresenceNfcv() )
         {
-            for( i=0; i<devCnt; i++ )                                                /* Copy devices found form local Nfcf list into global device list */
-            {
-                gDevList[gDevCnt].type     = EXAMPLE_RFAL_POLLER_TYPE_NFCV;
-                gDevList[gDevCnt].dev.nfcv = nfcvDevList[i];
-                gDevCnt++;
-            }
+            techs &= ~RFAL_NFC_POLL_TECH_V;
         }
     }
     
-    return (gDevCnt > 0);
+    return techs;
 }
 
 
 /*!
  ******************************************************************************
- * \brief Poller Activation
- * 
- * This method Activates a given device according to it's type and 
- * protocols supported
- *  
- * \param[in]  devIt : device's position on the list to be activated 
+ * \brief Poller report
  * 
- * \return true         : Activation successful 
- * \return false        : Activation failed
+ * Reports the devices found by the rfalNfcWorker Collision Resolution to the
+ * tag tracker: new devices raise an arrival, known ones only refresh their 
+ * presence.
  * 
  ******************************************************************************
  */
-static bool exampleRfalPollerActivation( uint8_t devIt )
+static void exampleRfalPollerReport( void )
 {
-    ReturnCode           err;
-    rfalNfcaSensRes      sensRes;
-    rfalNfcaSelRes       selRes;
-    rfalNfcbSensbRes     sensbRes;
-    uint8_t              sensbResLen;
+    rfalNfcDevice *devList;
+    uint8_t       devCnt;
+    uint8_t       i;
     
-    if( devIt > gDevCnt )
+    if( rfalNfcGetDevicesFound( &devList, &devCnt ) != RFAL_ERR_NONE )
     {
-        return false;
+        return;
     }
     
-    switch( gDevList[devIt].type )
+    for( i = 0; i < devCnt; i++ )                                                     /* The device's NFCID is only assigned on activation, use the technology's own */
     {
-        /*******************************************************************************/
-        /* NFC-A Activation                                                            */
-        /*******************************************************************************/
-        case EXAMPLE_RFAL_POLLER_TYPE_NFCA:
-            
-            rfalNfcaPollerInitialize();
-            if( gDevList[devIt].dev.nfca.isSleep )                                    /* Check if desired device is in Sleep      */
-            {
-                err = rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes ); /* Wake up all cards  */
-                if( err != RFAL_ERR_NONE )
-                {
-                    return false;
-                }
-                
-                err = rfalNfcaPollerSelect( gDevList[devIt].dev.nfca.nfcId1, gDevList[devIt].dev.nfca.nfcId1Len, &selRes ); /* Select specific device  */
-                if( err != RFAL_ERR_NONE )
-                {
-                    return false;
-                }
-            }
-            
-            /*******************************************************************************/
-            /* Perform protocol specific activation                                        */
-            switch( gDevList[devIt].dev.nfca.type )
-            {
-                /*******************************************************************************/
-                case RFAL_NFCA_T1T:
-                    
-                    /* No further activation needed for a T1T (RID already performed)*/
-                    Serial0.print("NFC-A T1T device activated \r\n");                   /* NFC-A T1T device activated */
-                    
-                    gDevList[devIt].rfInterface = EXAMPLE_RFAL_POLLER_INTERFACE_RF;
-                    break;
-                    
-                
-                /*******************************************************************************/
-                case RFAL_NFCA_T2T:
-                  
-                    /* No specific activation needed for a T2T */    
-                    Serial0.print("NFC-A T2T device activated \r\n");                   /* NFC-A T2T device activated */
-                    
-                    gDevList[devIt].rfInterface = EXAMPLE_RFAL_POLLER_INTERFACE_RF;
-                    break;
-                
-                
-                /*******************************************************************************/
-                case RFAL_NFCA_T4T:
+        switch( devList[i].type )
+        {
+            case RFAL_NFC_LISTEN_TYPE_NFCA:
+                tagTrackerAdd( devList[i].type, devList[i].dev.nfca.nfcId1, devList[i].dev.nfca.nfcId1Len );
+                break;
                 
-                    /* Perform ISO-DEP (ISO14443-4) activation: RATS and PPS if supported */
-                    err = rfalIsoDepPollAHandleActivation( (rfalIsoDepFSxI)RFAL_ISODEP_FSDI_DEFAULT, RFAL_ISODEP_NO_DID, RFAL_BR_424, &gDevList[devIt].proto.isoDep );
-                    if( err != RFAL_ERR_NONE )
-                    {
-                        return false;
-                    }
-                    
-                    Serial0.print("NFC-A T4T (ISO-DEP) device activated \r\n");         /* NFC-A T4T device activated */
-                    
-                    gDevList[devIt].rfInterface = EXAMPLE_RFAL_POLLER_INTERFACE_ISODEP;
-                    break;
-                  
-                  
-                /*******************************************************************************/
-                case RFAL_NFCA_T4T_NFCDEP:                                              /* Device supports both T4T and NFC-DEP */
-                case RFAL_NFCA_NFCDEP:                                                  /* Device supports NFC-DEP */
-                  
-                    /* Perform NFC-DEP (P2P) activation: ATR and PSL if supported */
-                    if( !exampleRfalPollerNfcDepActivate( &gDevList[devIt] ) )
-                    {
-                      return false;
-                    }
-                    
-                    Serial0.print("NFC-A P2P (NFC-DEP) device activated \r\n");         /* NFC-A P2P device activated */
-                    gDevList[devIt].rfInterface = EXAMPLE_RFAL_POLLER_INTERFACE_NFCDEP;
-                    break;
-            }
-            
-            break;
-        
-        /*******************************************************************************/
-        /* NFC-B Activation                                                            */
-        /*******************************************************************************/
-        case EXAMPLE_RFAL_POLLER_TYPE_NFCB:
-            
-            rfalNfcbPollerInitialize();
-            if( gDevList[devIt].dev.nfcb.isSleep )                                    /* Check if desired device is in Sleep */
-            {
-                /* Wake up all cards. SENSB_RES may return collision but the NFCID0 is available to explicitly select NFC-B card via ATTRIB; so error will be ignored here */
-                rfalNfcbPollerCheckPresence( RFAL_NFCB_SENS_CMD_ALLB_REQ, RFAL_NFCB_SLOT_NUM_1, &sensbRes, &sensbResLen );
-            }
-            
-            
-            /*******************************************************************************/
-            /* Perform ISO-DEP (ISO14443-4) activation: RATS and PPS if supported          */
-            err = rfalIsoDepPollBHandleActivation( (rfalIsoDepFSxI)RFAL_ISODEP_FSDI_DEFAULT, RFAL_ISODEP_NO_DID, RFAL_BR_424, 0x00, &gDevList[devIt].dev.nfcb, NULL, 0, &gDevList[devIt].proto.isoDep );
-            if( err == RFAL_ERR_NONE )
-            {
-                Serial0.print("NFC-B T4T (ISO-DEP) device activated \r\n");             /* NFC-B T4T device activated */
+            case RFAL_NFC_LISTEN_TYPE_NFCB:
+                tagTrackerAdd( devList[i].type, devList[i].dev.nfcb.sensbRes.nfcid0, RFAL_NFCB_NFCID0_LEN );
+                break;
                 
-                gDevList[devIt].rfInterface = EXAMPLE_RFAL_POLLER_INTERFACE_ISODEP ;
+            case RFAL_NFC_LISTEN_TYPE_NFCF:
+                tagTrackerAdd( devList[i].type, devList[i].dev.nfcf.sensfRes.NFCID2, RFAL_NFCF_NFCID2_LEN );
                 break;
-            }
-            
-            Serial0.print("NFC-B device activated \r\n");                               /* NFC-B  device activated */
-            gDevList[devIt].rfInterface =  EXAMPLE_RFAL_POLLER_INTERFACE_RF;
-            break;
-            
-        /*******************************************************************************/
-        /* NFC-F Activation                                                            */
-        /*******************************************************************************/
-        case EXAMPLE_RFAL_POLLER_TYPE_NFCF:
-            
-            rfalNfcfPollerInitialize( RFAL_BR_212 );
-            if( rfalNfcfIsNfcDepSupported( &gDevList[devIt].dev.nfcf ) )
-            {
-                /* Perform NFC-DEP (P2P) activation: ATR and PSL if supported */
-                if( !exampleRfalPollerNfcDepActivate( &gDevList[devIt] ) )
-                {
-                    return false;
-                }
                 
-                Serial0.print("NFC-F P2P (NFC-DEP) device activated \r\n");             /* NFC-A P2P device activated */
+            case RFAL_NFC_LISTEN_TYPE_NFCV:
+                tagTrackerAdd( devList[i].type, devList[i].dev.nfcv.InvRes.UID, RFAL_NFCV_UID_LEN );
+                break;
                 
-                gDevList[devIt].rfInterface = EXAMPLE_RFAL_POLLER_INTERFACE_NFCDEP;
+            default:
                 break;
-            }
-            
-            Serial0.print("NFC-F T3T device activated \r\n");                           /* NFC-F T3T device activated */
-            gDevList[devIt].rfInterface = EXAMPLE_RFAL_POLLER_INTERFACE_RF;
-            break;
-            
-        /*******************************************************************************/
-        /* NFC-V Activation                                                            */
-        /*******************************************************************************/
-        case EXAMPLE_RFAL_POLLER_TYPE_NFCV:
-            
-            rfalNfcvPollerInitialize();
-            
-            /* No specific activation needed for a T5T */
-            Serial0.print("NFC-V T5T device activated \r\n");                           /* NFC-V T5T device activated */
-            
-            gDevList[devIt].rfInterface = EXAMPLE_RFAL_POLLER_INTERFACE_RF;
-            break;
-        
-        /*******************************************************************************/
-        default:
-            return false;
+        }
     }
-    
-    gActiveDev = &gDevList[devIt];                                                    /* Assign active device to be used further on */
-    return true;
 }
 
 
 /*!
  ******************************************************************************
- * \brief Poller NFC DEP Activate
+ * \brief Poller notification
  * 
- * This method performs NFC-DEP Activation 
- *  
- * \param[in]  devIt : device to be activated 
+ * rfalNfcWorker notification callback (rfalNfcDiscoverParam.notifyCb).
+ * When several devices were found the worker waits in POLL_SELECT for the 
+ * device to be activated: the first one is selected. If its activation 
+ * fails the worker comes back to POLL_SELECT, the poller then ends the 
+ * round (see loop()).
+ * Entering and leaving the Wake-Up mode is reported to the wake-up 
+ * controller.
  * 
- * \return true         : Activation successful 
- * \return false        : Activation failed
+ * \param[in]  st : new rfalNfcWorker state
  * 
  ******************************************************************************
  */
-static bool exampleRfalPollerNfcDepActivate( exampleRfalPollerDevice *device )
+static void exampleRfalPollerNotify( rfalNfcState st )
 {
-    rfalNfcDepAtrParam   param;
-                
-    /*******************************************************************************/
-    /* If Passive F use the NFCID2 retrieved from SENSF                            */
-    if( device->type == EXAMPLE_RFAL_POLLER_TYPE_NFCF )
+#if EXAMPLE_RFAL_POLLER_WAKEUP
+    if( st == RFAL_NFC_STATE_WAKEUP_MODE )
     {
-        param.nfcid    = device->dev.nfcf.sensfRes.NFCID2;
-        param.nfcidLen = RFAL_NFCF_NFCID2_LEN;
+        wakeUpCtrlSleep();
     }
-    else
+    else if( st == RFAL_NFC_STATE_POLL_TECHDETECT )
     {
-        param.nfcid    = gNfcid3;
-        param.nfcidLen = RFAL_NFCDEP_NFCID3_LEN;
-    }    
-    
-    param.BS    = RFAL_NFCDEP_Bx_NO_HIGH_BR;
-    param.BRATE = RFAL_NFCDEP_Bx_NO_HIGH_BR;
-    param.DID   = RFAL_NFCDEP_DID_NO;
-    param.NAD   = RFAL_NFCDEP_NAD_NO;
-    param.LR    = RFAL_NFCDEP_LR_254;
-    param.GB    = gGenBytes;
-    param.GBLen = sizeof(gGenBytes);
-    param.commMode  = RFAL_NFCDEP_COMM_PASSIVE;
-    param.operParam = (RFAL_NFCDEP_OPER_FULL_MI_EN | RFAL_NFCDEP_OPER_EMPTY_DEP_DIS | RFAL_NFCDEP_OPER_ATN_EN | RFAL_NFCDEP_OPER_RTOX_REQ_EN);
-    
-    /* Perform NFC-DEP (P2P) activation: ATR and PSL if supported */
-    return (rfalNfcDepInitiatorHandleActivation( &param, RFAL_BR_424, &device->proto.nfcDep ) == RFAL_ERR_NONE);
-}
-
+        wakeUpCtrlWoke();                                                             /* Only counted if the worker comes from the Wake-Up mode */
+    }
+#endif /* EXAMPLE_RFAL_POLLER_WAKEUP */
 
+    if( (st == RFAL_NFC_STATE_POLL_SELECT) && (!multiSel) )
+    {
+        multiSel = true;
+        rfalNfcSelect( 0 );                                                           /* Multiple devices were found, activate the first of them */
+    }
+}
 /*!
  ******************************************************************************
- * \brief Data Exchange
- * 
- * This method performs Data Exchange by device's type and interface.
- *  
- * 
- * \return RFAL_ERR_REQUEST     : Bad request
- * \return RFAL_ERR_BUSY        : Data Exchange ongoing
- * \return RFAL_ERR_NONE        : Data Exchange terminated successfully
- * 
+ * \brief Poller NFC-A presence check
+ *
+ * Checks the known NFC-A devices one by one: a REQA wakes the devices that
+ * were not checked yet, a SELECT with the known UID confirms the device
+ * (no anticollision needed) and a SLP_REQ/HLTA keeps it quiet afterwards.
+ * A final REQA reveals any device that is not known.
+ *
+ * \return true         : An unknown NFC-A device answered
+ * \return false        : Only known devices (or none) are present
+ *
  ******************************************************************************
  */
-static ReturnCode exampleRfalPollerDataExchange( void )
+static bool exampleRfalPollerPresenceNfca( void )
 {
-    rfalTransceiveContext ctx;
-    ReturnCode            err;
-    rfalIsoDepTxRxParam   isoDepTxRx;
-    rfalNfcDepTxRxParam   nfcDepTxRx;
-    uint8_t               *txBuf;
-    uint16_t              txBufLen;
-    
-    
-    /*******************************************************************************/
-    /* The Data Exchange is divided in two different moments, the trigger/Start of *
-     *  the transfer followed by the check until its completion                    */
-    if( gState == EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_START )                      /* Trigger/Start the data exchange */
+    const tagTrackerTag *tag;
+    rfalNfcaSensRes      sensRes;
+    rfalNfcaSelRes       selRes;
+    uint8_t              i;
+
+    for( i = 0; (tag = tagTrackerGet( i )) != NULL; i++ )
     {
-        switch( gActiveDev->rfInterface )                                             /* Check which RF interface shall be used/has been activated */
+        if( tag->tech != RFAL_NFC_LISTEN_TYPE_NFCA )
         {
-            /*******************************************************************************/
-            case EXAMPLE_RFAL_POLLER_INTERFACE_RF:
-    
-                switch( gActiveDev->type )                                            /* Over RF interface no specific protocol is selected, each device supports a different protocol */
-                {
-                    /*******************************************************************************/
-                    case EXAMPLE_RFAL_POLLER_TYPE_NFCA:
-                        switch( gActiveDev->dev.nfca.type )
-                        {
-                            /*******************************************************************************/
-                            case RFAL_NFCA_T1T:
-                                
-                                /* To perform presence check, on this example a T1T Read command is used */
-                                MEMCPY( &t1tReadReq[3], gActiveDev->dev.nfca.nfcId1, RFAL_NFCA_CASCADE_1_UID_LEN );  /* Assign device's NFCID for read command */
-                                                        
-                                txBuf    = t1tReadReq;
-                                txBufLen = sizeof(t1tReadReq);
-                                break;
-                                
-                            /*******************************************************************************/
-                            case RFAL_NFCA_T2T:
-                                
-                                /* To perform presence check, on this example a T2T Read command is used */
-                                txBuf    = t2tReadReq;
-                                txBufLen = sizeof(t2tReadReq);
-                                break;
-                            
-                            /*******************************************************************************/
-                            default:
-                                return RFAL_ERR_REQUEST;;
-                        }
-                        break;
-
-                        
-                    /*******************************************************************************/
-                    case EXAMPLE_RFAL_POLLER_TYPE_NFCB:
-                        
-                        /* To perform presence check, no specific command is used */
-                        txBuf    = nfcbReq;
-                        txBufLen = sizeof(nfcbReq);
-                        break;
-                        
-                        
-                    /*******************************************************************************/
-                    case EXAMPLE_RFAL_POLLER_TYPE_NFCF:
-                        
-                        /* To perform presence check, on this example a T3T Check/Read command is used */
-                        MEMCPY( &t3tCheckReq[1], gActiveDev->dev.nfcf.sensfRes.NFCID2, RFAL_NFCF_NFCID2_LEN );  /* Assign device's NFCID for Check command */
-                        
-                        txBuf    = t3tCheckReq;
-                        txBufLen = sizeof(t3tCheckReq);
-                        break;
-                        
-                        
-                    /*******************************************************************************/
-                    case EXAMPLE_RFAL_POLLER_TYPE_NFCV:
-                        
-                        /* To perform presence check, on this example a Get System Information command is used */
-                        txBuf    = t5tSysInfoReq;
-                        txBufLen = sizeof(t5tSysInfoReq);
-                        break;
-                        
-                        
-                    /*******************************************************************************/
-                    default:
-                        return RFAL_ERR_REQUEST;
-                }
-                
-                /*******************************************************************************/
-                /* Trigger a RFAL Transceive using the previous defined frames                 */
-                rfalCreateByteFlagsTxRxContext( ctx, txBuf, txBufLen, gRxBuf.rfRxBuf, sizeof(gRxBuf.rfRxBuf), &gRcvLen, RFAL_TXRX_FLAGS_DEFAULT, rfalConvMsTo1fc(20) );
-                return (((err = rfalStartTransceive( &ctx )) == RFAL_ERR_NONE) ? RFAL_ERR_BUSY : err);     /* Signal RFAL_ERR_BUSY as Data Exchange has been started and is ongoing */
-                
-            case EXAMPLE_RFAL_POLLER_INTERFACE_ISODEP:
-                
-                MEMCPY( gTxBuf.isoDepTxBuf.inf, t4tSelectReq, sizeof(t4tSelectReq) );
-                
-                isoDepTxRx.DID          = RFAL_ISODEP_NO_DID;
-                isoDepTxRx.ourFSx       = RFAL_ISODEP_FSX_KEEP;
-                isoDepTxRx.FSx          = gActiveDev->proto.isoDep.info.FSx;
-                isoDepTxRx.dFWT         = gActiveDev->proto.isoDep.info.dFWT;
-                isoDepTxRx.FWT          = gActiveDev->proto.isoDep.info.FWT;
-                isoDepTxRx.txBuf        = &gTxBuf.isoDepTxBuf;
-                isoDepTxRx.txBufLen     = sizeof(t4tSelectReq);
-                isoDepTxRx.isTxChaining = false;
-                isoDepTxRx.rxBuf        = &gRxBuf.isoDepRxBuf;
-                isoDepTxRx.rxLen        = &gRcvLen;
-                isoDepTxRx.isRxChaining = &gRxChaining;
-                
-                /*******************************************************************************/
-                /* Trigger a RFAL ISO-DEP Transceive                                           */
-                return (((err = rfalIsoDepStartTransceive( isoDepTxRx )) == RFAL_ERR_NONE) ? RFAL_ERR_BUSY : err); /* Signal RFAL_ERR_BUSY as Data Exchange has been started and is ongoing */
-                
-                
-            case EXAMPLE_RFAL_POLLER_INTERFACE_NFCDEP:
-                
-                MEMCPY( gTxBuf.nfcDepTxBuf.inf, llcpSymm, sizeof(llcpSymm) );
-                
-                nfcDepTxRx.DID          = RFAL_NFCDEP_DID_KEEP;
-                nfcDepTxRx.FSx          = rfalNfcDepLR2FS( rfalNfcDepPP2LR( gActiveDev->proto.nfcDep.activation.Target.ATR_RES.PPt ) );
-                nfcDepTxRx.dFWT         = gActiveDev->proto.nfcDep.info.dFWT;
-                nfcDepTxRx.FWT          = gActiveDev->proto.nfcDep.info.FWT;
-                nfcDepTxRx.txBuf        = &gTxBuf.nfcDepTxBuf;
-                nfcDepTxRx.txBufLen     = sizeof(llcpSymm);
-                nfcDepTxRx.isTxChaining = false;
-                nfcDepTxRx.rxBuf        = &gRxBuf.nfcDepRxBuf;
-                nfcDepTxRx.rxLen        = &gRcvLen;
-                nfcDepTxRx.isRxChaining = &gRxChaining;
-                
-                /*******************************************************************************/
-                /* Trigger a RFAL NFC-DEP Transceive                                           */
-                return (((err = rfalNfcDepStartTransceive( &nfcDepTxRx )) == RFAL_ERR_NONE) ? RFAL_ERR_BUSY : err);  /* Signal RFAL_ERR_BUSY as Data Exchange has been started and is ongoing */
-                
-            default:
-                break;
+            continue;
         }
-    }
-    /*******************************************************************************/
-    /* The Data Exchange has been started, wait until completed                    */
-    else if( gState == EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_CHECK )
-    {
-        switch( gActiveDev->rfInterface )
+
+        if( rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_REQA, &sensRes ) == RFAL_ERR_TIMEOUT )
         {
-            /*******************************************************************************/
-            case EXAMPLE_RFAL_POLLER_INTERFACE_RF:
-                return rfalGetTransceiveStatus();
-                
-            /*******************************************************************************/
-            case EXAMPLE_RFAL_POLLER_INTERFACE_ISODEP:
-                return rfalIsoDepGetTransceiveStatus();
-                
-            /*******************************************************************************/
-            case EXAMPLE_RFAL_POLLER_INTERFACE_NFCDEP:
-                return rfalNfcDepGetTransceiveStatus();
-                
-            /*******************************************************************************/
-            default:
-                return RFAL_ERR_PARAM;
+            break;                                                                    /* No device left awake, the remaining known ones are gone */
+        }
+
+        if( rfalNfcaPollerSelect( tag->uid, tag->uidLen, &selRes ) == RFAL_ERR_NONE )
+        {
+            tagTrackerMark( tag->tech, tag->uid, tag->uidLen );
+            rfalNfcaPollerSleep();                                                    /* Halted devices ignore the following REQAs */
         }
     }
-    return RFAL_ERR_REQUEST;
+
+    return (rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_REQA, &sensRes ) == RFAL_ERR_NONE);
 }
 
 
 /*!
  ******************************************************************************
- * \brief Poller NFC DEP Deactivate
- * 
- * This method Deactivates the device if a deactivation procedure exists 
- * 
- * \return true         : Deactivation successful 
- * \return false        : Deactivation failed
- * 
+ * \brief Poller NFC-F presence check
+ *
+ * A single SENSF_REQ with 4 slots returns the NFCID2 of the devices
+ * present, which are matched against the known ones.
+ *
+ * \return true         : An unknown NFC-F device answered or responses collided
+ * \return false        : Only known devices (or none) are present
+ *
  ******************************************************************************
  */
-static bool exampleRfalPollerDeactivate( void )
+static bool exampleRfalPollerPresenceNfcf( void )
 {
-    if( gActiveDev != NULL )                                                          /* Check if a device has been activated */
-    {
-        switch( gActiveDev->rfInterface )
-        {
-            /*******************************************************************************/
-            case EXAMPLE_RFAL_POLLER_INTERFACE_RF:
-                break;                                                                /* No specific deactivation to be performed */
-                
-            /*******************************************************************************/
-            case EXAMPLE_RFAL_POLLER_INTERFACE_ISODEP:
-                rfalIsoDepDeselect();                                                 /* Send a Deselect to device */
-                break;
-                
-            /*******************************************************************************/
-            case EXAMPLE_RFAL_POLLER_INTERFACE_NFCDEP:
-                rfalNfcDepRLS();                                                      /* Send a Release to device */
-                break;
-                
-            default:
-                return false;
-        }
-        Serial0.print("Device deactivated \r\n");
-    }
-    
-    return true;
-}
+    rfalFeliCaPollRes pollRes[RFAL_NFCF_POLL_MAXCARDS];
+    uint8_t           devCnt;
+    uint8_t           collisions;
+    uint8_t           i;
+    bool              unknown;
 
+    devCnt     = 0;
+    collisions = 0;
+    unknown    = false;
 
-/***************************************   SETUP ***************************************/
-void setup() 
-{
-    Serial0.begin(115200);
-    Serial0.println("Init ...");
-    
-    spi_init();
+    rfalNfcfPollerPoll( RFAL_FELICA_4_SLOTS, RFAL_NFCF_SYSTEMCODE, RFAL_FELICA_POLL_RC_NO_REQUEST, pollRes, &devCnt, &collisions );
 
-    // NFC:
-    ReturnCode ret = rfalNfcInitialize();      // WAS: 'rfalInitialize()' - but this function is NOT setting NFC-state!!
-    
-    if (RFAL_ERR_NONE != ret)
+    for( i = 0; i < devCnt; i++ )
     {
-        Serial0.println("ERROR: NFC subsystem init failed!\nNFC subsystem init return code:");
-        Serial0.println(ret);
-        while(1)
+        if( !tagTrackerMark( RFAL_NFC_LISTEN_TYPE_NFCF, &pollRes[i][EXAMPLE_RFAL_POLLER_NFCF_NFCID2_POS], RFAL_NFCF_NFCID2_LEN ) )
         {
-            vTaskDelay(1000);
+            unknown = true;
         }
     }
 
-    Serial0.println("NFC subsystem initialized OK ...");
+    return (unknown || (collisions != 0U));
 }
 
 
-/*************************************** MAIN task(-loop) ***************************************************/
-void loop() 
+/*!
+ ******************************************************************************
+ * \brief Poller NFC-V presence check
+ *
+ * Checks the known NFC-V devices one by one with an INVENTORY_REQ masked
+ * with the full UID, only that device can answer. Confirmed devices are
+ * sent to the Quiet state, so a final unmasked INVENTORY_REQ reveals any
+ * device that is not known.
+ *
+ * \return true         : An unknown NFC-V device answered
+ * \return false        : Only known devices (or none) are present
+ *
+ ******************************************************************************
+ */
+static bool exampleRfalPollerPresenceNfcv( void )
+{
+    const tagTrackerTag  *tag;
+    rfalNfcvInventoryRes invRes;
+    uint8_t              i;
+
+    for( i = 0; (tag = tagTrackerGet( i )) != NULL; i++ )
+    {
+        if( tag->tech != RFAL_NFC_LISTEN_TYPE_NFCV )
+        {
+            continue;
+        }
+
+        if( (rfalNfcvPollerInventory( RFAL_NFCV_NUM_SLOTS_1, (uint8_t)rfalConvBytesToBits( RFAL_NFCV_UID_LEN ), tag->uid, &invRes, NULL ) == RFAL_ERR_NONE)
+            && (memcmp( invRes.UID, tag->uid, RFAL_NFCV_UID_LEN ) == 0) )
+        {
+            tagTrackerMark( tag->tech, tag->uid, tag->uidLen );
+            rfalNfcvPollerSleep( RFAL_NFCV_REQ_FLAG_DEFAULT, tag->uid );              /* Quiet devices ignore the following INVENTORY_REQs */
+        }
+    }
+
+    return (rfalNfcvPollerCheckPresence( &invRes ) == RFAL_ERR_NONE);
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller log record
+ *
+ * Puts a record into the log ring of the calling poller's reader and wakes 
+ * up the output task. Never blocks: a full ring drops the record, counted 
+ * in the ring report.
+ *
+ * \param[in]  rec : record, see evtLogBegin()
+ *
+ ******************************************************************************
+ */
+static void exampleRfalPollerLog( const evtLogRecord *rec )
+{
+    if( evtLogCommit( rec ) && (gOutputTask != NULL) )
+    {
+        xTaskNotifyGive( gOutputTask );
+    }
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller tag event
+ *
+ * Tag tracker callback, runs in the poller task: logs the devices entering
+ * and leaving the field for the output task. Nothing is printed here.
+ *
+ * \param[in]  evt : TAG_TRACKER_EVT_ARRIVED or TAG_TRACKER_EVT_LEFT
+ * \param[in]  tag : device
+ *
+ ******************************************************************************
+ */
+static void exampleRfalPollerTagEvent( tagTrackerEvt evt, const tagTrackerTag *tag )
+{
+    evtLogRecord rec;
+
+    if( evt == TAG_TRACKER_EVT_ARRIVED )
+    {
+        evtLogBegin( &rec, EVT_LOG_TAG_ARRIVED );
+        evtLogU8( &rec, tag->tech );
+    }
+    else
+    {
+        evtLogBegin( &rec, EVT_LOG_TAG_LEFT );
+        evtLogU8( &rec, tag->tech );
+        evtLogU32( &rec, (rec.timeMs - tag->arrivedMs) );
+    }
+    evtLogU8( &rec, tag->uidLen );
+    evtLogBytes( &rec, tag->uid, tag->uidLen );
+
+    exampleRfalPollerLog( &rec );
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Output log record
+ *
+ * Sends a record taken from a reader's log ring, as a text line or, with 
+ * EXAMPLE_RFAL_POLLER_LOG_BINARY, as a binary frame. Tag records also drive
+ * the tag LED, which stays on while any reader has a tag in its field.
+ *
+ * \param[in]  rec : record
+ *
+ ******************************************************************************
+ */
+static void exampleRfalPollerOutputRecord( const evtLogRecord *rec )
+{
+    static uint32_t present;
+#if EXAMPLE_RFAL_POLLER_LOG_BINARY
+    uint8_t         frame[EVT_LOG_FRAME_MAX];
+#else
+    char            line[128];
+    int             n;
+#endif /* EXAMPLE_RFAL_POLLER_LOG_BINARY */
+
+    if( rec->id == EVT_LOG_TAG_ARRIVED )
+    {
+        present++;
+        platformLedOn( LED_TAG_READ_PORT, LED_TAG_READ_PIN );
+    }
+    else if( rec->id == EVT_LOG_TAG_LEFT )
+    {
+        present = ((present != 0U) ? (present - 1U) : 0U);                            /* An arrival may have been dropped */
+        if( present == 0U )
+        {
+            platformLedOff( LED_TAG_READ_PORT, LED_TAG_READ_PIN );
+        }
+    }
+
+#if EXAMPLE_RFAL_POLLER_LOG_BINARY
+    EXAMPLE_RFAL_POLLER_LOG_PORT.write( frame, evtLogEncode( rec, frame ) );
+#else
+    n = 0;
+#if PLTF_READERS > 1
+    if( rec->id != EVT_LOG_RING )
+    {
+        n = snprintf( line, sizeof(line), "Reader %u: ", (unsigned)rec->reader );
+    }
+#endif /* PLTF_READERS > 1 */
+    (void)evtLogFormat( rec, &line[n], (sizeof(line) - (size_t)n) );
+    EXAMPLE_RFAL_POLLER_LOG_PORT.printf( "%s\r\n", line );
+#endif /* EXAMPLE_RFAL_POLLER_LOG_BINARY */
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Output log ring report
+ *
+ * Reports the depth and drop counters of the readers' log rings, provided 
+ * records were put since the last report.
+ *
+ ******************************************************************************
+ */
+static void exampleRfalPollerOutputReport( void )
+{
+    static uint32_t lastRecords[PLTF_READERS];
+    static uint32_t lastDrops[PLTF_READERS];
+    evtLogStats     stats;
+    evtLogRecord    rec;
+    uint8_t         i;
+
+    for( i = 0; i < PLTF_READERS; i++ )
+    {
+        evtLogGetStats( i, &stats );
+        if( (stats.records != lastRecords[i]) || (stats.drops != lastDrops[i]) )
+        {
+            evtLogBegin( &rec, EVT_LOG_RING );
+            rec.reader = i;
+            evtLogU32( &rec, stats.records );
+            evtLogU32( &rec, stats.drops );
+            evtLogU32( &rec, stats.depth );
+            evtLogU32( &rec, stats.depthMax );
+            evtLogU32( &rec, EVT_LOG_DEPTH );
+            exampleRfalPollerOutputRecord( &rec );
+
+            lastRecords[i] = stats.records;
+            lastDrops[i]   = stats.drops;
+        }
+    }
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Output task
+ *
+ * Consumer side of the log rings, pinned to the core the pollers do not 
+ * run on: all the formatting and serial output of the poll path happens 
+ * here. Woken by the pollers on every record, it also reports the ring 
+ * counters every EXAMPLE_RFAL_POLLER_OUTPUT_REPORT_MS.
+ *
+ * \param[in]  arg : unused
+ *
+ ******************************************************************************
+ */
+static void exampleRfalPollerOutputTask( void *arg )
+{
+    evtLogRecord rec;
+    uint32_t     reportMs;
+    uint8_t      i;
+
+    (void)arg;
+    reportMs = platformGetSysTick();
+
+    for(;;)
+    {
+        (void)ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( EXAMPLE_RFAL_POLLER_OUTPUT_REPORT_MS ) );
+
+        for( i = 0; i < PLTF_READERS; i++ )
+        {
+            while( evtLogGet( i, &rec ) )
+            {
+                exampleRfalPollerOutputRecord( &rec );
+            }
+        }
+
+        if( (platformGetSysTick() - reportMs) >= EXAMPLE_RFAL_POLLER_OUTPUT_REPORT_MS )
+        {
+            reportMs = platformGetSysTick();
+            exampleRfalPollerOutputReport();
+        }
+    }
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller IRQ notification
+ * 
+ * Upper layer callback called by the ST25R3911 interrupt handler, which 
+ * runs in the RFAL IRQ task (see pltf_interrupt.c). 
+ * Wakes up the poller task if it is waiting in the idle window.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerIrqNotify( void )
+{
+    if( gPollerTask != NULL )
+    {
+        xTaskNotifyGive( gPollerTask );
+    }
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller idle window
+ * 
+ * Keeps the field Off for at least EXAMPLE_RFAL_POLLER_FIELD_OFF_MS and then 
+ * blocks until the end of the idle window or until the ST25R3911 IRQ (e.g. 
+ * a wake-up event) notifies the poller task, whichever comes first.
+ * This is the only place where the poller sleeps.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerIdle( void )
+{
+    vTaskDelay( pdMS_TO_TICKS( EXAMPLE_RFAL_POLLER_FIELD_OFF_MS ) );
+    
+    (void)ulTaskNotifyTake( pdTRUE, 0 );                                              /* Drop notifications left by the IRQs of the last poll cycle */
+    (void)ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( EXAMPLE_RFAL_POLLER_IDLE_MS - EXAMPLE_RFAL_POLLER_FIELD_OFF_MS ) );
+}
+
+
+#if EXAMPLE_RFAL_POLLER_WAKEUP
+/*!
+ ******************************************************************************
+ * \brief Poller Wake-Up mode preparation
+ * 
+ * The Wake-Up mode is only used while no device is known: known devices 
+ * are confirmed by the presence checks on every cycle anyway. The 
+ * references are (re)calibrated here, with the field Off, when the 
+ * wake-up controller asks for it.
+ * 
+ * \return true         : Wake-Up mode to be started by the rfalNfcWorker
+ * \return false        : Poll right away
+ * 
+ ******************************************************************************
+ */
+static bool exampleRfalPollerWakeUpPrepare( void )
+{
+    evtLogRecord rec;
+    ReturnCode   err;
+    
+    if( tagTrackerGet( 0 ) != NULL )
+    {
+        return false;
+    }
+    
+    if( wakeUpCtrlNeedsCalibration() )
+    {
+        err = wakeUpCtrlCalibrate();
+        if( err != RFAL_ERR_NONE )
+        {
+            evtLogBegin( &rec, EVT_LOG_WAKEUP_CAL_ERR );
+            evtLogU32( &rec, err );
+            exampleRfalPollerLog( &rec );
+            return false;
+        }
+    }
+    
+    discParam.wakeupConfig = *wakeUpCtrlConfig();
+    return true;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller Wake-Up mode result
+ * 
+ * Reports the end of a discovery to the wake-up controller and, if it 
+ * followed a wake-up, logs the false wake rate against the wake to 
+ * detection latency.
+ * 
+ * \param[in]  found : a device was found
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerWakeUpResult( bool found )
+{
+    wakeUpCtrlStats stats;
+    evtLogRecord    rec;
+    
+    if( !wakeUpCtrlResult( found ) )
+    {
+        return;                                                                       /* Not preceded by a wake-up */
+    }
+    
+    wakeUpCtrlGetStats( &stats );
+    evtLogBegin( &rec, EVT_LOG_WAKEUP );
+    evtLogU32( &rec, stats.wakes );
+    evtLogU32( &rec, stats.falseWakes );
+    evtLogU32( &rec, ((stats.wakes > stats.falseWakes) ? (stats.latencyTotalMs / (stats.wakes - stats.falseWakes)) : 0U) );
+    evtLogU32( &rec, stats.latencyMaxMs );
+    evtLogU32( &rec, stats.sleepMs );
+    exampleRfalPollerLog( &rec );
+    
+    evtLogBegin( &rec, EVT_LOG_WAKEUP_REF );
+    evtLogU8( &rec, stats.ampRef );
+    evtLogU8( &rec, stats.ampDelta );
+    evtLogU8( &rec, stats.phaRef );
+    evtLogU8( &rec, stats.phaDelta );
+    evtLogU32( &rec, stats.timerEvents );
+    evtLogU32( &rec, stats.refUpdates );
+    evtLogU32( &rec, stats.calibrations );
+    exampleRfalPollerLog( &rec );
+}
+#endif /* EXAMPLE_RFAL_POLLER_WAKEUP */
+
+
+#if EXAMPLE_RFAL_POLLER_SCHED
+/*!
+ ******************************************************************************
+ * \brief Poller technology scheduler report
+ * 
+ * Logs, every EXAMPLE_RFAL_POLLER_SCHED_REPORT poll cycles, how often each
+ * technology was detected, found a device or was skipped as idle and the
+ * time its Technology Detection took.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerSchedReport( void )
+{
+    static const uint16_t techs[] = { RFAL_NFC_POLL_TECH_A, RFAL_NFC_POLL_TECH_B, RFAL_NFC_POLL_TECH_F, RFAL_NFC_POLL_TECH_V };  /* Listen type order */
+    static uint32_t       cycles[PLTF_READERS];
+    rfalNfcTechStats      stats;
+    evtLogRecord          rec;
+    uint8_t               i;
+    
+    if( (++cycles[pltf_reader_get()] % EXAMPLE_RFAL_POLLER_SCHED_REPORT) != 0U )
+    {
+        return;
+    }
+    
+    for( i = 0; i < (sizeof(techs) / sizeof(techs[0])); i++ )
+    {
+        if( (rfalNfcGetTechStats( techs[i], &stats ) == RFAL_ERR_NONE) && ((stats.polls + stats.skips) != 0U) )
+        {
+            evtLogBegin( &rec, EVT_LOG_TECH_STATS );
+            evtLogU8( &rec, i );
+            evtLogU32( &rec, stats.polls );
+            evtLogU32( &rec, stats.hits );
+            evtLogU32( &rec, stats.skips );
+            evtLogU32( &rec, ((stats.polls != 0U) ? (stats.timeTotalUs / stats.polls) : 0U) );
+            evtLogU32( &rec, stats.timeMaxUs );
+            exampleRfalPollerLog( &rec );
+        }
+    }
+}
+#endif /* EXAMPLE_RFAL_POLLER_SCHED */
+
+
+#if EXAMPLE_RFAL_POLLER_DPO
+/*!
+ ******************************************************************************
+ * \brief Poller power level report
+ * 
+ * Logs, every EXAMPLE_RFAL_POLLER_DPO_REPORT poll cycles, how many cycles ran
+ * at each power level and the frames received with and without error at it.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerDpoReport( void )
+{
+    static uint32_t cycles[PLTF_READERS];
+    rfalDpoStats    stats;
+    evtLogRecord    rec;
+    uint8_t         i;
+    
+    if( (++cycles[pltf_reader_get()] % EXAMPLE_RFAL_POLLER_DPO_REPORT) != 0U )
+    {
+        return;
+    }
+    
+    for( i = 0; i < (sizeof(exampleRfalPollerDpoTable) / sizeof(exampleRfalPollerDpoTable[0])); i++ )
+    {
+        if( (rfalDpoGetStats( i, &stats ) == RFAL_ERR_NONE) && (stats.adjusts != 0U) )
+        {
+            evtLogBegin( &rec, EVT_LOG_DPO_STATS );
+            evtLogU8( &rec, i );
+            evtLogU8( &rec, exampleRfalPollerDpoTable[i].rfoRes );
+            evtLogU32( &rec, stats.adjusts );
+            evtLogU32( &rec, stats.steps );
+            evtLogU32( &rec, stats.rxOk );
+            evtLogU32( &rec, stats.rxErrors );
+            exampleRfalPollerLog( &rec );
+        }
+    }
+}
+#endif /* EXAMPLE_RFAL_POLLER_DPO */
+
+
+#if EXAMPLE_RFAL_POLLER_ISODEP
+/*!
+ ******************************************************************************
+ * \brief Poller ISO-DEP max bit rate
+ * 
+ * rfalNfcDiscoverParam.maxBRCb: the bit rate the activation of the given 
+ * card may negotiate, lowered for the cards that failed at higher ones 
+ * (see isodep_rate.h).
+ * 
+ * \param[in]  dev : device about to be activated
+ * 
+ * \return the max bit rate
+ * 
+ ******************************************************************************
+ */
+static rfalBitRate exampleRfalPollerIsoDepMaxBR( const rfalNfcDevice *dev )
+{
+    return isoDepRateGet( dev->nfcid, dev->nfcidLen );
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller ISO-DEP card offer
+ * 
+ * \param[in]  dev : activated device
+ * 
+ * \return the highest bit rate the card offers in both directions (ATS TA,
+ *         SENSB_RES Bit Rate Capability)
+ * 
+ ******************************************************************************
+ */
+static rfalBitRate exampleRfalPollerIsoDepOffered( const rfalNfcDevice *dev )
+{
+    uint8_t brc;
+    uint8_t br;
+    
+    brc = 0x00U;
+    if( (dev->type == RFAL_NFC_LISTEN_TYPE_NFCA) && ((dev->proto.isoDep.activation.A.Listener.ATS.T0 & RFAL_ISODEP_ATS_T0_TA_PRESENCE_MASK) != 0U) )
+    {
+        brc = dev->proto.isoDep.activation.A.Listener.ATS.TA;
+    }
+    else if( dev->type == RFAL_NFC_LISTEN_TYPE_NFCB )
+    {
+        brc = dev->dev.nfcb.sensbRes.protInfo.BRC;
+    }
+    else
+    {
+        /* No TA: 106 only */
+    }
+    
+    if( (brc & RFAL_ISODEP_BITRATE_RFU_MASK) != 0U )
+    {
+        return RFAL_BR_106;
+    }
+    for( br = (uint8_t)RFAL_BR_848; br > (uint8_t)RFAL_BR_106; br-- )
+    {
+        if( ((brc & (0x10U << (br - 1U))) != 0U) && ((brc & (0x01U << (br - 1U))) != 0U) )
+        {
+            return (rfalBitRate)br;
+        }
+    }
+    return RFAL_BR_106;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller ISO-DEP APDU
+ * 
+ * Exchanges an APDU with the activated card, blocking, and accounts it in 
+ * the session.
+ * 
+ * \param[in]   capdu    : C-APDU
+ * \param[in]   capduLen : C-APDU length
+ * \param[out]  rapdu    : R-APDU data, valid until the next exchange
+ * \param[out]  sw       : status word SW1SW2
+ * \param[out]  ses      : session
+ * 
+ * \return RFAL_ERR_NONE or the transmission error
+ * 
+ ******************************************************************************
+ */
+static ReturnCode exampleRfalPollerIsoDepApdu( uint8_t *capdu, uint16_t capduLen, uint8_t **rapdu, uint16_t *sw, isoDepRateSession *ses )
+{
+    uint16_t   *rcvLen;
+    uint32_t   t0;
+    ReturnCode err;
+    
+    t0  = platformGetSysTickUs();
+    err = rfalNfcDataExchangeStart( capdu, capduLen, rapdu, &rcvLen, RFAL_FWT_NONE );
+    if( err == RFAL_ERR_NONE )
+    {
+        do
+        {
+            rfalNfcWorker();
+            rfalWorkerWait();
+            err = rfalNfcDataExchangeGetStatus();
+        }
+        while( err == RFAL_ERR_BUSY );
+    }
+    
+    ses->timeUs += (platformGetSysTickUs() - t0);
+    ses->apdus++;
+    if( err != RFAL_ERR_NONE )
+    {
+        return err;
+    }
+    if( *rcvLen < 2U )
+    {
+        return RFAL_ERR_PROTO;
+    }
+    
+    ses->bytes += (uint32_t)capduLen + *rcvLen;
+    *sw         = (uint16_t)(((uint16_t)(*rapdu)[*rcvLen - 2U] << 8) | (*rapdu)[*rcvLen - 1U]);
+    return RFAL_ERR_NONE;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller ISO-DEP session
+ * 
+ * Reads the activated card: the NDEF message of a Type 4 Tag, up to 
+ * EXAMPLE_RFAL_POLLER_ISODEP_READ_MAX, in bulk and without the CC once the
+ * card (model) is known (see ndef_read.h), or the PPSE and first record of
+ * a payment card.
+ * 
+ * \param[in]   dev : activated card
+ * \param[out]  ses : session, type and accounting filled in
+ * 
+ * \return false if a transmission error ended the session
+ * 
+ ******************************************************************************
+ */
+static bool exampleRfalPollerIsoDepSession( const rfalNfcDevice *dev, isoDepRateSession *ses )
+{
+    ndefReadMsg   msg;
+    ndefReadStats stats;
+    uint8_t       *buf;
+    uint8_t       *rapdu;
+    uint16_t      sw;
+    ReturnCode    err;
+    
+    ses->type = ISODEP_RATE_TYPE_OTHER;
+    
+    /* Type 4 Tag: NDEF application, CC (unless cached), NDEF file, message */
+    buf = apduPoolAlloc( EXAMPLE_RFAL_POLLER_ISODEP_READ_MAX );
+    if( buf == NULL )
+    {
+        return true;                                                              /* Pool exhausted: not the card's fault */
+    }
+    memset( &stats, 0x00, sizeof(stats) );
+    err = ndefRead( dev, buf, EXAMPLE_RFAL_POLLER_ISODEP_READ_MAX, &msg, &stats );
+#if EXAMPLE_RFAL_POLLER_NDEF
+    if( err != RFAL_ERR_NOTFOUND )
+    {
+        exampleRfalPollerNdefLog( dev, err, &msg, &stats );
+    }
+#endif /* EXAMPLE_RFAL_POLLER_NDEF */
+    apduPoolFree( buf );
+    
+    ses->apdus  += stats.cmds;
+    ses->bytes  += stats.bytes;
+    ses->timeUs += stats.timeUs;
+    if( err != RFAL_ERR_NOTFOUND )
+    {
+        ses->type = ((stats.cmds > 1U) ? ISODEP_RATE_TYPE_NDEF : ISODEP_RATE_TYPE_OTHER);  /* NDEF application selected */
+        return ((err == RFAL_ERR_NONE) || (err == RFAL_ERR_REQUEST) || (err == RFAL_ERR_NOMEM));
+    }
+    
+    /* Payment card: PPSE, first record */
+    if( exampleRfalPollerIsoDepApdu( ppseSelectApp, sizeof(ppseSelectApp), &rapdu, &sw, ses ) != RFAL_ERR_NONE )
+    {
+        return false;
+    }
+    if( sw == 0x9000U )
+    {
+        ses->type = ISODEP_RATE_TYPE_PAY;
+        return (exampleRfalPollerIsoDepApdu( readRecord, sizeof(readRecord), &rapdu, &sw, ses ) == RFAL_ERR_NONE);
+    }
+    return true;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller ISO-DEP reactivation
+ * 
+ * Deselects the active card (it goes to sleep) and activates it again, 
+ * RATS and PPS at the current cap of the card included.
+ * 
+ * \param[in]  devIdx : index of the card in the device list
+ * 
+ * \return true if the card is activated again
+ * 
+ ******************************************************************************
+ */
+static bool exampleRfalPollerIsoDepReactivate( uint8_t devIdx )
+{
+    multiSel = true;                                                              /* The worker comes back to POLL_SELECT: the card is selected here, not by exampleRfalPollerNotify() */
+    if( rfalNfcDeactivate( RFAL_NFC_DEACTIVATE_SLEEP ) != RFAL_ERR_NONE )
+    {
+        return false;
+    }
+    do
+    {
+        rfalNfcWorker();
+        rfalWorkerWait();
+    }
+    while( rfalNfcGetState() == RFAL_NFC_STATE_DEACTIVATION );
+    
+    if( rfalNfcSelect( devIdx ) != RFAL_ERR_NONE )
+    {
+        return false;
+    }
+    do
+    {
+        rfalNfcWorker();
+        rfalWorkerWait();
+    }
+    while( rfalNfcGetState() == RFAL_NFC_STATE_POLL_ACTIVATION );
+    
+    return (rfalNfcGetState() == RFAL_NFC_STATE_ACTIVATED);
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller ISO-DEP
+ * 
+ * Runs a session with the activated ISO-DEP card and reports its outcome 
+ * (see isodep_rate.h). A session that failed is retried on a new 
+ * activation, once the card's cap has fallen back at a lower bit rate, up
+ * to EXAMPLE_RFAL_POLLER_ISODEP_TRIES sessions.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerIsoDep( void )
+{
+    rfalNfcDevice     *dev;
+    rfalNfcDevice     *devList;
+    isoDepRateSession ses;
+    evtLogRecord      rec;
+    rfalBitRate       cap;
+    uint8_t           devCnt;
+    uint8_t           tries;
+    bool              ok;
+    
+    if( (rfalNfcGetState() != RFAL_NFC_STATE_ACTIVATED) || (rfalNfcGetActiveDevice( &dev ) != RFAL_ERR_NONE)
+        || (dev->rfInterface != RFAL_NFC_INTERFACE_ISODEP) || (rfalNfcGetDevicesFound( &devList, &devCnt ) != RFAL_ERR_NONE) )
+    {
+        return;
+    }
+    
+    for( tries = 1U; ; tries++ )
+    {
+        cap = isoDepRateGet( dev->nfcid, dev->nfcidLen );
+        memset( &ses, 0x00, sizeof(ses) );
+        ses.tried = exampleRfalPollerIsoDepOffered( dev );
+        ses.tried = ((cap < ses.tried) ? cap : ses.tried);
+        ses.br    = dev->proto.isoDep.info.DSI;
+        ok        = exampleRfalPollerIsoDepSession( dev, &ses );
+        ses.ok    = ok;
+        
+        if( isoDepRateReport( dev->nfcid, dev->nfcidLen, &ses ) )
+        {
+            evtLogBegin( &rec, EVT_LOG_ISODEP_FALLBACK );
+            evtLogU8( &rec, (uint8_t)ses.tried );
+            evtLogU8( &rec, (uint8_t)isoDepRateGet( dev->nfcid, dev->nfcidLen ) );
+            evtLogU8( &rec, dev->nfcidLen );
+            evtLogBytes( &rec, dev->nfcid, dev->nfcidLen );
+            exampleRfalPollerLog( &rec );
+        }
+        
+        if( ok || (tries >= EXAMPLE_RFAL_POLLER_ISODEP_TRIES) || !exampleRfalPollerIsoDepReactivate( (uint8_t)(dev - devList) ) )
+        {
+            return;
+        }
+    }
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller ISO-DEP report
+ * 
+ * Logs, every EXAMPLE_RFAL_POLLER_ISODEP_REPORT poll cycles, the sessions 
+ * of each card type at each bit rate with their effective APDU throughput
+ * (C-APDU and R-APDU bytes over the exchange time), and the fallbacks.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerIsoDepReport( void )
+{
+    static uint32_t    cycles[PLTF_READERS];
+    isoDepRateStats    stats;
+    isoDepRateCounters cnt;
+    evtLogRecord       rec;
+    uint8_t            type;
+    uint8_t            br;
+    
+    if( (++cycles[pltf_reader_get()] % EXAMPLE_RFAL_POLLER_ISODEP_REPORT) != 0U )
+    {
+        return;
+    }
+    
+    isoDepRateGetCounters( &cnt );
+    if( cnt.cards == 0U )
+    {
+        return;
+    }
+    
+    for( type = 0; type < (uint8_t)ISODEP_RATE_TYPES; type++ )
+    {
+        for( br = (uint8_t)RFAL_BR_106; br < ISODEP_RATE_BRS; br++ )
+        {
+            if( isoDepRateGetStats( (isoDepRateType)type, (rfalBitRate)br, &stats ) && (stats.sessions != 0U) )
+            {
+                evtLogBegin( &rec, EVT_LOG_ISODEP_STATS );
+                evtLogU8( &rec, type );
+                evtLogU8( &rec, br );
+                evtLogU32( &rec, stats.sessions );
+                evtLogU32( &rec, stats.failures );
+                evtLogU32( &rec, stats.apdus );
+                evtLogU32( &rec, ((stats.timeUs != 0U) ? (uint32_t)(((uint64_t)stats.bytes * 1000000U) / stats.timeUs) : 0U) );
+                evtLogU32( &rec, ((stats.apdus != 0U) ? (stats.timeUs / stats.apdus) : 0U) );
+                exampleRfalPollerLog( &rec );
+            }
+        }
+    }
+    
+    evtLogBegin( &rec, EVT_LOG_ISODEP_RATE );
+    evtLogU32( &rec, cnt.fallbacks );
+    evtLogU32( &rec, cnt.probes );
+    evtLogU32( &rec, cnt.ppsFails );
+    evtLogU32( &rec, cnt.cards );
+    exampleRfalPollerLog( &rec );
+}
+#endif /* EXAMPLE_RFAL_POLLER_ISODEP */
+
+
+#if EXAMPLE_RFAL_POLLER_NDEF
+/*!
+ ******************************************************************************
+ * \brief Poller NDEF read log
+ * 
+ * Logs an NDEF read: message length and records, or the error, commands, 
+ * exchange time and where the tag layout came from (CC read, cached).
+ * 
+ * \param[in]  dev   : device read
+ * \param[in]  err   : outcome of ndefRead()
+ * \param[in]  msg   : message read
+ * \param[in]  stats : cost of the read
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerNdefLog( const rfalNfcDevice *dev, ReturnCode err, const ndefReadMsg *msg, const ndefReadStats *stats )
+{
+    ndefReadRecord rec;
+    evtLogRecord   log;
+    uint16_t       pos;
+    uint8_t        records;
+    
+    records = 0;
+    pos     = 0;
+    while( (records < 0xFFU) && (ndefReadRecordNext( msg->msg, msg->msgLen, &pos, &rec ) == RFAL_ERR_NONE) )
+    {
+        records++;
+    }
+    
+    evtLogBegin( &log, EVT_LOG_NDEF );
+    evtLogU8( &log, (uint8_t)msg->type );
+    evtLogU8( &log, (uint8_t)msg->ccSrc );
+    evtLogU8( &log, (uint8_t)err );
+    evtLogU8( &log, (uint8_t)((stats->cmds > 0xFFU) ? 0xFFU : stats->cmds) );
+    evtLogU8( &log, records );
+    evtLogU32( &log, msg->nlen );
+    evtLogU32( &log, stats->timeUs );
+    evtLogU8( &log, dev->nfcidLen );
+    evtLogBytes( &log, dev->nfcid, dev->nfcidLen );
+    exampleRfalPollerLog( &log );
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller NDEF
+ * 
+ * Reads the NDEF message of the activated T2T / T5T, up to 
+ * EXAMPLE_RFAL_POLLER_NDEF_READ_MAX bytes, straight into a buffer of the 
+ * APDU pool: the memory from the CC to the end of the message in a single
+ * command once the tag (model) is known, see ndef_read.h.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerNdef( void )
+{
+    rfalNfcDevice *dev;
+    ndefReadMsg   msg;
+    ndefReadStats stats;
+    uint8_t       *buf;
+    ReturnCode    err;
+    
+    if( (rfalNfcGetState() != RFAL_NFC_STATE_ACTIVATED) || (rfalNfcGetActiveDevice( &dev ) != RFAL_ERR_NONE)
+        || (dev->rfInterface == RFAL_NFC_INTERFACE_ISODEP) )
+    {
+        return;
+    }
+    
+    buf = apduPoolAlloc( NDEF_READ_BUF_LEN( EXAMPLE_RFAL_POLLER_NDEF_READ_MAX ) );
+    if( buf == NULL )
+    {
+        return;
+    }
+    memset( &stats, 0x00, sizeof(stats) );
+    err = ndefRead( dev, buf, (uint16_t)NDEF_READ_BUF_LEN( EXAMPLE_RFAL_POLLER_NDEF_READ_MAX ), &msg, &stats );
+    if( err != RFAL_ERR_NOTSUPP )
+    {
+        exampleRfalPollerNdefLog( dev, err, &msg, &stats );
+    }
+    apduPoolFree( buf );
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller NDEF report
+ * 
+ * Logs, every EXAMPLE_RFAL_POLLER_NDEF_REPORT poll cycles, how the NDEF 
+ * reads found the tag layout: cached for the tag, for its model, or read.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerNdefReport( void )
+{
+    static uint32_t  cycles[PLTF_READERS];
+    ndefReadCounters cnt;
+    evtLogRecord     rec;
+    
+    if( (++cycles[pltf_reader_get()] % EXAMPLE_RFAL_POLLER_NDEF_REPORT) != 0U )
+    {
+        return;
+    }
+    
+    ndefReadGetCounters( &cnt );
+    if( cnt.reads == 0U )
+    {
+        return;
+    }
+    
+    evtLogBegin( &rec, EVT_LOG_NDEF_STATS );
+    evtLogU32( &rec, cnt.reads );
+    evtLogU32( &rec, cnt.tagHits );
+    evtLogU32( &rec, cnt.modelHits );
+    evtLogU32( &rec, cnt.misses );
+    evtLogU32( &rec, cnt.stale );
+    evtLogU32( &rec, cnt.failures );
+    exampleRfalPollerLog( &rec );
+}
+#endif /* EXAMPLE_RFAL_POLLER_NDEF */
+
+
+#ifdef ST25R_COM_TRACE
+/*!
+ ******************************************************************************
+ * \brief Poller SPI cost log
+ * 
+ * \param[in]  kind : EVT_LOG_SPI_COST_PHASE, _OP or _REG
+ * \param[in]  idx  : RFAL phase, operation or register address
+ * \param[in]  cost : SPI cost
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerTraceCost( uint8_t kind, uint8_t idx, const st25r3911TraceCost *cost )
+{
+    evtLogRecord rec;
+    
+    evtLogBegin( &rec, EVT_LOG_SPI_COST );
+    evtLogU8( &rec, kind );
+    evtLogU8( &rec, idx );
+    evtLogU32( &rec, cost->frames );
+    evtLogU32( &rec, cost->bytes );
+    evtLogU32( &rec, cost->timeUs );
+    exampleRfalPollerLog( &rec );
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller SPI trace dump
+ * 
+ * Logs the SPI cost of the last poll cycle for the output task: totals, per
+ * RFAL phase, per operation and the registers with the most traffic. The 
+ * statistics are cleared afterwards so that every cycle is reported on its
+ * own. Nothing is printed here.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerTraceDump( void )
+{
+    static st25r3911TraceStats stats[PLTF_READERS];
+    st25r3911TraceStats        *st;
+    evtLogRecord               rec;
+    uint8_t                    hot[5];
+    uint8_t                    n;
+    uint8_t                    i;
+    
+    st = &stats[pltf_reader_get()];
+    st25r3911TraceGetStats( st );
+    st25r3911TraceReset();
+    
+    evtLogBegin( &rec, EVT_LOG_SPI_CYCLE );
+    evtLogU32( &rec, st->total.frames );
+    evtLogU32( &rec, st->total.bytes );
+    evtLogU32( &rec, st->total.timeUs );
+    exampleRfalPollerLog( &rec );
+    
+    for( i = 0; i < ST25R3911_TRACE_PHASE_NUM; i++ )
+    {
+        if( st->phase[i].frames != 0U )
+        {
+            exampleRfalPollerTraceCost( EVT_LOG_SPI_COST_PHASE, i, &st->phase[i] );
+        }
+    }
+    
+    for( i = 0; i < ST25R3911_TRACE_OP_NUM; i++ )
+    {
+        if( st->op[i].frames != 0U )
+        {
+            exampleRfalPollerTraceCost( EVT_LOG_SPI_COST_OP, i, &st->op[i] );
+        }
+    }
+    
+    n = st25r3911TraceHotRegs( st, hot, sizeof(hot) );
+    for( i = 0; i < n; i++ )
+    {
+        exampleRfalPollerTraceCost( EVT_LOG_SPI_COST_REG, hot[i], &st->reg[hot[i]] );
+    }
+}
+#endif /* ST25R_COM_TRACE */
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller initialization
+ * 
+ * Initializes RFAL, the tag tracker and the discovery parameters of the 
+ * reader the calling task is bound to (see pltf_reader_select()).
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerInit( void )
 {
-    static rfalNfcDevice *nfcDevice;
+    // NFC:
+    ReturnCode ret = rfalNfcInitialize();      // WAS: 'rfalInitialize()' - but this function is NOT setting NFC-state!!
+    
+    if (RFAL_ERR_NONE != ret)
+    {
+        Serial0.println("ERROR: NFC subsystem init failed!\nNFC subsystem init return code:");
+        Serial0.println(ret);
+        while(1)
+        {
+            vTaskDelay(1000);
+        }
+    }
+
+    rfalSetUpperLayerCallback( exampleRfalPollerIrqNotify );
+    tagTrackerInit( exampleRfalPollerTagEvent );
+    ndefReadInit();
+
+    // Discovery profile, see EXAMPLE_RFAL_POLLER_PROFILE. techs2Find is narrowed down on every round by the presence checks.
+    rfalNfcDefaultDiscParams( &discParam );
+    discParam.techs2Find    = EXAMPLE_RFAL_POLLER_TECHS;
+    discParam.techs2Bail    = EXAMPLE_RFAL_POLLER_TECHS_BAIL;
+    discParam.devLimit      = EXAMPLE_RFAL_POLLER_DEV_LIMIT;
+    discParam.totalDuration = EXAMPLE_RFAL_POLLER_TOTAL_DURATION;
+    discParam.notifyCb      = exampleRfalPollerNotify;
+    memcpy( discParam.nfcid3, NFCID3, sizeof(NFCID3) );
+    memcpy( discParam.GB, GB, sizeof(GB) );
+    discParam.GBLen         = sizeof(GB);
+#if EXAMPLE_RFAL_POLLER_SCHED
+    discParam.techSchedAdaptive = true;                                           // NFC-V (and B, F) polled less often once nothing was seen for a while.
+    discParam.techPrio[0]       = RFAL_NFC_SCHED_PRIO_ALWAYS;                     // Indexed by flag bit position: RFAL_NFC_POLL_TECH_A
+    discParam.techPrio[3]       = 1U;                                             //                               RFAL_NFC_POLL_TECH_V
+#endif /* EXAMPLE_RFAL_POLLER_SCHED */
+#if EXAMPLE_RFAL_POLLER_DPO
+    rfalDpoInitialize();
+    rfalDpoTableWrite( exampleRfalPollerDpoTable, (sizeof(exampleRfalPollerDpoTable) / sizeof(exampleRfalPollerDpoTable[0])) );
+    rfalDpoSetEnabled( true );                                                    // Adjusted once per poll cycle, see EXAMPLE_RFAL_POLLER_STATE_INIT.
+#endif /* EXAMPLE_RFAL_POLLER_DPO */
+#if EXAMPLE_RFAL_POLLER_WAKEUP
+    wakeUpCtrlInit();
+    discParam.wakeupConfigDefault = false;                                        // wakeupEnabled is decided on every round, see exampleRfalPollerWakeUpPrepare().
+#endif /* EXAMPLE_RFAL_POLLER_WAKEUP */
+#if EXAMPLE_RFAL_POLLER_ISODEP
+    isoDepRateInit( EXAMPLE_RFAL_POLLER_ISODEP_MAX_BR );
+    discParam.maxBR         = EXAMPLE_RFAL_POLLER_ISODEP_MAX_BR;
+    discParam.maxBRCb       = exampleRfalPollerIsoDepMaxBR;                       // Per card: lowered for the cards that failed at higher bit rates.
+    discParam.isoDepFS      = RFAL_ISODEP_FSDI_BUF_MAX;                           // Largest I-Blocks the buffers take: fewer blocks per NDEF read.
+#endif /* EXAMPLE_RFAL_POLLER_ISODEP */
+}
 
-    Serial0.println("Worker - start scan ...");
+
+/*!
+ ******************************************************************************
+ * \brief Poller step
+ * 
+ * Runs the rfalNfcWorker and advances the poller state machine of the 
+ * reader the calling task is bound to by one step.
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerRun( void )
+{
+    evtLogRecord rec;
+    ReturnCode   err;
 
     // put your main code here, to run repeatedly:
     rfalNfcWorker(); //TODO: put in a separate thread. NOTE: was 'rfalWorker()'.
+    rfalWorkerWait();                                                             // Sleeps while a transceive waits for an IRQ or a timer, returns at once otherwise.
 
-    vTaskDelay(50);
-
+    // States are advanced back-to-back: loop() is called again right away, the poller only sleeps in the idle window.
     switch( gState )
     {
         /*******************************************************************************/
         case EXAMPLE_RFAL_POLLER_STATE_INIT:                                     
             
-            gTechsFound = EXAMPLE_RFAL_POLLER_FOUND_NONE; 
-            gActiveDev  = NULL;
-            gDevCnt     = 0;
-            
-            gState = EXAMPLE_RFAL_POLLER_STATE_TECHDETECT;	// Transit to POLLER-state = 'Technology Detect'.
-            break;
-            
+            multiSel = false;
+            tagTrackerCycleStart();                                               /* Known devices are confirmed again in this cycle */
             
-        /*******************************************************************************/
-        case EXAMPLE_RFAL_POLLER_STATE_TECHDETECT:
-            
-            if( !exampleRfalPollerTechDetetection() )                             /* Poll for nearby devices in different technologies */
+#if EXAMPLE_RFAL_POLLER_DPO
+            if( (tagTrackerGet( 0 ) != NULL) || (rfalDpoGetCurrentTableIndex() != 0U) )
             {
-                gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;                  /* If no device was found, restart loop */
-                break;
+                (void)rfalDpoAdjust();                                            /* Follow the known devices, back to full power once they left. New devices: see rfalNfcWorker() */
             }
+#endif /* EXAMPLE_RFAL_POLLER_DPO */
             
-            gState = EXAMPLE_RFAL_POLLER_STATE_COLAVOIDANCE;                      /* One or more devices found, go to Collision Avoidance */
-            break;
-            
-            
-        /*******************************************************************************/
-        case EXAMPLE_RFAL_POLLER_STATE_COLAVOIDANCE:
-            
-            if( !exampleRfalPollerCollResolution() )                              /* Resolve any eventual collision */
+            discParam.techs2Find = exampleRfalPollerPresence();                   /* Known devices only: no discovery needed for their technology */
+            if( discParam.techs2Find == RFAL_NFC_TECH_NONE )
             {
-                gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;                  /* If Collision Resolution was unable to retrieve any device, restart loop */
+                gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;
                 break;
             }
             
-            Serial0.print("Device(s) found: ");
-            Serial0.println( gDevCnt );
+#if EXAMPLE_RFAL_POLLER_WAKEUP
+            discParam.wakeupEnabled = exampleRfalPollerWakeUpPrepare();           /* No device known: sleep until the antenna is detuned */
+#endif /* EXAMPLE_RFAL_POLLER_WAKEUP */
             
-            for(int i = 0; i < gDevCnt; i++)
+            err = rfalNfcDiscover( &discParam );                                  /* rfalNfcWorker runs Technology Detection, Collision Resolution and Activation */
+            if( err != RFAL_ERR_NONE )
             {
-                switch( gDevList[i].type )
-                {
-                    case EXAMPLE_RFAL_POLLER_TYPE_NFCA:
-                        Serial0.print( " NFC-A device UID: "); 
-                        Serial0.println( hex2str(gDevList[i].dev.nfca.nfcId1, gDevList[i].dev.nfca.nfcId1Len) );
-                        //platformLedOn( LED_NFCA_PORT, LED_NFCA_PIN  );
-                        platformLedOn(LED_TAG_READ_PORT, LED_TAG_READ_PIN); 
-                        break;
-                        
-                    case EXAMPLE_RFAL_POLLER_TYPE_NFCB:
-                        Serial0.print( " NFC-B device UID: "); 
-                        Serial0.println( hex2str(gDevList[i].dev.nfcb.sensbRes.nfcid0, RFAL_NFCB_NFCID0_LEN) );
-                        //platformLedOn( LED_NFCB_PORT, LED_NFCB_PIN  );
-                        platformLedOn(LED_TAG_READ_PORT, LED_TAG_READ_PIN); 
-                        break;
-                        
-                    case EXAMPLE_RFAL_POLLER_TYPE_NFCF:
-                        Serial0.print( " NFC-F device UID: "); 
-                        Serial0.println( hex2str(gDevList[i].dev.nfcf.sensfRes.NFCID2, RFAL_NFCF_NFCID2_LEN) );
-                        //platformLedOn( LED_NFCF_PORT, LED_NFCF_PIN  );
-                        platformLedOn(LED_TAG_READ_PORT, LED_TAG_READ_PIN); 
-                        break;
-                        
-                    case EXAMPLE_RFAL_POLLER_TYPE_NFCV:
-                        Serial0.print( " NFC-V device UID: "); 
-                        Serial0.println( hex2str(gDevList[i].dev.nfcv.InvRes.UID, RFAL_NFCV_UID_LEN) );
-                        //platformLedOn( LED_NFCV_PORT, LED_NFCV_PIN  );
-                        platformLedOn(LED_TAG_READ_PORT, LED_TAG_READ_PIN); 
-                        break;
-                }
+                evtLogBegin( &rec, EVT_LOG_DISCOVER_ERR );
+                evtLogU32( &rec, err );
+                exampleRfalPollerLog( &rec );
+                gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;
+                break;
             }
-            //platformDelay(200);
-            gState = EXAMPLE_RFAL_POLLER_STATE_ACTIVATION;                        /* Device(s) have been identified, go to Activation */
+            
+            gState = EXAMPLE_RFAL_POLLER_STATE_DISCOVERY;
             break;
-        
+            
             
         /*******************************************************************************/
-        case EXAMPLE_RFAL_POLLER_STATE_ACTIVATION:
-#if defined(USE_POLLER_STATE_REACTIVATION) && (USE_POLLER_STATE_REACTIVATION == 1)
-
-            if( !exampleRfalPollerActivation( 0 ) )                               /* Any device previous identified can be Activated, on this example will select the firt on the list */
+        case EXAMPLE_RFAL_POLLER_STATE_DISCOVERY:
+            
+            switch( rfalNfcGetState() )
             {
-                gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;                  /* If Activation failed, restart loop */
-                break;
+                case RFAL_NFC_STATE_ACTIVATED:                                    /* Device(s) found, one of them activated */
+                case RFAL_NFC_STATE_POLL_SELECT:                                  /* Device(s) found, activation of the selected one failed */
+                    exampleRfalPollerReport();
+#if EXAMPLE_RFAL_POLLER_ISODEP
+                    exampleRfalPollerIsoDep();                                    /* Activated ISO-DEP card: read it, falling back to lower bit rates on errors */
+#endif /* EXAMPLE_RFAL_POLLER_ISODEP */
+#if EXAMPLE_RFAL_POLLER_NDEF
+                    exampleRfalPollerNdef();                                      /* Activated T2T / T5T: read its NDEF message */
+#endif /* EXAMPLE_RFAL_POLLER_NDEF */
+#if EXAMPLE_RFAL_POLLER_WAKEUP
+                    exampleRfalPollerWakeUpResult( true );
+#endif /* EXAMPLE_RFAL_POLLER_WAKEUP */
+                    rfalNfcDeactivate( RFAL_NFC_DEACTIVATE_IDLE );
+                    gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;
+                    break;
+                    
+                case RFAL_NFC_STATE_LISTEN_TECHDETECT:                            /* No device found, the worker would wait for the end of totalDuration */
+                case RFAL_NFC_STATE_START_DISCOVERY:                              /* Collision Resolution or Activation failed, the worker would restart */
+#if EXAMPLE_RFAL_POLLER_WAKEUP
+                    exampleRfalPollerWakeUpResult( false );
+#endif /* EXAMPLE_RFAL_POLLER_WAKEUP */
+                    rfalNfcDeactivate( RFAL_NFC_DEACTIVATE_IDLE );
+                    gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;
+                    break;
+                    
+#if EXAMPLE_RFAL_POLLER_WAKEUP
+                case RFAL_NFC_STATE_WAKEUP_MODE:                                  /* Sleep until the WU timer/threshold IRQ, rfalWorkerWait() does not block here */
+                    wakeUpCtrlTrack();
+                    (void)ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+                    break;
+#endif /* EXAMPLE_RFAL_POLLER_WAKEUP */
+                    
+                case RFAL_NFC_STATE_IDLE:                                         /* Not expected, the poller is the only one to stop the worker */
+                    gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;
+                    break;
+                    
+                default:                                                          /* Discovery ongoing */
+                    break;
             }
+            break;
             
-            //gState = EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_START;                /* Device has been properly activated, go to Data Exchange */
-            gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;
-        break;
-#endif	            
-            
-        /*******************************************************************************/
-#if defined(USE_POLLER_STATE_DATAEXCHANGE) && (USE_POLLER_STATE_DATAEXCHANGE == 1)
-    case EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_START:                       
-    case EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_CHECK:
-            
-        err = exampleRfalPollerDataExchange();                                /* Perform Data Exchange, in this example a simple transfer will executed in order to do device's presence check */
-        switch( err )
-        {
-            case RFAL_ERR_NONE:                                                    /* Data exchange successful  */
-                platformDelay(300);                                           /* Wait a bit */
-                gState = EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_START;        /* Trigger new exchange with device */
-                break;
-                
-            case RFAL_ERR_BUSY:                                                    /* Data exchange ongoing  */
-                gState = EXAMPLE_RFAL_POLLER_STATE_DATAEXCHANGE_CHECK;        /* Once triggered/started the Data Exchange only do check until is completed */
-                break;
-                
-            default:                                                          /* Data exchange not successful, card removed or other transmission error */
-                Serial0.print("Data exchange terminated with error: %d \r\n", err);
-                gState = EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION;              /* Restart loop */
-                break;
-        }
-        break;
             
-#endif	            
         /*******************************************************************************/
         case EXAMPLE_RFAL_POLLER_STATE_DEACTIVATION:
-#if defined(USE_POLLER_DEACTIVATION) && (USE_POLLER_DEACTIVATION == 1)
-            exampleRfalPollerDeactivate();                                        /* If a card has been activated, properly deactivate the device */
-#endif	            
+            tagTrackerCycleEnd();                                                 /* Report the devices that have left */
             rfalFieldOff();                                                       /* Turn the Field Off powering down any device nearby */
-            platformDelay(20);                                                     /* Remain a certain period with field off */
+#ifdef ST25R_COM_TRACE
+            exampleRfalPollerTraceDump();                                         /* Report the SPI cost of this poll cycle */
+#endif /* ST25R_COM_TRACE */
+#if EXAMPLE_RFAL_POLLER_SCHED
+            exampleRfalPollerSchedReport();
+#endif /* EXAMPLE_RFAL_POLLER_SCHED */
+#if EXAMPLE_RFAL_POLLER_DPO
+            exampleRfalPollerDpoReport();
+#endif /* EXAMPLE_RFAL_POLLER_DPO */
+#if EXAMPLE_RFAL_POLLER_ISODEP
+            exampleRfalPollerIsoDepReport();
+#endif /* EXAMPLE_RFAL_POLLER_ISODEP */
+#if EXAMPLE_RFAL_POLLER_NDEF
+            exampleRfalPollerNdefReport();
+#endif /* EXAMPLE_RFAL_POLLER_NDEF */
+            exampleRfalPollerIdle();                                              /* Remain a certain period with field off, sleeping */
             gState = EXAMPLE_RFAL_POLLER_STATE_INIT;                              /* Restart the loop */
-            //
             break;
         
         
@@ -1211,8 +1878,75 @@ void loop()
             return;
 
 	}
+}
+
+
+#if PLTF_READERS > 1
+/*!
+ ******************************************************************************
+ * \brief Poller task
+ * 
+ * Runs the poller of one of the readers other than the first one, which is
+ * run by loop(). The readers share the SPI bus (frame by frame, see 
+ * pltf_protect_com()), each one has its own IRQ pin and handler task.
+ * 
+ * \param[in]  arg : reader index
+ * 
+ ******************************************************************************
+ */
+static void exampleRfalPollerTask( void *arg )
+{
+    pltf_reader_select( (uint8_t)(uintptr_t)arg );
+    gPollerTask = xTaskGetCurrentTaskHandle();
+    
+    for(;;)
+    {
+        exampleRfalPollerRun();
+    }
+}
+#endif /* PLTF_READERS > 1 */
+
+
+/***************************************   SETUP ***************************************/
+void setup() 
+{
+    uint8_t reader;
+    
+    Serial0.begin( EXAMPLE_RFAL_POLLER_LOG_BAUD );
+#if EXAMPLE_RFAL_POLLER_LOG_USB
+    Serial.begin( EXAMPLE_RFAL_POLLER_LOG_BAUD );
+#endif /* EXAMPLE_RFAL_POLLER_LOG_USB */
+    Serial0.println("Init ...");
+    
+    spi_init();
+
+    for( reader = 0; reader < PLTF_READERS; reader++ )
+    {
+        pltf_reader_select( reader );                                             // RFAL calls below go to this reader
+        exampleRfalPollerInit();
+    }
+    
+    pltf_reader_select( 0 );
+    gPollerTask = xTaskGetCurrentTaskHandle();  // setup() and loop() both run in the Arduino loopTask.
+    vTaskPrioritySet( NULL, EXAMPLE_RFAL_POLLER_TASK_PRIO );
+
+    xTaskCreatePinnedToCore( exampleRfalPollerOutputTask, "rfal_output", EXAMPLE_RFAL_POLLER_OUTPUT_STACK, NULL, EXAMPLE_RFAL_POLLER_OUTPUT_PRIO,
+                             &gOutputTask, EXAMPLE_RFAL_POLLER_OUTPUT_CORE );
 
-    vTaskDelay(3000);    // Run this task every 3seconds - task should NOT use more than 3sec to complete!!
+#if PLTF_READERS > 1
+    for( reader = 1; reader < PLTF_READERS; reader++ )
+    {
+        xTaskCreatePinnedToCore( exampleRfalPollerTask, "rfal_poller", EXAMPLE_RFAL_POLLER_TASK_STACK, (void *)(uintptr_t)reader,
+                                 EXAMPLE_RFAL_POLLER_TASK_PRIO, NULL, EXAMPLE_RFAL_POLLER_RF_CORE );
+    }
+#endif /* PLTF_READERS > 1 */
+
+    Serial0.println("NFC subsystem initialized OK ...");
 }
 
 
+/*************************************** MAIN task(-loop) ***************************************************/
+void loop() 
+{
+    exampleRfalPollerRun();                                                       // First reader, the others run in their own task.
+}
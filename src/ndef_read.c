@@ -0,0 +1,765 @@
+/*! \file ndef_read.c
+ *
+ *  \brief NDEF message read of Type 2, 4 and 5 Tags with CC caching
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <string.h>
+
+#include "ndef_read.h"
+#include "t4t_read.h"
+#include "rfal_platform/rfal_platform.h"
+#include "rfal_core/rfal_nfca.h"
+#include "rfal_core/rfal_t2t.h"
+#include "rfal_core/rfal_nfcv.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define NDEF_READ_T2T_CC_PAGE       3U      /*!< Page of the CC, the image starts there         */
+#define NDEF_READ_T2T_IMG_MAX       ((256U - NDEF_READ_T2T_CC_PAGE) * RFAL_T2T_BLOCK_LEN)  /*!< Sector 0 from the CC on */
+#define NDEF_READ_T2T_CC_MAGIC      0xE1U
+#define NDEF_READ_T2T_CC_LEN        4U
+#define NDEF_READ_T2T_READ_TX_LEN   2U
+#define NDEF_READ_T2T_FAST_TX_LEN   3U
+#define NDEF_READ_T2T_HLTA_TX_LEN   2U
+#define NDEF_READ_T2T_WUPA_TX_LEN   1U
+#define NDEF_READ_T2T_SEL_TX_LEN    7U      /*!< SEL, NVB, CL bytes, BCC per cascade level      */
+
+#define NDEF_READ_T5T_CC_MAGIC_1    0xE1U   /*!< Blocks 0..255                                  */
+#define NDEF_READ_T5T_CC_MAGIC_2    0xE2U   /*!< Extended commands for blocks above 255         */
+#define NDEF_READ_T5T_CC_LEN        4U
+#define NDEF_READ_T5T_CC_EXT_LEN    8U      /*!< MLEN 0 in byte 2: 8 byte CC                    */
+#define NDEF_READ_T5T_CC_MBREAD     0x01U   /*!< READ MULTIPLE BLOCKS supported                 */
+#define NDEF_READ_T5T_BLOCKS_MAX    256U    /*!< Blocks reachable w/o extended commands         */
+#define NDEF_READ_T5T_FLAGS_LEN     1U      /*!< Flags ahead of the response data               */
+#define NDEF_READ_T5T_TX_LEN        (2U + RFAL_NFCV_UID_LEN + 2U)  /*!< Flags, command, UID, block number(s) */
+
+#define NDEF_READ_CC_VERSION_1      0x01U   /*!< Major mapping version read                     */
+#define NDEF_READ_AREA_UNIT         8U      /*!< CC data area size unit (T2T, T5T MLEN)         */
+
+#define NDEF_READ_TLV_NULL          0x00U
+#define NDEF_READ_TLV_NDEF          0x03U
+#define NDEF_READ_TLV_TERMINATOR    0xFEU
+#define NDEF_READ_TLV_LEN_3         0xFFU   /*!< Three byte length format                       */
+
+#define NDEF_READ_REC_SR            0x10U   /*!< Short Record: one byte payload length          */
+#define NDEF_READ_REC_IL            0x08U   /*!< ID Length present                              */
+#define NDEF_READ_REC_TNF_MASK      0x07U
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! What a read learned about a tag */
+typedef struct
+{
+    uint16_t    imgLen;                     /*!< T2T / T5T: image bytes up to the message end   */
+    uint8_t     blockLen;                   /*!< T5T block size                                 */
+    bool        multi;                      /*!< FAST_READ (T2T) / MBREAD (T5T) usable          */
+    t4tReadInfo t4t;                        /*!< T4T CC, NLEN of the last read                  */
+} ndefReadLayout;
+
+/*! Cache entry of a tag */
+typedef struct
+{
+    uint8_t        uid[NDEF_READ_UID_MAX];
+    uint8_t        uidLen;                  /*!< 0: free                                        */
+    ndefReadType   type;
+    rfalNfcDevType devType;
+    uint8_t        mfr;                     /*!< IC manufacturer code, with the types the model */
+    bool           known;                   /*!< layout holds a complete read                   */
+    ndefReadLayout layout;
+    uint32_t       seq;                     /*!< Last use, least recently read is replaced      */
+} ndefReadTag;
+
+/*! Memory image read of a T2T / T5T */
+typedef struct
+{
+    const rfalNfcDevice *dev;
+    ndefReadType         type;
+    uint8_t             *img;               /*!< From the CC on                                 */
+    uint16_t             cap;               /*!< Image bytes the buffer takes                   */
+    uint16_t             len;               /*!< Image bytes read                               */
+    uint16_t             ccLen;
+    uint16_t             areaEnd;           /*!< End of the data area, within the image         */
+    uint8_t              blockLen;
+    bool                 multi;
+    bool                 fastFailed;        /*!< FAST_READ answered with a NACK or not at all   */
+    ndefReadStats       *stats;
+} ndefReadImg;
+
+/*! Reader context, one per reader */
+typedef struct
+{
+    uint32_t         seq;
+    ndefReadTag      tags[NDEF_READ_CACHE];
+    ndefReadCounters cnt;
+} ndefReadCtx;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static ndefReadCtx gNrInstances[PLTF_READERS];
+
+#define gNr          (gNrInstances[pltf_reader_get()])  /*!< Context of the calling task's reader */
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static ndefReadType ndefReadTypeOf( const rfalNfcDevice *dev, uint8_t *mfr )
+{
+    *mfr = (((dev->nfcid != NULL) && (dev->nfcidLen != 0U)) ? dev->nfcid[0] : 0U);
+
+    if( dev->rfInterface == RFAL_NFC_INTERFACE_ISODEP )
+    {
+        return NDEF_READ_TYPE_T4T;
+    }
+    if( (dev->type == RFAL_NFC_LISTEN_TYPE_NFCA) && (dev->dev.nfca.type == RFAL_NFCA_T2T) )
+    {
+        return NDEF_READ_TYPE_T2T;
+    }
+    if( dev->type == RFAL_NFC_LISTEN_TYPE_NFCV )
+    {
+        *mfr = dev->dev.nfcv.InvRes.UID[RFAL_NFCV_UID_LEN - 2U];                     /* Sent LSB first: E0, then the manufacturer code */
+        return NDEF_READ_TYPE_T5T;
+    }
+    return NDEF_READ_TYPE_NONE;
+}
+
+
+/*******************************************************************************/
+static ndefReadTag *ndefReadFind( const rfalNfcDevice *dev, ndefReadType type, uint8_t mfr, ndefReadCcSrc *src )
+{
+    const ndefReadTag *model;
+    ndefReadTag       *tag;
+    ndefReadLayout     layout;
+    uint8_t            i;
+
+    *src = NDEF_READ_CC_READ;
+    if( (dev->nfcidLen == 0U) || (dev->nfcidLen > NDEF_READ_UID_MAX) )
+    {
+        return NULL;
+    }
+
+    tag   = NULL;
+    model = NULL;
+    for( i = 0; i < NDEF_READ_CACHE; i++ )
+    {
+        if( (gNr.tags[i].uidLen == dev->nfcidLen) && (memcmp( gNr.tags[i].uid, dev->nfcid, dev->nfcidLen ) == 0) && (gNr.tags[i].type == type) )
+        {
+            gNr.tags[i].seq = ++gNr.seq;
+            *src            = (gNr.tags[i].known ? NDEF_READ_CC_TAG : NDEF_READ_CC_READ);
+            return &gNr.tags[i];
+        }
+        if( (gNr.tags[i].uidLen != 0U) && gNr.tags[i].known && (gNr.tags[i].type == type) && (gNr.tags[i].devType == dev->type)
+            && (gNr.tags[i].mfr == mfr) && ((model == NULL) || (gNr.tags[i].seq > model->seq)) )
+        {
+            model = &gNr.tags[i];                                                     /* Last read tag of the same model */
+        }
+        if( (tag == NULL) || (gNr.tags[i].uidLen == 0U) || ((tag->uidLen != 0U) && (gNr.tags[i].seq < tag->seq)) )
+        {
+            tag = &gNr.tags[i];                                                       /* Free entry first, least recently read otherwise */
+        }
+    }
+
+    /* Layout of the model taken before its entry may be replaced */
+    if( model != NULL )
+    {
+        layout = model->layout;
+        *src   = NDEF_READ_CC_MODEL;
+    }
+
+    memset( tag, 0x00, sizeof(ndefReadTag) );
+    memcpy( tag->uid, dev->nfcid, dev->nfcidLen );
+    tag->uidLen        = dev->nfcidLen;
+    tag->type          = type;
+    tag->devType       = dev->type;
+    tag->mfr           = mfr;
+    tag->layout.multi  = true;                                                        /* Until the tag shows otherwise */
+    tag->seq           = ++gNr.seq;
+    if( model != NULL )
+    {
+        tag->layout = layout;
+        tag->known  = true;
+    }
+    return tag;
+}
+
+
+/*******************************************************************************/
+static void ndefReadCmd( ndefReadImg *ctx, uint32_t t0, uint16_t txLen, uint16_t rcvLen )
+{
+    ctx->stats->timeUs += (platformGetSysTickUs() - t0);
+    ctx->stats->cmds++;
+    ctx->stats->bytes  += ((uint32_t)txLen + rcvLen);
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadT2tReselect( ndefReadImg *ctx )
+{
+    rfalNfcaSensRes sensRes;
+    rfalNfcaSelRes  selRes;
+    uint8_t         levels;
+    uint32_t        t0;
+    ReturnCode      ret;
+
+    /* ACTIVE (timeout) or IDLE (NACK): HLTA takes the former to HALT, WUPA wakes both */
+    t0 = platformGetSysTickUs();
+    (void)rfalNfcaPollerSleep();
+    ndefReadCmd( ctx, t0, NDEF_READ_T2T_HLTA_TX_LEN, 0U );
+
+    t0  = platformGetSysTickUs();
+    ret = rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes );
+    ndefReadCmd( ctx, t0, NDEF_READ_T2T_WUPA_TX_LEN, ((ret == RFAL_ERR_NONE) ? (uint16_t)sizeof(sensRes) : 0U) );
+    if( ret != RFAL_ERR_NONE )
+    {
+        return ret;
+    }
+
+    t0     = platformGetSysTickUs();
+    levels = (uint8_t)((ctx->dev->dev.nfca.nfcId1Len + 2U) / 4U);                     /* 4, 7, 10 byte UID: 1, 2, 3 */
+    ret    = rfalNfcaPollerSelect( ctx->dev->dev.nfca.nfcId1, ctx->dev->dev.nfca.nfcId1Len, &selRes );
+    ndefReadCmd( ctx, t0, (uint16_t)(levels * NDEF_READ_T2T_SEL_TX_LEN), ((ret == RFAL_ERR_NONE) ? levels : 0U) );
+    return ret;
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadT2tMore( ndefReadImg *ctx, uint16_t target )
+{
+    uint8_t    tmp[RFAL_T2T_READ_DATA_LEN];
+    uint16_t   rcvLen;
+    uint16_t   n;
+    uint8_t    first;
+    uint8_t    last;
+    uint32_t   t0;
+    ReturnCode ret;
+
+    target = (uint16_t)RFAL_MIN( target, ctx->cap );
+    while( ctx->len < target )
+    {
+        first  = (uint8_t)(NDEF_READ_T2T_CC_PAGE + (ctx->len / RFAL_T2T_BLOCK_LEN));
+        rcvLen = 0;
+        t0     = platformGetSysTickUs();
+
+        /* FAST_READ where a READ would not do: the range up to the target in one response */
+        if( ctx->multi && ((uint16_t)(target - ctx->len) > RFAL_T2T_READ_DATA_LEN) )
+        {
+            last = (uint8_t)(NDEF_READ_T2T_CC_PAGE + (((target + RFAL_T2T_BLOCK_LEN) - 1U) / RFAL_T2T_BLOCK_LEN) - 1U);
+            n    = (uint16_t)(((uint16_t)(last - first) + 1U) * RFAL_T2T_BLOCK_LEN);
+            ret  = rfalT2TPollerFastRead( first, last, &ctx->img[ctx->len], n, &rcvLen );
+            ndefReadCmd( ctx, t0, NDEF_READ_T2T_FAST_TX_LEN, rcvLen );
+            if( (ret == RFAL_ERR_PROTO) || (ret == RFAL_ERR_TIMEOUT) )
+            {
+                /* No FAST_READ: select the tag again and go on with READs */
+                ctx->fastFailed = true;
+                ctx->multi      = false;
+                RFAL_EXIT_ON_ERR( ret, ndefReadT2tReselect( ctx ) );
+                continue;
+            }
+        }
+        else if( (uint16_t)(ctx->cap - ctx->len) >= RFAL_T2T_READ_DATA_LEN )
+        {
+            n   = RFAL_T2T_READ_DATA_LEN;
+            ret = rfalT2TPollerRead( first, &ctx->img[ctx->len], n, &rcvLen );
+            ndefReadCmd( ctx, t0, NDEF_READ_T2T_READ_TX_LEN, rcvLen );
+        }
+        else
+        {
+            n   = RFAL_T2T_READ_DATA_LEN;                                             /* Buffer end: the last pages through a copy */
+            ret = rfalT2TPollerRead( first, tmp, n, &rcvLen );
+            ndefReadCmd( ctx, t0, NDEF_READ_T2T_READ_TX_LEN, rcvLen );
+            RFAL_MEMCPY( &ctx->img[ctx->len], tmp, (ctx->cap - ctx->len) );
+        }
+
+        if( ret != RFAL_ERR_NONE )
+        {
+            return ret;
+        }
+        if( rcvLen != n )
+        {
+            return RFAL_ERR_PROTO;
+        }
+        ctx->len = (uint16_t)RFAL_MIN( (ctx->len + n), ctx->cap );
+    }
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadT5tMore( ndefReadImg *ctx, uint16_t target )
+{
+    uint8_t   *dst;
+    uint8_t    save;
+    uint16_t   rcvLen;
+    uint16_t   n;
+    uint32_t   t0;
+    ReturnCode ret;
+
+    target = (uint16_t)RFAL_MIN( target, ctx->cap );
+    while( ctx->len < target )
+    {
+        n = (uint16_t)((((target - ctx->len) + ctx->blockLen) - 1U) / ctx->blockLen);
+        n = (uint16_t)(ctx->multi ? RFAL_MIN( n, NDEF_READ_T5T_BLOCKS ) : 1U);
+
+        /* Response flags land on the last byte read before, restored afterwards: the blocks go in place */
+        dst    = &ctx->img[ctx->len - 1];
+        save   = *dst;
+        rcvLen = 0;
+        t0     = platformGetSysTickUs();
+        if( n == 1U )
+        {
+            ret = rfalNfcvPollerReadSingleBlock( RFAL_NFCV_REQ_FLAG_DEFAULT, ctx->dev->dev.nfcv.InvRes.UID, (uint8_t)(ctx->len / ctx->blockLen), dst,
+                                                 (uint16_t)(NDEF_READ_T5T_FLAGS_LEN + ctx->blockLen + RFAL_CRC_LEN), &rcvLen );
+        }
+        else
+        {
+            ret = rfalNfcvPollerReadMultipleBlocks( RFAL_NFCV_REQ_FLAG_DEFAULT, ctx->dev->dev.nfcv.InvRes.UID, (uint8_t)(ctx->len / ctx->blockLen), (uint8_t)(n - 1U),
+                                                    dst, (uint16_t)(NDEF_READ_T5T_FLAGS_LEN + (n * ctx->blockLen) + RFAL_CRC_LEN), &rcvLen );
+        }
+        ndefReadCmd( ctx, t0, NDEF_READ_T5T_TX_LEN, rcvLen );
+        *dst = save;
+
+        if( ret != RFAL_ERR_NONE )
+        {
+            return ret;
+        }
+        if( rcvLen != (NDEF_READ_T5T_FLAGS_LEN + (n * ctx->blockLen)) )
+        {
+            return RFAL_ERR_REQUEST;                                                  /* Not the block size expected */
+        }
+        ctx->len = (uint16_t)(ctx->len + (n * ctx->blockLen));
+    }
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadT5tFirst( ndefReadImg *ctx, uint16_t bufLen )
+{
+    uint16_t   rcvLen;
+    uint32_t   t0;
+    ReturnCode ret;
+
+    /* Block 0: CC and block size */
+    rcvLen = 0;
+    t0     = platformGetSysTickUs();
+    ret    = rfalNfcvPollerReadSingleBlock( RFAL_NFCV_REQ_FLAG_DEFAULT, ctx->dev->dev.nfcv.InvRes.UID, 0, &ctx->img[-1],
+                                            (uint16_t)RFAL_MIN( bufLen, (NDEF_READ_T5T_FLAGS_LEN + RFAL_NFCV_MAX_BLOCK_LEN + RFAL_CRC_LEN) ), &rcvLen );
+    ndefReadCmd( ctx, t0, NDEF_READ_T5T_TX_LEN, rcvLen );
+    if( ret != RFAL_ERR_NONE )
+    {
+        return ret;
+    }
+
+    if( (rcvLen <= NDEF_READ_T5T_FLAGS_LEN) || ((rcvLen - NDEF_READ_T5T_FLAGS_LEN) > ctx->cap) )
+    {
+        return RFAL_ERR_PROTO;
+    }
+    ctx->blockLen = (uint8_t)(rcvLen - NDEF_READ_T5T_FLAGS_LEN);
+    ctx->len      = ctx->blockLen;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadMore( ndefReadImg *ctx, uint16_t target )
+{
+    return ((ctx->type == NDEF_READ_TYPE_T2T) ? ndefReadT2tMore( ctx, target ) : ndefReadT5tMore( ctx, target ));
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadParseCc( ndefReadImg *ctx, uint16_t *need )
+{
+    const uint8_t *cc;
+    uint32_t       areaEnd;
+    uint32_t       imgMax;
+
+    cc    = ctx->img;
+    *need = ((ctx->type == NDEF_READ_TYPE_T2T) ? NDEF_READ_T2T_CC_LEN : NDEF_READ_T5T_CC_LEN);
+    if( ctx->len < *need )
+    {
+        return RFAL_ERR_NONE;
+    }
+
+    if( ctx->type == NDEF_READ_TYPE_T2T )
+    {
+        /* Magic, major version 1, read access granted */
+        if( (cc[0] != NDEF_READ_T2T_CC_MAGIC) || ((cc[1] >> 4) != NDEF_READ_CC_VERSION_1) || ((cc[3] >> 4) != 0U) )
+        {
+            return RFAL_ERR_REQUEST;
+        }
+        ctx->ccLen = NDEF_READ_T2T_CC_LEN;
+        areaEnd    = (NDEF_READ_T2T_CC_LEN + ((uint32_t)cc[2] * NDEF_READ_AREA_UNIT));
+        imgMax     = NDEF_READ_T2T_IMG_MAX;
+    }
+    else
+    {
+        /* Magic, major version 1, read access granted, MLEN in byte 2 or bytes 6..7 */
+        if( ((cc[0] != NDEF_READ_T5T_CC_MAGIC_1) && (cc[0] != NDEF_READ_T5T_CC_MAGIC_2)) || ((cc[1] >> 6) != NDEF_READ_CC_VERSION_1) || (((cc[1] >> 2) & 0x03U) != 0U) )
+        {
+            return RFAL_ERR_REQUEST;
+        }
+        if( cc[2] != 0U )
+        {
+            ctx->ccLen = NDEF_READ_T5T_CC_LEN;
+            areaEnd    = (NDEF_READ_T5T_CC_LEN + ((uint32_t)cc[2] * NDEF_READ_AREA_UNIT));
+        }
+        else
+        {
+            *need = NDEF_READ_T5T_CC_EXT_LEN;
+            if( ctx->len < *need )
+            {
+                return RFAL_ERR_NONE;
+            }
+            ctx->ccLen = NDEF_READ_T5T_CC_EXT_LEN;
+            areaEnd    = (NDEF_READ_T5T_CC_EXT_LEN + ((((uint32_t)cc[6] << 8) | cc[7]) * NDEF_READ_AREA_UNIT));
+        }
+        ctx->multi = ((cc[3] & NDEF_READ_T5T_CC_MBREAD) != 0U);
+        imgMax     = (NDEF_READ_T5T_BLOCKS_MAX * ctx->blockLen);
+    }
+
+    ctx->areaEnd = (uint16_t)RFAL_MIN( areaEnd, imgMax );
+    *need        = ctx->ccLen;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadParse( ndefReadImg *ctx, uint16_t *need, uint16_t *msgOff, uint16_t *msgLen )
+{
+    const uint8_t *img;
+    uint32_t       pos;
+    uint32_t       len;
+    uint8_t        hdr;
+    ReturnCode     ret;
+
+    *msgOff = 0;
+    ret     = ndefReadParseCc( ctx, need );
+    if( (ret != RFAL_ERR_NONE) || (*need > ctx->len) )
+    {
+        return ret;
+    }
+
+    /* TLVs up to the NDEF one: NULL skipped, Lock / Memory Control / proprietary ones by their length */
+    img = ctx->img;
+    for( pos = ctx->ccLen; pos < ctx->areaEnd; pos += (hdr + len) )
+    {
+        *need = (uint16_t)(pos + 1U);
+        if( *need > ctx->len )
+        {
+            return RFAL_ERR_NONE;
+        }
+        if( img[pos] == NDEF_READ_TLV_NULL )
+        {
+            hdr = 1U;
+            len = 0U;
+            continue;
+        }
+        if( img[pos] == NDEF_READ_TLV_TERMINATOR )
+        {
+            break;
+        }
+
+        *need = (uint16_t)(pos + 2U);
+        if( *need > ctx->len )
+        {
+            return RFAL_ERR_NONE;
+        }
+        hdr = 2U;
+        len = img[pos + 1U];
+        if( len == NDEF_READ_TLV_LEN_3 )
+        {
+            *need = (uint16_t)(pos + 4U);
+            if( *need > ctx->len )
+            {
+                return RFAL_ERR_NONE;
+            }
+            hdr = 4U;
+            len = (((uint32_t)img[pos + 2U] << 8) | img[pos + 3U]);
+        }
+
+        if( img[pos] == NDEF_READ_TLV_NDEF )
+        {
+            if( (pos + hdr + len) > ctx->areaEnd )
+            {
+                return RFAL_ERR_REQUEST;                                              /* Message beyond the data area */
+            }
+            *msgOff = (uint16_t)(pos + hdr);
+            *msgLen = (uint16_t)len;
+            *need   = (uint16_t)(pos + hdr + len);
+            return RFAL_ERR_NONE;
+        }
+    }
+    return RFAL_ERR_NOTFOUND;
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadImage( const rfalNfcDevice *dev, ndefReadType type, ndefReadTag *tag, bool cached, uint8_t *buf, uint16_t bufLen, ndefReadMsg *msg, ndefReadStats *stats )
+{
+    ndefReadImg ctx;
+    uint16_t    need;
+    uint16_t    msgOff;
+    uint16_t    msgLen;
+    uint16_t    prevLen;
+    ReturnCode  ret;
+
+    RFAL_MEMSET( &ctx, 0x00, sizeof(ctx) );
+    ctx.dev   = dev;
+    ctx.type  = type;
+    ctx.stats = stats;
+    ctx.multi = ((tag != NULL) ? tag->layout.multi : true);
+    msgOff    = 0;
+    msgLen    = 0;
+
+    if( type == NDEF_READ_TYPE_T2T )
+    {
+        ctx.img = buf;
+        ctx.cap = (uint16_t)(RFAL_MIN( bufLen, NDEF_READ_T2T_IMG_MAX ) & ~(RFAL_T2T_BLOCK_LEN - 1U));
+        ret     = ndefReadT2tMore( &ctx, (cached ? tag->layout.imgLen : RFAL_T2T_READ_DATA_LEN) );
+    }
+    else
+    {
+        /* One byte ahead of the image for the response flags, two behind it for the CRC */
+        if( bufLen <= (NDEF_READ_T5T_FLAGS_LEN + RFAL_CRC_LEN) )
+        {
+            return RFAL_ERR_NOMEM;
+        }
+        ctx.img = &buf[NDEF_READ_T5T_FLAGS_LEN];
+        ctx.cap = (uint16_t)(bufLen - NDEF_READ_T5T_FLAGS_LEN - RFAL_CRC_LEN);
+        if( cached )
+        {
+            ctx.blockLen = tag->layout.blockLen;
+            ctx.cap      = (uint16_t)(ctx.cap - (ctx.cap % ctx.blockLen));
+            ret          = ndefReadT5tMore( &ctx, tag->layout.imgLen );
+        }
+        else
+        {
+            ret = ndefReadT5tFirst( &ctx, bufLen );
+            if( ret == RFAL_ERR_NONE )
+            {
+                ctx.cap = (uint16_t)(ctx.cap - (ctx.cap % ctx.blockLen));
+            }
+        }
+    }
+
+    /* Parse what was read, read on as far as it takes */
+    while( ret == RFAL_ERR_NONE )
+    {
+        ret = ndefReadParse( &ctx, &need, &msgOff, &msgLen );
+        if( (ret != RFAL_ERR_NONE) || (need <= ctx.len) )
+        {
+            break;
+        }
+        prevLen = ctx.len;
+        ret     = ndefReadMore( &ctx, need );
+        if( (ret == RFAL_ERR_NONE) && (ctx.len == prevLen) )
+        {
+            ret = RFAL_ERR_NOMEM;                                                     /* Buffer full */
+        }
+    }
+
+    if( (tag != NULL) && ctx.fastFailed )
+    {
+        tag->layout.multi = false;                                                    /* No FAST_READ: READs next time */
+    }
+    if( ((ret == RFAL_ERR_NONE) || (ret == RFAL_ERR_NOMEM)) && (msgOff != 0U) )
+    {
+        msg->msg    = &ctx.img[msgOff];
+        msg->msgLen = (uint16_t)((ctx.len > msgOff) ? RFAL_MIN( msgLen, (uint16_t)(ctx.len - msgOff) ) : 0U);
+        msg->nlen   = msgLen;
+        if( tag != NULL )
+        {
+            tag->known           = true;
+            tag->layout.imgLen   = (uint16_t)RFAL_MIN( (msgOff + msgLen), ctx.cap );
+            tag->layout.blockLen = ctx.blockLen;
+            tag->layout.multi    = (ctx.multi && !ctx.fastFailed);
+        }
+    }
+    return ret;
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadT4t( const rfalNfcDevice *dev, ndefReadTag *tag, bool cached, uint8_t *buf, uint16_t bufLen, ndefReadMsg *msg, ndefReadStats *stats )
+{
+    t4tReadInfo  info;
+    t4tReadStats t4tStats;
+    uint16_t     msgLen;
+    ReturnCode   ret;
+
+    if( cached )
+    {
+        info = tag->layout.t4t;
+    }
+    RFAL_MEMSET( &t4tStats, 0x00, sizeof(t4tStats) );
+    ret = t4tReadNdef( &dev->proto.isoDep, buf, bufLen, &msgLen, &info, cached, &t4tStats );
+
+    stats->cmds   += t4tStats.apdus;
+    stats->bytes  += t4tStats.bytes;
+    stats->timeUs += t4tStats.timeUs;
+    if( ret != RFAL_ERR_NONE )
+    {
+        return ret;
+    }
+
+    msg->msgLen = msgLen;
+    msg->nlen   = info.nlen;
+    if( tag != NULL )
+    {
+        tag->known      = true;
+        tag->layout.t4t = info;
+    }
+    return ((info.nlen > msgLen) ? RFAL_ERR_NOMEM : RFAL_ERR_NONE);
+}
+
+
+/*******************************************************************************/
+static ReturnCode ndefReadOnce( const rfalNfcDevice *dev, ndefReadType type, ndefReadTag *tag, bool cached, uint8_t *buf, uint16_t bufLen, ndefReadMsg *msg, ndefReadStats *stats )
+{
+    msg->msg    = buf;
+    msg->msgLen = 0;
+    msg->nlen   = 0;
+
+    if( type == NDEF_READ_TYPE_T4T )
+    {
+        return ndefReadT4t( dev, tag, cached, buf, bufLen, msg, stats );
+    }
+    return ndefReadImage( dev, type, tag, cached, buf, bufLen, msg, stats );
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void ndefReadInit( void )
+{
+    memset( &gNr, 0x00, sizeof(gNr) );
+}
+
+
+/*******************************************************************************/
+ReturnCode ndefRead( const rfalNfcDevice *dev, uint8_t *buf, uint16_t bufLen, ndefReadMsg *msg, ndefReadStats *stats )
+{
+    ndefReadTag  *tag;
+    ndefReadType  type;
+    ndefReadCcSrc src;
+    uint8_t       mfr;
+    ReturnCode    ret;
+
+    RFAL_MEMSET( msg, 0x00, sizeof(ndefReadMsg) );
+    type      = ndefReadTypeOf( dev, &mfr );
+    msg->type = type;
+    if( type == NDEF_READ_TYPE_NONE )
+    {
+        return RFAL_ERR_NOTSUPP;
+    }
+
+    gNr.cnt.reads++;
+    tag = ndefReadFind( dev, type, mfr, &src );
+    gNr.cnt.tagHits   += ((src == NDEF_READ_CC_TAG) ? 1U : 0U);
+    gNr.cnt.modelHits += ((src == NDEF_READ_CC_MODEL) ? 1U : 0U);
+    gNr.cnt.misses    += ((src == NDEF_READ_CC_READ) ? 1U : 0U);
+
+    ret = ndefReadOnce( dev, type, tag, (src != NDEF_READ_CC_READ), buf, bufLen, msg, stats );
+
+    /* The tag does not match the cached layout: forget it, read the CC */
+    if( (src != NDEF_READ_CC_READ) && ((ret == RFAL_ERR_REQUEST) || (ret == RFAL_ERR_NOTSUPP)) )
+    {
+        gNr.cnt.stale++;
+        tag->known         = false;
+        tag->layout.imgLen = 0;
+        tag->layout.multi  = (ret != RFAL_ERR_NOTSUPP);
+        src                = NDEF_READ_CC_READ;
+        ret                = ndefReadOnce( dev, type, tag, false, buf, bufLen, msg, stats );
+    }
+
+    msg->ccSrc         = src;
+    gNr.cnt.failures  += (((ret != RFAL_ERR_NONE) && (ret != RFAL_ERR_NOTFOUND)) ? 1U : 0U);
+    return ret;
+}
+
+
+/*******************************************************************************/
+ReturnCode ndefReadRecordNext( const uint8_t *msg, uint16_t msgLen, uint16_t *pos, ndefReadRecord *rec )
+{
+    uint32_t p;
+    uint32_t rest;
+
+    p = *pos;
+    if( p >= msgLen )
+    {
+        return RFAL_ERR_NOTFOUND;
+    }
+
+    /* Header, TYPE LENGTH, PAYLOAD LENGTH (1 or 4 bytes), ID LENGTH */
+    rec->header = msg[p++];
+    rec->tnf    = (uint8_t)(rec->header & NDEF_READ_REC_TNF_MASK);
+    if( (p + 1U + (((rec->header & NDEF_READ_REC_SR) != 0U) ? 1U : 4U) + (((rec->header & NDEF_READ_REC_IL) != 0U) ? 1U : 0U)) > msgLen )
+    {
+        return RFAL_ERR_PROTO;
+    }
+    rec->typeLen = msg[p++];
+    if( (rec->header & NDEF_READ_REC_SR) != 0U )
+    {
+        rec->payloadLen = msg[p++];
+    }
+    else
+    {
+        rec->payloadLen = (((uint32_t)msg[p] << 24) | ((uint32_t)msg[p + 1U] << 16) | ((uint32_t)msg[p + 2U] << 8) | msg[p + 3U]);
+        p              += 4U;
+    }
+    rec->idLen = (((rec->header & NDEF_READ_REC_IL) != 0U) ? msg[p++] : 0U);
+
+    /* TYPE, ID and PAYLOAD within the message */
+    rest = (msgLen - p);
+    if( (((uint32_t)rec->typeLen + rec->idLen) > rest) || (rec->payloadLen > (rest - rec->typeLen - rec->idLen)) )
+    {
+        return RFAL_ERR_PROTO;
+    }
+    rec->type    = &msg[p];
+    p           += rec->typeLen;
+    rec->id      = ((rec->idLen != 0U) ? &msg[p] : NULL);
+    p           += rec->idLen;
+    rec->payload = &msg[p];
+    p           += rec->payloadLen;
+
+    *pos = (uint16_t)p;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void ndefReadGetCounters( ndefReadCounters *cnt )
+{
+    uint8_t i;
+
+    *cnt      = gNr.cnt;
+    cnt->tags = 0;
+    for( i = 0; i < NDEF_READ_CACHE; i++ )
+    {
+        cnt->tags += ((gNr.tags[i].uidLen != 0U) ? 1U : 0U);
+    }
+}
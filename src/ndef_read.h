@@ -0,0 +1,207 @@
+/*! \file ndef_read.h
+ *
+ *  \brief NDEF message read of Type 2, 4 and 5 Tags with CC caching
+ *
+ *  Reads the NDEF message of an activated tag, the tag type taken from its
+ *  activation (NFC-A T2T, ISO-DEP, NFC-V), with as few commands as the tag
+ *  type allows:
+ *   - T2T: READ of page 3 (CC and the first 12 data bytes), TLVs walked up
+ *     to the NDEF one, the rest of the message with one FAST_READ (NTAG21x)
+ *     or 16 byte READs for a tag without it: a tag that NACKs FAST_READ (or
+ *     does not answer it) is selected again and read on with READs in the
+ *     same call
+ *   - T4T: t4tReadNdef(), READ BINARY as large as the CC allows
+ *   - T5T: READ SINGLE BLOCK of block 0 (CC, block size), the TLVs and the
+ *     message with READ MULTIPLE BLOCKS of up to NDEF_READ_T5T_BLOCKS blocks
+ *     (MBREAD in the CC) or READ SINGLE BLOCKs
+ *
+ *  The T2T and T5T memory is read straight into the caller's buffer (from
+ *  the CC on), the message returned points into it: no copy is made, and
+ *  ndefReadRecordNext() walks its records the same way.
+ *
+ *  What a read learns is kept per tag (UID) in a cache of NDEF_READ_CACHE
+ *  entries per reader, the least recently read one replaced: the CC and
+ *  commands the tag takes, and how much of its memory the message used.
+ *  The next read of the tag skips the CC discovery: a T2T or T5T is read
+ *  from the CC to the end of the message in a single command, the CC
+ *  checked on the way, a T4T is read without the CC file (see t4tReadNdef()).
+ *  A tag not in the cache takes the layout of the last tag read of the same
+ *  model (tag type and IC manufacturer), tags of one model share it. A
+ *  cached layout the tag does not match (e.g. REQUEST status word, block
+ *  size) is dropped and the tag read again from scratch at once.
+ *
+ *  Only the first sector of a T2T (1 KB) is read, lock and reserved areas
+ *  inside the data area (Lock / Memory Control TLVs) are not skipped.
+ *
+ */
+
+#ifndef NDEF_READ_H
+#define NDEF_READ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rfal_core/rfal_nfc.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#ifndef NDEF_READ_CACHE
+#define NDEF_READ_CACHE             8U      /*!< Tags whose layout is kept                      */
+#endif
+
+#ifndef NDEF_READ_T5T_BLOCKS
+#define NDEF_READ_T5T_BLOCKS        32U     /*!< Blocks per READ MULTIPLE BLOCKS                */
+#endif
+
+#define NDEF_READ_UID_MAX           10U     /*!< Longest UID (NFC-A triple size)                */
+#define NDEF_READ_IMG_OVERHEAD      32U     /*!< CC, TLVs ahead of the NDEF one, response slack */
+
+/*! Buffer for a T2T / T5T message of up to len bytes along with the memory ahead of it */
+#define NDEF_READ_BUF_LEN( len )    ((uint32_t)(len) + NDEF_READ_IMG_OVERHEAD)
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Tag types */
+typedef enum
+{
+    NDEF_READ_TYPE_NONE = 0,                /*!< No NDEF tag                                    */
+    NDEF_READ_TYPE_T2T  = 1,                /*!< NFC-A Type 2 Tag                               */
+    NDEF_READ_TYPE_T4T  = 2,                /*!< ISO-DEP Type 4 Tag                             */
+    NDEF_READ_TYPE_T5T  = 3,                /*!< NFC-V Type 5 Tag                               */
+    NDEF_READ_TYPES     = 4
+} ndefReadType;
+
+/*! Where the layout of a read came from */
+typedef enum
+{
+    NDEF_READ_CC_READ   = 0,                /*!< CC read from the tag                           */
+    NDEF_READ_CC_TAG    = 1,                /*!< Cached for this tag                            */
+    NDEF_READ_CC_MODEL  = 2                 /*!< Cached for another tag of the same model       */
+} ndefReadCcSrc;
+
+/*! NDEF message read */
+typedef struct
+{
+    ndefReadType   type;                    /*!< Tag type                                       */
+    ndefReadCcSrc  ccSrc;                   /*!< Layout used                                    */
+    const uint8_t *msg;                     /*!< Message, inside the buffer given               */
+    uint16_t       msgLen;                  /*!< Message bytes read                             */
+    uint16_t       nlen;                    /*!< Message length, above msgLen if it did not fit */
+} ndefReadMsg;
+
+/*! NDEF record, pointing into the message */
+typedef struct
+{
+    uint8_t        header;                  /*!< MB, ME, CF, SR, IL and TNF                     */
+    uint8_t        tnf;                     /*!< Type Name Format                               */
+    const uint8_t *type;
+    uint8_t        typeLen;
+    const uint8_t *id;                      /*!< NULL if none                                   */
+    uint8_t        idLen;
+    const uint8_t *payload;
+    uint32_t       payloadLen;
+} ndefReadRecord;
+
+/*! Cost of a read */
+typedef struct
+{
+    uint32_t cmds;                          /*!< Commands (APDUs) exchanged                     */
+    uint32_t bytes;                         /*!< Command and response bytes                     */
+    uint32_t timeUs;                        /*!< Exchange time                                  */
+} ndefReadStats;
+
+/*! Read counters of a reader */
+typedef struct
+{
+    uint32_t reads;                         /*!< Reads of an NDEF tag                           */
+    uint32_t tagHits;                       /*!< Reads with the layout cached for the tag       */
+    uint32_t modelHits;                     /*!< Reads with the layout of another tag           */
+    uint32_t misses;                        /*!< Reads discovering the CC                       */
+    uint32_t stale;                         /*!< Cached layouts dropped, tag read again         */
+    uint32_t failures;                      /*!< Reads ended by an error                        */
+    uint32_t tags;                          /*!< Tags in the cache                              */
+} ndefReadCounters;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Initializes the cache and counters of the calling task's reader
+ *****************************************************************************
+ */
+void ndefReadInit( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Reads the NDEF message of an activated tag
+ *
+ * \param[in]   dev    : activated device
+ * \param[out]  buf    : T2T / T5T memory image, T4T message, the message
+ *                       returned points into it; NDEF_READ_BUF_LEN() for a
+ *                       T2T / T5T message of a given length
+ * \param[in]   bufLen : buf size
+ * \param[out]  msg    : message read
+ * \param[out]  stats  : commands, bytes and time, added to
+ *
+ * \return RFAL_ERR_NONE     : message read, possibly empty
+ * \return RFAL_ERR_NOTSUPP  : not a T2T, T4T or T5T
+ * \return RFAL_ERR_NOTFOUND : no NDEF message (T4T: no NDEF application)
+ * \return RFAL_ERR_REQUEST  : invalid CC or TLVs, error status word
+ * \return RFAL_ERR_NOMEM    : message larger than buf, msg holds what fit;
+ *                             or APDU pool exhausted (T4T)
+ * \return any other         : transmission error
+ *****************************************************************************
+ */
+ReturnCode ndefRead( const rfalNfcDevice *dev, uint8_t *buf, uint16_t bufLen, ndefReadMsg *msg, ndefReadStats *stats );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the next record of a message
+ *
+ * \param[in]      msg    : message
+ * \param[in]      msgLen : message length
+ * \param[in,out]  pos    : offset of the record, 0 for the first one;
+ *                          set to the following one
+ * \param[out]     rec    : record, pointing into msg
+ *
+ * \return RFAL_ERR_NONE     : record found
+ * \return RFAL_ERR_NOTFOUND : no more records
+ * \return RFAL_ERR_PROTO    : record malformed or cut off
+ *****************************************************************************
+ */
+ReturnCode ndefReadRecordNext( const uint8_t *msg, uint16_t msgLen, uint16_t *pos, ndefReadRecord *rec );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the read counters of the calling task's reader
+ *
+ * \param[out]  cnt : counters
+ *****************************************************************************
+ */
+void ndefReadGetCounters( ndefReadCounters *cnt );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NDEF_READ_H */
@@ -63,6 +63,14 @@
 
 #define RFAL_TEST_REG         0x0080U      /*!< Test Register indicator  */    
 
+#ifndef RFAL_ANALOG_CONFIG_IDX_SIZE
+    #define RFAL_ANALOG_CONFIG_IDX_SIZE        64U     /*!< Configuration IDs resolved in the index, power of 2       */
+#endif /* RFAL_ANALOG_CONFIG_IDX_SIZE */
+
+#define RFAL_ANALOG_CONFIG_IDX_SETS            4U      /*!< Max Configuration sets matching an indexed Configuration ID */
+#define RFAL_ANALOG_CONFIG_IDX_FREE            0xFFU   /*!< Index entry not used                                        */
+#define RFAL_ANALOG_CONFIG_IDX_SEARCH          0xFEU   /*!< Index entry of a Configuration ID left to the LUT search    */
+
 /*
  ******************************************************************************
  * MACROS
@@ -89,6 +97,18 @@ typedef struct {
 
 static rfalAnalogConfigMgmt   gRfalAnalogConfigMgmt;  /*!< Analog Configuration LUT management */
 
+
+/*! Index entry: a Configuration ID resolved to the Configuration sets it matches in the LUT */
+typedef struct {
+    rfalAnalogConfigId  id;                                   /*!< Configuration ID                              */
+    uint8_t             cnt;                                  /*!< Configuration sets found, or RFAL_ANALOG_CONFIG_IDX_FREE */
+    rfalAnalogConfigNum num[RFAL_ANALOG_CONFIG_IDX_SETS];     /*!< Number of Register-Mask-Value of each set     */
+    uint16_t            offset[RFAL_ANALOG_CONFIG_IDX_SETS];  /*!< Offset of the Register-Mask-Value of each set */
+} rfalAnalogConfigIdxEntry;
+
+static rfalAnalogConfigIdxEntry gRfalAnalogConfigIdx[RFAL_ANALOG_CONFIG_IDX_SIZE]; /*!< Analog Configuration LUT index                */
+static bool                     gRfalAnalogConfigIdxComplete;                      /*!< Every Configuration ID matching a set indexed */
+
 /*
  ******************************************************************************
  * LOCAL TABLES
@@ -101,6 +121,10 @@ static rfalAnalogConfigMgmt   gRfalAnalogConfigMgmt;  /*!< Analog Configuration
  ******************************************************************************
  */
 static rfalAnalogConfigNum rfalAnalogConfigSearch( rfalAnalogConfigId configId, uint16_t *configOffset );
+static void rfalAnalogConfigIdxBuild( void );
+static bool rfalAnalogConfigIdxAdd( rfalAnalogConfigId configId );
+static const rfalAnalogConfigIdxEntry* rfalAnalogConfigIdxGet( rfalAnalogConfigId configId );
+static ReturnCode rfalAnalogConfigApply( const rfalAnalogConfigRegAddrMaskVal *configTbl, rfalAnalogConfigNum numConfigSet );
 
 #if RFAL_FEATURE_DYNAMIC_ANALOG_CONFIG
     static void rfalAnalogConfigPtrUpdate( const uint8_t* analogConfigTbl );
@@ -131,6 +155,7 @@ void rfalAnalogConfigInitialize( void )
     gRfalAnalogConfigMgmt.configTblSize          = sizeof(rfalAnalogConfigDefaultSettings);
 #endif
   
+  rfalAnalogConfigIdxBuild();
   gRfalAnalogConfigMgmt.ready = true;
 } /* rfalAnalogConfigInitialize() */
 
@@ -187,7 +212,7 @@ ReturnCode rfalAnalogConfigListWrite( uint8_t more, const rfalAnalogConfig *conf
     if (true == gRfalAnalogConfigMgmt.ready)
     {   /* First Update to the Configuration list. */
         gRfalAnalogConfigMgmt.ready = false;   // invalidate the config List
-        gRfalAnalogConfigMgmt.configTblSize = 0; // Clear the config List
+        gRfalAnalogConfigMgmt.configTblSize = 0; // Clear the config List, the index is rebuilt once it is complete
     }
 
     configId = RFAL_GETU16(config->id);
@@ -298,16 +323,34 @@ ReturnCode rfalSetAnalogConfig( rfalAnalogConfigId configId )
     rfalAnalogConfigOffset configOffset = 0;
     rfalAnalogConfigNum numConfigSet;
     const rfalAnalogConfigRegAddrMaskVal *configTbl;
+    const rfalAnalogConfigIdxEntry *idx;
     ReturnCode retCode = RFAL_ERR_NONE;
-    rfalAnalogConfigNum i;
+    uint8_t i;
     
     if (true != gRfalAnalogConfigMgmt.ready)
     {
         return RFAL_ERR_REQUEST;
     }
     
+    /* Collect the register writes so that they reach the chip with a minimum of bus transactions */
+    rfalChipRegBatchStart();
+    
+    /* Configuration ID already resolved: no LUT search */
+    idx = rfalAnalogConfigIdxGet( configId );
+    if( idx != NULL )
+    {
+        for( i = 0; (i < idx->cnt) && (RFAL_ERR_NONE == retCode); i++ )
+        {
+            configTbl = (const rfalAnalogConfigRegAddrMaskVal *)( (uintptr_t)gRfalAnalogConfigMgmt.currentAnalogConfigTbl + (uint32_t)idx->offset[i] );
+            retCode   = rfalAnalogConfigApply( configTbl, idx->num[i] );
+        }
+        
+        rfalChipRegBatchEnd();
+        return retCode;
+    }
+    
     /* Search LUT for the specific Configuration ID. */
-    while(true)
+    while( RFAL_ERR_NONE == retCode )
     {
         numConfigSet = rfalAnalogConfigSearch(configId, &configOffset);
         if( RFAL_ANALOG_CONFIG_LUT_NOT_FOUND == numConfigSet )
@@ -321,23 +364,17 @@ ReturnCode rfalSetAnalogConfig( rfalAnalogConfigId configId )
         
         if ((gRfalAnalogConfigMgmt.configTblSize + 1U) < configOffset)
         {   /* Error check make sure that the we do not access outside the configuration Table Size */
-            return RFAL_ERR_NOMEM;
+            retCode = RFAL_ERR_NOMEM;
+            break;
         }
         
-        for ( i = 0; i < numConfigSet; i++)
-        {
-            if( (RFAL_GETU16(configTbl[i].addr) & RFAL_TEST_REG) != 0U )
-            {
-                RFAL_EXIT_ON_ERR(retCode, rfalChipChangeTestRegBits( (RFAL_GETU16(configTbl[i].addr) & ~RFAL_TEST_REG), configTbl[i].mask, configTbl[i].val) );
-            }
-            else
-            {
-                RFAL_EXIT_ON_ERR(retCode, rfalChipChangeRegBits( RFAL_GETU16(configTbl[i].addr), configTbl[i].mask, configTbl[i].val) );
-            }
-        }
+        retCode = rfalAnalogConfigApply( configTbl, numConfigSet );
         
     } /* while(found Analog Config Id) */
     
+    /* Send the collected writes, also on error so that no write is left pending */
+    rfalChipRegBatchEnd();
+    
     return retCode;
     
 } /* rfalSetAnalogConfig() */
@@ -418,6 +455,7 @@ static void rfalAnalogConfigPtrUpdate( const uint8_t* analogConfigTbl )
 {
 
     gRfalAnalogConfigMgmt.currentAnalogConfigTbl = analogConfigTbl;
+    rfalAnalogConfigIdxBuild();
     gRfalAnalogConfigMgmt.ready = true;
     
 } /* rfalAnalogConfigPtrUpdate() */
@@ -478,3 +516,223 @@ static rfalAnalogConfigNum rfalAnalogConfigSearch( rfalAnalogConfigId configId,
     
     return RFAL_ANALOG_CONFIG_LUT_NOT_FOUND;
 } /* rfalAnalogConfigSearch() */
+
+
+/*! 
+ *****************************************************************************
+ * \brief  Build the Analog Configuration LUT index
+ *  
+ * To be called whenever the LUT changes, before it is marked ready. Every
+ * Configuration ID that matches a set of the LUT is resolved here: the
+ * ID of each set and, unless it is a Chip-Specific or DPO ID, each of the
+ * single Technology / Direction IDs it also matches (see 
+ * rfalAnalogConfigSearch()). 
+ * The index is only read afterwards: the LUT must not be changed while
+ * the readers use it.
+ *
+ *****************************************************************************
+ */
+static void rfalAnalogConfigIdxBuild( void )
+{
+    const uint8_t     *configTbl;
+    rfalAnalogConfigId foundConfigId;
+    rfalAnalogConfigId techs;
+    rfalAnalogConfigId dirs;
+    rfalAnalogConfigId tech;
+    rfalAnalogConfigId dir;
+    uint16_t           i;
+    uint8_t            j;
+    
+    for( j = 0; j < RFAL_ANALOG_CONFIG_IDX_SIZE; j++ )
+    {
+        gRfalAnalogConfigIdx[j].cnt = RFAL_ANALOG_CONFIG_IDX_FREE;
+    }
+    gRfalAnalogConfigIdxComplete = true;
+    
+    i = 0;
+    while( (i + sizeof(rfalAnalogConfigId) + sizeof(rfalAnalogConfigNum)) <= gRfalAnalogConfigMgmt.configTblSize )
+    {
+        configTbl     = &gRfalAnalogConfigMgmt.currentAnalogConfigTbl[i];
+        foundConfigId = RFAL_GETU16(configTbl);
+        
+        if( (RFAL_ANALOG_CONFIG_TECH_CHIP == RFAL_ANALOG_CONFIG_ID_GET_TECH(foundConfigId)) 
+            || (RFAL_ANALOG_CONFIG_DPO == RFAL_ANALOG_CONFIG_ID_GET_DIRECTION(foundConfigId)) )
+        {
+            gRfalAnalogConfigIdxComplete = (rfalAnalogConfigIdxAdd( foundConfigId ) && gRfalAnalogConfigIdxComplete);
+        }
+        else
+        {
+            /* A set also matches the IDs of each of its Technologies and Directions */
+            techs = (foundConfigId & RFAL_ANALOG_CONFIG_TECH_MASK);
+            for( tech = (techs & (rfalAnalogConfigId)(~techs + 1U)); tech != 0U; techs &= (rfalAnalogConfigId)~tech, tech = (techs & (rfalAnalogConfigId)(~techs + 1U)) )
+            {
+                dirs = (foundConfigId & RFAL_ANALOG_CONFIG_DIRECTION_MASK);
+                do
+                {
+                    dir  = (dirs & (rfalAnalogConfigId)(~dirs + 1U));
+                    dirs &= (rfalAnalogConfigId)~dir;
+                    
+                    gRfalAnalogConfigIdxComplete = (rfalAnalogConfigIdxAdd( (foundConfigId & (RFAL_ANALOG_CONFIG_POLL_LISTEN_MODE_MASK | RFAL_ANALOG_CONFIG_BITRATE_MASK)) | tech | dir ) 
+                                                    && gRfalAnalogConfigIdxComplete);
+                }
+                while( dirs != 0U );
+            }
+        }
+        
+        i += (uint16_t)( sizeof(rfalAnalogConfigId) + sizeof(rfalAnalogConfigNum) 
+                        + (configTbl[sizeof(rfalAnalogConfigId)] * sizeof(rfalAnalogConfigRegAddrMaskVal) )
+                        );
+    }
+} /* rfalAnalogConfigIdxBuild() */
+
+
+/*! 
+ *****************************************************************************
+ * \brief  Add a Configuration ID to the index
+ *  
+ * Resolves the Configuration ID with the LUT search, unless it is already
+ * indexed. A Configuration ID matching more than RFAL_ANALOG_CONFIG_IDX_SETS
+ * sets (or a truncated LUT) is indexed as left to the search.
+ * 
+ * \param[in]  configId: Configuration ID
+ * 
+ * \return false if the index is full
+ *****************************************************************************
+ */
+static bool rfalAnalogConfigIdxAdd( rfalAnalogConfigId configId )
+{
+    rfalAnalogConfigIdxEntry *entry;
+    rfalAnalogConfigOffset   configOffset;
+    rfalAnalogConfigNum      numConfigSet;
+    uint8_t                  slot;
+    uint8_t                  i;
+    
+    slot = (uint8_t)(((configId >> RFAL_ANALOG_CONFIG_TECH_SHIFT) ^ (configId >> 2U) ^ configId) & (RFAL_ANALOG_CONFIG_IDX_SIZE - 1U));
+    
+    for( i = 0; i < RFAL_ANALOG_CONFIG_IDX_SIZE; i++ )
+    {
+        entry = &gRfalAnalogConfigIdx[(slot + i) & (RFAL_ANALOG_CONFIG_IDX_SIZE - 1U)];
+        
+        if( entry->cnt == RFAL_ANALOG_CONFIG_IDX_FREE )
+        {
+            break;
+        }
+        
+        if( entry->id == configId )
+        {
+            return true;                                                 /* Already indexed */
+        }
+    }
+    
+    if( i >= RFAL_ANALOG_CONFIG_IDX_SIZE )
+    {
+        return false;                                                    /* Index full */
+    }
+    
+    /* Resolve the Configuration ID */
+    entry->id    = configId;
+    entry->cnt   = 0;
+    configOffset = 0;
+    
+    while( (numConfigSet = rfalAnalogConfigSearch( configId, &configOffset )) != RFAL_ANALOG_CONFIG_LUT_NOT_FOUND )
+    {
+        if( (entry->cnt >= RFAL_ANALOG_CONFIG_IDX_SETS) 
+            || ((configOffset + (numConfigSet * sizeof(rfalAnalogConfigRegAddrMaskVal))) > ((uint32_t)gRfalAnalogConfigMgmt.configTblSize + 1U)) )
+        {
+            entry->cnt = RFAL_ANALOG_CONFIG_IDX_SEARCH;                  /* Not indexable (or truncated LUT): leave it to the search */
+            return true;
+        }
+        
+        entry->offset[entry->cnt] = configOffset;
+        entry->num[entry->cnt]    = numConfigSet;
+        entry->cnt++;
+        
+        configOffset += (uint16_t)(numConfigSet * sizeof(rfalAnalogConfigRegAddrMaskVal));
+    }
+    
+    return true;
+} /* rfalAnalogConfigIdxAdd() */
+
+
+/*! 
+ *****************************************************************************
+ * \brief  Get the index entry of a Configuration ID
+ *  
+ * Looks the Configuration ID up in the index (open addressing), the index
+ * is not modified. A Chip-Specific or single Technology / Direction 
+ * Configuration ID not indexed matches no set, provided the whole LUT fit
+ * in the index.
+ * 
+ * \param[in]  configId: Configuration ID
+ * 
+ * \return the index entry
+ * \return NULL if the Configuration ID is left to the LUT search
+ *****************************************************************************
+ */
+static const rfalAnalogConfigIdxEntry* rfalAnalogConfigIdxGet( rfalAnalogConfigId configId )
+{
+    static const rfalAnalogConfigIdxEntry noSet;                         /* No Configuration set matching */
+    const rfalAnalogConfigIdxEntry *entry;
+    rfalAnalogConfigId             tech;
+    rfalAnalogConfigId             dir;
+    uint8_t                        slot;
+    uint8_t                        i;
+    
+    slot = (uint8_t)(((configId >> RFAL_ANALOG_CONFIG_TECH_SHIFT) ^ (configId >> 2U) ^ configId) & (RFAL_ANALOG_CONFIG_IDX_SIZE - 1U));
+    
+    for( i = 0; i < RFAL_ANALOG_CONFIG_IDX_SIZE; i++ )
+    {
+        entry = &gRfalAnalogConfigIdx[(slot + i) & (RFAL_ANALOG_CONFIG_IDX_SIZE - 1U)];
+        
+        if( entry->cnt == RFAL_ANALOG_CONFIG_IDX_FREE )
+        {
+            break;
+        }
+        
+        if( entry->id == configId )
+        {
+            return ((entry->cnt == RFAL_ANALOG_CONFIG_IDX_SEARCH) ? NULL : entry);
+        }
+    }
+    
+    /* Not indexed: only the IDs rfalAnalogConfigIdxBuild() enumerates are known to match nothing */
+    tech = (configId & RFAL_ANALOG_CONFIG_TECH_MASK);
+    dir  = (configId & RFAL_ANALOG_CONFIG_DIRECTION_MASK);
+    if( gRfalAnalogConfigIdxComplete && ((tech == RFAL_ANALOG_CONFIG_TECH_CHIP) || (((tech & (tech - 1U)) == 0U) && ((dir & (dir - 1U)) == 0U))) )
+    {
+        return &noSet;
+    }
+    
+    return NULL;
+} /* rfalAnalogConfigIdxGet() */
+
+
+/*! 
+ *****************************************************************************
+ * \brief  Apply a Configuration set
+ *  
+ * \param[in]  configTbl: Register-Mask-Value of the set
+ * \param[in]  numConfigSet: number of Register-Mask-Value
+ * 
+ * \return RFAL_ERR_NONE or the error of the register change
+ *****************************************************************************
+ */
+static ReturnCode rfalAnalogConfigApply( const rfalAnalogConfigRegAddrMaskVal *configTbl, rfalAnalogConfigNum numConfigSet )
+{
+    ReturnCode retCode = RFAL_ERR_NONE;
+    rfalAnalogConfigNum i;
+    
+    for ( i = 0; (i < numConfigSet) && (RFAL_ERR_NONE == retCode); i++)
+    {
+        if( (RFAL_GETU16(configTbl[i].addr) & RFAL_TEST_REG) != 0U )
+        {
+            retCode = rfalChipChangeTestRegBits( (RFAL_GETU16(configTbl[i].addr) & ~RFAL_TEST_REG), configTbl[i].mask, configTbl[i].val );
+        }
+        else
+        {
+            retCode = rfalChipChangeRegBits( RFAL_GETU16(configTbl[i].addr), configTbl[i].mask, configTbl[i].val );
+        }
+    }
+    
+    return retCode;
+} /* rfalAnalogConfigApply() */
@@ -122,7 +122,8 @@ typedef struct{
  ******************************************************************************
  */
 
-static rfalCdCtx gCd;
+static rfalCdCtx gCdInstances[RFAL_INSTANCES];
+#define gCd RFAL_INSTANCE(gCdInstances)
 
 
 /*
@@ -118,6 +118,30 @@ ReturnCode rfalChipReadReg( uint16_t reg, uint8_t* values, uint8_t len );
  */
 ReturnCode rfalChipChangeRegBits( uint16_t reg, uint8_t valueMask, uint8_t value );
 
+/*!
+ *****************************************************************************
+ * \brief Starts a register write batch on the RF Chip
+ *
+ * Until rfalChipRegBatchEnd() the register changes done with 
+ * rfalChipChangeRegBits() may be held back and sent together, with a 
+ * minimum number of bus transactions. Any other RF Chip access sends the 
+ * pending changes first, so the order of the accesses is kept.
+ * Batches are not nested.
+ *
+ *****************************************************************************
+ */
+void rfalChipRegBatchStart( void );
+
+/*!
+ *****************************************************************************
+ * \brief Ends a register write batch on the RF Chip
+ *
+ * Sends all the register changes held back since rfalChipRegBatchStart()
+ *
+ *****************************************************************************
+ */
+void rfalChipRegBatchEnd( void );
+
 /*!
  *****************************************************************************
  * \brief Writes a Test register on the RF Chip
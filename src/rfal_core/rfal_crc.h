@@ -42,6 +42,26 @@
 */
 #include "rfal_platform/rfal_platform.h"
 
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+
+#define RFAL_CRC_ENGINE_BITWISE     0U      /*!< Shift/xor per byte, no table                          */
+#define RFAL_CRC_ENGINE_TABLE       1U      /*!< 256 entry table per byte (512 bytes flash)            */
+#define RFAL_CRC_ENGINE_SLICE4      2U      /*!< Slicing-by-4 (+1.5 kB RAM)                            */
+#define RFAL_CRC_ENGINE_SLICE8      3U      /*!< Slicing-by-8 (+3.5 kB RAM)                            */
+#define RFAL_CRC_ENGINE_ROM         4U      /*!< ESP32 ROM routine esp_rom_crc16_le()                  */
+
+#ifndef RFAL_CRC_ENGINE
+    #define RFAL_CRC_ENGINE         RFAL_CRC_ENGINE_SLICE4   /*!< CRC engine used by rfalCrcCalculateCcitt() */
+#endif /* RFAL_CRC_ENGINE */
+
+#if ( RFAL_CRC_ENGINE == RFAL_CRC_ENGINE_ROM ) && !defined(ESP_PLATFORM)
+    #error "RFAL_CRC_ENGINE_ROM requires the ESP32 ROM"
+#endif
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -66,5 +86,26 @@
  */
 extern uint16_t rfalCrcCalculateCcitt(uint16_t preloadValue, const uint8_t* buf, uint16_t length);
 
+#ifdef RFAL_CRC_ALL_ENGINES
+/*! 
+ *****************************************************************************
+ *  \brief  Calculate CRC according to CCITT standard with a given engine.
+ *
+ *  Same as rfalCrcCalculateCcitt() but with the engine chosen at run time,
+ *  for comparisons and benchmarks. Only built with RFAL_CRC_ALL_ENGINES.
+ *  RFAL_CRC_ENGINE_ROM falls back to the bit-wise engine off the ESP32.
+ *
+ *  \param[in] engine : RFAL_CRC_ENGINE_*
+ *  \param[in] preloadValue : Initial value of CRC calculation.
+ *  \param[in] buf : buffer to calculate the CRC for.
+ *  \param[in] length : size of the buffer.
+ *
+ *  \return 16 bit long crc value.
+ *
+ *****************************************************************************
+ */
+extern uint16_t rfalCrcCalculateCcittEngine(uint8_t engine, uint16_t preloadValue, const uint8_t* buf, uint16_t length);
+#endif /* RFAL_CRC_ALL_ENGINES */
+
 #endif /* RFAL_CRC_H_ */
 
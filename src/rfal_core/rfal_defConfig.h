@@ -55,6 +55,14 @@
 ******************************************************************************
 */
 
+#ifndef RFAL_INSTANCES
+    #define RFAL_INSTANCES                          1U         /*!< Number of ST25R3911 driven by RFAL, each module keeps a context per instance */
+#endif /* RFAL_INSTANCES */
+
+#ifndef platformGetInstance
+    #define platformGetInstance()                   0U         /*!< Instance (0..RFAL_INSTANCES-1) the calling task works with                 */
+#endif /* platformGetInstance */
+
 
 /*
 ******************************************************************************
@@ -222,6 +230,14 @@
     #define platformUnprotectWorker()                  /*!< Unprotect RFAL Worker/Task/Process from concurrent execution on multi thread platforms */
 #endif /* platformUnprotectWorker */
 
+#ifndef platformIrqST25RSignal
+    #define platformIrqST25RSignal()                   /*!< Signals the waiters of platformIrqST25RWait() that new IRQs have been read               */
+#endif /* platformIrqST25RSignal */
+
+#ifndef platformIrqST25RWait
+    #define platformIrqST25RWait( timer )              /*!< Blocks until signaled or the given timer expires - returns at once (busy wait) if unsupported */
+#endif /* platformIrqST25RWait */
+
 #ifndef platformIrqST25RPinInitialize
     #define platformIrqST25RPinInitialize()            /*!< Initializes ST25R IRQ pin                     */
 #endif /* platformIrqST25RPinInitialize */                                                                
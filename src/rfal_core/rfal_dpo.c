@@ -63,6 +63,7 @@
  */
 #define RFAL_DPO_ANALOGCONFIG_SHIFT       13U
 #define RFAL_DPO_ANALOGCONFIG_MASK        0x6000U
+#define RFAL_DPO_ENTRIES_MAX              (RFAL_DPO_TABLE_SIZE_MAX / RFAL_DPO_TABLE_PARAMETER)
     
 /*
  ******************************************************************************
@@ -80,6 +81,7 @@ typedef struct{
     rfalDpoMeasureFunc  measureCallback;
     rfalMode            curMode;
     rfalBitRate         curBR;
+    rfalDpoStats        stats[RFAL_DPO_ENTRIES_MAX];
 }rfalDpo;
 
 
@@ -89,7 +91,8 @@ typedef struct{
  ******************************************************************************
  */
 
-static rfalDpo gRfalDpo;
+static rfalDpo gRfalDpoInstances[RFAL_INSTANCES];
+#define gRfalDpo RFAL_INSTANCE(gRfalDpoInstances)
 
 /*
  ******************************************************************************
@@ -103,6 +106,7 @@ void rfalDpoInitialize( void )
     gRfalDpo.tableEntry = 0;
     gRfalDpo.curMode    = RFAL_MODE_NONE;
     gRfalDpo.curBR      = RFAL_BR_KEEP;
+    RFAL_MEMSET( gRfalDpo.stats, 0x00, sizeof(gRfalDpo.stats) );
     
     
     /* Set default measurement */
@@ -159,7 +163,7 @@ ReturnCode rfalDpoTableWrite( rfalDpoEntry* powerTbl, uint8_t powerTblEntries )
     gRfalDpo.currentDpo   = gRfalDpo.table;
     gRfalDpo.tableEntries = powerTblEntries;
     
-    if( gRfalDpo.tableEntry > powerTblEntries )
+    if( gRfalDpo.tableEntry >= powerTblEntries )
     {
         /* Is always greater then zero, otherwise we already returned RFAL_ERR_PARAM */
         gRfalDpo.tableEntry = (powerTblEntries - 1); 
@@ -194,12 +198,17 @@ ReturnCode rfalDpoAdjust( void )
     rfalBitRate   br;
     rfalMode      mode;
     uint8_t       tableEntry;
+    uint8_t       step;
+    int8_t        dir;
+    ReturnCode    ret;
     rfalDpoEntry* dpoTable = (rfalDpoEntry*) gRfalDpo.currentDpo;    
     
     
     /* Initialize local vars */
     tableEntry = gRfalDpo.tableEntry;
     refValue   = 0;
+    dir        = 0;
+    ret        = RFAL_ERR_NONE;
     
     /* Obtain RFAL's current mode and bit rate */
     mode = rfalGetMode();
@@ -218,43 +227,56 @@ ReturnCode rfalDpoAdjust( void )
     {
         return RFAL_ERR_WRONG_STATE;
     }
-      
-    /* Ensure a proper measure reference value */
-    if( RFAL_ERR_NONE != gRfalDpo.measureCallback( &refValue ) )
-    {
-        return RFAL_ERR_IO;
-    }
-
     
-    if( refValue >= dpoTable[gRfalDpo.tableEntry].inc )
-    {   /* Increase the output power */
-        /* the top of the table represents the highest amplitude value*/
-        if( gRfalDpo.tableEntry == 0U )
+    /* Measure, step and measure again until the measurement is within the window of the entry */
+    for( step = 0; step < gRfalDpo.tableEntries; step++ )
+    {
+        /* Ensure a proper measure reference value */
+        if( RFAL_ERR_NONE != gRfalDpo.measureCallback( &refValue ) )
         {
-            /* Maximum driver value has been reached */
+            ret = RFAL_ERR_IO;
+            break;                                                                   /* Keep the steps already applied */
         }
-        else
-        {
+        
+        if( (refValue >= dpoTable[tableEntry].inc) && (tableEntry != 0U) )
+        {   /* Increase the output power */
+            /* the top of the table represents the highest amplitude value*/
+            if( dir < 0 )
+            {
+                break;                                                               /* Direction reversed: keep the lower power */
+            }
+            
             /* Go up in the table to decrease the driver resistance */
             tableEntry--;
+            dir = 1;
         }
-    }
-    else if(refValue <= dpoTable[gRfalDpo.tableEntry].dec)
-    {   /* Decrease the output power */
-        /* The bottom is the highest possible value */
-        if( (gRfalDpo.tableEntry + 1) >= gRfalDpo.tableEntries)
-        {
-            /* minimum driver value has been reached */
+        else if( (refValue <= dpoTable[tableEntry].dec) && ((tableEntry + 1U) < gRfalDpo.tableEntries) )
+        {   /* Decrease the output power */
+            /* The bottom is the highest possible value */
+            /* Go down in the table to increase the driver resistance */
+            tableEntry++;
+            
+            if( dir > 0 )
+            {
+                rfalChipSetRFO( dpoTable[tableEntry].rfoRes );
+                gRfalDpo.stats[tableEntry].steps++;
+                break;                                                               /* Direction reversed: back to the lower power */
+            }
+            dir = -1;
         }
         else
         {
-            /* Go down in the table to increase the driver resistance */
-            tableEntry++;
+            break;                                                                   /* Within the window or at the end of the table */
         }
+        
+        /* The next measurement must see the new driver resistance */
+        rfalChipSetRFO( dpoTable[tableEntry].rfoRes );
+        gRfalDpo.stats[tableEntry].steps++;
     }
-    else
+    
+    if( ret == RFAL_ERR_NONE )
     {
-        /* Fall through to evaluate whether to write dpo and its associated analog configs */
+        gRfalDpo.stats[tableEntry].adjusts++;
     }
     
     
@@ -267,7 +289,10 @@ ReturnCode rfalDpoAdjust( void )
         gRfalDpo.tableEntry = tableEntry;
         
         /* Get the new value for RFO resistance form the table and apply the new RFO resistance setting */ 
-        rfalChipSetRFO( dpoTable[gRfalDpo.tableEntry].rfoRes );
+        if( dir == 0 )
+        {
+            rfalChipSetRFO( dpoTable[gRfalDpo.tableEntry].rfoRes );                  /* Already applied by the steps otherwise */
+        }
         
         /* Apply the DPO Analog Config according to this treshold */
         /* Technology field is being extended for DPO: 2msb are used for treshold step (only 4 allowed) */
@@ -276,7 +301,7 @@ ReturnCode rfalDpoAdjust( void )
         rfalSetAnalogConfig( modeID );                                                                   /* Apply DPO Analog Config         */
     }
     
-    return RFAL_ERR_NONE;
+    return ret;
 }
 
 
@@ -308,4 +333,44 @@ bool rfalDpoIsEnabled( void )
     return gRfalDpo.enabled;
 }
 
+
+/*******************************************************************************/
+ReturnCode rfalDpoGetStats( uint8_t entry, rfalDpoStats *stats )
+{
+    if( (stats == NULL) || (entry >= gRfalDpo.tableEntries) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    *stats = gRfalDpo.stats[entry];
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void rfalDpoRxResult( ReturnCode status )
+{
+    if( !gRfalDpo.enabled || (gRfalDpo.tableEntry >= RFAL_DPO_ENTRIES_MAX) )
+    {
+        return;
+    }
+    
+    switch( status )
+    {
+        case RFAL_ERR_NONE:
+            gRfalDpo.stats[gRfalDpo.tableEntry].rxOk++;
+            break;
+            
+        case RFAL_ERR_CRC:
+        case RFAL_ERR_PAR:
+        case RFAL_ERR_FRAMING:
+            gRfalDpo.stats[gRfalDpo.tableEntry].rxErrors++;
+            break;
+            
+        default:
+            /* Timeouts, collisions, incomplete bytes: not a sign of the field strength */
+            break;
+    }
+}
+
 #endif /* RFAL_FEATURE_DPO */
@@ -81,6 +81,14 @@ typedef struct {
 /*! Function pointer to methode doing the reference measurement */
 typedef ReturnCode (*rfalDpoMeasureFunc)(uint8_t*);
 
+/*! DPO statistics of a table entry, the power level vs the reception error rate */
+typedef struct {
+    uint32_t adjusts;   /*!< rfalDpoAdjust() calls that settled on this entry                  */
+    uint32_t steps;     /*!< Steps taken into this entry                                        */
+    uint32_t rxOk;      /*!< Frames received without error while this entry was applied        */
+    uint32_t rxErrors;  /*!< Frames received with a CRC, parity or framing error (not timeouts) */
+}rfalDpoStats;
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -150,6 +158,13 @@ ReturnCode rfalDpoTableRead( rfalDpoEntry* tblBuf, uint8_t tblBufEntries, uint8_
  *  
  * It measures the current output and adjusts the power accordingly to 
  * the dynamic power table  
+ *
+ * The measurement is repeated after every step, so that the power converges
+ * to the entry whose [dec, inc] window holds the measurement within one call,
+ * at most one step per table entry. The windows of neighbouring entries must
+ * overlap: the overlap is the hysteresis that keeps a measurement close to a
+ * threshold from toggling between two entries. Should the measurements still
+ * reverse the direction, the lower power entry is kept.
  * 
  * \return RFAL_ERR_NONE        : No error
  * \return RFAL_ERR_PARAM       : if configTbl is invalid or parameters are invalid
@@ -204,6 +219,30 @@ void rfalDpoSetEnabled( bool enable );
  */
 bool rfalDpoIsEnabled(void);
 
+/*! 
+ *****************************************************************************
+ * \brief  Get the Dynamic power statistics of a table entry
+ *  
+ * \param[in]   entry : table entry
+ * \param[out]  stats : statistics since rfalDpoInitialize()
+ *
+ * \return RFAL_ERR_NONE    : No error
+ * \return RFAL_ERR_PARAM   : if the entry is not in the table or stats is NULL
+ *****************************************************************************
+ */
+ReturnCode rfalDpoGetStats( uint8_t entry, rfalDpoStats *stats );
+
+/*! 
+ *****************************************************************************
+ * \brief  Account a reception to the current table entry
+ *  
+ * Called by the RF chip driver at the end of every reception.
+ *
+ * \param[in]  status : reception result
+ *****************************************************************************
+ */
+void rfalDpoRxResult( ReturnCode status );
+
 #endif /* RFAL_DPO_H */
 
 /**
@@ -81,21 +81,129 @@
 
 #define ISO15693_PHY_BIT_BUFFER_SIZE 1000 /*!< size of the receiving buffer. Might be adjusted if longer datastreams are expected. */
 
+#define ISO15693_MAN_SOF_LEN          5U    /*!< Bits of the SOF before the first Manchester pair                  */
+#define ISO15693_MAN_NIBBLE_INVALID   0xFFU /*!< gIso15693ManNibble: a pair is neither 01 nor 10 (collision/EOF) */
+
+#define ISO15693_CODE_LEN_1_4         4U    /*!< Coded bytes per data byte in 1 of 4                               */
+#define ISO15693_CODE_LEN_1_256       64U   /*!< Coded bytes per data byte in 1 of 256                             */
+
 
 /*
 ******************************************************************************
 * LOCAL VARIABLES
 ******************************************************************************
 */
-static rfalIso15693PhyConfig_t gIso15693PhyConfig; /*!< current phy configuration */
+static rfalIso15693PhyConfig_t gIso15693PhyConfigInstances[RFAL_INSTANCES]; /*!< current phy configuration */
+#define gIso15693PhyConfig RFAL_INSTANCE(gIso15693PhyConfigInstances)
+
+/*! Four Manchester pairs (one input byte, LSB first) to four data bits, ISO15693_MAN_NIBBLE_INVALID if any pair is not a data bit */
+static const uint8_t gIso15693ManNibble[256] =
+{
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0x00U, 0x01U, 0xFFU, 0xFFU, 0x02U, 0x03U, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0x04U, 0x05U, 0xFFU, 0xFFU, 0x06U, 0x07U, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0x08U, 0x09U, 0xFFU, 0xFFU, 0x0AU, 0x0BU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0x0CU, 0x0DU, 0xFFU, 0xFFU, 0x0EU, 0x0FU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU
+};
+
+/*! 1 of 4 code of one data byte: one pulse position per bit pair, LSB first */
+static const uint8_t gIso15693Code1Of4[256][ISO15693_CODE_LEN_1_4] =
+{
+    { 0x02U, 0x02U, 0x02U, 0x02U }, { 0x08U, 0x02U, 0x02U, 0x02U }, { 0x20U, 0x02U, 0x02U, 0x02U }, { 0x80U, 0x02U, 0x02U, 0x02U },
+    { 0x02U, 0x08U, 0x02U, 0x02U }, { 0x08U, 0x08U, 0x02U, 0x02U }, { 0x20U, 0x08U, 0x02U, 0x02U }, { 0x80U, 0x08U, 0x02U, 0x02U },
+    { 0x02U, 0x20U, 0x02U, 0x02U }, { 0x08U, 0x20U, 0x02U, 0x02U }, { 0x20U, 0x20U, 0x02U, 0x02U }, { 0x80U, 0x20U, 0x02U, 0x02U },
+    { 0x02U, 0x80U, 0x02U, 0x02U }, { 0x08U, 0x80U, 0x02U, 0x02U }, { 0x20U, 0x80U, 0x02U, 0x02U }, { 0x80U, 0x80U, 0x02U, 0x02U },
+    { 0x02U, 0x02U, 0x08U, 0x02U }, { 0x08U, 0x02U, 0x08U, 0x02U }, { 0x20U, 0x02U, 0x08U, 0x02U }, { 0x80U, 0x02U, 0x08U, 0x02U },
+    { 0x02U, 0x08U, 0x08U, 0x02U }, { 0x08U, 0x08U, 0x08U, 0x02U }, { 0x20U, 0x08U, 0x08U, 0x02U }, { 0x80U, 0x08U, 0x08U, 0x02U },
+    { 0x02U, 0x20U, 0x08U, 0x02U }, { 0x08U, 0x20U, 0x08U, 0x02U }, { 0x20U, 0x20U, 0x08U, 0x02U }, { 0x80U, 0x20U, 0x08U, 0x02U },
+    { 0x02U, 0x80U, 0x08U, 0x02U }, { 0x08U, 0x80U, 0x08U, 0x02U }, { 0x20U, 0x80U, 0x08U, 0x02U }, { 0x80U, 0x80U, 0x08U, 0x02U },
+    { 0x02U, 0x02U, 0x20U, 0x02U }, { 0x08U, 0x02U, 0x20U, 0x02U }, { 0x20U, 0x02U, 0x20U, 0x02U }, { 0x80U, 0x02U, 0x20U, 0x02U },
+    { 0x02U, 0x08U, 0x20U, 0x02U }, { 0x08U, 0x08U, 0x20U, 0x02U }, { 0x20U, 0x08U, 0x20U, 0x02U }, { 0x80U, 0x08U, 0x20U, 0x02U },
+    { 0x02U, 0x20U, 0x20U, 0x02U }, { 0x08U, 0x20U, 0x20U, 0x02U }, { 0x20U, 0x20U, 0x20U, 0x02U }, { 0x80U, 0x20U, 0x20U, 0x02U },
+    { 0x02U, 0x80U, 0x20U, 0x02U }, { 0x08U, 0x80U, 0x20U, 0x02U }, { 0x20U, 0x80U, 0x20U, 0x02U }, { 0x80U, 0x80U, 0x20U, 0x02U },
+    { 0x02U, 0x02U, 0x80U, 0x02U }, { 0x08U, 0x02U, 0x80U, 0x02U }, { 0x20U, 0x02U, 0x80U, 0x02U }, { 0x80U, 0x02U, 0x80U, 0x02U },
+    { 0x02U, 0x08U, 0x80U, 0x02U }, { 0x08U, 0x08U, 0x80U, 0x02U }, { 0x20U, 0x08U, 0x80U, 0x02U }, { 0x80U, 0x08U, 0x80U, 0x02U },
+    { 0x02U, 0x20U, 0x80U, 0x02U }, { 0x08U, 0x20U, 0x80U, 0x02U }, { 0x20U, 0x20U, 0x80U, 0x02U }, { 0x80U, 0x20U, 0x80U, 0x02U },
+    { 0x02U, 0x80U, 0x80U, 0x02U }, { 0x08U, 0x80U, 0x80U, 0x02U }, { 0x20U, 0x80U, 0x80U, 0x02U }, { 0x80U, 0x80U, 0x80U, 0x02U },
+    { 0x02U, 0x02U, 0x02U, 0x08U }, { 0x08U, 0x02U, 0x02U, 0x08U }, { 0x20U, 0x02U, 0x02U, 0x08U }, { 0x80U, 0x02U, 0x02U, 0x08U },
+    { 0x02U, 0x08U, 0x02U, 0x08U }, { 0x08U, 0x08U, 0x02U, 0x08U }, { 0x20U, 0x08U, 0x02U, 0x08U }, { 0x80U, 0x08U, 0x02U, 0x08U },
+    { 0x02U, 0x20U, 0x02U, 0x08U }, { 0x08U, 0x20U, 0x02U, 0x08U }, { 0x20U, 0x20U, 0x02U, 0x08U }, { 0x80U, 0x20U, 0x02U, 0x08U },
+    { 0x02U, 0x80U, 0x02U, 0x08U }, { 0x08U, 0x80U, 0x02U, 0x08U }, { 0x20U, 0x80U, 0x02U, 0x08U }, { 0x80U, 0x80U, 0x02U, 0x08U },
+    { 0x02U, 0x02U, 0x08U, 0x08U }, { 0x08U, 0x02U, 0x08U, 0x08U }, { 0x20U, 0x02U, 0x08U, 0x08U }, { 0x80U, 0x02U, 0x08U, 0x08U },
+    { 0x02U, 0x08U, 0x08U, 0x08U }, { 0x08U, 0x08U, 0x08U, 0x08U }, { 0x20U, 0x08U, 0x08U, 0x08U }, { 0x80U, 0x08U, 0x08U, 0x08U },
+    { 0x02U, 0x20U, 0x08U, 0x08U }, { 0x08U, 0x20U, 0x08U, 0x08U }, { 0x20U, 0x20U, 0x08U, 0x08U }, { 0x80U, 0x20U, 0x08U, 0x08U },
+    { 0x02U, 0x80U, 0x08U, 0x08U }, { 0x08U, 0x80U, 0x08U, 0x08U }, { 0x20U, 0x80U, 0x08U, 0x08U }, { 0x80U, 0x80U, 0x08U, 0x08U },
+    { 0x02U, 0x02U, 0x20U, 0x08U }, { 0x08U, 0x02U, 0x20U, 0x08U }, { 0x20U, 0x02U, 0x20U, 0x08U }, { 0x80U, 0x02U, 0x20U, 0x08U },
+    { 0x02U, 0x08U, 0x20U, 0x08U }, { 0x08U, 0x08U, 0x20U, 0x08U }, { 0x20U, 0x08U, 0x20U, 0x08U }, { 0x80U, 0x08U, 0x20U, 0x08U },
+    { 0x02U, 0x20U, 0x20U, 0x08U }, { 0x08U, 0x20U, 0x20U, 0x08U }, { 0x20U, 0x20U, 0x20U, 0x08U }, { 0x80U, 0x20U, 0x20U, 0x08U },
+    { 0x02U, 0x80U, 0x20U, 0x08U }, { 0x08U, 0x80U, 0x20U, 0x08U }, { 0x20U, 0x80U, 0x20U, 0x08U }, { 0x80U, 0x80U, 0x20U, 0x08U },
+    { 0x02U, 0x02U, 0x80U, 0x08U }, { 0x08U, 0x02U, 0x80U, 0x08U }, { 0x20U, 0x02U, 0x80U, 0x08U }, { 0x80U, 0x02U, 0x80U, 0x08U },
+    { 0x02U, 0x08U, 0x80U, 0x08U }, { 0x08U, 0x08U, 0x80U, 0x08U }, { 0x20U, 0x08U, 0x80U, 0x08U }, { 0x80U, 0x08U, 0x80U, 0x08U },
+    { 0x02U, 0x20U, 0x80U, 0x08U }, { 0x08U, 0x20U, 0x80U, 0x08U }, { 0x20U, 0x20U, 0x80U, 0x08U }, { 0x80U, 0x20U, 0x80U, 0x08U },
+    { 0x02U, 0x80U, 0x80U, 0x08U }, { 0x08U, 0x80U, 0x80U, 0x08U }, { 0x20U, 0x80U, 0x80U, 0x08U }, { 0x80U, 0x80U, 0x80U, 0x08U },
+    { 0x02U, 0x02U, 0x02U, 0x20U }, { 0x08U, 0x02U, 0x02U, 0x20U }, { 0x20U, 0x02U, 0x02U, 0x20U }, { 0x80U, 0x02U, 0x02U, 0x20U },
+    { 0x02U, 0x08U, 0x02U, 0x20U }, { 0x08U, 0x08U, 0x02U, 0x20U }, { 0x20U, 0x08U, 0x02U, 0x20U }, { 0x80U, 0x08U, 0x02U, 0x20U },
+    { 0x02U, 0x20U, 0x02U, 0x20U }, { 0x08U, 0x20U, 0x02U, 0x20U }, { 0x20U, 0x20U, 0x02U, 0x20U }, { 0x80U, 0x20U, 0x02U, 0x20U },
+    { 0x02U, 0x80U, 0x02U, 0x20U }, { 0x08U, 0x80U, 0x02U, 0x20U }, { 0x20U, 0x80U, 0x02U, 0x20U }, { 0x80U, 0x80U, 0x02U, 0x20U },
+    { 0x02U, 0x02U, 0x08U, 0x20U }, { 0x08U, 0x02U, 0x08U, 0x20U }, { 0x20U, 0x02U, 0x08U, 0x20U }, { 0x80U, 0x02U, 0x08U, 0x20U },
+    { 0x02U, 0x08U, 0x08U, 0x20U }, { 0x08U, 0x08U, 0x08U, 0x20U }, { 0x20U, 0x08U, 0x08U, 0x20U }, { 0x80U, 0x08U, 0x08U, 0x20U },
+    { 0x02U, 0x20U, 0x08U, 0x20U }, { 0x08U, 0x20U, 0x08U, 0x20U }, { 0x20U, 0x20U, 0x08U, 0x20U }, { 0x80U, 0x20U, 0x08U, 0x20U },
+    { 0x02U, 0x80U, 0x08U, 0x20U }, { 0x08U, 0x80U, 0x08U, 0x20U }, { 0x20U, 0x80U, 0x08U, 0x20U }, { 0x80U, 0x80U, 0x08U, 0x20U },
+    { 0x02U, 0x02U, 0x20U, 0x20U }, { 0x08U, 0x02U, 0x20U, 0x20U }, { 0x20U, 0x02U, 0x20U, 0x20U }, { 0x80U, 0x02U, 0x20U, 0x20U },
+    { 0x02U, 0x08U, 0x20U, 0x20U }, { 0x08U, 0x08U, 0x20U, 0x20U }, { 0x20U, 0x08U, 0x20U, 0x20U }, { 0x80U, 0x08U, 0x20U, 0x20U },
+    { 0x02U, 0x20U, 0x20U, 0x20U }, { 0x08U, 0x20U, 0x20U, 0x20U }, { 0x20U, 0x20U, 0x20U, 0x20U }, { 0x80U, 0x20U, 0x20U, 0x20U },
+    { 0x02U, 0x80U, 0x20U, 0x20U }, { 0x08U, 0x80U, 0x20U, 0x20U }, { 0x20U, 0x80U, 0x20U, 0x20U }, { 0x80U, 0x80U, 0x20U, 0x20U },
+    { 0x02U, 0x02U, 0x80U, 0x20U }, { 0x08U, 0x02U, 0x80U, 0x20U }, { 0x20U, 0x02U, 0x80U, 0x20U }, { 0x80U, 0x02U, 0x80U, 0x20U },
+    { 0x02U, 0x08U, 0x80U, 0x20U }, { 0x08U, 0x08U, 0x80U, 0x20U }, { 0x20U, 0x08U, 0x80U, 0x20U }, { 0x80U, 0x08U, 0x80U, 0x20U },
+    { 0x02U, 0x20U, 0x80U, 0x20U }, { 0x08U, 0x20U, 0x80U, 0x20U }, { 0x20U, 0x20U, 0x80U, 0x20U }, { 0x80U, 0x20U, 0x80U, 0x20U },
+    { 0x02U, 0x80U, 0x80U, 0x20U }, { 0x08U, 0x80U, 0x80U, 0x20U }, { 0x20U, 0x80U, 0x80U, 0x20U }, { 0x80U, 0x80U, 0x80U, 0x20U },
+    { 0x02U, 0x02U, 0x02U, 0x80U }, { 0x08U, 0x02U, 0x02U, 0x80U }, { 0x20U, 0x02U, 0x02U, 0x80U }, { 0x80U, 0x02U, 0x02U, 0x80U },
+    { 0x02U, 0x08U, 0x02U, 0x80U }, { 0x08U, 0x08U, 0x02U, 0x80U }, { 0x20U, 0x08U, 0x02U, 0x80U }, { 0x80U, 0x08U, 0x02U, 0x80U },
+    { 0x02U, 0x20U, 0x02U, 0x80U }, { 0x08U, 0x20U, 0x02U, 0x80U }, { 0x20U, 0x20U, 0x02U, 0x80U }, { 0x80U, 0x20U, 0x02U, 0x80U },
+    { 0x02U, 0x80U, 0x02U, 0x80U }, { 0x08U, 0x80U, 0x02U, 0x80U }, { 0x20U, 0x80U, 0x02U, 0x80U }, { 0x80U, 0x80U, 0x02U, 0x80U },
+    { 0x02U, 0x02U, 0x08U, 0x80U }, { 0x08U, 0x02U, 0x08U, 0x80U }, { 0x20U, 0x02U, 0x08U, 0x80U }, { 0x80U, 0x02U, 0x08U, 0x80U },
+    { 0x02U, 0x08U, 0x08U, 0x80U }, { 0x08U, 0x08U, 0x08U, 0x80U }, { 0x20U, 0x08U, 0x08U, 0x80U }, { 0x80U, 0x08U, 0x08U, 0x80U },
+    { 0x02U, 0x20U, 0x08U, 0x80U }, { 0x08U, 0x20U, 0x08U, 0x80U }, { 0x20U, 0x20U, 0x08U, 0x80U }, { 0x80U, 0x20U, 0x08U, 0x80U },
+    { 0x02U, 0x80U, 0x08U, 0x80U }, { 0x08U, 0x80U, 0x08U, 0x80U }, { 0x20U, 0x80U, 0x08U, 0x80U }, { 0x80U, 0x80U, 0x08U, 0x80U },
+    { 0x02U, 0x02U, 0x20U, 0x80U }, { 0x08U, 0x02U, 0x20U, 0x80U }, { 0x20U, 0x02U, 0x20U, 0x80U }, { 0x80U, 0x02U, 0x20U, 0x80U },
+    { 0x02U, 0x08U, 0x20U, 0x80U }, { 0x08U, 0x08U, 0x20U, 0x80U }, { 0x20U, 0x08U, 0x20U, 0x80U }, { 0x80U, 0x08U, 0x20U, 0x80U },
+    { 0x02U, 0x20U, 0x20U, 0x80U }, { 0x08U, 0x20U, 0x20U, 0x80U }, { 0x20U, 0x20U, 0x20U, 0x80U }, { 0x80U, 0x20U, 0x20U, 0x80U },
+    { 0x02U, 0x80U, 0x20U, 0x80U }, { 0x08U, 0x80U, 0x20U, 0x80U }, { 0x20U, 0x80U, 0x20U, 0x80U }, { 0x80U, 0x80U, 0x20U, 0x80U },
+    { 0x02U, 0x02U, 0x80U, 0x80U }, { 0x08U, 0x02U, 0x80U, 0x80U }, { 0x20U, 0x02U, 0x80U, 0x80U }, { 0x80U, 0x02U, 0x80U, 0x80U },
+    { 0x02U, 0x08U, 0x80U, 0x80U }, { 0x08U, 0x08U, 0x80U, 0x80U }, { 0x20U, 0x08U, 0x80U, 0x80U }, { 0x80U, 0x08U, 0x80U, 0x80U },
+    { 0x02U, 0x20U, 0x80U, 0x80U }, { 0x08U, 0x20U, 0x80U, 0x80U }, { 0x20U, 0x20U, 0x80U, 0x80U }, { 0x80U, 0x20U, 0x80U, 0x80U },
+    { 0x02U, 0x80U, 0x80U, 0x80U }, { 0x08U, 0x80U, 0x80U, 0x80U }, { 0x20U, 0x80U, 0x80U, 0x80U }, { 0x80U, 0x80U, 0x80U, 0x80U }
+};
+
+/*! 1 of 256 pulse position inside the coded byte selected by data / 4 */
+static const uint8_t gIso15693Slot1Of256[4] =
+{
+    ISO15693_DAT_SLOT0_1_256, ISO15693_DAT_SLOT1_1_256, ISO15693_DAT_SLOT2_1_256, ISO15693_DAT_SLOT3_1_256
+};
 
 /*
 ******************************************************************************
 * LOCAL FUNCTION PROTOTYPES
 ******************************************************************************
 */
+static void rfalIso15693VCDCodeBytes(const uint8_t* data, uint16_t length, uint8_t* outbuf, uint16_t codeLen);
+#ifdef RFAL_ISO15693_DECODE_REFERENCE
 static ReturnCode rfalIso15693PhyVCDCode1Of4(const uint8_t data, uint8_t* outbuffer, uint16_t maxOutBufLen, uint16_t* outBufLen);
 static ReturnCode rfalIso15693PhyVCDCode1Of256(const uint8_t data, uint8_t* outbuffer, uint16_t maxOutBufLen, uint16_t* outBufLen);
+#endif /* RFAL_ISO15693_DECODE_REFERENCE */
+static bool rfalIso15693IsEOF(const uint8_t *inBuf, uint16_t mp);
+static ReturnCode rfalIso15693VICCCheckCrc(const uint8_t* outBuf, uint16_t outBufPos, bool picopassMode);
 
 
 
@@ -141,6 +249,246 @@ ReturnCode rfalIso15693PhyGetConfiguration(rfalIso15693PhyConfig_t* config)
 ReturnCode rfalIso15693VCDCode(uint8_t* buffer, uint16_t length, bool sendCrc, bool sendFlags, bool picopassMode,
                    uint16_t *subbit_total_length, uint16_t *offset,
                    uint8_t* outbuf, uint16_t outBufSize, uint16_t* actOutBufSize)
+{
+    uint8_t eof, sof;
+    uint8_t transbuf[2];
+    uint16_t crc;
+    uint16_t codeLen;
+    uint16_t total;
+    uint16_t num;
+    uint16_t len;
+    uint8_t* outputBuf;
+    uint16_t outputBufSize;
+
+    total = (uint16_t)(length + ((sendCrc) ? 2U : 0U));
+
+    *actOutBufSize = 0;
+
+    if (ISO15693_VCD_CODING_1_4 == gIso15693PhyConfig.coding)
+    {
+        sof = ISO15693_DAT_SOF_1_4;
+        eof = ISO15693_DAT_EOF_1_4;
+        codeLen = ISO15693_CODE_LEN_1_4;
+        if (outBufSize < 5U) { /* 5 should be safe: enough for sof + 1byte data in 1of4 */
+            return RFAL_ERR_NOMEM;
+        }
+    }
+    else
+    {
+        sof = ISO15693_DAT_SOF_1_256;
+        eof = ISO15693_DAT_EOF_1_256;
+        codeLen = ISO15693_CODE_LEN_1_256;
+        if (outBufSize < ((*offset != 0U) ? 64U : 65U)) { /* At beginning of a frame we need at least 65 bytes to start: enough for sof + 1byte data in 1of256 */
+            return RFAL_ERR_NOMEM;
+        }
+    }
+
+    *subbit_total_length = (uint16_t)((length == 0U) ? 1U : ( 1U /* SOF */ + (total * codeLen) + 1U /* EOF */ ));
+
+    if ((length != 0U) && (0U == *offset) && sendFlags && (!picopassMode))
+    {
+        /* set high datarate flag */
+        buffer[0] |= (uint8_t)ISO15693_REQ_FLAG_HIGH_DATARATE;
+        /* clear sub-carrier flag - we only support single sub-carrier */
+        buffer[0] = (uint8_t)(buffer[0] & ~ISO15693_REQ_FLAG_TWO_SUBCARRIERS);  /* MISRA 10.3 */
+    }
+
+    outputBuf = outbuf;             /* MISRA 17.8: Use intermediate variable */
+    outputBufSize = outBufSize;     /* MISRA 17.8: Use intermediate variable */
+
+    /* Send SOF if at 0 offset */
+    if ((length != 0U) && (0U == *offset))
+    {
+        *outputBuf = sof;
+        (*actOutBufSize)++;
+        outputBufSize--;
+        outputBuf++;
+    }
+
+    /* Code as many whole bytes as fit into the output buffer in one go */
+    num = ((*offset < total) ? (uint16_t)RFAL_MIN( (uint16_t)(total - *offset), (uint16_t)(outputBufSize / codeLen) ) : 0U);
+
+    /* send data */
+    if (*offset < length)
+    {
+        len = (uint16_t)RFAL_MIN( num, (uint16_t)(length - *offset) );
+        rfalIso15693VCDCodeBytes(&buffer[*offset], len, outputBuf, codeLen);
+        outputBuf = &outputBuf[len * codeLen];  /* MISRA 18.4: Avoid pointer arithmetic */
+        (*actOutBufSize) += (uint16_t)(len * codeLen);
+        (*offset) += len;
+        num -= len;
+    }
+
+    /* send crc */
+    if (num != 0U)
+    {
+        crc = 0;
+        if (length != 0U)
+        {
+            crc = rfalCrcCalculateCcitt( (uint16_t) ((picopassMode) ? 0xE012U : 0xFFFFU),        /* In PicoPass Mode a different Preset Value is used   */
+                                                    ((picopassMode) ? (buffer + 1U) : buffer),   /* CMD byte is not taken into account in PicoPass mode */
+                                                    ((picopassMode) ? (length - 1U) : length));  /* CMD byte is not taken into account in PicoPass mode */
+
+            crc = (uint16_t)((picopassMode) ? crc : ~crc);
+        }
+        transbuf[0] = (uint8_t)(crc & 0xffU);
+        transbuf[1] = (uint8_t)((crc >> 8) & 0xffU);
+
+        rfalIso15693VCDCodeBytes(&transbuf[*offset - length], num, outputBuf, codeLen);
+        outputBuf = &outputBuf[num * codeLen];  /* MISRA 18.4: Avoid pointer arithmetic */
+        (*actOutBufSize) += (uint16_t)(num * codeLen);
+        (*offset) += num;
+    }
+
+    /* The EOF follows the last coded byte, like with the per byte coders also when the chunk filled outBufSize */
+    if (*offset != total)
+    {
+        return RFAL_ERR_AGAIN;
+    }
+
+    *outputBuf = eof;
+    (*actOutBufSize)++;
+
+    return RFAL_ERR_NONE;
+}
+
+ReturnCode rfalIso15693VICCDecode(const uint8_t *inBuf,
+                                  uint16_t inBufLen,
+                                  uint8_t* outBuf,
+                                  uint16_t outBufLen,
+                                  uint16_t* outBufPos,
+                                  uint16_t* bitsBeforeCol,
+                                  uint16_t ignoreBits,
+                                  bool picopassMode )
+{
+    ReturnCode err = RFAL_ERR_NONE;
+    uint16_t mp; /* Current bit position in manchester bit inBuf*/
+    uint16_t bp; /* Current bit position in outBuf */
+    uint32_t mpEnd; /* Manchester pairs start before this position */
+    uint32_t bpEnd; /* Size of outBuf in bits */
+    uint8_t  nib;
+    uint8_t  eofPair;
+    uint8_t  sh;
+
+    *bitsBeforeCol = 0;
+    *outBufPos = 0;
+
+    /* first check for valid SOF. Since it starts with 3 unmodulated pulses it is 0x17. */
+    if ((inBuf[0] & 0x1fU) != 0x17U)
+    {
+		ISO_15693_DEBUG("0x%x\n", iso15693PhyBitBuffer[0]);
+		return RFAL_ERR_FRAMING;
+    }
+    ISO_15693_DEBUG("SOF\n");
+
+    if (outBufLen == 0U)
+    {
+        return RFAL_ERR_NONE;
+    }
+
+    mp = ISO15693_MAN_SOF_LEN; /* 5 bits were SOF, now manchester starts: 2 bits per payload bit */
+    bp = 0;
+
+    RFAL_MEMSET(outBuf,0,outBufLen);
+
+    if (inBufLen == 0U)
+    {
+        return RFAL_ERR_CRC;
+    }
+
+    mpEnd = (((uint32_t)inBufLen * 8U) - 2U);
+    bpEnd = ((uint32_t)outBufLen * 8U);
+
+    while ( mp < mpEnd )
+    {
+        bool isEOF = false;
+        uint8_t man;
+        
+        /* Fast path: the 4 pairs held by the next input byte (the pairs are byte aligned every 4 pairs, 
+         * after the SOF) are decoded at once as long as they are all data bits, they fit into outBuf and 
+         * the EOF check due when an output byte completes does not match                                */
+        if( ((mp & 7U) == ISO15693_MAN_SOF_LEN) && (((uint32_t)mp + 6U) < mpEnd) && (((uint32_t)bp + 4U) <= bpEnd) )
+        {
+            nib = gIso15693ManNibble[ (uint8_t)((inBuf[mp/8U] >> ISO15693_MAN_SOF_LEN) | (inBuf[(mp/8U) + 1U] << (8U - ISO15693_MAN_SOF_LEN))) ];
+            
+            eofPair = (uint8_t)(7U - (bp & 7U));                  /* Pair of this group after which an output byte is complete */
+            if( (nib != ISO15693_MAN_NIBBLE_INVALID) && ((eofPair >= 4U) || (!rfalIso15693IsEOF(inBuf, (mp + (2U * (uint16_t)eofPair))))) )
+            {
+                sh = (uint8_t)(bp & 7U);
+                outBuf[bp/8U] = (uint8_t)(outBuf[bp/8U] | (uint8_t)(nib << sh));
+                if (sh > 4U)
+                {
+                    outBuf[(bp/8U) + 1U] = (uint8_t)(nib >> (8U - sh));
+                }
+                
+                bp += 4U;
+                mp += 8U;
+                
+                if (bp >= bpEnd)
+                { /* Don't write beyond the end */
+                    break;
+                }
+                continue;
+            }
+        }
+        
+        /* One pair at a time */
+        man  = (inBuf[mp/8U] >> (mp%8U)) & 0x1U;
+        man |= ((inBuf[(mp+1U)/8U] >> ((mp+1U)%8U)) & 0x1U) << 1;
+        if (1U == man)
+        {
+            bp++;
+        }
+        if (2U == man)
+        {
+            outBuf[bp/8U] = (uint8_t)(outBuf[bp/8U] | (1U <<(bp%8U)));  /* MISRA 10.3 */
+            bp++;
+        }
+        if ((bp%8U) == 0U)
+        { /* Check for EOF */
+            ISO_15693_DEBUG("ceof %hhx %hhx\n", inBuf[mp/8U], inBuf[mp/8+1]);
+            isEOF = rfalIso15693IsEOF(inBuf, mp);
+        }
+        if ( ((0U == man) || (3U == man)) && (!isEOF) )
+        {  
+            if (bp >= ignoreBits)
+            {
+                err = RFAL_ERR_RF_COLLISION;
+            }
+            else
+            {
+                /* ignored collision: leave as 0 */
+                bp++;
+            }
+        }
+        if ( (bp >= bpEnd) || (err == RFAL_ERR_RF_COLLISION) || isEOF )        
+        { /* Don't write beyond the end */
+            break;
+        }
+        
+        mp += 2U;
+    }
+
+    *outBufPos = (bp / 8U);
+    *bitsBeforeCol = bp;
+
+    if (err != RFAL_ERR_NONE) 
+    {
+        return err;
+    }
+
+    if ((bp%8U) != 0U)
+    {
+        return RFAL_ERR_CRC;
+    }
+
+    return rfalIso15693VICCCheckCrc(outBuf, *outBufPos, picopassMode);
+}
+
+#ifdef RFAL_ISO15693_DECODE_REFERENCE
+ReturnCode rfalIso15693VCDCodeReference(uint8_t* buffer, uint16_t length, bool sendCrc, bool sendFlags, bool picopassMode,
+                                        uint16_t *subbit_total_length, uint16_t *offset,
+                                        uint8_t* outbuf, uint16_t outBufSize, uint16_t* actOutBufSize)
 {
     ReturnCode err = RFAL_ERR_NONE;
     uint8_t eof, sof;
@@ -277,7 +625,7 @@ ReturnCode rfalIso15693VCDCode(uint8_t* buffer, uint16_t length, bool sendCrc, b
     return err;
 }
 
-ReturnCode rfalIso15693VICCDecode(const uint8_t *inBuf,
+ReturnCode rfalIso15693VICCDecodeReference(const uint8_t *inBuf,
                                   uint16_t inBufLen,
                                   uint8_t* outBuf,
                                   uint16_t outBufLen,
@@ -403,12 +751,50 @@ ReturnCode rfalIso15693VICCDecode(const uint8_t *inBuf,
 
     return err;
 }
+#endif /* RFAL_ISO15693_DECODE_REFERENCE */
 
 /*
 ******************************************************************************
 * LOCAL FUNCTIONS
 ******************************************************************************
 */
+/*! 
+ *****************************************************************************
+ *  \brief  Code a run of bytes with the precomputed tables
+ *
+ *  \param[in]  data    : bytes to code
+ *  \param[in]  length  : number of bytes to code
+ *  \param[out] outbuf  : coded stream, \a length * \a codeLen bytes
+ *  \param[in]  codeLen : ISO15693_CODE_LEN_1_4 or ISO15693_CODE_LEN_1_256
+ *
+ *****************************************************************************
+ */
+static void rfalIso15693VCDCodeBytes(const uint8_t* data, uint16_t length, uint8_t* outbuf, uint16_t codeLen)
+{
+    uint16_t i;
+    uint8_t* out = outbuf;
+
+    if (codeLen == ISO15693_CODE_LEN_1_4)
+    {
+        for (i = 0; i < length; i++)
+        {
+            RFAL_MEMCPY(out, gIso15693Code1Of4[data[i]], ISO15693_CODE_LEN_1_4);
+            out = &out[ISO15693_CODE_LEN_1_4];
+        }
+    }
+    else
+    {
+        /* A single pulse in 256 slots: all coded bytes but one are empty */
+        RFAL_MEMSET(out, 0x00, ((uint32_t)length * ISO15693_CODE_LEN_1_256));
+        for (i = 0; i < length; i++)
+        {
+            out[data[i] >> 2] = gIso15693Slot1Of256[data[i] & 0x03U];
+            out = &out[ISO15693_CODE_LEN_1_256];
+        }
+    }
+}
+
+#ifdef RFAL_ISO15693_DECODE_REFERENCE
 /*! 
  *****************************************************************************
  *  \brief  Perform 1 of 4 coding and send coded data
@@ -525,4 +911,69 @@ static ReturnCode rfalIso15693PhyVCDCode1Of256(const uint8_t data, uint8_t* outb
     return err;
 }
 
+#endif /* RFAL_ISO15693_DECODE_REFERENCE */
+
+/*! 
+ *****************************************************************************
+ *  \brief  Check for the EOF after a Manchester pair
+ *
+ *  \param[in] inBuf : Manchester bit stream
+ *  \param[in] mp    : bit position of the pair completing an output byte
+ *
+ *  \return true if the stream continues with 10111000 = EOF
+ *
+ *****************************************************************************
+ */
+static bool rfalIso15693IsEOF(const uint8_t *inBuf, uint16_t mp)
+{
+    if ( ((inBuf[mp/8U]   & 0xe0U) == 0xa0U)
+       &&(inBuf[(mp/8U)+1U] == 0x03U))
+    { /* Now we know that it was 10111000 = EOF */
+        ISO_15693_DEBUG("EOF\n");
+        return true;
+    }
+    return false;
+}
+
+/*! 
+ *****************************************************************************
+ *  \brief  Check the CRC of a decoded VICC response
+ *
+ *  \param[in] outBuf       : decoded response incl. CRC
+ *  \param[in] outBufPos    : number of decoded bytes
+ *  \param[in] picopassMode : Picopass CRC preset and no inversion
+ *
+ *  \return RFAL_ERR_CRC  : CRC error or response too short
+ *  \return RFAL_ERR_NONE : CRC ok
+ *
+ *****************************************************************************
+ */
+static ReturnCode rfalIso15693VICCCheckCrc(const uint8_t* outBuf, uint16_t outBufPos, bool picopassMode)
+{
+    uint16_t crc;
+
+    if (outBufPos <= 2U)
+    {
+        return RFAL_ERR_CRC;
+    }
+
+    /* finally, check crc */
+    ISO_15693_DEBUG("Calculate CRC, val: 0x%x, outBufLen: ", *outBuf);
+    ISO_15693_DEBUG("0x%x ", outBufPos - 2);
+    
+    crc = rfalCrcCalculateCcitt(((picopassMode) ? 0xE012U : 0xFFFFU), outBuf, outBufPos - 2U);
+    crc = (uint16_t)((picopassMode) ? crc : ~crc);
+    
+    if (((crc & 0xffU) == outBuf[outBufPos-2U]) &&
+            (((crc >> 8U) & 0xffU) == outBuf[outBufPos-1U]))
+    {
+        ISO_15693_DEBUG("OK\n");
+        return RFAL_ERR_NONE;
+    }
+
+    ISO_15693_DEBUG("error! Expected: 0x%x, got ", crc);
+    ISO_15693_DEBUG("0x%hhx 0x%hhx\n", outBuf[outBufPos-2], outBuf[outBufPos-1]);
+    return RFAL_ERR_CRC;
+}
+
 #endif /* RFAL_FEATURE_NFCV */
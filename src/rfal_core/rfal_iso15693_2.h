@@ -157,6 +157,22 @@ extern ReturnCode rfalIso15693VCDCode(uint8_t* buffer, uint16_t length, bool sen
                                        uint16_t *subbit_total_length, uint16_t *offset,
                                        uint8_t* outbuf, uint16_t outBufSize, uint16_t* actOutBufSize);
 
+#ifdef RFAL_ISO15693_DECODE_REFERENCE
+/*! 
+ *****************************************************************************
+ *  \brief  Code an ISO15693 frame, one byte at a time
+ *
+ *  Previous implementation of #rfalIso15693VCDCode, kept as reference for
+ *  equivalence checks and benchmarks. Only built with 
+ *  RFAL_ISO15693_DECODE_REFERENCE. Same parameters and return values.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode rfalIso15693VCDCodeReference(uint8_t* buffer, uint16_t length, bool sendCrc, bool sendFlags, bool picopassMode,
+                                                uint16_t *subbit_total_length, uint16_t *offset,
+                                                uint8_t* outbuf, uint16_t outBufSize, uint16_t* actOutBufSize);
+#endif /* RFAL_ISO15693_DECODE_REFERENCE */
+
 
 /*! 
  *****************************************************************************
@@ -193,5 +209,26 @@ extern ReturnCode rfalIso15693VICCDecode(const uint8_t *inBuf,
                                           uint16_t ignoreBits,
                                           bool picopassMode );
 
+#ifdef RFAL_ISO15693_DECODE_REFERENCE
+/*! 
+ *****************************************************************************
+ *  \brief  Receive an ISO15693 compatible frame, one Manchester pair at a time
+ *
+ *  Previous implementation of #rfalIso15693VICCDecode, kept as reference for
+ *  equivalence checks and benchmarks. Only built with 
+ *  RFAL_ISO15693_DECODE_REFERENCE. Same parameters and return values.
+ *
+ *****************************************************************************
+ */
+extern ReturnCode rfalIso15693VICCDecodeReference(const uint8_t *inBuf,
+                                                   uint16_t inBufLen,
+                                                   uint8_t* outBuf,
+                                                   uint16_t outBufLen,
+                                                   uint16_t* outBufPos,
+                                                   uint16_t* bitsBeforeCol,
+                                                   uint16_t ignoreBits,
+                                                   bool picopassMode );
+#endif /* RFAL_ISO15693_DECODE_REFERENCE */
+
 #endif /* RFAL_ISO_15693_2_H */
 
@@ -437,7 +437,8 @@ typedef struct{
  ******************************************************************************
  */
 
-static rfalIsoDep gIsoDep;    /*!< ISO-DEP Module instance               */
+static rfalIsoDep gIsoDepInstances[RFAL_INSTANCES];    /*!< ISO-DEP Module instances              */
+#define gIsoDep RFAL_INSTANCE(gIsoDepInstances)
 
 /*
  ******************************************************************************
@@ -1104,8 +1105,8 @@ uint16_t rfalIsoDepFSxI2FSx( uint8_t FSxI )
     uint16_t fsx;
     uint8_t  fsi;
     
-    /* Enforce maximum FSxI/FSx allowed - NFC Forum and EMVCo differ */
-    fsi = (( gIsoDep.compMode == RFAL_COMPLIANCE_MODE_EMV ) ? RFAL_MIN( FSxI, RFAL_ISODEP_FSDI_MAX_EMV ) : RFAL_MIN( FSxI, RFAL_ISODEP_FSDI_MAX_NFC ));
+    /* Enforce maximum FSxI/FSx allowed - NFC Forum and EMVCo differ, Digital 2.1 allows the ISO14443-4 frame sizes up to 4096 */
+    fsi = (( gIsoDep.compMode == RFAL_COMPLIANCE_MODE_EMV ) ? RFAL_MIN( FSxI, RFAL_ISODEP_FSDI_MAX_EMV ) : RFAL_MIN( FSxI, RFAL_ISODEP_FSDI_MAX_NFC_21 ));
     
     switch( fsi )
     {
@@ -1919,6 +1920,7 @@ static ReturnCode rfalIsoDepStartRATS( rfalIsoDepFSxI FSDI, uint8_t DID, rfalIso
     gIsoDep.rxBuf   = (uint8_t*) ats;
     gIsoDep.rxLen8  = atsLen;
     gIsoDep.did     = DID;
+    FSDI            = (rfalIsoDepFSxI)RFAL_MIN( (uint8_t)FSDI, (uint8_t)RFAL_ISODEP_FSDI_BUF_MAX );  /* Never announce frames larger than the I-Block buffer */
     
     /*******************************************************************************/
     /* Compose RATS */
@@ -2043,6 +2045,7 @@ static ReturnCode rfalIsoDepStartATTRIB( const uint8_t* nfcid0, uint8_t PARAM1,
     gIsoDep.rxBuf   = (uint8_t*)  attribRes;
     gIsoDep.rxLen8  = attribResLen;
     gIsoDep.did     = DID;
+    FSDI            = (rfalIsoDepFSxI)RFAL_MIN( (uint8_t)FSDI, (uint8_t)RFAL_ISODEP_FSDI_BUF_MAX );  /* Never announce frames larger than the I-Block buffer */
     
     /*******************************************************************************/
     /* Compose ATTRIB command */
@@ -2792,7 +2795,7 @@ ReturnCode rfalIsoDepGetApduTransceiveStatus( void )
             if( *gIsoDep.APDUParam.rxLen > 0U )    /* MISRA 21.18 */
             {
                 /* Ensure that data in tmpBuf still fits into APDU buffer */
-                if( (gIsoDep.APDURxPos + (*gIsoDep.APDUParam.rxLen)) > (uint16_t)RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN )
+                if( ((uint32_t)gIsoDep.APDURxPos + (*gIsoDep.APDUParam.rxLen)) > ((gIsoDep.APDUParam.rxBufLen != 0U) ? gIsoDep.APDUParam.rxBufLen : (uint32_t)RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN) )
                 {
                     return RFAL_ERR_NOMEM;
                 }
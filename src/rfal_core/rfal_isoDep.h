@@ -117,6 +117,35 @@
 
 #define RFAL_ISODEP_APDU_MAX_LEN                RFAL_ISODEP_FSX_1024  /*!< Max APDU length                                      */
 
+/*! Largest FSDI whose frames fit in the I-Block buffer (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN), RATS/ATTRIB never ask for more */
+#if   (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 4096)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_4096
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 2048)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_2048
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 1024)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_1024
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 512)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_512
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 256)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_256
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 128)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_128
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 96)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_96
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 64)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_64
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 48)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_48
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 40)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_40
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 32)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_32
+#elif (RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN >= 24)
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_24
+#else
+    #define RFAL_ISODEP_FSDI_BUF_MAX            RFAL_ISODEP_FSXI_16
+#endif
+
 #define RFAL_ISODEP_ATTRIB_RES_MBLI_NO_INFO     (0x00U)  /*!< MBLI indicating no information on its internal input buffer size  */
 #define RFAL_ISODEP_ATTRIB_REQ_PARAM1_DEFAULT   (0x00U)  /*!< Default values of Param 1 of ATTRIB_REQ Digital 1.0  12.6.1.3-5   */
 #define RFAL_ISODEP_ATTRIB_HLINFO_LEN           (32U)    /*!< Maximum Size of Higher Layer Information                          */
@@ -411,6 +440,7 @@ typedef struct
     rfalIsoDepApduBufFormat  *txBuf;                   /*!< Transmit Buffer struct reference         */
     uint16_t                 txBufLen;                 /*!< Transmit Buffer INF field length in Bytes*/
     rfalIsoDepApduBufFormat  *rxBuf;                   /*!< Receive Buffer struct reference in Bytes */
+    uint16_t                 rxBufLen;                 /*!< Receive Buffer APDU length in Bytes, 0: RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN */
     uint16_t                 *rxLen;                   /*!< Received INF data length in Bytes        */
     rfalIsoDepBufFormat      *tmpBuf;                  /*!< Temp buffer for Rx I-Blocks (internal)   */
     uint32_t                 FWT;                      /*!< FWT to be used (ignored in Listen Mode)  */
@@ -38,6 +38,7 @@
 #include "rfal_nfc.h"
 #include "rfal_utils.h"
 #include "rfal_analogConfig.h"
+#include "rfal_dpo.h"
 
 
 /*
@@ -80,6 +81,14 @@ typedef union{  /*PRQA S 0750 # MISRA 19.2 - Members of the union will not be us
 }rfalNfcTmpBuffer;
 
 
+/*! Technology scheduler state of a Poll technology                                                 */
+typedef struct{
+    uint8_t                 history;            /*!< Hit history, MSB: last Technology Detection     */
+    uint16_t                idleCycles;         /*!< Cycles since the last device found              */
+    rfalNfcTechStats        stats;              /*!< Technology Detection statistics                 */
+}rfalNfcSchedTech;
+
+
 /*! RFAL NFC instance                                                                                */
 typedef struct{
     rfalNfcState            state;              /*!< Main state                                      */
@@ -92,6 +101,19 @@ typedef struct{
     rfalNfcDiscoverParam    disc;               /*!< Discovery parameters                            */
     rfalNfcDevice           devList[RFAL_NFC_MAX_DEVICES];   /*!< Location of device list            */
     uint8_t                 devCnt;             /*!< Decices found counter                           */
+    uint8_t                 collDevCnt;         /*!< Devices found by the ongoing Collision Resolution */
+    union{                                      /*!< Devices of the ongoing Collision Resolution, one technology at a time */
+#if RFAL_FEATURE_NFCA
+        rfalNfcaListenDevice nfca[RFAL_NFC_MAX_DEVICES];
+#endif /* RFAL_FEATURE_NFCA */
+#if RFAL_FEATURE_NFCB
+        rfalNfcbListenDevice nfcb[RFAL_NFC_MAX_DEVICES];
+#endif /* RFAL_FEATURE_NFCB */
+#if RFAL_FEATURE_NFCF
+        rfalNfcfListenDevice nfcf[RFAL_NFC_MAX_DEVICES];
+#endif /* RFAL_FEATURE_NFCF */
+        uint8_t              none;              /*!< No technology with a non-blocking Collision Resolution */
+    }collDevList;
     uint32_t                discTmr;            /*!< Discovery Total duration timer                  */
     ReturnCode              dataExErr;          /*!< Last Data Exchange error                        */
     rfalNfcDeactivateType   deactType;          /*!< Deactivation type                               */
@@ -102,6 +124,13 @@ typedef struct{
     bool                    isOperOngoing;      /*!< Flag indicating operation is ongoing            */
     bool                    isDeactivating;     /*!< Flag indicating deactivation is ongoing         */
 
+    rfalNfcSchedTech        sched[RFAL_NFC_POLL_TECH_NUM];      /*!< Scheduler state, by Flag bit position   */
+    uint8_t                 schedOrder[RFAL_NFC_POLL_TECH_NUM]; /*!< Detection order of the current cycle    */
+    uint8_t                 schedOrderLen;      /*!< Technologies in the detection order             */
+    uint16_t                schedCycle;         /*!< Discovery cycles counter                        */
+    uint16_t                schedTech;          /*!< Technology currently being detected             */
+    uint32_t                schedStartUs;       /*!< Start of its Technology Detection               */
+
     rfalNfcaSensRes         sensRes;            /*!< SENS_RES during card detection and activation   */
     rfalNfcbSensbRes        sensbRes;           /*!< SENSB_RES during card detection and activation  */
     uint8_t                 sensbResLen;        /*!< SENSB_RES length                                */
@@ -123,10 +152,11 @@ typedef struct{
  ******************************************************************************
  */
 #ifdef RFAL_TEST_MODE
-    rfalNfc gNfcDev;
+    rfalNfc gNfcDevInstances[RFAL_INSTANCES];
 #else /* RFAL_TEST_MODE */
-    static rfalNfc gNfcDev;
+    static rfalNfc gNfcDevInstances[RFAL_INSTANCES];
 #endif /* RFAL_TEST_MODE */
+#define gNfcDev RFAL_INSTANCE(gNfcDevInstances)
 
 /*
 ******************************************************************************
@@ -134,10 +164,34 @@ typedef struct{
 ******************************************************************************
 */
 static ReturnCode rfalNfcPollTechDetetection( void );
+#if RFAL_FEATURE_NFCA
+static ReturnCode rfalNfcPollTechDetectNfca( void );
+#endif /* RFAL_FEATURE_NFCA */
+#if RFAL_FEATURE_NFCB
+static ReturnCode rfalNfcPollTechDetectNfcb( void );
+#endif /* RFAL_FEATURE_NFCB */
+#if RFAL_FEATURE_NFCF
+static ReturnCode rfalNfcPollTechDetectNfcf( void );
+#endif /* RFAL_FEATURE_NFCF */
+#if RFAL_FEATURE_NFCV
+static ReturnCode rfalNfcPollTechDetectNfcv( void );
+#endif /* RFAL_FEATURE_NFCV */
+#if RFAL_FEATURE_ST25TB
+static ReturnCode rfalNfcPollTechDetectSt25tb( void );
+#endif /* RFAL_FEATURE_ST25TB */
+static ReturnCode rfalNfcPollTechDetectProp( void );
+static uint8_t rfalNfcSchedTechIdx( uint16_t tech );
+static void rfalNfcSchedCycleStart( bool skipIdle );
+static uint16_t rfalNfcSchedNextTech( void );
+static void rfalNfcSchedTechDone( uint16_t tech );
 static ReturnCode rfalNfcPollCollResolution( void );
 static ReturnCode rfalNfcPollActivation( uint8_t devIt );
 static ReturnCode rfalNfcDeactivation( void );
 
+#if RFAL_FEATURE_ISO_DEP && RFAL_FEATURE_ISO_DEP_POLL
+static rfalBitRate rfalNfcIsoDepMaxBR( const rfalNfcDevice *device );
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+
 #if RFAL_FEATURE_NFC_DEP
 static ReturnCode rfalNfcNfcDepActivate( rfalNfcDevice *device, rfalNfcDepCommMode commMode, const uint8_t *atrReq, uint16_t atrReqLen );
 #endif /* RFAL_FEATURE_NFC_DEP */
@@ -320,6 +374,23 @@ ReturnCode rfalNfcGetDevicesFound( rfalNfcDevice **devList, uint8_t *devCnt )
     return RFAL_ERR_NONE;
 }
 
+/*******************************************************************************/
+ReturnCode rfalNfcGetTechStats( uint16_t tech, rfalNfcTechStats *stats )
+{
+    uint8_t idx;
+    
+    /* Check valid parameters */
+    idx = rfalNfcSchedTechIdx( tech );
+    if( (stats == NULL) || (idx >= RFAL_NFC_POLL_TECH_NUM) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    *stats = gNfcDev.sched[idx].stats;
+    
+    return RFAL_ERR_NONE;
+}
+
 /*******************************************************************************/
 ReturnCode rfalNfcGetActiveDevice( rfalNfcDevice **dev )
 {
@@ -390,6 +461,11 @@ void rfalNfcWorker( void )
             
         #endif /* RFAL_FEATURE_WAKEUP_MODE */
             
+            if( gNfcDev.state == RFAL_NFC_STATE_POLL_TECHDETECT )
+            {
+                rfalNfcSchedCycleStart( true );                               /* Order the technologies, idle ones may be skipped */
+            }
+            
             rfalNfcNfcNotify( gNfcDev.state );                                /* Notify caller that WU or Technology Detection has started  */
             break;
         
@@ -408,6 +484,8 @@ void rfalNfcWorker( void )
                 platformTimerDestroy( gNfcDev.discTmr );
                 gNfcDev.discTmr = (uint32_t)platformTimerCreate( gNfcDev.disc.totalDuration );
                 
+                rfalNfcSchedCycleStart( false );                                      /* Something is in the field, skip none */
+                
                 rfalNfcNfcNotify( gNfcDev.state );                                    /* Notify caller that WU has woke */
             }
     #endif /* RFAL_FEATURE_WAKEUP_MODE */
@@ -430,6 +508,13 @@ void rfalNfcWorker( void )
                 
                 gNfcDev.techs2do = gNfcDev.techsFound;                                /* Store the found technologies for collision resolution */
                 gNfcDev.state    = RFAL_NFC_STATE_POLL_COLAVOIDANCE;                  /* One or more devices found, go to Collision Avoidance  */
+                
+            #if RFAL_FEATURE_DPO
+                if( rfalDpoIsEnabled() )
+                {
+                    (void)rfalDpoAdjust();                                            /* Power for the devices just detected before resolving them */
+                }
+            #endif /* RFAL_FEATURE_DPO */
             }
             break;
             
@@ -686,6 +771,7 @@ ReturnCode rfalNfcDataExchangeStart( uint8_t *txData, uint16_t txDataLen, uint8_
                 rfalIsoDepTxRx.txBuf     = &gNfcDev.txBuf.isoDepBuf;
                 rfalIsoDepTxRx.txBufLen  = txDataLen;
                 rfalIsoDepTxRx.rxBuf     = &gNfcDev.rxBuf.isoDepBuf;
+                rfalIsoDepTxRx.rxBufLen  = (uint16_t)sizeof(gNfcDev.rxBuf.isoDepBuf.apdu);
                 rfalIsoDepTxRx.rxLen     = &gNfcDev.rxLen;
                 rfalIsoDepTxRx.tmpBuf    = &gNfcDev.tmpBuf.isoDepBuf;
                 *rxData                  = (uint8_t*)gNfcDev.rxBuf.isoDepBuf.apdu;
@@ -844,6 +930,8 @@ ReturnCode rfalNfcDataExchangeGetStatus( void )
  * 
  * This method implements the Technology Detection / Poll for different 
  * device technologies.
+ * The passive technologies are detected one at a time in the order set by
+ * rfalNfcSchedCycleStart() for the current discovery cycle.
  * 
  * \return  RFAL_ERR_NONE         : Operation completed with no error
  * \return  RFAL_ERR_BUSY         : Operation ongoing
@@ -854,6 +942,7 @@ ReturnCode rfalNfcDataExchangeGetStatus( void )
 static ReturnCode rfalNfcPollTechDetetection( void )
 {
     ReturnCode err;
+    uint16_t   tech;
     
     err = RFAL_ERR_NONE;
     
@@ -917,251 +1006,525 @@ static ReturnCode rfalNfcPollTechDetetection( void )
 
     
     /*******************************************************************************/
-    /* Passive NFC-A Technology Detection                                          */
+    /* Passive Technology Detection, in scheduled order                            */
     /*******************************************************************************/
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_A) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_A) != 0U) )
+    tech = rfalNfcSchedNextTech();
+    if( tech == RFAL_NFC_TECH_NONE )
     {
+        return RFAL_ERR_NONE;                                                          /* All technologies performed (or skipped) */
+    }
         
+    if( tech != gNfcDev.schedTech )
+    {
+        gNfcDev.schedTech    = tech;
+        gNfcDev.schedStartUs = platformGetSysTickUs();
+    }
+
+    switch( tech )
+    {
     #if RFAL_FEATURE_NFCA
+        case RFAL_NFC_POLL_TECH_A:
+            err = rfalNfcPollTechDetectNfca();
+            break;
+    #endif /* RFAL_FEATURE_NFCA */
         
-        if( !gNfcDev.isTechInit )
+    #if RFAL_FEATURE_NFCB
+        case RFAL_NFC_POLL_TECH_B:
+            err = rfalNfcPollTechDetectNfcb();
+            break;
+    #endif /* RFAL_FEATURE_NFCB */
+
+    #if RFAL_FEATURE_NFCF
+        case RFAL_NFC_POLL_TECH_F:
+            err = rfalNfcPollTechDetectNfcf();
+            break;
+    #endif /* RFAL_FEATURE_NFCF */
+
+    #if RFAL_FEATURE_NFCV
+        case RFAL_NFC_POLL_TECH_V:
+            err = rfalNfcPollTechDetectNfcv();
+            break;
+    #endif /* RFAL_FEATURE_NFCV */
+
+    #if RFAL_FEATURE_ST25TB
+        case RFAL_NFC_POLL_TECH_ST25TB:
+            err = rfalNfcPollTechDetectSt25tb();
+            break;
+    #endif /* RFAL_FEATURE_ST25TB */
+
+        case RFAL_NFC_POLL_TECH_PROP:
+            err = rfalNfcPollTechDetectProp();
+            break;
+
+        default:
+            gNfcDev.techs2do &= ~tech;                                                 /* Technology not supported, nothing to detect */
+            return RFAL_ERR_BUSY;
+    }
+
+    if( (gNfcDev.techs2do & tech) == 0U )
+    {
+        rfalNfcSchedTechDone( tech );
+    }
+
+    return err;
+}
+
+
+#if RFAL_FEATURE_NFCA
+/*!
+ ******************************************************************************
+ * \brief Poller NFC-A Technology Detection
+ *
+ * \return  RFAL_ERR_NONE         : Bail-out after NFC-A
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or completed
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ *
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectNfca( void )
+{
+    ReturnCode err;
+
+    if( !gNfcDev.isTechInit )
+    {
+        RFAL_EXIT_ON_ERR( err, rfalNfcaPollerInitialize() );                           /* Initialize RFAL for NFC-A */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                              /* As field is already On only starts GT timer */
+        gNfcDev.isTechInit    = true;
+        gNfcDev.isOperOngoing = false;                                                 /* No operation currently ongoing  */
+    }
+
+    if( rfalIsGTExpired() )                                                            /* Wait until Guard Time is fulfilled */
+    {
+        if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcaPollerInitialize() );                       /* Initialize RFAL for NFC-A */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                          /* As field is already On only starts GT timer */
-            gNfcDev.isTechInit    = true;
-            gNfcDev.isOperOngoing = false;                                             /* No operation currently ongoing  */
+            rfalNfcaPollerStartTechnologyDetection( gNfcDev.disc.compMode, &gNfcDev.sensRes );/* Poll for NFC-A devices */
+
+            gNfcDev.isOperOngoing = true;
+            return RFAL_ERR_BUSY;
         }
         
-        if( rfalIsGTExpired() )                                                        /* Wait until Guard Time is fulfilled */
+        err = rfalNfcaPollerGetTechnologyDetectionStatus();
+        if( err != RFAL_ERR_BUSY )
         {
-            if( !gNfcDev.isOperOngoing )
-            {
-                rfalNfcaPollerStartTechnologyDetection( gNfcDev.disc.compMode, &gNfcDev.sensRes );/* Poll for NFC-A devices */
-             
-                gNfcDev.isOperOngoing = true;
-                return RFAL_ERR_BUSY;
-            }
-            
-            err = rfalNfcaPollerGetTechnologyDetectionStatus();
-            if( err != RFAL_ERR_BUSY )
+            if( err == RFAL_ERR_NONE )
             {
-                if( err == RFAL_ERR_NONE )
-                {
-                    gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_A;
-                }
-                
-                gNfcDev.isTechInit = false;
-                gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_A;
+                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_A;
             }
             
-            /* Check if bail-out after NFC-A     Activity 2.1  9.2.3.21 */
-            if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_A) != 0U) && (gNfcDev.techsFound != 0U) )
-            {
-                return RFAL_ERR_NONE;
-            }
+            gNfcDev.isTechInit = false;
+            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_A;
+        }
+        
+        /* Check if bail-out after NFC-A     Activity 2.1  9.2.3.21 */
+        if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_A) != 0U) && (gNfcDev.techsFound != 0U) )
+        {
+            return RFAL_ERR_NONE;
         }
-    
-        return RFAL_ERR_BUSY;
-
-    #endif /* RFAL_FEATURE_NFCA */
     }
     
+    return RFAL_ERR_BUSY;
+}
+#endif /* RFAL_FEATURE_NFCA */
     
-    /*******************************************************************************/
-    /* Passive NFC-B Technology Detection                                          */
-    /*******************************************************************************/
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_B) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_B) != 0U) )
+
+#if RFAL_FEATURE_NFCB
+/*!
+ ******************************************************************************
+ * \brief Poller NFC-B Technology Detection
+ *
+ * \return  RFAL_ERR_NONE         : Bail-out after NFC-B
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or completed
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ *
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectNfcb( void )
+{
+    ReturnCode err;
+
+    if( !gNfcDev.isTechInit )
     {
-    #if RFAL_FEATURE_NFCB
+        RFAL_EXIT_ON_ERR( err, rfalNfcbPollerInitialize() );                          /* Initialize RFAL for NFC-B */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                             /* As field is already On only starts GT timer */
+        gNfcDev.isTechInit    = true;
+        gNfcDev.isOperOngoing = false;                                                /* No operation currently ongoing  */
+    }
         
-        if( !gNfcDev.isTechInit )
+    if( rfalIsGTExpired() )                                                           /* Wait until Guard Time is fulfilled */
+    {
+
+        if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcbPollerInitialize() );                      /* Initialize RFAL for NFC-B */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
-            gNfcDev.isTechInit    = true;
-            gNfcDev.isOperOngoing = false;                                            /* No operation currently ongoing  */
+            rfalNfcbPollerStartTechnologyDetection( gNfcDev.disc.compMode, &gNfcDev.sensbRes, &gNfcDev.sensbResLen );/* Poll for NFC-B devices */
+
+            gNfcDev.isOperOngoing = true;
+            return RFAL_ERR_BUSY;
         }
-        
-        if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+     
+        err = rfalNfcbPollerGetTechnologyDetectionStatus();
+        if( err != RFAL_ERR_BUSY )
         {
-            
-            if( !gNfcDev.isOperOngoing )
-            {
-                rfalNfcbPollerStartTechnologyDetection( gNfcDev.disc.compMode, &gNfcDev.sensbRes, &gNfcDev.sensbResLen );/* Poll for NFC-B devices */
-             
-                gNfcDev.isOperOngoing = true;
-                return RFAL_ERR_BUSY;
-            }
-            
-            err = rfalNfcbPollerGetTechnologyDetectionStatus();
-            if( err != RFAL_ERR_BUSY )
+            if( err == RFAL_ERR_NONE )
             {
-                if( err == RFAL_ERR_NONE )
-                {
-                    gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_B;
-                }
-                
-                gNfcDev.isTechInit = false;
-                gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_B;
+                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_B;
             }
             
-            /* Check if bail-out after NFC-B     Activity 2.1  9.2.3.26 */
-            if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_B) != 0U) && (gNfcDev.techsFound != 0U) )
-            {
-                return RFAL_ERR_NONE;
-            }
-        }        
+            gNfcDev.isTechInit = false;
+            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_B;
+        }
         
-        return RFAL_ERR_BUSY;
-    
-    #endif /* RFAL_FEATURE_NFCB */
+        /* Check if bail-out after NFC-B     Activity 2.1  9.2.3.26 */
+        if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_B) != 0U) && (gNfcDev.techsFound != 0U) )
+        {
+            return RFAL_ERR_NONE;
+        }
     }
     
-    /*******************************************************************************/
-    /* Passive NFC-F Technology Detection                                          */
-    /*******************************************************************************/
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_F) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_F) != 0U) )
+    return RFAL_ERR_BUSY;
+}
+#endif /* RFAL_FEATURE_NFCB */
+
+
+#if RFAL_FEATURE_NFCF
+/*!
+ ******************************************************************************
+ * \brief Poller NFC-F Technology Detection
+ *
+ * \return  RFAL_ERR_NONE         : Bail-out after NFC-F
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or completed
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ *
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectNfcf( void )
+{
+    ReturnCode err;
+
+    if( !gNfcDev.isTechInit )
     {
-    #if RFAL_FEATURE_NFCF
-     
-        if( !gNfcDev.isTechInit )
+        RFAL_EXIT_ON_ERR( err, rfalNfcfPollerInitialize( gNfcDev.disc.nfcfBR ) );    /* Initialize RFAL for NFC-F */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                            /* As field is already On only starts GT timer */
+
+        gNfcDev.isTechInit    = true;
+        gNfcDev.isOperOngoing = false;                                               /* No operation currently ongoing  */
+    }
+
+    if( rfalIsGTExpired() )                                                          /* Wait until Guard Time is fulfilled */
+    {
+
+        if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcfPollerInitialize( gNfcDev.disc.nfcfBR ) );/* Initialize RFAL for NFC-F */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                        /* As field is already On only starts GT timer */
-            
-            gNfcDev.isTechInit    = true;
-            gNfcDev.isOperOngoing = false;                                           /* No operation currently ongoing  */
-        }
+            rfalNfcfPollerStartCheckPresence();
 
-        if( rfalIsGTExpired() )                                                      /* Wait until Guard Time is fulfilled */
+            gNfcDev.isOperOngoing = true;
+            return RFAL_ERR_BUSY;
+        }
+     
+        err = rfalNfcfPollerGetCheckPresenceStatus();                                /* Poll for NFC-F devices */
+        if( err != RFAL_ERR_BUSY )
         {
-            
-            if( !gNfcDev.isOperOngoing )
-            {
-                rfalNfcfPollerStartCheckPresence();
-             
-                gNfcDev.isOperOngoing = true;
-                return RFAL_ERR_BUSY;
-            }
-            
-            err = rfalNfcfPollerGetCheckPresenceStatus();                            /* Poll for NFC-F devices */
-            if( err != RFAL_ERR_BUSY )
+            if( err == RFAL_ERR_NONE )
             {
-                if( err == RFAL_ERR_NONE )
-                {
-                    gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_F;
-                }
-                
-                gNfcDev.isTechInit = false;
-                gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_F;
+                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_F;
             }
             
-            /* Check if bail-out after NFC-F     Activity 2.1  9.2.3.31 */
-            if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_F) != 0U) && (gNfcDev.techsFound != 0U) )
-            {
-                return RFAL_ERR_NONE;
-            }
+            gNfcDev.isTechInit = false;
+            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_F;
         }
         
-        return RFAL_ERR_BUSY;
-    
-    #endif /* RFAL_FEATURE_NFCF */
+        /* Check if bail-out after NFC-F     Activity 2.1  9.2.3.31 */
+        if( ((gNfcDev.disc.techs2Bail & RFAL_NFC_POLL_TECH_F) != 0U) && (gNfcDev.techsFound != 0U) )
+        {
+            return RFAL_ERR_NONE;
+        }
     }
     
-    
-    /*******************************************************************************/
-    /* Passive NFC-V Technology Detection                                          */
-    /*******************************************************************************/
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_V) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_V) != 0U) )
+    return RFAL_ERR_BUSY;
+}
+#endif /* RFAL_FEATURE_NFCF */
+
+
+#if RFAL_FEATURE_NFCV
+/*!
+ ******************************************************************************
+ * \brief Poller NFC-V Technology Detection
+ *
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or completed
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ *
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectNfcv( void )
+{
+    ReturnCode           err;
+    rfalNfcvInventoryRes invRes;
+
+    if( !gNfcDev.isTechInit )
     {
-    #if RFAL_FEATURE_NFCV
-        
-        rfalNfcvInventoryRes invRes;
- 
-        if( !gNfcDev.isTechInit )
+        RFAL_EXIT_ON_ERR( err, rfalNfcvPollerInitialize() );                          /* Initialize RFAL for NFC-V */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                             /* As field is already On only starts GT timer */
+        gNfcDev.isTechInit = true;
+    }
+
+    if( rfalIsGTExpired() )                                                           /* Wait until Guard Time is fulfilled */
+    {
+        err = rfalNfcvPollerCheckPresence( &invRes );                                 /* Poll for NFC-V devices */
+        if( err == RFAL_ERR_NONE )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcvPollerInitialize() );                      /* Initialize RFAL for NFC-V */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
-            gNfcDev.isTechInit = true;
+            gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_V;
         }
-                
-        if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+
+        gNfcDev.isTechInit = false;
+        gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_V;
+    }
+
+    return RFAL_ERR_BUSY;
+}
+#endif /* RFAL_FEATURE_NFCV */
+
+
+#if RFAL_FEATURE_ST25TB
+/*!
+ ******************************************************************************
+ * \brief Poller Proprietary Technology ST25TB Detection
+ *
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or completed
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ *
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectSt25tb( void )
+{
+    ReturnCode err;
+
+    if( !gNfcDev.isTechInit )
+    {
+        RFAL_EXIT_ON_ERR( err, rfalSt25tbPollerInitialize() );                        /* Initialize RFAL for NFC-V */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                             /* As field is already On only starts GT timer */
+        gNfcDev.isTechInit = true;
+    }
+
+    if( rfalIsGTExpired() )                                                           /* Wait until Guard Time is fulfilled */
+    {
+        err = rfalSt25tbPollerCheckPresence( NULL );                                  /* Poll for ST25TB devices */
+        if( err == RFAL_ERR_NONE )
         {
-            err = rfalNfcvPollerCheckPresence( &invRes );                             /* Poll for NFC-V devices */
-            if( err == RFAL_ERR_NONE )
-            {
-                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_V;
-            }
-            
-            gNfcDev.isTechInit = false;
-            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_V;
+            gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_ST25TB;
         }
-        
-        return RFAL_ERR_BUSY;
-    
-    #endif /* RFAL_FEATURE_NFCV */
+
+        gNfcDev.isTechInit = false;
+        gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_ST25TB;
     }
-    
-    
-    /*******************************************************************************/
-    /* Passive Proprietary Technology ST25TB                                       */
-    /*******************************************************************************/  
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_ST25TB) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_ST25TB) != 0U) )
+
+    return RFAL_ERR_BUSY;
+}
+#endif /* RFAL_FEATURE_ST25TB */
+
+
+/*!
+ ******************************************************************************
+ * \brief Poller Proprietary Technology Detection
+ *
+ * \return  RFAL_ERR_BUSY         : Operation ongoing or completed
+ * \return  RFAL_ERR_XXXX         : Error occurred
+ *
+ ******************************************************************************
+ */
+static ReturnCode rfalNfcPollTechDetectProp( void )
+{
+    ReturnCode err;
+
+    if( !gNfcDev.isTechInit )
     {
-    #if RFAL_FEATURE_ST25TB
-        
-        if( !gNfcDev.isTechInit )
+        RFAL_EXIT_ON_ERR( err, rfalNfcpCbPollerInitialize() );                        /* Initialize RFAL for Proprietary NFC */
+        RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                             /* As field may already be On only starts GT timer */
+        gNfcDev.isTechInit = true;
+    }
+
+    if( rfalIsGTExpired() )                                                           /* Wait until Guard Time is fulfilled */
+    {
+        err = rfalNfcpCbPollerTechnologyDetection();                                  /* Poll for devices */
+        if( err == RFAL_ERR_NONE )
         {
-            RFAL_EXIT_ON_ERR( err, rfalSt25tbPollerInitialize() );                    /* Initialize RFAL for NFC-V */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field is already On only starts GT timer */
-            gNfcDev.isTechInit = true;
+            gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_PROP;
         }
-     
-        if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+
+        gNfcDev.isTechInit = false;
+        gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_PROP;
+    }
+
+    return RFAL_ERR_BUSY;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Technology scheduler index
+ *
+ * \param[in]  tech : Poll technology Flag
+ *
+ * \return  the Flag bit position or RFAL_NFC_POLL_TECH_NUM if tech is not a
+ *          single passive Poll technology
+ *
+ ******************************************************************************
+ */
+static uint8_t rfalNfcSchedTechIdx( uint16_t tech )
+{
+    uint8_t i;
+
+    for( i = 0; i < RFAL_NFC_POLL_TECH_NUM; i++ )
+    {
+        if( (tech == (uint16_t)(1U << i)) && (tech != RFAL_NFC_POLL_TECH_AP2P) )
         {
-            err = rfalSt25tbPollerCheckPresence( NULL );                              /* Poll for ST25TB devices */
-            if( err == RFAL_ERR_NONE )
-            {
-                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_ST25TB;
-            }
-            
-            gNfcDev.isTechInit = false;
-            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_ST25TB;
+            return i;
         }
-        
-        return RFAL_ERR_BUSY;
-        
-    #endif /* RFAL_FEATURE_ST25TB */
     }
-    
-    /*******************************************************************************/
-    /* Passive Proprietary Technology                                              */
-    /*******************************************************************************/  
-    if( ((gNfcDev.disc.techs2Find & RFAL_NFC_POLL_TECH_PROP) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_PROP) != 0U) )
+
+    return RFAL_NFC_POLL_TECH_NUM;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Technology scheduler order key
+ *
+ * Static priority first then, if adaptive, the hit history: a technology
+ * found in the last cycles ranks above one found long ago.
+ *
+ * \param[in]  idx : Poll technology Flag bit position
+ *
+ * \return  order key, higher is detected first
+ *
+ ******************************************************************************
+ */
+static uint16_t rfalNfcSchedKey( uint8_t idx )
+{
+    return (uint16_t)( ((uint16_t)gNfcDev.disc.techPrio[idx] << 8U) | (gNfcDev.disc.techSchedAdaptive ? gNfcDev.sched[idx].history : 0U) );
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Technology scheduler cycle start
+ *
+ * Sets the Technology Detection order of the passive technologies still to
+ * be performed. Equal keys keep the default order A, B, F, V, ST25TB,
+ * Proprietary, so without priorities nor adaptive scheduling the order is
+ * the one of Activity 2.1.
+ * With adaptive scheduling a technology without any device found for
+ * RFAL_NFC_SCHED_IDLE_CYCLES is only detected once every
+ * RFAL_NFC_SCHED_IDLE_PERIOD cycles, staggered among technologies.
+ *
+ * \param[in]  skipIdle : idle technologies may be skipped this cycle
+ *
+ ******************************************************************************
+ */
+static void rfalNfcSchedCycleStart( bool skipIdle )
+{
+    rfalNfcSchedTech *st;
+    uint16_t         tech;
+    uint16_t         key;
+    uint8_t          i;
+    uint8_t          j;
+
+    gNfcDev.schedCycle++;
+    gNfcDev.schedTech     = RFAL_NFC_TECH_NONE;
+    gNfcDev.schedOrderLen = 0;
+
+    for( i = 0; i < RFAL_NFC_POLL_TECH_NUM; i++ )
     {
-        if( !gNfcDev.isTechInit )
+        tech = (uint16_t)(1U << i);
+        if( (tech == RFAL_NFC_POLL_TECH_AP2P) || ((gNfcDev.techs2do & tech) == 0U) )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcpCbPollerInitialize() );                    /* Initialize RFAL for Proprietary NFC */
-            RFAL_EXIT_ON_ERR( err, rfalFieldOnAndStartGT() );                         /* As field may already be On only starts GT timer */
-            gNfcDev.isTechInit = true;
+            continue;
         }
-     
-        if( rfalIsGTExpired() )                                                       /* Wait until Guard Time is fulfilled */
+
+        st = &gNfcDev.sched[i];
+        if( skipIdle && gNfcDev.disc.techSchedAdaptive && (gNfcDev.disc.techPrio[i] != RFAL_NFC_SCHED_PRIO_ALWAYS)
+            && (st->idleCycles >= RFAL_NFC_SCHED_IDLE_CYCLES) && (((gNfcDev.schedCycle + i) % RFAL_NFC_SCHED_IDLE_PERIOD) != 0U) )
         {
-            err = rfalNfcpCbPollerTechnologyDetection();                              /* Poll for devices */
-            if( err == RFAL_ERR_NONE )
-            {
-                gNfcDev.techsFound |= RFAL_NFC_POLL_TECH_PROP;
-            }
-            
-            gNfcDev.isTechInit = false;
-            gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_PROP;
+            gNfcDev.techs2do &= ~tech;
+            st->idleCycles    = ((st->idleCycles < UINT16_MAX) ? (st->idleCycles + 1U) : st->idleCycles);
+            st->stats.skips++;
+            continue;
         }
-        
-        return RFAL_ERR_BUSY;
+
+        /* Insert after all technologies with a higher or equal key */
+        key = rfalNfcSchedKey( i );
+        for( j = gNfcDev.schedOrderLen; (j > 0U) && (rfalNfcSchedKey( gNfcDev.schedOrder[j - 1U] ) < key); j-- )
+        {
+            gNfcDev.schedOrder[j] = gNfcDev.schedOrder[j - 1U];
+        }
+        gNfcDev.schedOrder[j] = i;
+        gNfcDev.schedOrderLen++;
     }
-    
-    return RFAL_ERR_NONE;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Technology scheduler next technology
+ *
+ * \return  the first technology of the cycle order still to be performed
+ *          or RFAL_NFC_TECH_NONE
+ *
+ ******************************************************************************
+ */
+static uint16_t rfalNfcSchedNextTech( void )
+{
+    uint16_t tech;
+    uint8_t  i;
+
+    for( i = 0; i < gNfcDev.schedOrderLen; i++ )
+    {
+        tech = (uint16_t)(1U << gNfcDev.schedOrder[i]);
+        if( (gNfcDev.techs2do & tech) != 0U )
+        {
+            return tech;
+        }
+    }
+
+    return RFAL_NFC_TECH_NONE;
+}
+
+
+/*!
+ ******************************************************************************
+ * \brief Technology scheduler technology done
+ *
+ * Updates the hit history and statistics once the Technology Detection of
+ * a technology has completed.
+ *
+ * \param[in]  tech : Poll technology Flag
+ *
+ ******************************************************************************
+ */
+static void rfalNfcSchedTechDone( uint16_t tech )
+{
+    rfalNfcSchedTech *st;
+    uint32_t         timeUs;
+    uint8_t          i;
+    bool             hit;
+
+    i = rfalNfcSchedTechIdx( tech );
+    if( i >= RFAL_NFC_POLL_TECH_NUM )
+    {
+        return;
+    }
+
+    st     = &gNfcDev.sched[i];
+    hit    = ((gNfcDev.techsFound & tech) != 0U);
+    timeUs = (platformGetSysTickUs() - gNfcDev.schedStartUs);
+
+    st->history    = (uint8_t)((st->history >> 1U) | (hit ? 0x80U : 0x00U));
+    st->idleCycles = (hit ? 0U : ((st->idleCycles < UINT16_MAX) ? (st->idleCycles + 1U) : st->idleCycles));
+
+    st->stats.polls++;
+    st->stats.hits        += (hit ? 1U : 0U);
+    st->stats.timeTotalUs += timeUs;
+    st->stats.timeMaxUs    = ((timeUs > st->stats.timeMaxUs) ? timeUs : st->stats.timeMaxUs);
+
+    gNfcDev.schedTech = RFAL_NFC_TECH_NONE;
 }
 
 /*!
@@ -1180,7 +1543,6 @@ static ReturnCode rfalNfcPollTechDetetection( void )
 static ReturnCode rfalNfcPollCollResolution( void )
 {
     uint8_t    i;
-    static uint8_t    devCnt;
     ReturnCode err;
     
     err    = RFAL_ERR_NONE;
@@ -1188,7 +1550,6 @@ static ReturnCode rfalNfcPollCollResolution( void )
     
     /* Suppress warning when specific RFAL features have been disabled */
     RFAL_NO_WARNING(err);
-    RFAL_NO_WARNING(devCnt);
     RFAL_NO_WARNING(i);
     
     /* Check if device limit has been reached */
@@ -1203,8 +1564,6 @@ static ReturnCode rfalNfcPollCollResolution( void )
 #if RFAL_FEATURE_NFCA
     if( ((gNfcDev.techsFound & RFAL_NFC_POLL_TECH_A) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_A) != 0U) )   /* If a NFC-A device was found/detected, perform Collision Resolution */
     {
-        static rfalNfcaListenDevice nfcaDevList[RFAL_NFC_MAX_DEVICES];
-        
         if( !gNfcDev.isTechInit )
         {
             RFAL_EXIT_ON_ERR( err, rfalNfcaPollerInitialize() );                       /* Initialize RFAL for NFC-A */
@@ -1221,7 +1580,7 @@ static ReturnCode rfalNfcPollCollResolution( void )
         
         if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcaPollerStartFullCollisionResolution( gNfcDev.disc.compMode, (gNfcDev.disc.devLimit - gNfcDev.devCnt), nfcaDevList, &devCnt ) );
+            RFAL_EXIT_ON_ERR( err, rfalNfcaPollerStartFullCollisionResolution( gNfcDev.disc.compMode, (gNfcDev.disc.devLimit - gNfcDev.devCnt), gNfcDev.collDevList.nfca, &gNfcDev.collDevCnt ) );
          
             gNfcDev.isOperOngoing = true;
             return RFAL_ERR_BUSY;
@@ -1233,12 +1592,12 @@ static ReturnCode rfalNfcPollCollResolution( void )
             gNfcDev.isTechInit = false;
             gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_A;
             
-            if( (err == RFAL_ERR_NONE) && (devCnt != 0U) )
+            if( (err == RFAL_ERR_NONE) && (gNfcDev.collDevCnt != 0U) )
             {
-                for( i=0; i<devCnt; i++ )                                                 /* Copy devices found form local Nfca list into global device list */
+                for( i=0; i<gNfcDev.collDevCnt; i++ )                                     /* Copy devices found form local Nfca list into global device list */
                 {
                     gNfcDev.devList[gNfcDev.devCnt].type     = RFAL_NFC_LISTEN_TYPE_NFCA;
-                    gNfcDev.devList[gNfcDev.devCnt].dev.nfca = nfcaDevList[i];
+                    gNfcDev.devList[gNfcDev.devCnt].dev.nfca = gNfcDev.collDevList.nfca[i];
                     gNfcDev.devCnt++;
                 }
             }
@@ -1254,8 +1613,6 @@ static ReturnCode rfalNfcPollCollResolution( void )
 #if RFAL_FEATURE_NFCB
     if( ((gNfcDev.techsFound & RFAL_NFC_POLL_TECH_B) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_B) != 0U) )   /* If a NFC-B device was found/detected, perform Collision Resolution */
     {
-        static rfalNfcbListenDevice nfcbDevList[RFAL_NFC_MAX_DEVICES];
-        
         if( !gNfcDev.isTechInit )
         {
             RFAL_EXIT_ON_ERR( err, rfalNfcbPollerInitialize());                        /* Initialize RFAL for NFC-B */
@@ -1272,7 +1629,7 @@ static ReturnCode rfalNfcPollCollResolution( void )
         
         if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcbPollerStartCollisionResolution( gNfcDev.disc.compMode, (gNfcDev.disc.devLimit - gNfcDev.devCnt), nfcbDevList, &devCnt ) );
+            RFAL_EXIT_ON_ERR( err, rfalNfcbPollerStartCollisionResolution( gNfcDev.disc.compMode, (gNfcDev.disc.devLimit - gNfcDev.devCnt), gNfcDev.collDevList.nfcb, &gNfcDev.collDevCnt ) );
          
             gNfcDev.isOperOngoing = true;
             return RFAL_ERR_BUSY;
@@ -1284,12 +1641,12 @@ static ReturnCode rfalNfcPollCollResolution( void )
             gNfcDev.isTechInit = false;
             gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_B;
             
-            if( (err == RFAL_ERR_NONE) && (devCnt != 0U) )
+            if( (err == RFAL_ERR_NONE) && (gNfcDev.collDevCnt != 0U) )
             {
-                for( i=0; i<devCnt; i++ )                                                 /* Copy devices found form local Nfcb list into global device list */
+                for( i=0; i<gNfcDev.collDevCnt; i++ )                                     /* Copy devices found form local Nfcb list into global device list */
                 {
                     gNfcDev.devList[gNfcDev.devCnt].type     = RFAL_NFC_LISTEN_TYPE_NFCB;
-                    gNfcDev.devList[gNfcDev.devCnt].dev.nfcb = nfcbDevList[i];
+                    gNfcDev.devList[gNfcDev.devCnt].dev.nfcb = gNfcDev.collDevList.nfcb[i];
                     gNfcDev.devCnt++;
                 }
             }
@@ -1305,8 +1662,6 @@ static ReturnCode rfalNfcPollCollResolution( void )
 #if RFAL_FEATURE_NFCF
     if( ((gNfcDev.techsFound & RFAL_NFC_POLL_TECH_F) != 0U) && ((gNfcDev.techs2do & RFAL_NFC_POLL_TECH_F) != 0U) )  /* If a NFC-F device was found/detected, perform Collision Resolution */
     {
-        static rfalNfcfListenDevice nfcfDevList[RFAL_NFC_MAX_DEVICES];
-        
         if( !gNfcDev.isTechInit )
         {
             RFAL_EXIT_ON_ERR( err, rfalNfcfPollerInitialize( gNfcDev.disc.nfcfBR ));   /* Initialize RFAL for NFC-F */
@@ -1323,7 +1678,7 @@ static ReturnCode rfalNfcPollCollResolution( void )
         
         if( !gNfcDev.isOperOngoing )
         {
-            RFAL_EXIT_ON_ERR( err, rfalNfcfPollerStartCollisionResolution( gNfcDev.disc.compMode, (gNfcDev.disc.devLimit - gNfcDev.devCnt), nfcfDevList, &devCnt ) );
+            RFAL_EXIT_ON_ERR( err, rfalNfcfPollerStartCollisionResolution( gNfcDev.disc.compMode, (gNfcDev.disc.devLimit - gNfcDev.devCnt), gNfcDev.collDevList.nfcf, &gNfcDev.collDevCnt ) );
          
             gNfcDev.isOperOngoing = true;
             return RFAL_ERR_BUSY;
@@ -1335,12 +1690,12 @@ static ReturnCode rfalNfcPollCollResolution( void )
             gNfcDev.isTechInit = false;
             gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_F;
             
-            if( (err == RFAL_ERR_NONE) && (devCnt != 0U) )
+            if( (err == RFAL_ERR_NONE) && (gNfcDev.collDevCnt != 0U) )
             {
-                for( i=0; i<devCnt; i++ )                                              /* Copy devices found form local Nfcf list into global device list */
+                for( i=0; i<gNfcDev.collDevCnt; i++ )                                  /* Copy devices found form local Nfcf list into global device list */
                 {
                     gNfcDev.devList[gNfcDev.devCnt].type     = RFAL_NFC_LISTEN_TYPE_NFCF;
-                    gNfcDev.devList[gNfcDev.devCnt].dev.nfcf = nfcfDevList[i];
+                    gNfcDev.devList[gNfcDev.devCnt].dev.nfcf = gNfcDev.collDevList.nfcf[i];
                     gNfcDev.devCnt++;
                 }
             }
@@ -1370,15 +1725,15 @@ static ReturnCode rfalNfcPollCollResolution( void )
             return RFAL_ERR_BUSY;
         }
         
-        devCnt             = 0;
+        gNfcDev.collDevCnt = 0;
         gNfcDev.isTechInit = false;
         gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_V;
         
         
-        err = rfalNfcvPollerCollisionResolution( RFAL_COMPLIANCE_MODE_NFC, (gNfcDev.disc.devLimit - gNfcDev.devCnt), nfcvDevList, &devCnt );
-        if( (err == RFAL_ERR_NONE) && (devCnt != 0U) )
+        err = rfalNfcvPollerCollisionResolution( RFAL_COMPLIANCE_MODE_NFC, (gNfcDev.disc.devLimit - gNfcDev.devCnt), nfcvDevList, &gNfcDev.collDevCnt );
+        if( (err == RFAL_ERR_NONE) && (gNfcDev.collDevCnt != 0U) )
         {
-            for( i=0; i<devCnt; i++ )                                                 /* Copy devices found form local Nfcf list into global device list */
+            for( i=0; i<gNfcDev.collDevCnt; i++ )                                     /* Copy devices found form local Nfcf list into global device list */
             {
                 gNfcDev.devList[gNfcDev.devCnt].type     = RFAL_NFC_LISTEN_TYPE_NFCV;
                 gNfcDev.devList[gNfcDev.devCnt].dev.nfcv = nfcvDevList[i];
@@ -1410,15 +1765,15 @@ static ReturnCode rfalNfcPollCollResolution( void )
             return RFAL_ERR_BUSY;
         }
         
-        devCnt             = 0;
+        gNfcDev.collDevCnt = 0;
         gNfcDev.isTechInit = false;
         gNfcDev.techs2do  &= ~RFAL_NFC_POLL_TECH_ST25TB;
         
         
-        err = rfalSt25tbPollerCollisionResolution( (gNfcDev.disc.devLimit - gNfcDev.devCnt), st25tbDevList, &devCnt );
-        if( (err == RFAL_ERR_NONE) && (devCnt != 0U) )
+        err = rfalSt25tbPollerCollisionResolution( (gNfcDev.disc.devLimit - gNfcDev.devCnt), st25tbDevList, &gNfcDev.collDevCnt );
+        if( (err == RFAL_ERR_NONE) && (gNfcDev.collDevCnt != 0U) )
         {
-            for( i=0; i<devCnt; i++ )                                                 /* Copy devices found form local Nfcf list into global device list */
+            for( i=0; i<gNfcDev.collDevCnt; i++ )                                     /* Copy devices found form local Nfcf list into global device list */
             {
                 gNfcDev.devList[gNfcDev.devCnt].type       = RFAL_NFC_LISTEN_TYPE_ST25TB;
                 gNfcDev.devList[gNfcDev.devCnt].dev.st25tb = st25tbDevList[i];
@@ -1620,7 +1975,7 @@ static ReturnCode rfalNfcPollActivation( uint8_t devIt )
                     {
                         /* Perform ISO-DEP (ISO14443-4) activation: RATS and PPS if supported */
                         rfalIsoDepInitializeWithParams( gNfcDev.disc.compMode, RFAL_ISODEP_MAX_R_RETRYS, RFAL_ISODEP_MAX_WTX_NACK_RETRYS, RFAL_ISODEP_MAX_WTX_RETRYS, RFAL_ISODEP_MAX_DSL_RETRYS, RFAL_ISODEP_MAX_I_RETRYS, RFAL_ISODEP_RATS_RETRIES);
-                        RFAL_EXIT_ON_ERR( err, rfalIsoDepPollAStartActivation( gNfcDev.disc.isoDepFS, RFAL_ISODEP_NO_DID, gNfcDev.disc.maxBR, &gNfcDev.devList[devIt].proto.isoDep ) );
+                        RFAL_EXIT_ON_ERR( err, rfalIsoDepPollAStartActivation( gNfcDev.disc.isoDepFS, RFAL_ISODEP_NO_DID, rfalNfcIsoDepMaxBR( &gNfcDev.devList[devIt] ), &gNfcDev.devList[devIt].proto.isoDep ) );
                         
                         gNfcDev.isOperOngoing = true;
                         return RFAL_ERR_BUSY;
@@ -1704,7 +2059,7 @@ static ReturnCode rfalNfcPollActivation( uint8_t devIt )
                 {
                     rfalIsoDepInitializeWithParams( gNfcDev.disc.compMode, RFAL_ISODEP_MAX_R_RETRYS, RFAL_ISODEP_MAX_WTX_NACK_RETRYS, RFAL_ISODEP_MAX_WTX_RETRYS, RFAL_ISODEP_MAX_DSL_RETRYS, RFAL_ISODEP_MAX_I_RETRYS, RFAL_ISODEP_RATS_RETRIES);
                     /* Perform ISO-DEP (ISO14443-4) activation: ATTRIB    */
-                    RFAL_EXIT_ON_ERR( err, rfalIsoDepPollBStartActivation( gNfcDev.disc.isoDepFS, RFAL_ISODEP_NO_DID, gNfcDev.disc.maxBR, 0x00, &gNfcDev.devList[devIt].dev.nfcb, NULL, 0, &gNfcDev.devList[devIt].proto.isoDep ) );
+                    RFAL_EXIT_ON_ERR( err, rfalIsoDepPollBStartActivation( gNfcDev.disc.isoDepFS, RFAL_ISODEP_NO_DID, rfalNfcIsoDepMaxBR( &gNfcDev.devList[devIt] ), 0x00, &gNfcDev.devList[devIt].dev.nfcb, NULL, 0, &gNfcDev.devList[devIt].proto.isoDep ) );
                     
                     gNfcDev.isOperOngoing = true;
                     return RFAL_ERR_BUSY;
@@ -2052,6 +2407,36 @@ static ReturnCode rfalNfcListenActivation( void )
 #endif /* RFAL_FEATURE_LISTEN_MODE */
 
 
+/*!
+ ******************************************************************************
+ * \brief Poller ISO-DEP max bit rate
+ * 
+ * Returns the max bit rate for the ISO-DEP activation (PPS/ATTRIB) of the 
+ * given device: the one of rfalNfcDiscoverParam.maxBRCb if set and valid,
+ * rfalNfcDiscoverParam.maxBR otherwise
+ *  
+ * \param[in]  device    : device about to be activated, NFCID already set
+ * 
+ * \return  the max bit rate
+ * 
+ ******************************************************************************
+ */
+#if RFAL_FEATURE_ISO_DEP && RFAL_FEATURE_ISO_DEP_POLL
+static rfalBitRate rfalNfcIsoDepMaxBR( const rfalNfcDevice *device )
+{
+    rfalBitRate br;
+    
+    if( gNfcDev.disc.maxBRCb == NULL )
+    {
+        return gNfcDev.disc.maxBR;
+    }
+    
+    br = gNfcDev.disc.maxBRCb( device );
+    return ( ((br > RFAL_BR_1695) && (br != RFAL_BR_KEEP)) ? gNfcDev.disc.maxBR : br );
+}
+#endif /* RFAL_FEATURE_ISO_DEP_POLL */
+
+
 /*!
  ******************************************************************************
  * \brief Poller NFC DEP Activate
@@ -2274,7 +2659,7 @@ static ReturnCode rfalNfcDeactivation( void )
             if( (gNfcDev.isFieldOn) && rfalNfcHasPollerTechs() )                                 /* Check if configured to Poll modes and the Field is On */
             {
                 aux = platformTimerIsExpired(gNfcDev.discTmr);                                   /* Check total duration timer is already expired */
-                if( ((platformGetSysTick() + RFAL_NFC_T_FIELD_OFF) > gNfcDev.discTmr) || (aux) ) /* In case Total Duration has expired or expring in less than tFIELD_OFF */
+                if( ((uint32_t)platformTimerCreate( RFAL_NFC_T_FIELD_OFF ) > gNfcDev.discTmr) || (aux) ) /* In case Total Duration has expired or expring in less than tFIELD_OFF */
                 {
                     platformTimerDestroy( gNfcDev.discTmr );
                     gNfcDev.discTmr = (uint32_t)platformTimerCreate( RFAL_NFC_T_FIELD_OFF );     /* Ensure that Operating Field is in Off condition at least tFIELD_OFF */
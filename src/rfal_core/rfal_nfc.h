@@ -89,6 +89,19 @@
 #define RFAL_NFC_LISTEN_TECH_F           0x4000U  /*!< Listen NFC-F technology Flag      */
 #define RFAL_NFC_LISTEN_TECH_AP2P        0x8000U  /*!< Listen AP2P technology Flag       */
 
+#define RFAL_NFC_POLL_TECH_NUM           7U       /*!< Number of Poll technology Flags, rfalNfcDiscoverParam.techPrio size */
+
+#define RFAL_NFC_SCHED_PRIO_NONE         0x00U    /*!< No static priority, ordered by hit history only     */
+#define RFAL_NFC_SCHED_PRIO_ALWAYS       0xFFU    /*!< Highest static priority, never skipped when idle    */
+
+#ifndef RFAL_NFC_SCHED_IDLE_CYCLES
+#define RFAL_NFC_SCHED_IDLE_CYCLES       8U       /*!< Cycles without a device before a technology is idle */
+#endif
+
+#ifndef RFAL_NFC_SCHED_IDLE_PERIOD
+#define RFAL_NFC_SCHED_IDLE_PERIOD       4U       /*!< An idle technology is polled once every n cycles    */
+#endif
+
 
 /*
 ******************************************************************************
@@ -126,6 +139,7 @@
                                         ((rfalNfcDiscoverParam*)(dp))->totalDuration          = 1000U;                    \
                                         ((rfalNfcDiscoverParam*)(dp))->techs2Find             = RFAL_NFC_TECH_NONE;       \
                                         ((rfalNfcDiscoverParam*)(dp))->techs2Bail             = RFAL_NFC_TECH_NONE;       \
+                                        ((rfalNfcDiscoverParam*)(dp))->techSchedAdaptive      = false;                    \
                                         }
 
 /*
@@ -239,6 +253,7 @@ typedef struct{
     uint16_t               totalDuration;                    /*!< Duration of a whole Poll + Listen cycle        NCI 2.1 Table 46    */
     uint8_t                devLimit;                         /*!< Max number of devices                      Activity 2.1  Table 11  */
     rfalBitRate            maxBR;                            /*!< Max Bit rate to be used                        NCI 2.1  Table 28   */
+    rfalBitRate            (*maxBRCb)( const rfalNfcDevice *dev ); /*!< ISO-DEP max Bit rate per device, overrides maxBR (NULL: maxBR) */
                                                                                                                    
     rfalBitRate            nfcfBR;                           /*!< Bit rate to poll for NFC-F                     NCI 2.1  Table 27   */
     uint8_t                nfcid3[RFAL_NFCDEP_NFCID3_LEN];   /*!< NFCID3 to be used on the ATR_REQ/ATR_RES                           */
@@ -261,9 +276,22 @@ typedef struct{
     bool                   wakeupConfigDefault;              /*!< Wake-Up mode default configuration                                 */
     rfalWakeUpConfig       wakeupConfig;                     /*!< Wake-Up mode configuration                                         */
     uint16_t               wakeupNPolls;                     /*!< Number of polling cycles before entering Wake-up                   */
+
+    bool                   techSchedAdaptive;                /*!< Order by hit history and poll idle technologies less often         */
+    uint8_t                techPrio[RFAL_NFC_POLL_TECH_NUM]; /*!< Static priority per Poll technology, indexed by its Flag bit position */
 }rfalNfcDiscoverParam;
 
 
+/*! Technology Detection statistics of a Poll technology                                                                            */
+typedef struct{
+    uint32_t               polls;                            /*!< Technology Detections performed                                    */
+    uint32_t               hits;                             /*!< Technology Detections that found a device                          */
+    uint32_t               skips;                            /*!< Cycles skipped as idle technology                                  */
+    uint32_t               timeTotalUs;                      /*!< Time spent, mode setting and GT included                           */
+    uint32_t               timeMaxUs;                        /*!< Longest Technology Detection                                       */
+}rfalNfcTechStats;
+
+
 /*! Buffer union, only one interface is used at a time                                                             */
 typedef union{  /*  PRQA S 0750 # MISRA 19.2 - Members of the union will not be used concurrently, only one interface at a time */
     uint8_t                  rfBuf[RFAL_FEATURE_NFC_RF_BUF_LEN]; /*!< RF buffer                                    */
@@ -356,6 +384,24 @@ rfalNfcState rfalNfcGetState( void );
 ReturnCode rfalNfcGetDevicesFound( rfalNfcDevice **devList, uint8_t *devCnt );
 
 
+/*!
+ *****************************************************************************
+ * \brief  RFAL NFC Get Technology Statistics
+ *  
+ * It returns the Technology Detection statistics of a Poll technology 
+ * since rfalNfcInitialize(), see rfalNfcDiscoverParam.techSchedAdaptive
+ *
+ * \param[in]   tech             : single Poll technology Flag, 
+ *                                 RFAL_NFC_POLL_TECH_AP2P not included
+ * \param[out]  stats            : statistics location
+ *
+ * \return RFAL_ERR_PARAM        : Invalid parameters
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalNfcGetTechStats( uint16_t tech, rfalNfcTechStats *stats );
+
+
 /*!
  *****************************************************************************
  * \brief  RFAL NFC Get Active Device
@@ -362,7 +362,8 @@ typedef struct{
  ******************************************************************************
  */
 
-static rfalNfcDep gNfcip;                    /*!< NFCIP module instance                         */
+static rfalNfcDep gNfcipInstances[RFAL_INSTANCES];   /*!< NFCIP module instances                        */
+#define gNfcip RFAL_INSTANCE(gNfcipInstances)
 
 
 /*
@@ -203,7 +203,8 @@ typedef struct{
 * LOCAL VARIABLES
 ******************************************************************************
 */
-static rfalNfca gNfca;  /*!< RFAL NFC-A instance  */
+static rfalNfca gNfcaInstances[RFAL_INSTANCES];  /*!< RFAL NFC-A instances  */
+#define gNfca RFAL_INSTANCE(gNfcaInstances)
 
 /*
 ******************************************************************************
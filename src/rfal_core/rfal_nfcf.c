@@ -150,7 +150,8 @@ typedef struct
 * LOCAL VARIABLES
 ******************************************************************************
 */
-static rfalNfcf gNfcf;  /*!< RFAL NFC-F instance  */
+static rfalNfcf gNfcfInstances[RFAL_INSTANCES];  /*!< RFAL NFC-F instances  */
+#define gNfcf RFAL_INSTANCE(gNfcfInstances)
 
 
 /*
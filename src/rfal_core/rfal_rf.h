@@ -183,7 +183,7 @@
 #define rfalConvBytesToBits( n )             (uint32_t)( (uint32_t)(n) * (RFAL_BITS_IN_BYTE) )                           /*!< Converts the given n from bytes to bits    */
 
 
-#define rfalRunBlocking( e, fn )              do{ (e)=(fn); rfalWorker(); }while( (e) == RFAL_ERR_BUSY )                      /*!< Macro used for the blocking methods        */
+#define rfalRunBlocking( e, fn )              do{ (e)=(fn); rfalWorker(); rfalWorkerWait(); }while( (e) == RFAL_ERR_BUSY )   /*!< Macro used for the blocking methods        */
 
 
 /*! Computes a Transceive context \a ctx with default flags and the lengths 
@@ -390,6 +390,32 @@ typedef enum {
 } rfalEHandling;
 
 
+/*! RFAL FIFO water level policy, see rfalSetFifoWaterLevel()                                                                               */
+typedef enum {
+    RFAL_FIFO_WL_AUTO                = 0,         /*!< Chosen on every transceive from the bit rates, the SPI clock and the IRQ latency       */
+    RFAL_FIFO_WL_MARGIN              = 1,         /*!< Most headroom: Tx WL with 32 bytes left in the FIFO, Rx WL with 64 bytes received      */
+    RFAL_FIFO_WL_BULK                = 2          /*!< Fewest WL interrupts: Tx WL with 16 bytes left in the FIFO, Rx WL with 80 bytes received */
+} rfalFifoWlPolicy;
+
+
+/*! RFAL FIFO water level configuration                                                                     */
+typedef struct {
+    rfalFifoWlPolicy      policy;                 /*!< Water level policy                                   */
+    uint32_t              spiClockHz;             /*!< SPI clock (RFAL_FIFO_WL_AUTO)                        */
+    uint16_t              irqLatencyUs;           /*!< IRQ line to worker, worst case (RFAL_FIFO_WL_AUTO)   */
+} rfalFifoWlConfig;
+
+
+/*! RFAL FIFO counters, see rfalGetFifoStats()                                                              */
+typedef struct {
+    uint32_t              transceives;            /*!< Transceives started                                  */
+    uint32_t              wlIrqsTx;               /*!< Tx water level IRQs, i.e. FIFO refills               */
+    uint32_t              wlIrqsRx;               /*!< Rx water level IRQs, i.e. FIFO reads before RXE      */
+    uint32_t              underflows;             /*!< Tx ended before the whole frame was loaded           */
+    uint32_t              overflows;              /*!< Rx bytes lost on a full FIFO                         */
+} rfalFifoStats;
+
+
 /*! Struct that holds all context to be used on a Transceive                                                */
 typedef struct {
     uint8_t*              txBuf;                  /*!< (In)  Buffer where outgoing message is located       */
@@ -793,6 +819,55 @@ void rfalSetErrorHandling( rfalEHandling eHandling );
 rfalEHandling rfalGetErrorHandling( void );
 
 
+/*! 
+ *****************************************************************************
+ * \brief Set FIFO Water Level policy
+ *  
+ * Selects when the ST25R391x raises the FIFO water level interrupt while a
+ * frame longer than the FIFO is transmitted or received. A water level
+ * close to the FIFO limits means fewer interrupts and larger SPI transfers
+ * but less time to serve the interrupt before the FIFO runs empty (Tx) or
+ * full (Rx). RFAL_FIFO_WL_AUTO picks the fewest interrupts whenever the
+ * remaining 16 bytes last longer on air, at the current bit rate, than the
+ * IRQ latency plus the SPI bytes needed to reach the FIFO.
+ *
+ * Applied from the next transceive on.
+ *
+ * \param[in]  config : policy, SPI clock and IRQ latency
+ *
+ * \return RFAL_ERR_PARAM : Invalid policy, or no SPI clock for RFAL_FIFO_WL_AUTO
+ * \return RFAL_ERR_NONE  : No error
+ *****************************************************************************
+ */
+ReturnCode rfalSetFifoWaterLevel( const rfalFifoWlConfig* config );
+
+
+/*! 
+ *****************************************************************************
+ * \brief Get FIFO Water Level policy
+ *  
+ * \param[out]  config : current policy, SPI clock and IRQ latency
+ *****************************************************************************
+ */
+void rfalGetFifoWaterLevel( rfalFifoWlConfig* config );
+
+
+/*! 
+ *****************************************************************************
+ * \brief Get FIFO counters
+ *  
+ * Water level interrupts and FIFO under/overflows of the last (or ongoing)
+ * transceive and since rfalInitialize(). An underflow ends the transceive
+ * with RFAL_ERR_IO, as before; an overflow with RFAL_ERR_FIFO: the bytes 
+ * lost are not covered by the CRC check of the ST25R391x.
+ *
+ * \param[out]  lastTxRx : counters of the last transceive, NULL if not needed
+ * \param[out]  total    : counters since initialization, NULL if not needed
+ *****************************************************************************
+ */
+void rfalGetFifoStats( rfalFifoStats* lastTxRx, rfalFifoStats* total );
+
+
 /*! 
  *****************************************************************************
  * \brief Set Observation Mode
@@ -1110,6 +1185,23 @@ bool rfalIsTransceiveSubcDetected( void );
 void rfalWorker( void );
 
 
+/*! 
+ *****************************************************************************
+ *  \brief RFAL Worker Wait
+ *  
+ *  Blocks the caller while the ongoing Transceive is waiting for an 
+ *  interrupt or a SW timer, until a new interrupt is read or at most 
+ *  a few ms, so that blocking methods do not spin on rfalWorker().
+ *  With no Transceive ongoing it blocks until the Guard Time started by
+ *  rfalFieldOnAndStartGT() has expired, if it is still running.
+ *  Returns at once if the Transceive can progress or the platform
+ *  does not provide platformIrqST25RWait()
+ *
+ *****************************************************************************
+ */
+void rfalWorkerWait( void );
+
+
 /*****************************************************************************
  *  ISO1443A                                                                 *  
  *****************************************************************************/
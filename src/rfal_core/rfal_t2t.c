@@ -79,6 +79,7 @@
 typedef enum
 {
     RFAL_T2T_CMD_READ           = 0x30,     /*!< T2T Read                                */
+    RFAL_T2T_CMD_FAST_READ      = 0x3A,     /*!< NTAG Fast Read (proprietary)            */
     RFAL_T2T_CMD_WRITE          = 0xA2,     /*!< T2T Write                               */
     RFAL_T2T_CMD_SECTOR_SELECT  = 0xC2      /*!< T2T Sector Select                       */
 } rfalT2Tcmds;
@@ -92,6 +93,15 @@ typedef struct
 } rfalT2TReadReq;
 
 
+ /*! NFC-A T2T FAST READ  NTAG21x datasheet 10.3 */
+typedef struct
+{
+    uint8_t code;                           /*!< Command code                            */
+    uint8_t startBlNo;                      /*!< First block number                      */
+    uint8_t endBlNo;                        /*!< Last block number                       */
+} rfalT2TFastReadReq;
+
+
  /*! NFC-A T2T WRITE    T2T 1.0 5.3 and table 12 */
 typedef struct
 {
@@ -149,6 +159,33 @@ typedef struct
  }
  
  
+ /*******************************************************************************/
+ ReturnCode rfalT2TPollerFastRead( uint8_t startBlock, uint8_t endBlock, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t *rcvLen )
+ {
+    ReturnCode          ret;
+    rfalT2TFastReadReq  req;
+     
+    if( (rxBuf == NULL) || (rcvLen == NULL) || (startBlock > endBlock) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    req.code      = (uint8_t)RFAL_T2T_CMD_FAST_READ;
+    req.startBlNo = startBlock;
+    req.endBlNo   = endBlock;
+    
+    /* Transceive Command */
+    ret = rfalTransceiveBlockingTxRx( (uint8_t*)&req, sizeof(rfalT2TFastReadReq), rxBuf, rxBufLen, rcvLen, RFAL_TXRX_FLAGS_DEFAULT, RFAL_FDT_POLL_READ_MAX );
+    
+    /* A NACK (invalid range, or no FAST_READ support) is treated as a Protocol Error, as for READ */
+    if( (ret == RFAL_ERR_INCOMPLETE_BYTE) && (*rcvLen == RFAL_T2T_ACK_NACK_LEN) && ((*rxBuf & RFAL_T2T_ACK_MASK) != RFAL_T2T_ACK) )
+    {
+        return RFAL_ERR_PROTO;
+    }
+    return ret;
+ }
+ 
+ 
  /*******************************************************************************/
  ReturnCode rfalT2TPollerWrite( uint8_t blockNum, const uint8_t* wrData )
  {
@@ -102,6 +102,32 @@
 ReturnCode rfalT2TPollerRead( uint8_t blockNum, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t *rcvLen );
 
 
+/*! 
+ *****************************************************************************
+ * \brief  NFC-A T2T Poller Fast Read
+ *  
+ * This method sends a FAST_READ command (NTAG21x, proprietary) to a NFC-A 
+ * T2T Listener device: the blocks from startBlock to endBlock, both 
+ * included, come in a single response.
+ * A tag without FAST_READ answers with a NACK and goes back to IDLE.
+ *
+ *
+ * \param[in]   startBlock       : Number of the first block to read
+ * \param[in]   endBlock         : Number of the last block to read
+ * \param[out]  rxBuf            : pointer to place the read data
+ * \param[in]   rxBufLen         : size of rxBuf, 
+ *                                 (endBlock - startBlock + 1) * RFAL_T2T_BLOCK_LEN
+ * \param[out]  rcvLen           : actual received data
+ * 
+ * \return RFAL_ERR_WRONG_STATE  : RFAL not initialized or mode not set
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_PROTO        : Protocol error (NACK)
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalT2TPollerFastRead( uint8_t startBlock, uint8_t endBlock, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t *rcvLen );
+
+
 /*! 
  *****************************************************************************
  * \brief  NFC-A T2T Poller Write
@@ -307,6 +307,32 @@ ReturnCode rfalT4TPollerComposeReadData( rfalIsoDepApduBufFormat *cApduBuf, uint
 }
 
 
+/*******************************************************************************/ 
+ReturnCode rfalT4TPollerComposeReadDataExt( rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, uint32_t expLen, uint16_t *cApduLen )
+{
+    uint16_t msgIt;
+    
+    if( (cApduBuf == NULL) || (cApduLen == NULL) || (expLen == 0U) || (expLen > RFAL_T4T_LE_EXT_MAX) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    /* CLA INS P1  P2   Le                 */
+    /* 00h B0h [Offset] 00h [len]  (65536: 0000h) */
+    msgIt = 0;
+    cApduBuf->apdu[msgIt++] = RFAL_T4T_CLA;
+    cApduBuf->apdu[msgIt++] = (uint8_t)RFAL_T4T_INS_READBINARY;
+    cApduBuf->apdu[msgIt++] = (uint8_t)((offset >> 8U) & 0xFFU);
+    cApduBuf->apdu[msgIt++] = (uint8_t)((offset >> 0U) & 0xFFU);
+    cApduBuf->apdu[msgIt++] = 0x00U;
+    cApduBuf->apdu[msgIt++] = (uint8_t)((expLen >> 8U) & 0xFFU);
+    cApduBuf->apdu[msgIt++] = (uint8_t)((expLen >> 0U) & 0xFFU);
+    
+    *cApduLen = msgIt;
+    return RFAL_ERR_NONE;
+}
+
+
 /*******************************************************************************/ 
 ReturnCode rfalT4TPollerComposeReadDataODO( rfalIsoDepApduBufFormat *cApduBuf, uint32_t offset, uint8_t expLen, uint16_t *cApduLen )
 {    
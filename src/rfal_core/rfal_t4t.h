@@ -70,6 +70,8 @@
 #define RFAL_T4T_MAX_CAPDU_PROLOGUE_LEN                          4U                          /*!< Command-APDU prologue length (CLA INS P1 P2)                    */
 #define RFAL_T4T_LE_LEN                                          1U                          /*!< Le Expected Response Length (short field coding)                */
 #define RFAL_T4T_LC_LEN                                          1U                          /*!< Lc Data field length  (short field coding)                      */
+#define RFAL_T4T_LE_EXT_LEN                                      3U                          /*!< Le Expected Response Length (extended field coding, no Lc)      */
+#define RFAL_T4T_LE_EXT_MAX                                      65536UL                     /*!< Largest extended Le, coded as 0000h                             */
 #define RFAL_T4T_MAX_RAPDU_SW1SW2_LEN                            2U                          /*!< SW1 SW2 length                                                  */
 #define RFAL_T4T_CLA                                          0x00U                          /*!< Class byte (contains 00h because secure message are not used)   */
 
@@ -278,6 +280,31 @@ ReturnCode rfalT4TPollerComposeSelectFileV1Mapping( rfalIsoDepApduBufFormat *cAp
  */
 ReturnCode rfalT4TPollerComposeReadData( rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, uint8_t expLen, uint16_t *cApduLen );
 
+/*! 
+ *****************************************************************************
+ * \brief  T4T Compose Read Data APDU with extended Le
+ *  
+ * This method computes a Read Data APDU with an extended field coded Le 
+ * (ISO7816-4 5.1: 00h followed by two bytes) which asks for up to 65536 
+ * bytes at once. Only to be used with a T4T that supports the extended field
+ * coding, i.e. whose CC announces a MLe above 255 (T4T 3.0)
+ *
+ * To transceive the formed APDU the ISO-DEP layer shall be used
+ *
+ * \see rfalIsoDepStartApduTransceive()
+ * \see rfalIsoDepGetApduTransceiveStatus()
+ * 
+ * \param[out]     cApduBuf : buffer where the C-APDU will be placed
+ * \param[in]      offset   : File offset
+ * \param[in]      expLen   : Expected length (Le), 1 .. RFAL_T4T_LE_EXT_MAX
+ * \param[out]     cApduLen : Composed C-APDU length
+ * 
+ * \return RFAL_ERR_PARAM        : Invalid parameter
+ * \return RFAL_ERR_NONE         : No error
+ *****************************************************************************
+ */
+ReturnCode rfalT4TPollerComposeReadDataExt( rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, uint32_t expLen, uint16_t *cApduLen );
+
 /*! 
  *****************************************************************************
  * \brief  T4T Compose Read Data ODO APDU
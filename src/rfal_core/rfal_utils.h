@@ -161,6 +161,8 @@ static inline int32_t RFAL_BYTECMP(void *s1, const void *s2, uint32_t n)    { re
 
 #define RFAL_NO_WARNING(v)      ((void) (v)) /*!< Macro to suppress compiler warning */
 
+#define RFAL_INSTANCE(inst)     ((inst)[platformGetInstance()]) /*!< Module context of the ST25R3911 the caller works with, see RFAL_INSTANCES */
+
 
 #ifndef NULL
   #define NULL (void*)0                 /*!< represents a NULL pointer */
@@ -43,7 +43,9 @@
 #include "st25r3911.h"
 #include "st25r3911_com.h"
 #include "st25r3911_interrupt.h"
+#include "st25r3911_trace.h"
 #include "../rfal_analogConfig.h"
+#include "../rfal_dpo.h"
 #include "../rfal_iso15693_2.h"
 
 /*
@@ -147,6 +149,11 @@ typedef struct{
     uint16_t                bytesTotal;  /*!< Total bytes to be transmitted OR the total bytes received                                  */
     uint16_t                bytesWritten;/*!< Amount of bytes already written on FIFO (Tx) OR read (RX) from FIFO and written on rxBuffer*/
     uint8_t                 status[ST25R3911_FIFO_STATUS_LEN];   /*!< FIFO Status Registers                                              */
+    rfalFifoWlConfig        wl;          /*!< Water level policy                                                                         */
+    uint8_t                 wlRegBits;   /*!< fifo_lt and fifo_lr bits currently set on the ST25R3911                                    */
+    uint16_t                noRxeTout;   /*!< Missing RXE timeout in ms, above the time the Rx WL takes to fill at the current bit rate  */
+    rfalFifoStats           stats;       /*!< Counters since initialization                                                              */
+    rfalFifoStats           statsTxRx;   /*!< Counters at the start of the last transceive                                               */
 } rfalFIFO;
 
 
@@ -274,6 +281,20 @@ typedef enum
 #define RFAL_FIFO_OUT_LT_32             (ST25R3911_FIFO_DEPTH - RFAL_FIFO_IN_LT_32)    /*!< Number of bytes sent/out of the FIFO when WL interrupt occurs while Tx ( fifo_lt: 0 ) */
 #define RFAL_FIFO_OUT_LT_16             (ST25R3911_FIFO_DEPTH - RFAL_FIFO_IN_LT_16)    /*!< Number of bytes sent/out of the FIFO when WL interrupt occurs while Tx ( fifo_lt: 1 ) */
 
+#define RFAL_FIFO_IN_LR_64              64U                                            /*!< Number of bytes in the FIFO when WL interrupt occurs while Rx ( fifo_lr: 0 )    */
+#define RFAL_FIFO_IN_LR_80              80U                                            /*!< Number of bytes in the FIFO when WL interrupt occurs while Rx ( fifo_lr: 1 )    */
+
+#define RFAL_FIFO_WL_SPI_BYTES          8U                                             /*!< SPI bytes from a WL interrupt to the first FIFO byte moved: IRQ status 4, FIFO status 3, FIFO command 1 */
+#define RFAL_FIFO_WL_BYTE_US_106        75U                                            /*!< FIFO byte (8 bits) on air at 106kbps in us, halved per bit rate step            */
+
+#ifndef RFAL_FIFO_WL_SPI_CLOCK_HZ
+#define RFAL_FIFO_WL_SPI_CLOCK_HZ       6000000U                                       /*!< Default SPI clock of the water level policy, platform overridable               */
+#endif /* RFAL_FIFO_WL_SPI_CLOCK_HZ */
+
+#ifndef RFAL_FIFO_WL_IRQ_LATENCY_US
+#define RFAL_FIFO_WL_IRQ_LATENCY_US     100U                                           /*!< Default IRQ latency of the water level policy, platform overridable             */
+#endif /* RFAL_FIFO_WL_IRQ_LATENCY_US */
+
 #define RFAL_FIFO_STATUS_REG1           0U                                             /*!< Location of FIFO status register 1 in local copy                                */
 #define RFAL_FIFO_STATUS_REG2           1U                                             /*!< Location of FIFO status register 2 in local copy                                */
 #define RFAL_FIFO_STATUS_INVALID        0xFFU                                          /*!< Value indicating that the local FIFO status in invalid|cleared                  */
@@ -293,6 +314,7 @@ typedef enum
 #define RFAL_EMVCO_RX_MAXLEN            (uint8_t)4U                                    /*!< Maximum value where EMVCo to apply special error handling                       */
 #define RFAL_EMVCO_RX_MINLEN            (uint8_t)2U                                    /*!< Minimum value where EMVCo to apply special error handling                       */
 
+#define RFAL_ST25R3911_IRQ_WAIT_SLICE   1U                                             /*!< Max time to block in a transceive wait state before rerunning the worker (SW timers) */
 #define RFAL_NORXE_TOUT                 10U                                            /*!< Timeout to be used on a potential missing RXE - Silicon ST25R3911B Errata #1.1  */
 
 #define RFAL_ISO14443A_SDD_RES_LEN      5U                                             /*!< SDD_RES | Anticollision (UID CLn) length  -  rfalNfcaSddRes                     */
@@ -418,7 +440,13 @@ typedef enum
  ******************************************************************************
  */
 
-static rfal gRFAL;              /*!< RFAL module instance               */
+static rfal gRFALInstances[RFAL_INSTANCES];  /*!< RFAL module instances, one per ST25R3911 */
+#define gRFAL RFAL_INSTANCE(gRFALInstances)
+
+static st25r3911RegBatch gRegBatchInstances[RFAL_INSTANCES];     /*!< Register writes held back by rfalChipRegBatchStart() */
+static bool gRegBatchActiveInstances[RFAL_INSTANCES];            /*!< Register write batch started                         */
+#define gRegBatch       RFAL_INSTANCE(gRegBatchInstances)
+#define gRegBatchActive RFAL_INSTANCE(gRegBatchActiveInstances)
 
 /*
 ******************************************************************************
@@ -447,6 +475,8 @@ static bool rfalFIFOStatusIsMissingPar( void );
 static bool rfalFIFOStatusIsIncompleteByte( void );
 static uint8_t rfalFIFOStatusGetNumBytes( void );
 static uint8_t rfalFIFOGetNumIncompleteBits( void );
+static void rfalFIFOWaterLevelApply( void );
+static uint16_t rfalFIFOByteTimeUs( rfalBitRate br, bool rx );
 
 /*
 ******************************************************************************
@@ -459,6 +489,8 @@ ReturnCode rfalInitialize( void )
 {
     ReturnCode err;
 
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_INIT );
+    
     /* Initialize chip */
     RFAL_EXIT_ON_ERR( err, st25r3911Initialize() );
     
@@ -476,9 +508,17 @@ ReturnCode rfalInitialize( void )
     rfalSetAnalogConfig( (RFAL_ANALOG_CONFIG_TECH_CHIP | RFAL_ANALOG_CONFIG_CHIP_INIT) );
 
     /*******************************************************************************/
-    /* Set FIFO Water Levels to be used */
+    /* Set FIFO Water Levels to be used, adapted on every transceive by the policy */
     st25r3911ChangeRegisterBits( ST25R3911_REG_IO_CONF1, (ST25R3911_REG_IO_CONF1_fifo_lt | ST25R3911_REG_IO_CONF1_fifo_lr), (ST25R3911_REG_IO_CONF1_fifo_lt_32bytes | ST25R3911_REG_IO_CONF1_fifo_lr_64bytes) );
     
+    gRFAL.fifo.wlRegBits       = (ST25R3911_REG_IO_CONF1_fifo_lt_32bytes | ST25R3911_REG_IO_CONF1_fifo_lr_64bytes);
+    gRFAL.fifo.wl.policy       = RFAL_FIFO_WL_AUTO;
+    gRFAL.fifo.wl.spiClockHz   = RFAL_FIFO_WL_SPI_CLOCK_HZ;
+    gRFAL.fifo.wl.irqLatencyUs = RFAL_FIFO_WL_IRQ_LATENCY_US;
+    gRFAL.fifo.noRxeTout       = RFAL_NORXE_TOUT;
+    RFAL_MEMSET( &gRFAL.fifo.stats, 0x00, sizeof(gRFAL.fifo.stats) );
+    RFAL_MEMSET( &gRFAL.fifo.statsTxRx, 0x00, sizeof(gRFAL.fifo.statsTxRx) );
+    
     /* Always have CRC in FIFO upon reception  */
     st25r3911SetRegisterBits( ST25R3911_REG_AUX, ST25R3911_REG_AUX_crc_2_fifo );
     
@@ -689,6 +729,7 @@ void rfalDisableObsvMode( void )
 /*******************************************************************************/
 ReturnCode rfalSetMode( rfalMode mode, rfalBitRate txBR, rfalBitRate rxBR )
 {
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_SET_MODE );
 
     /* Check if RFAL is not initialized */
     if( gRFAL.state == RFAL_STATE_IDLE )
@@ -899,6 +940,8 @@ ReturnCode rfalSetBitRate( rfalBitRate txBR, rfalBitRate rxBR )
 {
     ReturnCode ret;
     
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_SET_BITRATE );
+    
     /* Check if RFAL is not initialized */
     if( gRFAL.state == RFAL_STATE_IDLE )
     {
@@ -1071,6 +1114,48 @@ rfalEHandling rfalGetErrorHandling( void )
 }
 
 
+/*******************************************************************************/
+ReturnCode rfalSetFifoWaterLevel( const rfalFifoWlConfig* config )
+{
+    if( (config == NULL) || (config->policy > RFAL_FIFO_WL_BULK) || ((config->policy == RFAL_FIFO_WL_AUTO) && (config->spiClockHz == 0U)) )
+    {
+        return RFAL_ERR_PARAM;
+    }
+    
+    gRFAL.fifo.wl = *config;
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+void rfalGetFifoWaterLevel( rfalFifoWlConfig* config )
+{
+    if( config != NULL )
+    {
+        *config = gRFAL.fifo.wl;
+    }
+}
+
+
+/*******************************************************************************/
+void rfalGetFifoStats( rfalFifoStats* lastTxRx, rfalFifoStats* total )
+{
+    if( lastTxRx != NULL )
+    {
+        lastTxRx->transceives = (gRFAL.fifo.stats.transceives - gRFAL.fifo.statsTxRx.transceives);
+        lastTxRx->wlIrqsTx    = (gRFAL.fifo.stats.wlIrqsTx    - gRFAL.fifo.statsTxRx.wlIrqsTx);
+        lastTxRx->wlIrqsRx    = (gRFAL.fifo.stats.wlIrqsRx    - gRFAL.fifo.statsTxRx.wlIrqsRx);
+        lastTxRx->underflows  = (gRFAL.fifo.stats.underflows  - gRFAL.fifo.statsTxRx.underflows);
+        lastTxRx->overflows   = (gRFAL.fifo.stats.overflows   - gRFAL.fifo.statsTxRx.overflows);
+    }
+    
+    if( total != NULL )
+    {
+        *total = gRFAL.fifo.stats;
+    }
+}
+
+
 /*******************************************************************************/
 void rfalSetFDTPoll( uint32_t FDTPoll )
 {
@@ -1126,6 +1211,8 @@ ReturnCode rfalFieldOnAndStartGT( void )
 {
     ReturnCode  ret;
     
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_FIELD );
+    
     /* Check if RFAL has been initialized (Oscillator should be running) and also
      * if a direct register access has been performed and left the Oscillator Off */
     if( (!st25r3911IsOscOn()) || (gRFAL.state < RFAL_STATE_INIT) )
@@ -1190,6 +1277,8 @@ ReturnCode rfalFieldOnAndStartGT( void )
 /*******************************************************************************/
 ReturnCode rfalFieldOff( void )
 {
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_FIELD );
+    
     /* Check whether a TxRx is not yet finished */
     if( gRFAL.TxRx.state != RFAL_TXRX_STATE_IDLE )
     {
@@ -1212,6 +1301,8 @@ ReturnCode rfalStartTransceive( const rfalTransceiveContext *ctx )
 {
     uint32_t FxTAdj;  /* FWT or FDT adjustment calculation */
     
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_TRANSCEIVE );
+    
     /* Check for valid parameters */
     if( ctx == NULL )
     {
@@ -1390,6 +1481,7 @@ static ReturnCode rfalTransceiveRunBlockingTx( void )
     do{
         rfalWorker();
         ret = rfalGetTransceiveStatus();
+        rfalWorkerWait();
     }
     while( (rfalIsTransceiveInTx()) && (ret == RFAL_ERR_BUSY) );
     
@@ -1410,6 +1502,7 @@ ReturnCode rfalTransceiveBlockingRx( void )
     do{
         rfalWorker();
         ret = rfalGetTransceiveStatus();
+        rfalWorkerWait();
     }
     while( (rfalIsTransceiveInRx()) || (ret == RFAL_ERR_BUSY) );
         
@@ -1417,6 +1510,39 @@ ReturnCode rfalTransceiveBlockingRx( void )
 }
 
 
+/*******************************************************************************/
+void rfalWorkerWait( void )
+{
+    /* Only states waiting on an IRQ or a SW timer can sleep, all others must rerun the worker at once */
+    switch( gRFAL.TxRx.state )
+    {
+        case RFAL_TXRX_STATE_TX_WAIT_GT:
+        case RFAL_TXRX_STATE_TX_WAIT_FDT:
+        case RFAL_TXRX_STATE_TX_WAIT_WL:
+        case RFAL_TXRX_STATE_TX_WAIT_TXE:
+        case RFAL_TXRX_STATE_RX_WAIT_EON:
+        case RFAL_TXRX_STATE_RX_WAIT_RXS:
+        case RFAL_TXRX_STATE_RX_WAIT_RXE:
+        case RFAL_TXRX_STATE_RX_WAIT_EOF:
+            /* Bounded, so that the SW timers (GT, FDT, missing RXE, ...) are still checked in time */
+            platformIrqST25RWait( platformTimerCreate( RFAL_ST25R3911_IRQ_WAIT_SLICE ) );
+            break;
+            
+        case RFAL_TXRX_STATE_IDLE:
+            /* No Transceive ongoing: the upper layer workers (e.g. rfalNfcWorker) can only be waiting for the Guard Time */
+            if( !rfalIsGTExpired() )
+            {
+                platformIrqST25RWait( gRFAL.tmr.GT );
+            }
+            break;
+            
+        default:
+            /* MISRA 16.4: no empty default statement (a comment being enough) */
+            break;
+    }
+}
+
+
 /*******************************************************************************/
 ReturnCode rfalTransceiveBlockingTxRx( uint8_t* txBuf, uint16_t txBufLen, uint8_t* rxBuf, uint16_t rxBufLen, uint16_t* actLen, uint32_t flags, uint32_t fwt )
 {
@@ -1517,6 +1643,8 @@ bool rfalIsTransceiveSubcDetected( void )
 /*******************************************************************************/
 void rfalWorker( void )
 {
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_WORKER );
+    
     platformProtectWorker();               /* Protect RFAL Worker/Task/Process */
     
     switch( gRFAL.state )
@@ -1892,8 +2020,8 @@ static void rfalTransceiveTx( void )
             /* Clear FIFO, Clear and Enable the Interrupts */
             rfalPrepareTransceive( );
 
-            /* Calculate when Water Level Interrupt will be triggered */
-            gRFAL.fifo.expWL = (uint16_t)( st25r3911CheckReg( ST25R3911_REG_IO_CONF1, ST25R3911_REG_IO_CONF1_fifo_lt, ST25R3911_REG_IO_CONF1_fifo_lt_16bytes) ? RFAL_FIFO_OUT_LT_16 : RFAL_FIFO_OUT_LT_32 );
+            /* Set the Water Levels for the bit rates in use and calculate when the Tx Water Level Interrupt will be triggered */
+            rfalFIFOWaterLevelApply();
             
         #if RFAL_FEATURE_NFCV
             /*******************************************************************************/
@@ -1987,10 +2115,17 @@ static void rfalTransceiveTx( void )
             
             if( ((irqs & ST25R3911_IRQ_MASK_FWL) != 0U) && ((irqs & ST25R3911_IRQ_MASK_TXE) == 0U) )
             {
+                gRFAL.fifo.stats.wlIrqsTx++;
                 gRFAL.TxRx.state  = RFAL_TXRX_STATE_TX_RELOAD_FIFO;
             }
             else
             {
+                if( (irqs & ST25R3911_IRQ_MASK_TXE) != 0U )
+                {
+                    /* Transmission ended while part of the frame was still to be loaded: FIFO ran empty */
+                    gRFAL.fifo.stats.underflows++;
+                }
+                
                 gRFAL.TxRx.status = RFAL_ERR_IO;
                 gRFAL.TxRx.state  = RFAL_TXRX_STATE_TX_FAIL;
                 break;
@@ -2228,7 +2363,7 @@ static void rfalTransceiveRx( void )
                     /* REMARK: Silicon workaround ST25R3911 Errata #1.1                            */
                     /* Rarely on corrupted frames I_rxs gets signaled but I_rxe is not signaled    */
                     /* Use a SW timer to handle an eventual missing RXE                            */
-                    rfalTimerStart( gRFAL.tmr.RXE, RFAL_NORXE_TOUT );
+                    rfalTimerStart( gRFAL.tmr.RXE, gRFAL.fifo.noRxeTout );
                     /*******************************************************************************/
                     
                     gRFAL.TxRx.state  = RFAL_TXRX_STATE_RX_WAIT_RXE;
@@ -2281,6 +2416,7 @@ static void rfalTransceiveRx( void )
             
             if( ((irqs & ST25R3911_IRQ_MASK_FWL) != 0U) && ((irqs & ST25R3911_IRQ_MASK_RXE) == 0U) )
             {
+                gRFAL.fifo.stats.wlIrqsRx++;
                 gRFAL.TxRx.state = RFAL_TXRX_STATE_RX_READ_FIFO;
                 break;
             }
@@ -2436,6 +2572,19 @@ static void rfalTransceiveRx( void )
                 }
             }
             
+            /*******************************************************************************/
+            /* Bytes lost on a full FIFO are not covered by the chip's CRC check           */
+            if( (gRFAL.fifo.status[RFAL_FIFO_STATUS_REG2] & ST25R3911_REG_FIFO_RX_STATUS2_fifo_ovr) != 0U )
+            {
+                gRFAL.fifo.stats.overflows++;
+                
+                /* Transmission errors have precedence over FIFO error */
+                if( gRFAL.TxRx.status == RFAL_ERR_BUSY )
+                {
+                    gRFAL.TxRx.status = RFAL_ERR_FIFO;
+                }
+            }
+            
         #if RFAL_FEATURE_NFCV
             /*******************************************************************************/
             /* Decode sub bit stream into payload bits for NFCV, if no error found so far  */
@@ -2498,6 +2647,10 @@ static void rfalTransceiveRx( void )
             
             gRFAL.TxRx.status = RFAL_ERR_NONE;
             gRFAL.TxRx.state  = RFAL_TXRX_STATE_IDLE;
+            
+        #if RFAL_FEATURE_DPO
+            rfalDpoRxResult( gRFAL.TxRx.status );                                  /* Error rate per power level */
+        #endif /* RFAL_FEATURE_DPO */
             break;
             
             
@@ -2509,7 +2662,7 @@ static void rfalTransceiveRx( void )
             /* ST25R3911 may indicate RXS without RXE afterwards, this happens rarely on   */
             /* corrupted frames.                                                           */
             /* Re-Start SW timer to handle an eventual missing RXE                         */
-            rfalTimerStart( gRFAL.tmr.RXE, RFAL_NORXE_TOUT );
+            rfalTimerStart( gRFAL.tmr.RXE, gRFAL.fifo.noRxeTout );
             /*******************************************************************************/        
                     
         
@@ -2558,6 +2711,10 @@ static void rfalTransceiveRx( void )
             #endif
             
             gRFAL.TxRx.state = RFAL_TXRX_STATE_IDLE;
+            
+        #if RFAL_FEATURE_DPO
+            rfalDpoRxResult( gRFAL.TxRx.status );                                  /* Error rate per power level */
+        #endif /* RFAL_FEATURE_DPO */
             break;
         
         
@@ -2669,6 +2826,63 @@ static uint8_t rfalFIFOGetNumIncompleteBits( void )
 }
 
 
+/*******************************************************************************/
+static uint16_t rfalFIFOByteTimeUs( rfalBitRate br, bool rx )
+{
+    if( br <= RFAL_BR_13560 )
+    {
+        return (uint16_t)(RFAL_FIFO_WL_BYTE_US_106 >> (uint8_t)br);
+    }
+    
+    /* NFC-V stream modes move coded bits through the FIFO: 2 bits per byte with 1 of 4, 4 Manchester *
+     * coded bits per byte at 26.48kbps (twice as long as at 106kbps), 8 at 52.97kbps                 */
+    if( rx && (br == RFAL_BR_26p48) )
+    {
+        return (uint16_t)(RFAL_FIFO_WL_BYTE_US_106 * 2U);
+    }
+    return RFAL_FIFO_WL_BYTE_US_106;
+}
+
+
+/*******************************************************************************/
+static void rfalFIFOWaterLevelApply( void )
+{
+    uint32_t budgetUs;
+    uint8_t  regBits;
+    bool     txBulk;
+    bool     rxBulk;
+    
+    txBulk = (gRFAL.fifo.wl.policy == RFAL_FIFO_WL_BULK);
+    rxBulk = txBulk;
+    
+    if( gRFAL.fifo.wl.policy == RFAL_FIFO_WL_AUTO )
+    {
+        /* Time from the WL interrupt until the first FIFO byte is moved */
+        budgetUs = ( (uint32_t)gRFAL.fifo.wl.irqLatencyUs + (((RFAL_FIFO_WL_SPI_BYTES * RFAL_BITS_IN_BYTE * 1000000U) + gRFAL.fifo.wl.spiClockHz - 1U) / gRFAL.fifo.wl.spiClockHz) );
+        
+        /* The high water levels leave 16 bytes: take them if these last longer on air than the budget */
+        txBulk = ( ((uint32_t)rfalFIFOByteTimeUs( gRFAL.txBR, false ) * RFAL_FIFO_IN_LT_16) > budgetUs );
+        rxBulk = ( ((uint32_t)rfalFIFOByteTimeUs( gRFAL.rxBR, true ) * (ST25R3911_FIFO_DEPTH - RFAL_FIFO_IN_LR_80)) > budgetUs );
+    }
+    
+    /* The missing RXE timer is restarted on every Rx WL: it has to outlast filling the FIFO up to it, *
+     * which at 26.48kbps (NFC-V) takes about as long as RFAL_NORXE_TOUT itself                        */
+    gRFAL.fifo.noRxeTout = (uint16_t)RFAL_MAX( RFAL_NORXE_TOUT, ((((uint32_t)rfalFIFOByteTimeUs( gRFAL.rxBR, true ) * (rxBulk ? RFAL_FIFO_IN_LR_80 : RFAL_FIFO_IN_LR_64)) + 999U) / 1000U) + (RFAL_NORXE_TOUT / 2U) );
+    
+    /* Only touch IO_CONF1 when the Water Levels change, the current ones are known since initialization */
+    regBits = ( (txBulk ? ST25R3911_REG_IO_CONF1_fifo_lt_16bytes : ST25R3911_REG_IO_CONF1_fifo_lt_32bytes) | (rxBulk ? ST25R3911_REG_IO_CONF1_fifo_lr_80bytes : ST25R3911_REG_IO_CONF1_fifo_lr_64bytes) );
+    if( regBits != gRFAL.fifo.wlRegBits )
+    {
+        st25r3911ChangeRegisterBits( ST25R3911_REG_IO_CONF1, (ST25R3911_REG_IO_CONF1_fifo_lt | ST25R3911_REG_IO_CONF1_fifo_lr), regBits );
+        gRFAL.fifo.wlRegBits = regBits;
+    }
+    
+    gRFAL.fifo.expWL     = (uint16_t)( txBulk ? RFAL_FIFO_OUT_LT_16 : RFAL_FIFO_OUT_LT_32 );
+    gRFAL.fifo.statsTxRx = gRFAL.fifo.stats;
+    gRFAL.fifo.stats.transceives++;
+}
+
+
 #if RFAL_FEATURE_NFCA
 
 /*******************************************************************************/
@@ -2713,7 +2927,7 @@ ReturnCode rfalISO14443ATransceiveShortFrame( rfal14443AShortFrameCmd txCmd, uin
     
     /*******************************************************************************/
     /* Wait for GT and FDT */
-    while( !rfalIsGTExpired() )      { /* MISRA 15.6: mandatory brackets */ };
+    while( !rfalIsGTExpired() )      { platformIrqST25RWait( gRFAL.tmr.GT ); };
     while( st25r3911IsGPTRunning() ) { /* MISRA 15.6: mandatory brackets */ };
     
     
@@ -3619,6 +3833,8 @@ ReturnCode rfalWakeUpModeStart( const rfalWakeUpConfig *config )
     uint32_t               irqs;
     
     
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_WAKEUP );
+    
     /* Check if RFAL is not initialized */
     if( gRFAL.state < RFAL_STATE_INIT )
     {
@@ -3934,6 +4150,8 @@ static void rfalRunWakeUpModeWorker( void )
 /*******************************************************************************/
 ReturnCode rfalWakeUpModeStop( void )
 {
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_WAKEUP );
+    
     /* Check if RFAL is in Wake-up mode */
     if( gRFAL.state != RFAL_STATE_WUM )
     {
@@ -3974,6 +4192,8 @@ ReturnCode rfalWakeUpModeStop( void )
 /*******************************************************************************/
 ReturnCode rfalLowPowerModeStart( rfalLpMode mode )
 {
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_WAKEUP );
+    
     /* Check if RFAL is not initialized */
     if( gRFAL.state < RFAL_STATE_INIT )
     {
@@ -4009,6 +4229,8 @@ ReturnCode rfalLowPowerModeStop( void )
 {
     ReturnCode ret;
     
+    st25r3911TracePhase( ST25R3911_TRACE_PHASE_WAKEUP );
+    
     /* Check if RFAL is on right state */
     if( !gRFAL.lpm.isRunning )
     {
@@ -4033,9 +4255,27 @@ ReturnCode rfalLowPowerModeStop( void )
  *  RF Chip                                                                    *
  *******************************************************************************/
  
+/*******************************************************************************/
+void rfalChipRegBatchStart( void )
+{
+    st25r3911BatchInit( &gRegBatch );
+    gRegBatchActive = true;
+}
+
+
+/*******************************************************************************/
+void rfalChipRegBatchEnd( void )
+{
+    gRegBatchActive = false;
+    st25r3911BatchFlush( &gRegBatch );
+}
+
+
 /*******************************************************************************/
 ReturnCode rfalChipWriteReg( uint16_t reg, const uint8_t* values, uint8_t len )
 {
+    st25r3911BatchFlush( &gRegBatch );
+    
     if( !st25r3911IsRegValid( (uint8_t)reg) )
     {
         return RFAL_ERR_PARAM;
@@ -4049,6 +4289,8 @@ ReturnCode rfalChipWriteReg( uint16_t reg, const uint8_t* values, uint8_t len )
 /*******************************************************************************/
 ReturnCode rfalChipReadReg( uint16_t reg, uint8_t* values, uint8_t len )
 {
+    st25r3911BatchFlush( &gRegBatch );
+    
     if( !st25r3911IsRegValid( (uint8_t)reg) )
     {
         return RFAL_ERR_PARAM;
@@ -4062,6 +4304,8 @@ ReturnCode rfalChipReadReg( uint16_t reg, uint8_t* values, uint8_t len )
 /*******************************************************************************/
 ReturnCode rfalChipExecCmd( uint16_t cmd )
 {
+    st25r3911BatchFlush( &gRegBatch );
+    
     if( !st25r3911IsCmdValid( (uint8_t)cmd) )
     {
         return RFAL_ERR_PARAM;
@@ -4075,6 +4319,8 @@ ReturnCode rfalChipExecCmd( uint16_t cmd )
 /*******************************************************************************/
 ReturnCode rfalChipWriteTestReg( uint16_t reg, uint8_t value )
 {
+    st25r3911BatchFlush( &gRegBatch );
+    
     st25r3911WriteTestRegister( (uint8_t)reg, value );
     return RFAL_ERR_NONE;
 }
@@ -4083,6 +4329,8 @@ ReturnCode rfalChipWriteTestReg( uint16_t reg, uint8_t value )
 /*******************************************************************************/
 ReturnCode rfalChipReadTestReg( uint16_t reg, uint8_t* value )
 {
+    st25r3911BatchFlush( &gRegBatch );
+    
     st25r3911ReadTestRegister( (uint8_t)reg, value );
     return RFAL_ERR_NONE;
 }
@@ -4091,6 +4339,12 @@ ReturnCode rfalChipReadTestReg( uint16_t reg, uint8_t* value )
 /*******************************************************************************/
 ReturnCode rfalChipChangeRegBits( uint16_t reg, uint8_t valueMask, uint8_t value )
 {
+    if( gRegBatchActive )
+    {
+        st25r3911BatchChangeRegisterBits( &gRegBatch, (uint8_t)reg, valueMask, value );
+        return RFAL_ERR_NONE;
+    }
+    
     st25r3911ChangeRegisterBits( (uint8_t)reg, valueMask, value );
     return RFAL_ERR_NONE;
 }
@@ -4099,6 +4353,8 @@ ReturnCode rfalChipChangeRegBits( uint16_t reg, uint8_t valueMask, uint8_t value
 /*******************************************************************************/
 ReturnCode rfalChipChangeTestRegBits( uint16_t reg, uint8_t valueMask, uint8_t value )
 {
+    st25r3911BatchFlush( &gRegBatch );
+    
     st25r3911ChangeTestRegisterBits( (uint8_t)reg, valueMask, value );
     return RFAL_ERR_NONE;
 }
@@ -79,7 +79,8 @@
 * LOCAL VARIABLES
 ******************************************************************************
 */
-static uint32_t st25r3911NoResponseTime_64fcs;
+static uint32_t st25r3911NoResponseTime_64fcsInstances[RFAL_INSTANCES];
+#define st25r3911NoResponseTime_64fcs RFAL_INSTANCE(st25r3911NoResponseTime_64fcsInstances)
 
 /*
 ******************************************************************************
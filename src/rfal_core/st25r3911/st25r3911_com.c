@@ -37,6 +37,7 @@
 */
 #include "st25r3911_com.h"
 #include "st25r3911.h"
+#include "st25r3911_trace.h"
 #include "../rfal_utils.h"
 
 
@@ -55,6 +56,26 @@
 #define ST25R3911_CMD_LEN     (1U)                           /*!< ST25R3911 CMD length                                           */
 #define ST25R3911_BUF_LEN     (ST25R3911_CMD_LEN+ST25R3911_FIFO_DEPTH)  /*!< ST25R3911 communication buffer: CMD + FIFO length   */
 
+#ifdef ST25R3911_REG_SHADOW
+
+#define ST25R3911_SHADOW_REGS       (ST25R3911_REG_IC_IDENTITY + 1U)  /*!< Registers covered by the shadow                  */
+#define ST25R3911_SHADOW_BIT(r)     (1ULL << (r))                     /*!< Shadow bit of a register                         */
+
+/*! Registers changed by the ST25R3911 itself, never shadowed */
+#define ST25R3911_SHADOW_VOLATILE   ( ST25R3911_SHADOW_BIT(ST25R3911_REG_IRQ_MAIN) | ST25R3911_SHADOW_BIT(ST25R3911_REG_IRQ_TIMER_NFC)                   \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_IRQ_ERROR_WUP) | ST25R3911_SHADOW_BIT(ST25R3911_REG_FIFO_RX_STATUS1)          \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_FIFO_RX_STATUS2) | ST25R3911_SHADOW_BIT(ST25R3911_REG_COLLISION_STATUS)        \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_NFCIP1_BIT_RATE) | ST25R3911_SHADOW_BIT(ST25R3911_REG_AD_RESULT)               \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_ANT_CAL_RESULT) | ST25R3911_SHADOW_BIT(ST25R3911_REG_AM_MOD_DEPTH_RESULT)      \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_REGULATOR_RESULT) | ST25R3911_SHADOW_BIT(ST25R3911_REG_RSSI_RESULT)            \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_GAIN_RED_STATE) | ST25R3911_SHADOW_BIT(ST25R3911_REG_CAP_SENSOR_RESULT)        \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_AUX_DISPLAY)                                                                 \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_AMPLITUDE_MEASURE_AA_RESULT) | ST25R3911_SHADOW_BIT(ST25R3911_REG_AMPLITUDE_MEASURE_RESULT) \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_PHASE_MEASURE_AA_RESULT) | ST25R3911_SHADOW_BIT(ST25R3911_REG_PHASE_MEASURE_RESULT)         \
+                                    | ST25R3911_SHADOW_BIT(ST25R3911_REG_CAPACITANCE_MEASURE_AA_RESULT) | ST25R3911_SHADOW_BIT(ST25R3911_REG_CAPACITANCE_MEASURE_RESULT) )
+
+#endif /* ST25R3911_REG_SHADOW */
+
 /*
 ******************************************************************************
 * LOCAL VARIABLES
@@ -65,12 +86,90 @@
 static uint8_t comBuf[ST25R3911_BUF_LEN];    /*!< ST25R3911 communication buffer            */
 #endif /* ST25R_COM_SINGLETXRX */
 
+#ifdef ST25R3911_REG_SHADOW
+static uint8_t  gShadowValInstances[RFAL_INSTANCES][ST25R3911_SHADOW_REGS];  /*!< Last value written to or read from each register */
+static uint64_t gShadowValidInstances[RFAL_INSTANCES];                       /*!< Registers with a valid shadow value               */
+#define gShadowVal   RFAL_INSTANCE(gShadowValInstances)
+#define gShadowValid RFAL_INSTANCE(gShadowValidInstances)
+#ifdef ST25R3911_REG_SHADOW_VERIFY
+static uint32_t gShadowMismatches;                  /*!< Shadow values found wrong                          */
+#endif /* ST25R3911_REG_SHADOW_VERIFY */
+#endif /* ST25R3911_REG_SHADOW */
+
 /*
 ******************************************************************************
 * LOCAL FUNCTION PROTOTYPES
 ******************************************************************************
 */
 
+#ifdef ST25R3911_REG_SHADOW
+/* The shadow is only accessed within platformProtectST25RComm() */
+
+static inline bool st25r3911ShadowGet( uint8_t reg, uint8_t *value )
+{
+    if( (reg >= ST25R3911_SHADOW_REGS) || ((gShadowValid & ST25R3911_SHADOW_BIT(reg)) == 0U) )
+    {
+        return false;
+    }
+    
+    *value = gShadowVal[reg];
+    return true;
+}
+
+static inline void st25r3911ShadowSet( uint8_t reg, uint8_t value )
+{
+    if( (reg < ST25R3911_SHADOW_REGS) && ((ST25R3911_SHADOW_VOLATILE & ST25R3911_SHADOW_BIT(reg)) == 0U) )
+    {
+        gShadowVal[reg] = value;
+        gShadowValid   |= ST25R3911_SHADOW_BIT(reg);
+    }
+}
+
+static inline void st25r3911ShadowCommand( uint8_t cmd )
+{
+    switch( cmd )
+    {
+        case ST25R3911_CMD_SET_DEFAULT:
+        case ST25R3911_CMD_ANALOG_PRESET:
+            gShadowValid = 0;                                             /* Registers set by the chip */
+            break;
+            
+        case ST25R3911_CMD_INITIAL_RF_COLLISION:
+        case ST25R3911_CMD_RESPONSE_RF_COLLISION_N:
+        case ST25R3911_CMD_RESPONSE_RF_COLLISION_0:
+        case ST25R3911_CMD_NORMAL_NFC_MODE:
+            gShadowValid &= ~ST25R3911_SHADOW_BIT(ST25R3911_REG_OP_CONTROL); /* tx_en switched by the chip */
+            break;
+            
+        default:
+            /* MISRA 16.4: no empty default statement (a comment being enough) */
+            break;
+    }
+}
+
+static inline bool st25r3911ShadowEquals( uint8_t reg, uint8_t value )
+{
+    uint8_t shadow;
+    
+    return ( st25r3911ShadowGet( reg, &shadow ) && (shadow == value) );
+}
+#endif /* ST25R3911_REG_SHADOW */
+
+static void st25r3911WriteModified( uint8_t reg, uint8_t org, uint8_t value )
+{
+#ifdef ST25R3911_REG_SHADOW
+    /* The value read came from (or is now in) the shadow: nothing to write back */
+    if( (value == org) && (reg < ST25R3911_SHADOW_REGS) && ((ST25R3911_SHADOW_VOLATILE & ST25R3911_SHADOW_BIT(reg)) == 0U) )
+    {
+        return;
+    }
+#else
+    RFAL_NO_WARNING( org );
+#endif /* ST25R3911_REG_SHADOW */
+    
+    st25r3911WriteRegister( reg, value );
+}
+
 static inline void st25r3911CheckFieldSetLED(uint8_t value)
 {
     if ((ST25R3911_REG_OP_CONTROL_tx_en & value) != 0U)
@@ -98,9 +197,32 @@ void st25r3911ReadRegister(uint8_t reg, uint8_t* value)
 #else  /* ST25R_COM_SINGLETXRX */
     uint8_t  buf[2];
 #endif  /* ST25R_COM_SINGLETXRX */
+#ifdef ST25R3911_REG_SHADOW
+    uint8_t  shadow;
+    bool     hit;
+#endif /* ST25R3911_REG_SHADOW */
   
     platformProtectST25RComm();
+    
+#ifdef ST25R3911_REG_SHADOW
+    hit = st25r3911ShadowGet( reg, &shadow );
+    
+  #ifndef ST25R3911_REG_SHADOW_VERIFY
+    if( hit )
+    {
+        if(value != NULL)
+        {
+          *value = shadow;
+        }
+        
+        platformUnprotectST25RComm();
+        return;
+    }
+  #endif /* ST25R3911_REG_SHADOW_VERIFY */
+#endif /* ST25R3911_REG_SHADOW */
+    
     platformSpiSelect();
+    st25r3911TraceBegin();
   
     buf[0] = (reg | ST25R3911_READ_MODE);
     buf[1] = 0x00;
@@ -112,7 +234,19 @@ void st25r3911ReadRegister(uint8_t reg, uint8_t* value)
       *value = buf[1];
     }
     
+    st25r3911TraceEnd( ST25R3911_TRACE_OP_REG_READ, reg, 2U );
     platformSpiDeselect();
+    
+#ifdef ST25R3911_REG_SHADOW
+  #ifdef ST25R3911_REG_SHADOW_VERIFY
+    if( hit && (shadow != buf[1]) )
+    {
+        gShadowMismatches++;
+    }
+  #endif /* ST25R3911_REG_SHADOW_VERIFY */
+    st25r3911ShadowSet( reg, buf[1] );
+#endif /* ST25R3911_REG_SHADOW */
+    
     platformUnprotectST25RComm();
 
     return;
@@ -124,11 +258,15 @@ void st25r3911ReadMultipleRegisters(uint8_t reg, uint8_t* values, uint8_t length
 #if !defined(ST25R_COM_SINGLETXRX)
     const uint8_t cmd = (reg | ST25R3911_READ_MODE);
 #endif  /* !ST25R_COM_SINGLETXRX */
+#ifdef ST25R3911_REG_SHADOW
+    uint8_t i;
+#endif /* ST25R3911_REG_SHADOW */
   
     if (length > 0U)
     {
         platformProtectST25RComm();
         platformSpiSelect();
+        st25r3911TraceBegin();
   
 #ifdef ST25R_COM_SINGLETXRX
   
@@ -151,7 +289,16 @@ void st25r3911ReadMultipleRegisters(uint8_t reg, uint8_t* values, uint8_t length
   
 #endif  /* ST25R_COM_SINGLETXRX */
 
+        st25r3911TraceEnd( ST25R3911_TRACE_OP_REG_READ, reg, (ST25R3911_CMD_LEN + length) );
         platformSpiDeselect();
+        
+#ifdef ST25R3911_REG_SHADOW
+        for( i = 0; (values != NULL) && (i < length); i++ )
+        {
+            st25r3911ShadowSet( (reg + i), values[i] );
+        }
+#endif /* ST25R3911_REG_SHADOW */
+        
         platformUnprotectST25RComm();
     }
     
@@ -169,6 +316,7 @@ void st25r3911ReadTestRegister(uint8_t reg, uint8_t* value)
 
     platformProtectST25RComm();
     platformSpiSelect();
+    st25r3911TraceBegin();
 
     buf[0] = ST25R3911_CMD_TEST_ACCESS;
     buf[1] = (reg | ST25R3911_READ_MODE);
@@ -181,6 +329,7 @@ void st25r3911ReadTestRegister(uint8_t reg, uint8_t* value)
       *value = buf[2];
     }
     
+    st25r3911TraceEnd( ST25R3911_TRACE_OP_TEST_READ, reg, 3U );
     platformSpiDeselect();
     platformUnprotectST25RComm();
 
@@ -197,6 +346,7 @@ void st25r3911WriteTestRegister(uint8_t reg, uint8_t value)
     
     platformProtectST25RComm();
     platformSpiSelect();
+    st25r3911TraceBegin();
 
     buf[0] = ST25R3911_CMD_TEST_ACCESS;
     buf[1] = (reg | ST25R3911_WRITE_MODE);
@@ -204,6 +354,7 @@ void st25r3911WriteTestRegister(uint8_t reg, uint8_t value)
   
     platformSpiTxRx(buf, NULL, 3);
   
+    st25r3911TraceEnd( ST25R3911_TRACE_OP_TEST_WRITE, reg, 3U );
     platformSpiDeselect();
     platformUnprotectST25RComm();
 
@@ -225,13 +376,18 @@ void st25r3911WriteRegister(uint8_t reg, uint8_t value)
     
     platformProtectST25RComm();
     platformSpiSelect();
+    st25r3911TraceBegin();
 
     buf[0] = reg | ST25R3911_WRITE_MODE;
     buf[1] = value;
     
     platformSpiTxRx(buf, NULL, 2);
     
+    st25r3911TraceEnd( ST25R3911_TRACE_OP_REG_WRITE, reg, 2U );
     platformSpiDeselect();
+#ifdef ST25R3911_REG_SHADOW
+    st25r3911ShadowSet( reg, value );
+#endif /* ST25R3911_REG_SHADOW */
     platformUnprotectST25RComm();
 
     return;
@@ -242,8 +398,7 @@ void st25r3911ClrRegisterBits( uint8_t reg, uint8_t clr_mask )
     uint8_t tmp;
 
     st25r3911ReadRegister(reg, &tmp);
-    tmp &= ~clr_mask;
-    st25r3911WriteRegister(reg, tmp);
+    st25r3911WriteModified(reg, tmp, (tmp & ~clr_mask));
     
     return;
 }
@@ -254,8 +409,7 @@ void st25r3911SetRegisterBits( uint8_t reg, uint8_t set_mask )
     uint8_t tmp;
 
     st25r3911ReadRegister(reg, &tmp);
-    tmp |= set_mask;
-    st25r3911WriteRegister(reg, tmp);
+    st25r3911WriteModified(reg, tmp, (tmp | set_mask));
     
     return;
 }
@@ -267,15 +421,16 @@ void st25r3911ChangeRegisterBits(uint8_t reg, uint8_t valueMask, uint8_t value)
 
 void st25r3911ModifyRegister(uint8_t reg, uint8_t clr_mask, uint8_t set_mask)
 {
+    uint8_t org;
     uint8_t tmp;
 
-    st25r3911ReadRegister(reg, &tmp);
+    st25r3911ReadRegister(reg, &org);
 
     /* mask out the bits we don't want to change */
-    tmp &= ~clr_mask;
+    tmp  = (org & ~clr_mask);
     /* set the new value */
     tmp |= set_mask;
-    st25r3911WriteRegister(reg, tmp);
+    st25r3911WriteModified(reg, org, tmp);
 
     return;
 }
@@ -303,6 +458,9 @@ void st25r3911WriteMultipleRegisters(uint8_t reg, const uint8_t* values, uint8_t
 #if !defined(ST25R_COM_SINGLETXRX)
     const uint8_t cmd = (reg | ST25R3911_WRITE_MODE);
 #endif  /* !ST25R_COM_SINGLETXRX */
+#ifdef ST25R3911_REG_SHADOW
+    uint8_t i;
+#endif /* ST25R3911_REG_SHADOW */
 
     if ((reg <= ST25R3911_REG_OP_CONTROL) && ((reg+length) >= ST25R3911_REG_OP_CONTROL))
     {
@@ -314,6 +472,7 @@ void st25r3911WriteMultipleRegisters(uint8_t reg, const uint8_t* values, uint8_t
         /* make this operation atomic */
         platformProtectST25RComm();
         platformSpiSelect();
+        st25r3911TraceBegin();
     
 #ifdef ST25R_COM_SINGLETXRX
       
@@ -329,7 +488,16 @@ void st25r3911WriteMultipleRegisters(uint8_t reg, const uint8_t* values, uint8_t
     
 #endif  /*ST25R_COM_SINGLETXRX*/    
     
+        st25r3911TraceEnd( ST25R3911_TRACE_OP_REG_WRITE, reg, (ST25R3911_CMD_LEN + length) );
         platformSpiDeselect();
+        
+#ifdef ST25R3911_REG_SHADOW
+        for( i = 0; i < length; i++ )
+        {
+            st25r3911ShadowSet( (reg + i), values[i] );
+        }
+#endif /* ST25R3911_REG_SHADOW */
+        
         platformUnprotectST25RComm();
     }
     
@@ -339,14 +507,15 @@ void st25r3911WriteMultipleRegisters(uint8_t reg, const uint8_t* values, uint8_t
 
 void st25r3911WriteFifo(const uint8_t* values, uint8_t length)
 {
-#if !defined(ST25R_COM_SINGLETXRX)
+#if !defined(ST25R_COM_SINGLETXRX) && !defined(platformSpiTxRxCmd)
     const uint8_t cmd = ST25R3911_FIFO_LOAD;
-#endif  /* !ST25R_COM_SINGLETXRX */
+#endif  /* !ST25R_COM_SINGLETXRX && !platformSpiTxRxCmd */
 
     if( (length > 0U) && (length <= ST25R3911_FIFO_DEPTH) )
     {
         platformProtectST25RComm();
         platformSpiSelect();
+        st25r3911TraceBegin();
   
 #ifdef ST25R_COM_SINGLETXRX
   
@@ -355,6 +524,10 @@ void st25r3911WriteFifo(const uint8_t* values, uint8_t length)
 
         platformSpiTxRx( comBuf, NULL, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );
   
+#elif defined(platformSpiTxRxCmd)
+  
+        platformSpiTxRxCmd( ST25R3911_FIFO_LOAD, values, NULL, length );                                         /* Command and data in one SPI transfer, straight from the caller's buffer */
+  
 #else  /*ST25R_COM_SINGLETXRX*/
   
         platformSpiTxRx( &cmd, NULL, ST25R3911_CMD_LEN );
@@ -362,6 +535,7 @@ void st25r3911WriteFifo(const uint8_t* values, uint8_t length)
   
 #endif  /*ST25R_COM_SINGLETXRX*/
   
+        st25r3911TraceEnd( ST25R3911_TRACE_OP_FIFO_LOAD, length, (ST25R3911_CMD_LEN + length) );
         platformSpiDeselect();
         platformUnprotectST25RComm();
     }
@@ -371,14 +545,15 @@ void st25r3911WriteFifo(const uint8_t* values, uint8_t length)
 
 void st25r3911ReadFifo(uint8_t* buf, uint8_t length)
 {
-#if !defined(ST25R_COM_SINGLETXRX)
+#if !defined(ST25R_COM_SINGLETXRX) && !defined(platformSpiTxRxCmd)
     const uint8_t cmd = ST25R3911_FIFO_READ;
-#endif  /* !ST25R_COM_SINGLETXRX */
+#endif  /* !ST25R_COM_SINGLETXRX && !platformSpiTxRxCmd */
     
     if(length > 0U)
     {
         platformProtectST25RComm();
         platformSpiSelect();
+        st25r3911TraceBegin();
 
 #ifdef ST25R_COM_SINGLETXRX
       
@@ -388,6 +563,10 @@ void st25r3911ReadFifo(uint8_t* buf, uint8_t length)
         platformSpiTxRx( comBuf, comBuf, RFAL_MIN( (ST25R3911_CMD_LEN + length), ST25R3911_BUF_LEN ) );          /* Transceive as a single SPI call                        */
         RFAL_MEMCPY( buf, &comBuf[ST25R3911_CMD_LEN], RFAL_MIN( length, ST25R3911_BUF_LEN - ST25R3911_CMD_LEN ) ); /* Copy from local buf to output buffer and skip cmd byte */
   
+#elif defined(platformSpiTxRxCmd)
+  
+        platformSpiTxRxCmd( ST25R3911_FIFO_READ, NULL, buf, length );                                            /* Command and data in one SPI transfer, straight into the caller's buffer */
+  
 #else  /*ST25R_COM_SINGLETXRX*/
   
         if( buf != NULL )
@@ -400,6 +579,7 @@ void st25r3911ReadFifo(uint8_t* buf, uint8_t length)
   
 #endif  /*ST25R_COM_SINGLETXRX*/
       
+        st25r3911TraceEnd( ST25R3911_TRACE_OP_FIFO_READ, length, (ST25R3911_CMD_LEN + length) );
         platformSpiDeselect();
         platformUnprotectST25RComm();
     }
@@ -422,10 +602,15 @@ void st25r3911ExecuteCommand( uint8_t cmd )
 
     platformProtectST25RComm();
     platformSpiSelect();
+    st25r3911TraceBegin();
     
     platformSpiTxRx( &tmpCmd, NULL, ST25R3911_CMD_LEN );
     
+    st25r3911TraceEnd( ST25R3911_TRACE_OP_CMD, cmd, ST25R3911_CMD_LEN );
     platformSpiDeselect();
+#ifdef ST25R3911_REG_SHADOW
+    st25r3911ShadowCommand( tmpCmd );
+#endif /* ST25R3911_REG_SHADOW */
     platformUnprotectST25RComm();
 
     return;
@@ -434,17 +619,202 @@ void st25r3911ExecuteCommand( uint8_t cmd )
 
 void st25r3911ExecuteCommands(const uint8_t *cmds, uint8_t length)
 {
+#ifdef ST25R3911_REG_SHADOW
+    uint8_t i;
+#endif /* ST25R3911_REG_SHADOW */
+    
     platformProtectST25RComm();
     platformSpiSelect();
+    st25r3911TraceBegin();
     
     platformSpiTxRx( cmds, NULL, length );
     
+    st25r3911TraceEnd( ST25R3911_TRACE_OP_CMD, cmds[0], length );
     platformSpiDeselect();
+#ifdef ST25R3911_REG_SHADOW
+    for( i = 0; i < length; i++ )
+    {
+        st25r3911ShadowCommand( cmds[i] );
+    }
+#endif /* ST25R3911_REG_SHADOW */
     platformUnprotectST25RComm();
 
     return;
 }
 
+void st25r3911BatchInit( st25r3911RegBatch *batch )
+{
+    batch->len   = 0;
+    batch->known = 0;
+}
+
+void st25r3911BatchWriteRegister( st25r3911RegBatch *batch, uint8_t reg, uint8_t value )
+{
+    /* Only the last pending write is replaced: merging into an earlier one would move the write ahead of the ones to other registers in between */
+    if( (batch->len > 0U) && (batch->reg[batch->len - 1U] == reg) )
+    {
+        batch->val[batch->len - 1U] = value;
+        return;
+    }
+    
+    if( batch->len >= ST25R3911_REG_BATCH_MAX )
+    {
+        st25r3911BatchFlush( batch );
+    }
+    
+    batch->reg[batch->len] = reg;
+    batch->val[batch->len] = value;
+    batch->len++;
+}
+
+void st25r3911BatchChangeRegisterBits( st25r3911RegBatch *batch, uint8_t reg, uint8_t valueMask, uint8_t value )
+{
+    uint8_t i;
+    uint8_t tmp;
+    
+    /* A full mask does not need the current value */
+    if( valueMask == 0xFFU )
+    {
+        st25r3911BatchWriteRegister( batch, reg, value );
+        return;
+    }
+    
+    /* Current value: the last pending write of the register, the register itself otherwise */
+    for( i = batch->len; i > 0U; i-- )
+    {
+        if( batch->reg[i - 1U] == reg )
+        {
+            break;
+        }
+    }
+    
+    if( i == 0U )
+    {
+        st25r3911ReadRegister( reg, &tmp );
+    }
+    else if( i == batch->len )
+    {
+        batch->val[i - 1U] = ((batch->val[i - 1U] & ~valueMask) | (value & valueMask));   /* Last pending write: changed in place */
+        return;
+    }
+    else
+    {
+        tmp = batch->val[i - 1U];                                                        /* Value after the pending write, appended behind the writes in between */
+    }
+    st25r3911BatchWriteRegister( batch, reg, ((tmp & ~valueMask) | (value & valueMask)) );
+    
+    /* The write was appended last (a full batch was flushed first) */
+    batch->org[batch->len - 1U] = tmp;
+    batch->known               |= (1UL << (batch->len - 1U));
+}
+
+void st25r3911BatchFlush( st25r3911RegBatch *batch )
+{
+    uint8_t i;
+    uint8_t run;
+#if !defined(ST25R_COM_SINGLETXRX)
+    uint8_t cmd;
+#endif  /* !ST25R_COM_SINGLETXRX */
+#if ST25R3911_REG_BATCH_DIFF
+    uint8_t n;
+  #ifdef ST25R3911_REG_SHADOW
+    uint8_t k;
+  #endif /* ST25R3911_REG_SHADOW */
+#endif /* ST25R3911_REG_BATCH_DIFF */
+    
+    if( batch->len == 0U )
+    {
+        return;
+    }
+    
+    platformProtectST25RComm();
+    
+#if ST25R3911_REG_BATCH_DIFF
+    /* Drop the writes that would put back the value read or the value already in the shadow */
+    for( i = 0, n = 0; i < batch->len; i++ )
+    {
+        if( ((batch->known & (1UL << i)) != 0U) && (batch->val[i] == batch->org[i]) )
+        {
+            continue;
+        }
+  #ifdef ST25R3911_REG_SHADOW
+        /* The shadow holds the value before the batch: only valid until a write of the register is kept */
+        for( k = 0; (k < n) && (batch->reg[k] != batch->reg[i]); k++ )
+        {
+            /* MISRA 15.6: mandatory brackets */
+        }
+        if( (k == n) && st25r3911ShadowEquals( batch->reg[i], batch->val[i] ) )
+        {
+            continue;
+        }
+  #endif /* ST25R3911_REG_SHADOW */
+        
+        batch->reg[n] = batch->reg[i];
+        batch->val[n] = batch->val[i];
+        n++;
+    }
+    batch->len   = n;
+    batch->known = 0;
+#endif /* ST25R3911_REG_BATCH_DIFF */
+    
+
+    for( i = 0; i < batch->len; i += run )
+    {
+        /* Merge the following writes to consecutive addresses into the same frame */
+        for( run = 1; ((i + run) < batch->len) && (batch->reg[i + run] == (batch->reg[i] + run)); run++ )
+        {
+            /* MISRA 15.6: mandatory brackets */
+        }
+        
+        if( (batch->reg[i] <= ST25R3911_REG_OP_CONTROL) && ((batch->reg[i] + run) > ST25R3911_REG_OP_CONTROL) )
+        {
+            st25r3911CheckFieldSetLED( batch->val[i + (ST25R3911_REG_OP_CONTROL - batch->reg[i])] );
+        }
+        
+        platformSpiSelect();
+        st25r3911TraceBegin();
+#ifdef ST25R_COM_SINGLETXRX
+        comBuf[0] = (batch->reg[i] | ST25R3911_WRITE_MODE);
+        RFAL_MEMCPY( &comBuf[ST25R3911_CMD_LEN], &batch->val[i], run );
+        platformSpiTxRx( comBuf, NULL, (ST25R3911_CMD_LEN + run) );
+#else  /*ST25R_COM_SINGLETXRX*/
+        cmd = (batch->reg[i] | ST25R3911_WRITE_MODE);
+        platformSpiTxRx( &cmd, NULL, ST25R3911_CMD_LEN );
+        platformSpiTxRx( &batch->val[i], NULL, run );
+#endif  /*ST25R_COM_SINGLETXRX*/
+        st25r3911TraceEnd( ST25R3911_TRACE_OP_REG_WRITE, batch->reg[i], (ST25R3911_CMD_LEN + run) );
+        platformSpiDeselect();
+    }
+    
+#ifdef ST25R3911_REG_SHADOW
+    for( i = 0; i < batch->len; i++ )
+    {
+        st25r3911ShadowSet( batch->reg[i], batch->val[i] );
+    }
+#endif /* ST25R3911_REG_SHADOW */
+    
+    platformUnprotectST25RComm();
+    
+    batch->len   = 0;
+    batch->known = 0;
+}
+
+#ifdef ST25R3911_REG_SHADOW
+void st25r3911ShadowInvalidate( void )
+{
+    platformProtectST25RComm();
+    gShadowValid = 0;
+    platformUnprotectST25RComm();
+}
+
+#ifdef ST25R3911_REG_SHADOW_VERIFY
+uint32_t st25r3911ShadowGetMismatches( void )
+{
+    return gShadowMismatches;
+}
+#endif /* ST25R3911_REG_SHADOW_VERIFY */
+#endif /* ST25R3911_REG_SHADOW */
+
 bool st25r3911IsRegValid( uint8_t reg )
 {
     if( (!(( (int16_t)reg >= (int16_t)ST25R3911_REG_IO_CONF1) && (reg <= ST25R3911_REG_CAPACITANCE_MEASURE_RESULT))) &&  (reg != ST25R3911_REG_IC_IDENTITY)  )
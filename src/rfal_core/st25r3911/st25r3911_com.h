@@ -41,6 +41,18 @@
  * - Load ST25R3911 FIFO with data: #st25r3911WriteFifo
  * - Read from ST25R3911 FIFO: #st25r3911ReadFifo
  * - Execute direct command: #st25r3911ExecuteCommand
+ * - Register write batch: #st25r3911BatchWriteRegister, #st25r3911BatchFlush
+ * - Shadow registers: #st25r3911ShadowInvalidate
+ * 
+ * With ST25R3911_REG_SHADOW defined the last value written to or read from
+ * each configuration register is kept: reads of these registers are served
+ * without SPI and read-modify-write operations become a single write, or 
+ * nothing when the value does not change. The registers the ST25R3911 
+ * changes itself (IRQ, FIFO status, displays, measurement results) always
+ * go to the chip. Set default and Analog Preset commands drop the whole 
+ * shadow, the collision avoidance commands the Operation Control register.
+ * ST25R3911_REG_SHADOW_VERIFY additionally reads every shadowed register 
+ * from the chip and counts the mismatches, see #st25r3911ShadowGetMismatches
  * 
  *
  * \addtogroup RFAL
@@ -80,6 +92,12 @@
 
 #define ST25R3911_FIFO_STATUS_LEN                  2           /*!< Number of FIFO Status Register */
 
+#define ST25R3911_REG_BATCH_MAX                    32U         /*!< Max number of register writes held by a batch */
+
+#ifndef ST25R3911_REG_BATCH_DIFF
+#define ST25R3911_REG_BATCH_DIFF                   true        /*!< Batched changes leaving the register value read unchanged are not sent */
+#endif
+
 
 
 
@@ -543,6 +561,22 @@
 
 /*! \endcond DOXYGEN_SUPPRESS */
 
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Register write batch: writes collected to be sent with one lock and as few SPI frames as possible */
+typedef struct
+{
+    uint8_t len;                                /*!< Number of pending writes      */
+    uint8_t reg[ST25R3911_REG_BATCH_MAX];       /*!< Pending register addresses    */
+    uint8_t val[ST25R3911_REG_BATCH_MAX];       /*!< Pending register values       */
+    uint8_t org[ST25R3911_REG_BATCH_MAX];       /*!< Register values read          */
+    uint32_t known;                             /*!< Pending writes with org read  */
+} st25r3911RegBatch;
+
 /*
 ******************************************************************************
 * GLOBAL FUNCTION PROTOTYPES
@@ -794,6 +828,97 @@ extern void st25r3911ExecuteCommands(const uint8_t *cmds, uint8_t length);
  */
 extern bool st25r3911IsRegValid( uint8_t reg );
 
+/*! 
+ *****************************************************************************
+ *  \brief  Initializes a register write batch
+ *
+ *  \param[out] batch: batch to be initialized (empty)
+ *
+ *****************************************************************************
+ */
+extern void st25r3911BatchInit( st25r3911RegBatch *batch );
+
+/*! 
+ *****************************************************************************
+ *  \brief  Adds a register write to a batch
+ *
+ *  The write is only sent on #st25r3911BatchFlush. A write to the register
+ *  of the last pending write replaces its value; any other write is
+ *  appended, so the writes keep the order they were added in, also when a
+ *  register is written again after others (e.g. mode / bit rate registers
+ *  before the operation control register).
+ *  A full batch is flushed first.
+ *
+ *  \param[in]  batch: batch to add the write to
+ *  \param[in]  reg: Address of the register to write.
+ *  \param[in]  value: Value to be written.
+ *
+ *****************************************************************************
+ */
+extern void st25r3911BatchWriteRegister( st25r3911RegBatch *batch, uint8_t reg, uint8_t value );
+
+/*! 
+ *****************************************************************************
+ *  \brief  Adds a register bits change to a batch
+ *
+ *  Same as #st25r3911ChangeRegisterBits but the write is collected in the
+ *  batch. The current value is taken from the last pending write of the
+ *  register, otherwise it is read from the ST25R3911. Ordered as
+ *  #st25r3911BatchWriteRegister.
+ *  With ST25R3911_REG_BATCH_DIFF a register read this way is not written
+ *  on #st25r3911BatchFlush if its final value is the one read.
+ *
+ *  \param[in]  batch: batch to add the write to
+ *  \param[in]  reg: Address of the register to change.
+ *  \param[in]  valueMask: mask of the bits to be changed
+ *  \param[in]  value: new value of the masked bits
+ *
+ *****************************************************************************
+ */
+extern void st25r3911BatchChangeRegisterBits( st25r3911RegBatch *batch, uint8_t reg, uint8_t valueMask, uint8_t value );
+
+/*! 
+ *****************************************************************************
+ *  \brief  Sends all the pending writes of a batch
+ *
+ *  The writes are sent in the order they were added, within a single
+ *  communication lock. 
+ *  Writes to consecutive registers are merged into one SPI frame 
+ *  (auto-increment); the ST25R3911 requires a new frame (SS toggle) for 
+ *  every non consecutive address.
+ *
+ *  \param[in]  batch: batch to be sent, empty on return
+ *
+ *****************************************************************************
+ */
+extern void st25r3911BatchFlush( st25r3911RegBatch *batch );
+
+#ifdef ST25R3911_REG_SHADOW
+/*! 
+ *****************************************************************************
+ *  \brief  Invalidates the shadow registers
+ *
+ *  To be called when the ST25R3911 registers may have changed without the
+ *  communication layer, e.g. after a power cycle of the chip.
+ *
+ *****************************************************************************
+ */
+extern void st25r3911ShadowInvalidate( void );
+
+#ifdef ST25R3911_REG_SHADOW_VERIFY
+/*! 
+ *****************************************************************************
+ *  \brief  Returns the number of shadow mismatches
+ *
+ *  \return number of register reads where the chip value differed from the 
+ *          shadow value (which is then corrected)
+ *
+ *****************************************************************************
+ */
+extern uint32_t st25r3911ShadowGetMismatches( void );
+#endif /* ST25R3911_REG_SHADOW_VERIFY */
+#endif /* ST25R3911_REG_SHADOW */
+
 #endif /* ST25R3911_COM_H */
 
 /**
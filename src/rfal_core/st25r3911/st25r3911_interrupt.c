@@ -71,7 +71,8 @@ typedef struct
 ******************************************************************************
 */
 
-static volatile t_st25r3911Interrupt st25r3911interrupt; /*!< Instance of ST25R3911 interrupt */
+static volatile t_st25r3911Interrupt st25r3911interruptInstances[RFAL_INSTANCES]; /*!< Instances of ST25R3911 interrupt */
+#define st25r3911interrupt RFAL_INSTANCE(st25r3911interruptInstances)
 
 
 static void st25r3911IRQCheck( uint32_t irqStatus );
@@ -153,6 +154,9 @@ void st25r3911CheckForReceivedInterrupts( void )
     platformProtectST25RIrqStatus();
     st25r3911interrupt.status |= irqStatus;
     platformUnprotectST25RIrqStatus();
+    
+    /* Wake up anyone blocked on the IRQ status */
+    platformIrqST25RSignal();
  
     /* Check received IRQs */
     st25r3911IRQCheck( irqStatus );
@@ -162,6 +166,9 @@ void st25r3911CheckForReceivedInterrupts( void )
 void st25r3911ModifyInterrupts(uint32_t clr_mask, uint32_t set_mask)
 {
     uint8_t i;
+    uint8_t first;
+    uint8_t last;
+    uint8_t regs[3];
     uint32_t old_mask;
     uint32_t new_mask;
 
@@ -169,12 +176,25 @@ void st25r3911ModifyInterrupts(uint32_t clr_mask, uint32_t set_mask)
     new_mask = (~old_mask & set_mask) | (old_mask & clr_mask);
     st25r3911interrupt.mask &= ~clr_mask;
     st25r3911interrupt.mask |= set_mask;
+    
+    /* The mask registers are consecutive: write the changed range in one frame */
+    first = 3U;
+    last  = 0U;
     for (i=0; i<3U ; i++)
     { 
+        regs[i] = (uint8_t)((st25r3911interrupt.mask>>(i*8U))&0xffU);
         if (((new_mask >> (i*8U)) & 0xffU) == 0U) {
             continue;
         }
-        st25r3911WriteRegister((ST25R3911_REG_IRQ_MASK_MAIN + i), (uint8_t)((st25r3911interrupt.mask>>(i*8U))&0xffU));
+        if (first == 3U) {
+            first = i;
+        }
+        last = i;
+    }
+    
+    if (first < 3U)
+    {
+        st25r3911WriteMultipleRegisters((ST25R3911_REG_IRQ_MASK_MAIN + first), &regs[first], ((last - first) + 1U));
     }
     return;
 }
@@ -189,6 +209,11 @@ uint32_t st25r3911WaitForInterruptsTimed(uint32_t mask, uint16_t tmo)
     do 
     {
         status = (st25r3911interrupt.status & mask);
+        if( status == 0U )
+        {
+            /* Sleep until new IRQs have been read or the timer expires instead of spinning */
+            platformIrqST25RWait( tmr );
+        }
     } while( ( (!platformTimerIsExpired( tmr )) || (tmo == 0U)) && (status == 0U) );
 
     status = st25r3911interrupt.status & mask;
@@ -0,0 +1,264 @@
+
+/******************************************************************************
+  * @attention
+  *
+  * COPYRIGHT 2016 STMicroelectronics, all rights reserved
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file st25r3911_trace.c
+ *
+ *  \brief ST25R3911 SPI transaction trace
+ *
+ *  The frames are recorded by the communication layer with the com lock
+ *  held, so there is a single writer at a time. Each ST25R3911 
+ *  (RFAL_INSTANCES) has its own ring, statistics and phase, those of the
+ *  instance the calling task works with are used. The ring buffer is
+ *  published through a sequence counter: an entry is written first and
+ *  the counter is advanced after, readers check the counter again after
+ *  copying to drop entries overwritten meanwhile.
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "st25r3911_trace.h"
+#include "st25r3911_com.h"
+#include "../rfal_utils.h"
+
+#ifdef ST25R_COM_TRACE
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+
+#define ST25R3911_TRACE_MASK            (ST25R3911_TRACE_DEPTH - 1U)    /*!< Ring buffer index mask */
+
+#ifndef platformGetSysTickUs
+    #define platformGetSysTickUs()      (platformGetSysTick() * 1000U)  /*!< us tick from the ms tick if the platform has none */
+#endif /* platformGetSysTickUs */
+
+#if ( (ST25R3911_TRACE_DEPTH & ST25R3911_TRACE_MASK) != 0U )
+    #error "ST25R3911_TRACE_DEPTH must be a power of 2"
+#endif
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+
+static st25r3911TraceEntry trcRingInstances[RFAL_INSTANCES][ST25R3911_TRACE_DEPTH];  /*!< Last frames                                */
+static uint32_t            trcSeqInstances[RFAL_INSTANCES];                         /*!< Number of frames recorded, published last  */
+static st25r3911TraceStats trcStatsInstances[RFAL_INSTANCES];                       /*!< Accumulated cost                           */
+static volatile uint8_t    trcPhaseInstances[RFAL_INSTANCES];                       /*!< Current RFAL phase                         */
+static uint32_t            trcStartInstances[RFAL_INSTANCES];                       /*!< Start of the frame in progress             */
+#define trcRing            RFAL_INSTANCE(trcRingInstances)
+#define trcSeq             RFAL_INSTANCE(trcSeqInstances)
+#define trcStats           RFAL_INSTANCE(trcStatsInstances)
+#define trcPhase           RFAL_INSTANCE(trcPhaseInstances)
+#define trcStart           RFAL_INSTANCE(trcStartInstances)
+
+static const char * const trcOpNames[ST25R3911_TRACE_OP_NUM] =
+{
+    "reg rd", "reg wr", "test rd", "test wr", "fifo rd", "fifo ld", "cmd"
+};
+
+static const char * const trcPhaseNames[ST25R3911_TRACE_PHASE_NUM] =
+{
+    "other", "init", "setMode", "setBitRate", "field", "transceive", "worker", "irq", "wakeup"
+};
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+static void st25r3911TraceAdd( st25r3911TraceCost *cost, uint8_t len, uint32_t dur )
+{
+    cost->frames++;
+    cost->bytes  += len;
+    cost->timeUs += dur;
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+void st25r3911TraceSetPhase( uint8_t phase )
+{
+    trcPhase = ((phase < ST25R3911_TRACE_PHASE_NUM) ? phase : ST25R3911_TRACE_PHASE_OTHER);
+}
+
+
+void st25r3911TraceFrameBegin( void )
+{
+    trcStart = platformGetSysTickUs();
+}
+
+
+void st25r3911TraceFrameEnd( uint8_t op, uint8_t reg, uint8_t len )
+{
+    st25r3911TraceEntry *e;
+    uint32_t             seq;
+    uint32_t             dur;
+    uint8_t              phase;
+
+    dur   = (platformGetSysTickUs() - trcStart);
+    phase = trcPhase;
+
+    /* The IRQ status registers are only read by the interrupt handler, which runs in its own context */
+    if( (op == ST25R3911_TRACE_OP_REG_READ) && (reg == ST25R3911_REG_IRQ_MAIN) )
+    {
+        phase = ST25R3911_TRACE_PHASE_IRQ;
+    }
+
+    seq = __atomic_load_n( &trcSeq, __ATOMIC_RELAXED );
+    e   = &trcRing[seq & ST25R3911_TRACE_MASK];
+
+    e->timeUs = trcStart;
+    e->durUs  = (uint16_t)RFAL_MIN( dur, 0xFFFFU );
+    e->op     = op;
+    e->reg    = reg;
+    e->len    = len;
+    e->phase  = phase;
+
+    /* Publish the entry only once it is complete */
+    __atomic_store_n( &trcSeq, (seq + 1U), __ATOMIC_RELEASE );
+
+    st25r3911TraceAdd( &trcStats.total, len, dur );
+    st25r3911TraceAdd( &trcStats.op[op], len, dur );
+    st25r3911TraceAdd( &trcStats.phase[phase], len, dur );
+
+    if( (op == ST25R3911_TRACE_OP_REG_READ) || (op == ST25R3911_TRACE_OP_REG_WRITE) )
+    {
+        st25r3911TraceAdd( &trcStats.reg[reg & (ST25R3911_TRACE_REG_NUM - 1U)], len, dur );
+    }
+}
+
+
+uint16_t st25r3911TraceRead( uint32_t *seq, st25r3911TraceEntry *entries, uint16_t max )
+{
+    uint32_t head;
+    uint32_t from;
+    uint16_t n;
+    uint16_t i;
+
+    head = __atomic_load_n( &trcSeq, __ATOMIC_ACQUIRE );
+    from = *seq;
+
+    /* Skip what is already overwritten: the writer fills slot head before publishing head + 1, *
+     * so entry head - DEPTH may be half overwritten already                                      */
+    if( (head - from) >= ST25R3911_TRACE_DEPTH )
+    {
+        from = ((head - ST25R3911_TRACE_DEPTH) + 1U);
+    }
+
+    n = (uint16_t)RFAL_MIN( (head - from), max );
+    for( i = 0; i < n; i++ )
+    {
+        entries[i] = trcRing[(from + i) & ST25R3911_TRACE_MASK];
+    }
+
+    /* Drop the entries the writer may have overwritten while copying */
+    head = __atomic_load_n( &trcSeq, __ATOMIC_ACQUIRE );
+    if( (head - from) >= ST25R3911_TRACE_DEPTH )
+    {
+        i = (uint16_t)RFAL_MIN( (((head - from) - ST25R3911_TRACE_DEPTH) + 1U), n );
+        RFAL_MEMMOVE( entries, &entries[i], ((uint32_t)(n - i) * sizeof(st25r3911TraceEntry)) );
+        n    -= i;
+        from += i;
+    }
+
+    *seq = (from + n);
+    return n;
+}
+
+
+void st25r3911TraceGetStats( st25r3911TraceStats *stats )
+{
+    platformProtectST25RComm();
+    *stats = trcStats;
+    platformUnprotectST25RComm();
+}
+
+
+uint8_t st25r3911TraceHotRegs( const st25r3911TraceStats *stats, uint8_t *regs, uint8_t num )
+{
+    uint8_t  n;
+    uint8_t  r;
+    uint8_t  best;
+    uint32_t taken[ST25R3911_TRACE_REG_NUM / 32U];
+
+    RFAL_MEMSET( taken, 0x00, sizeof(taken) );
+
+    for( n = 0; n < num; n++ )
+    {
+        best = 0xFFU;
+        for( r = 0; r < ST25R3911_TRACE_REG_NUM; r++ )
+        {
+            if( ((taken[r / 32U] & (1UL << (r % 32U))) == 0U) && (stats->reg[r].bytes != 0U) )
+            {
+                if( (best == 0xFFU) || (stats->reg[r].bytes > stats->reg[best].bytes) )
+                {
+                    best = r;
+                }
+            }
+        }
+
+        if( best == 0xFFU )
+        {
+            break;
+        }
+
+        taken[best / 32U] |= (1UL << (best % 32U));
+        regs[n] = best;
+    }
+
+    return n;
+}
+
+
+void st25r3911TraceReset( void )
+{
+    platformProtectST25RComm();
+    RFAL_MEMSET( &trcStats, 0x00, sizeof(trcStats) );
+    platformUnprotectST25RComm();
+}
+
+
+const char *st25r3911TraceOpName( uint8_t op )
+{
+    return ((op < ST25R3911_TRACE_OP_NUM) ? trcOpNames[op] : "?");
+}
+
+
+const char *st25r3911TracePhaseName( uint8_t phase )
+{
+    return ((phase < ST25R3911_TRACE_PHASE_NUM) ? trcPhaseNames[phase] : "?");
+}
+
+#endif /* ST25R_COM_TRACE */
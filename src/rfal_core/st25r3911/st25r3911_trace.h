@@ -0,0 +1,249 @@
+
+/******************************************************************************
+  * @attention
+  *
+  * COPYRIGHT 2016 STMicroelectronics, all rights reserved
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+
+/*
+ *      PROJECT:   ST25R3911 firmware
+ *      Revision:
+ *      LANGUAGE:  ISO C99
+ */
+
+/*! \file st25r3911_trace.h
+ *
+ *  \brief ST25R3911 SPI transaction trace
+ *
+ *  Optional instrumentation of the ST25R3911 communication layer, enabled
+ *  by defining ST25R_COM_TRACE. Every SPI frame (register access, FIFO
+ *  access, direct command) is recorded with its register/command, number
+ *  of bytes on the bus, duration and the RFAL phase it was issued in:
+ *   - into a ring buffer of the last #ST25R3911_TRACE_DEPTH frames which
+ *     is read without locking, see #st25r3911TraceRead
+ *   - into counters per operation, per phase and per register,
+ *     see #st25r3911TraceGetStats
+ *
+ *  The RFAL phase is the last one entered with #st25r3911TracePhase and
+ *  stays current until the next one. The IRQ status reads of the interrupt
+ *  handler are always accounted to #ST25R3911_TRACE_PHASE_IRQ.
+ *
+ *  With several ST25R3911 (RFAL_INSTANCES) each one is traced on its own:
+ *  the functions below work on the instance of the calling task.
+ *
+ *  Without ST25R_COM_TRACE the hooks compile to nothing.
+ *
+ */
+
+#ifndef ST25R3911_TRACE_H
+#define ST25R3911_TRACE_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "rfal_platform/rfal_platform.h"
+#include "../rfal_utils.h"
+#include "../rfal_defConfig.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+
+#ifndef ST25R3911_TRACE_DEPTH
+#define ST25R3911_TRACE_DEPTH               128U        /*!< Number of frames kept in the ring buffer, power of 2 */
+#endif
+
+#define ST25R3911_TRACE_REG_NUM             64U         /*!< Number of register addresses accounted               */
+
+/*! Traced operations */
+#define ST25R3911_TRACE_OP_REG_READ         0U          /*!< Register read (single or multiple)                   */
+#define ST25R3911_TRACE_OP_REG_WRITE        1U          /*!< Register write (single or multiple)                  */
+#define ST25R3911_TRACE_OP_TEST_READ        2U          /*!< Test register read                                   */
+#define ST25R3911_TRACE_OP_TEST_WRITE       3U          /*!< Test register write                                  */
+#define ST25R3911_TRACE_OP_FIFO_READ        4U          /*!< FIFO read                                            */
+#define ST25R3911_TRACE_OP_FIFO_LOAD        5U          /*!< FIFO load                                            */
+#define ST25R3911_TRACE_OP_CMD              6U          /*!< Direct command(s)                                    */
+#define ST25R3911_TRACE_OP_NUM              7U          /*!< Number of traced operations                          */
+
+/*! RFAL phases the frames are accounted to */
+#define ST25R3911_TRACE_PHASE_OTHER         0U          /*!< Outside of the phases below                          */
+#define ST25R3911_TRACE_PHASE_INIT          1U          /*!< rfalInitialize()                                     */
+#define ST25R3911_TRACE_PHASE_SET_MODE      2U          /*!< rfalSetMode() incl. analog configs                   */
+#define ST25R3911_TRACE_PHASE_SET_BITRATE   3U          /*!< rfalSetBitRate() incl. analog configs                */
+#define ST25R3911_TRACE_PHASE_FIELD         4U          /*!< Field on/off                                         */
+#define ST25R3911_TRACE_PHASE_TRANSCEIVE    5U          /*!< rfalStartTransceive()                                */
+#define ST25R3911_TRACE_PHASE_WORKER        6U          /*!< rfalWorker()                                         */
+#define ST25R3911_TRACE_PHASE_IRQ           7U          /*!< Interrupt status read                                */
+#define ST25R3911_TRACE_PHASE_WAKEUP        8U          /*!< Wake-up and low power modes                          */
+#define ST25R3911_TRACE_PHASE_NUM           9U          /*!< Number of phases                                     */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! One traced SPI frame */
+typedef struct
+{
+    uint32_t timeUs;          /*!< Start of the frame (platform us tick)           */
+    uint16_t durUs;           /*!< Duration of the frame                           */
+    uint8_t  op;              /*!< Operation, ST25R3911_TRACE_OP_*                 */
+    uint8_t  reg;             /*!< Register address, FIFO length or command code   */
+    uint8_t  len;             /*!< Bytes on the bus including the command byte     */
+    uint8_t  phase;           /*!< RFAL phase, ST25R3911_TRACE_PHASE_*             */
+} st25r3911TraceEntry;
+
+/*! Accumulated cost */
+typedef struct
+{
+    uint32_t frames;          /*!< Number of SPI frames                            */
+    uint32_t bytes;           /*!< Number of bytes on the bus                      */
+    uint32_t timeUs;          /*!< Time spent in the frames                        */
+} st25r3911TraceCost;
+
+/*! Trace statistics since the last #st25r3911TraceReset */
+typedef struct
+{
+    st25r3911TraceCost total;                                   /*!< All frames                                   */
+    st25r3911TraceCost op[ST25R3911_TRACE_OP_NUM];              /*!< Per operation                                */
+    st25r3911TraceCost phase[ST25R3911_TRACE_PHASE_NUM];        /*!< Per RFAL phase                               */
+    st25r3911TraceCost reg[ST25R3911_TRACE_REG_NUM];            /*!< Per register (read+write, by first address)  */
+} st25r3911TraceStats;
+
+/*
+******************************************************************************
+* GLOBAL MACROS
+******************************************************************************
+*/
+
+#ifdef ST25R_COM_TRACE
+    #define st25r3911TracePhase( ph )                 st25r3911TraceSetPhase( (ph) )                  /*!< Enter an RFAL phase                 */
+    #define st25r3911TraceBegin()                     st25r3911TraceFrameBegin()                      /*!< Frame starts, com lock held         */
+    #define st25r3911TraceEnd( op, reg, len )         st25r3911TraceFrameEnd( (op), (reg), (len) )    /*!< Frame ends, com lock still held     */
+#else
+    #define st25r3911TracePhase( ph )
+    #define st25r3911TraceBegin()
+    #define st25r3911TraceEnd( op, reg, len )
+#endif /* ST25R_COM_TRACE */
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+#ifdef ST25R_COM_TRACE
+
+/*!
+ *****************************************************************************
+ *  \brief  Sets the current RFAL phase
+ *
+ *  \param[in]  phase: ST25R3911_TRACE_PHASE_*
+ *
+ *****************************************************************************
+ */
+void st25r3911TraceSetPhase( uint8_t phase );
+
+/*!
+ *****************************************************************************
+ *  \brief  Marks the start of a frame
+ *
+ *  Only to be called by the communication layer, with the com lock held
+ *
+ *****************************************************************************
+ */
+void st25r3911TraceFrameBegin( void );
+
+/*!
+ *****************************************************************************
+ *  \brief  Records the frame started with #st25r3911TraceFrameBegin
+ *
+ *  Only to be called by the communication layer, with the com lock held
+ *
+ *  \param[in]  op: ST25R3911_TRACE_OP_*
+ *  \param[in]  reg: register address, FIFO length or command code
+ *  \param[in]  len: number of bytes on the bus including the command byte
+ *
+ *****************************************************************************
+ */
+void st25r3911TraceFrameEnd( uint8_t op, uint8_t reg, uint8_t len );
+
+/*!
+ *****************************************************************************
+ *  \brief  Reads frames from the ring buffer
+ *
+ *  Copies the frames recorded since \a seq. Frames that were overwritten
+ *  before they could be read are skipped, as is the oldest frame of a full
+ *  ring (its slot is the next one written). Does not block the writers.
+ *
+ *  \param[in,out] seq: sequence number of the next frame to read, updated
+ *  \param[out]    entries: output buffer
+ *  \param[in]     max: size of the output buffer
+ *
+ *  \return number of frames copied
+ *
+ *****************************************************************************
+ */
+uint16_t st25r3911TraceRead( uint32_t *seq, st25r3911TraceEntry *entries, uint16_t max );
+
+/*!
+ *****************************************************************************
+ *  \brief  Gets a copy of the trace statistics
+ *
+ *  \param[out] stats: statistics since the last #st25r3911TraceReset
+ *
+ *****************************************************************************
+ */
+void st25r3911TraceGetStats( st25r3911TraceStats *stats );
+
+/*!
+ *****************************************************************************
+ *  \brief  Gets the registers with the highest SPI traffic
+ *
+ *  \param[in]  stats: statistics as returned by #st25r3911TraceGetStats
+ *  \param[out] regs: register addresses, most bytes first
+ *  \param[in]  num: number of registers requested
+ *
+ *  \return number of registers written to \a regs (registers without
+ *          traffic are not reported)
+ *
+ *****************************************************************************
+ */
+uint8_t st25r3911TraceHotRegs( const st25r3911TraceStats *stats, uint8_t *regs, uint8_t num );
+
+/*!
+ *****************************************************************************
+ *  \brief  Clears the trace statistics
+ *
+ *  The ring buffer is kept.
+ *
+ *****************************************************************************
+ */
+void st25r3911TraceReset( void );
+
+/*!
+ *****************************************************************************
+ *  \brief  Gets the name of an operation or phase, for dumps
+ *
+ *****************************************************************************
+ */
+const char *st25r3911TraceOpName( uint8_t op );
+const char *st25r3911TracePhaseName( uint8_t phase );
+
+#endif /* ST25R_COM_TRACE */
+
+#endif /* ST25R3911_TRACE_H */
@@ -0,0 +1,177 @@
+/*! \file Arduino.h
+ *
+ *  \brief Minimal Arduino/FreeRTOS API stand-in for the native (host) build
+ *
+ *  Provides just the subset of the Arduino-ESP32 core used by this project
+ *  (GPIO, interrupts, Serial0, String, FreeRTOS mutexes and delays) so the
+ *  unmodified application and platform layer compile on Linux.
+ *  GPIO accesses to the ST25R3911 CS and IRQ pins are routed to the chip
+ *  simulator, and all time is virtual (see sim_clock.h).
+ *
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define LED_BUILTIN             47          /*!< Same value as the ESP32-S3 DevKitM-1 so config.h selects its pinout */
+
+#define LOW                     0x0
+#define HIGH                    0x1
+
+#define INPUT                   0x01
+#define OUTPUT                  0x03
+
+#define RISING                  0x01
+#define FALLING                 0x02
+#define CHANGE                  0x03
+
+#define digitalPinToInterrupt(p)    (((p) < 64) ? (p) : -1)
+
+#ifndef MEMCPY
+#define MEMCPY(dst, src, len)       memcpy(dst, src, len)   /*!< Normally pulled in through lwIP on the ESP32 core */
+#endif
+
+/*
+******************************************************************************
+* FREERTOS SUBSET
+******************************************************************************
+*/
+typedef uint32_t TickType_t;
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef void   (*TaskFunction_t)( void *arg );
+typedef struct hostSemaphore* SemaphoreHandle_t;
+typedef struct hostTask*      TaskHandle_t;
+typedef struct hostEventGroup* EventGroupHandle_t;
+typedef uint32_t               EventBits_t;
+
+#define configMAX_PRIORITIES    25          /*!< Same as the ESP32 Arduino core */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 1   /*!< Same as the ESP32 Arduino core */
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFU)
+#define portTICK_PERIOD_MS      1U
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  pdTRUE
+#define ARDUINO_RUNNING_CORE    1           /*!< Core of the loopTask, cores are not modelled */
+
+SemaphoreHandle_t xSemaphoreCreateMutex( void );
+BaseType_t xSemaphoreTake( SemaphoreHandle_t sem, TickType_t ticksToWait );
+BaseType_t xSemaphoreGive( SemaphoreHandle_t sem );
+void vTaskDelay( TickType_t ticks );
+TickType_t xTaskGetTickCount( void );
+BaseType_t xTaskCreate( TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, UBaseType_t prio, TaskHandle_t *handle );
+BaseType_t xTaskCreatePinnedToCore( TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, UBaseType_t prio, TaskHandle_t *handle, BaseType_t core );
+void vTaskPrioritySet( TaskHandle_t task, UBaseType_t prio );
+TaskHandle_t xTaskGetCurrentTaskHandle( void );
+void vTaskSetThreadLocalStoragePointer( TaskHandle_t task, BaseType_t index, void *value );
+void *pvTaskGetThreadLocalStoragePointer( TaskHandle_t task, BaseType_t index );
+uint32_t ulTaskNotifyTake( BaseType_t clearCountOnExit, TickType_t ticksToWait );
+BaseType_t xTaskNotifyGive( TaskHandle_t task );
+void vTaskNotifyGiveFromISR( TaskHandle_t task, BaseType_t *higherPriorityTaskWoken );
+
+EventGroupHandle_t xEventGroupCreate( void );
+EventBits_t xEventGroupSetBits( EventGroupHandle_t group, EventBits_t bits );
+EventBits_t xEventGroupClearBits( EventGroupHandle_t group, EventBits_t bits );
+EventBits_t xEventGroupWaitBits( EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit, BaseType_t waitForAll, TickType_t ticksToWait );
+
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+#define ARDUINO_ISR_ATTR
+
+/*
+******************************************************************************
+* ARDUINO CORE SUBSET
+******************************************************************************
+*/
+void pinMode( uint8_t pin, uint8_t mode );
+void digitalWrite( uint8_t pin, uint8_t val );
+int digitalRead( uint8_t pin );
+void attachInterrupt( uint8_t pin, void (*isr)(void), int mode );
+void attachInterruptArg( uint8_t pin, void (*isr)(void *arg), void *arg, int mode );
+void detachInterrupt( uint8_t pin );
+
+unsigned long millis( void );
+unsigned long micros( void );
+void delay( uint32_t ms );
+void delayMicroseconds( uint32_t us );
+
+#ifdef __cplusplus
+}
+
+/*
+******************************************************************************
+* C++ ONLY: String and Serial
+******************************************************************************
+*/
+#include <string>
+
+/*! Tiny subset of Arduino's String class, backed by std::string */
+class String
+{
+public:
+    String( void ) {}
+    String( const char *s ) : str( (s != NULL) ? s : "" ) {}
+    String( const String &s ) = default;
+    String& operator=( const String &s ) = default;
+    String& operator=( const char *s ) { str = (s != NULL) ? s : ""; return *this; }
+    String& operator+=( const String &s ) { str += s.str; return *this; }
+    String& operator+=( const char *s ) { str += s; return *this; }
+    bool operator==( const String &s ) const { return str == s.str; }
+    const char* c_str( void ) const { return str.c_str(); }
+    unsigned int length( void ) const { return (unsigned int)str.length(); }
+
+private:
+    std::string str;
+};
+
+/*! Serial port stand-in writing to stdout */
+class HostSerial
+{
+public:
+    void   begin( unsigned long baud );
+    size_t print( const char *s );
+    size_t print( const String &s );
+    size_t print( char c );
+    size_t print( int n );
+    size_t print( unsigned int n );
+    size_t print( long n );
+    size_t print( unsigned long n );
+    size_t println( void );
+    size_t println( const char *s );
+    size_t println( const String &s );
+    size_t println( char c );
+    size_t println( int n );
+    size_t println( unsigned int n );
+    size_t println( long n );
+    size_t println( unsigned long n );
+    size_t write( const uint8_t *buf, size_t len );
+    size_t printf( const char *fmt, ... ) __attribute__((format(printf, 2, 3)));
+    void   flush( void );
+};
+
+extern HostSerial Serial0;
+extern HostSerial Serial;
+
+#endif /* __cplusplus */
+
+#endif /* HOST_ARDUINO_H */
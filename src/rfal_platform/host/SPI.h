@@ -0,0 +1,74 @@
+/*! \file SPI.h
+ *
+ *  \brief Minimal Arduino SPI API stand-in for the native (host) build
+ *
+ *  Bytes clocked through SPIClass::transferBytes() are handed to the
+ *  ST25R3911 simulator and the virtual clock advances by the time they
+ *  would take on the wire at the configured SPI frequency.
+ *
+ */
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdint.h>
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define MSBFIRST        1
+#define LSBFIRST        0
+
+#define SPI_MODE0       0
+#define SPI_MODE1       1
+#define SPI_MODE2       2
+#define SPI_MODE3       3
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+class SPISettings
+{
+public:
+    SPISettings( uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0 )
+        : clock( clock ), bitOrder( bitOrder ), dataMode( dataMode ) {}
+
+    uint32_t clock;
+    uint8_t  bitOrder;
+    uint8_t  dataMode;
+};
+
+class SPIClass
+{
+public:
+    void begin( int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1 );
+    void end( void );
+    void setFrequency( uint32_t freq );
+    void beginTransaction( SPISettings settings );
+    void endTransaction( void );
+    uint8_t transfer( uint8_t data );
+    void transferBytes( const uint8_t *data, uint8_t *out, uint32_t size );
+
+    uint32_t getFrequency( void ) const { return freq; }
+
+    /* Native build only: SPI clock of the transactions from now on instead of
+       the one of SPISettings, 0 to follow SPISettings again (benchmarks) */
+    void setClockOverride( uint32_t f ) { clockOverride = f; }
+
+private:
+    uint32_t freq          = 1000000;
+    uint32_t clockOverride = 0;
+};
+
+extern SPIClass SPI;
+
+#endif /* HOST_SPI_H */
@@ -0,0 +1,814 @@
+/*! \file host_arduino.cpp
+ *
+ *  \brief Arduino/FreeRTOS/SPI stand-in for the native (host) build
+ *
+ *  Single threaded: the attached ISR is called synchronously from the
+ *  virtual clock whenever the ST25R3911 IRQ line rose, as long as no
+ *  FreeRTOS mutex is held and the ISR is not already running. A deferred
+ *  interrupt is delivered as soon as the last mutex is given back.
+ *
+ *  Tasks created with xTaskCreate() run as coroutines (ucontext) next to
+ *  the Arduino loopTask, which is the main thread. A notified task with a
+ *  higher priority than the running one preempts it at the next scheduling
+ *  point (after an ISR, a notification or a mutex give) and runs until it
+ *  blocks again. The loopTask is also the idle task: while it sleeps, the
+ *  ready tasks of any priority (notified, or whose timed wait expired) run
+ *  in turn and the virtual time advances to the next chip event or task
+ *  timeout.
+ *
+ *  The chip select and IRQ pins of the readers in config.h
+ *  (READER_SS_PINS, READER_IRQ_PINS) are routed to the simulated chips of
+ *  the same index.
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <Arduino.h>
+#include <SPI.h>
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+#include "config.h"
+#include "sim_clock.h"
+#include "sim_st25r3911.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define HOST_PIN_COUNT          64U
+#define HOST_TASKS_MAX          8U
+#define HOST_TASK_STACK_MIN     (64U * 1024U)   /*!< Host frames are larger than the ESP32 ones */
+#define HOST_LOOP_TASK_PRIO     1U              /*!< Priority of the Arduino loopTask           */
+#define HOST_NO_WAKE            UINT64_MAX      /*!< Task not in a timed wait                   */
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+struct hostSemaphore
+{
+    bool taken;
+};
+
+struct hostEventGroup
+{
+    EventBits_t bits;
+};
+
+struct hostIsr
+{
+    void         (*isr)(void);          /*!< attachInterrupt()                      */
+    void         (*isrArg)(void *arg);  /*!< attachInterruptArg()                   */
+    void          *arg;
+};
+
+struct hostTask
+{
+    uint32_t       notifyCount;
+    bool           waiting;             /*!< Blocked on a notification/event group  */
+    hostEventGroup *waitGroup;          /*!< Event group waited for, if any         */
+    EventBits_t    waitBits;
+    uint64_t       wakeNs;              /*!< Timed wait expiry, or HOST_NO_WAKE     */
+    UBaseType_t    prio;
+    ucontext_t     ctx;
+    hostTask      *preempted;           /*!< Task to resume when this one blocks    */
+    TaskFunction_t fn;
+    void          *arg;
+    const char    *name;
+    void          *tls[configNUM_THREAD_LOCAL_STORAGE_POINTERS];  /*!< Thread local storage pointers */
+};
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static hostIsr  gHostIsr[SIM_ST25R3911_CHIPS];     /*!< ISR attached to the IRQ pin of each chip */
+static bool     gHostInIsr;             /*!< ISR currently executing          */
+static uint32_t gHostMutexHeld;         /*!< Number of mutexes currently held */
+static uint8_t  gHostPins[HOST_PIN_COUNT];
+static const uint8_t gHostSsPins[]  = READER_SS_PINS;
+static const uint8_t gHostIrqPins[] = READER_IRQ_PINS;
+static_assert( (sizeof(gHostSsPins) >= SIM_ST25R3911_CHIPS) && (sizeof(gHostIrqPins) >= SIM_ST25R3911_CHIPS), "a reader pin per simulated chip" );
+static hostTask gHostLoopTask = { 0, false, NULL, 0, HOST_NO_WAKE, HOST_LOOP_TASK_PRIO, {}, NULL, NULL, NULL, "loopTask" };
+static hostTask *gHostCurrent = &gHostLoopTask;
+static hostTask *gHostTasks[HOST_TASKS_MAX];
+static uint32_t gHostTaskCnt;
+
+/*
+******************************************************************************
+* GLOBAL VARIABLES
+******************************************************************************
+*/
+SPIClass   SPI;
+HostSerial Serial0;
+HostSerial Serial;
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static void hostSchedule( void )
+{
+    hostTask *next;
+    hostTask *prev;
+    uint32_t  i;
+
+    /* A preempted task could hold a mutex the higher priority one needs */
+    while( !gHostInIsr && (gHostMutexHeld == 0U) )
+    {
+        next = NULL;
+        for( i = 0; i < gHostTaskCnt; i++ )
+        {
+            if( !gHostTasks[i]->waiting && (gHostTasks[i]->prio > gHostCurrent->prio) && ((next == NULL) || (gHostTasks[i]->prio > next->prio)) )
+            {
+                next = gHostTasks[i];
+            }
+        }
+
+        if( next == NULL )
+        {
+            break;
+        }
+
+        prev            = gHostCurrent;
+        next->preempted = prev;
+        gHostCurrent    = next;
+        swapcontext( &prev->ctx, &next->ctx );
+    }
+}
+
+
+/*******************************************************************************/
+static void hostTaskEntry( void )
+{
+    gHostCurrent->fn( gHostCurrent->arg );
+
+    fprintf( stderr, "host: task %s returned\n", gHostCurrent->name );
+    abort();
+}
+
+
+/*******************************************************************************/
+static void hostBlock( void )
+{
+    hostTask *self;
+
+    self = gHostCurrent;
+    if( self == &gHostLoopTask )
+    {
+        fprintf( stderr, "host: loopTask blocked forever\n" );
+        abort();
+    }
+
+    /* Give the CPU back to the task this one preempted */
+    self->waiting = true;
+    gHostCurrent  = self->preempted;
+    swapcontext( &self->ctx, &gHostCurrent->ctx );
+}
+
+
+/*******************************************************************************/
+static bool hostRunIdle( void )
+{
+    hostTask *next;
+    hostTask *task;
+    uint32_t  i;
+
+    if( gHostInIsr || (gHostMutexHeld != 0U) )
+    {
+        return false;
+    }
+
+    next = NULL;
+    for( i = 0; i < gHostTaskCnt; i++ )
+    {
+        task = gHostTasks[i];
+        if( task->waiting && (task->wakeNs <= simClockNowNs()) )
+        {
+            task->waiting = false;                                                    /* Timed out */
+        }
+        if( !task->waiting && ((next == NULL) || (task->prio > next->prio)) )
+        {
+            next = task;
+        }
+    }
+
+    if( next == NULL )
+    {
+        return false;
+    }
+
+    /* Runs until it blocks again, then the loopTask goes on sleeping */
+    next->preempted = &gHostLoopTask;
+    gHostCurrent    = next;
+    swapcontext( &gHostLoopTask.ctx, &next->ctx );
+    return true;
+}
+
+
+/*******************************************************************************/
+static void hostSleep( bool (*done)(void *arg), void *arg, TickType_t ticksToWait )
+{
+    hostTask *self;
+    uint64_t  deadline;
+    uint64_t  next;
+    uint32_t  i;
+
+    self     = gHostCurrent;
+    deadline = simClockNowNs() + ((ticksToWait == portMAX_DELAY) ? UINT64_MAX / 2U : ((uint64_t)ticksToWait * portTICK_PERIOD_MS * SIM_NS_PER_MS));
+
+    if( self != &gHostLoopTask )
+    {
+        self->wakeNs = ((ticksToWait == portMAX_DELAY) ? HOST_NO_WAKE : deadline);
+        while( !done( arg ) && (simClockNowNs() < deadline) )
+        {
+            hostBlock();
+        }
+        self->wakeNs = HOST_NO_WAKE;
+        return;
+    }
+
+    /* The loopTask sleeps from chip event to chip event or task timeout: only the IRQ path and the other tasks can wake it up */
+    while( !done( arg ) && (simClockNowNs() < deadline) )
+    {
+        if( hostRunIdle() )
+        {
+            continue;
+        }
+
+        next = simSt25r3911NextEventNs();
+        next = ((next < deadline) ? next : deadline);
+        for( i = 0; i < gHostTaskCnt; i++ )
+        {
+            next = ((gHostTasks[i]->wakeNs < next) ? gHostTasks[i]->wakeNs : next);
+        }
+        simClockAdvanceNs( (next > simClockNowNs()) ? (next - simClockNowNs()) : 0U );
+    }
+}
+
+
+/*******************************************************************************/
+static bool hostNever( void *arg )
+{
+    (void)arg;
+    return false;
+}
+
+
+/*******************************************************************************/
+static bool hostNotified( void *arg )
+{
+    return (((hostTask*)arg)->notifyCount != 0U);
+}
+
+
+/*******************************************************************************/
+static bool hostBitsSet( void *arg )
+{
+    hostTask *task = (hostTask*)arg;
+
+    return ((task->waitGroup->bits & task->waitBits) != 0U);
+}
+
+
+/*******************************************************************************/
+static int hostChipOfPin( const uint8_t *pins, uint8_t pin )
+{
+    uint8_t chip;
+
+    for( chip = 0; chip < SIM_ST25R3911_CHIPS; chip++ )
+    {
+        if( pins[chip] == pin )
+        {
+            return chip;
+        }
+    }
+    return -1;
+}
+
+
+/*******************************************************************************/
+static void hostDeliverIrq( void )
+{
+    uint8_t chip;
+
+    for( chip = 0; chip < SIM_ST25R3911_CHIPS; chip++ )
+    {
+        while( ((gHostIsr[chip].isr != NULL) || (gHostIsr[chip].isrArg != NULL)) && !gHostInIsr && (gHostMutexHeld == 0U)
+               && simSt25r3911TakeIrqEdge( chip ) )
+        {
+            if( simSt25r3911IrqLine( chip ) )
+            {
+                gHostInIsr = true;
+                if( gHostIsr[chip].isr != NULL )
+                {
+                    gHostIsr[chip].isr();
+                }
+                else
+                {
+                    gHostIsr[chip].isrArg( gHostIsr[chip].arg );
+                }
+                gHostInIsr = false;
+            }
+        }
+    }
+
+    hostSchedule();
+}
+
+/*
+******************************************************************************
+* FREERTOS SUBSET
+******************************************************************************
+*/
+
+/*******************************************************************************/
+SemaphoreHandle_t xSemaphoreCreateMutex( void )
+{
+    return new hostSemaphore();
+}
+
+
+/*******************************************************************************/
+BaseType_t xSemaphoreTake( SemaphoreHandle_t sem, TickType_t ticksToWait )
+{
+    (void)ticksToWait;
+
+    /* Nothing else runs concurrently, a taken mutex can only be a recursive deadlock */
+    if( sem->taken )
+    {
+        fprintf( stderr, "host: deadlock on mutex %p\n", (void*)sem );
+        abort();
+    }
+
+    sem->taken = true;
+    gHostMutexHeld++;
+    return pdTRUE;
+}
+
+
+/*******************************************************************************/
+BaseType_t xSemaphoreGive( SemaphoreHandle_t sem )
+{
+    if( !sem->taken )
+    {
+        return pdFALSE;
+    }
+
+    sem->taken = false;
+    gHostMutexHeld--;
+
+    simClockPoll();
+    hostSchedule();
+    return pdTRUE;
+}
+
+
+/*******************************************************************************/
+void vTaskDelay( TickType_t ticks )
+{
+    hostSleep( hostNever, NULL, ticks );
+}
+
+
+/*******************************************************************************/
+TickType_t xTaskGetTickCount( void )
+{
+    return (TickType_t)(simClockNowNs() / (portTICK_PERIOD_MS * SIM_NS_PER_MS));
+}
+
+/*******************************************************************************/
+BaseType_t xTaskCreate( TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, UBaseType_t prio, TaskHandle_t *handle )
+{
+    hostTask *task;
+    size_t    stackSize;
+
+    if( gHostTaskCnt >= HOST_TASKS_MAX )
+    {
+        return pdFALSE;
+    }
+
+    stackSize = ((stackDepth > HOST_TASK_STACK_MIN) ? stackDepth : HOST_TASK_STACK_MIN);
+
+    task         = new hostTask();
+    task->prio   = prio;
+    task->fn     = fn;
+    task->arg    = arg;
+    task->name   = name;
+    task->wakeNs = HOST_NO_WAKE;
+
+    getcontext( &task->ctx );
+    task->ctx.uc_stack.ss_sp   = malloc( stackSize );
+    task->ctx.uc_stack.ss_size = stackSize;
+    task->ctx.uc_link          = NULL;
+    makecontext( &task->ctx, hostTaskEntry, 0 );
+
+    gHostTasks[gHostTaskCnt++] = task;
+    if( handle != NULL )
+    {
+        *handle = task;
+    }
+
+    /* A new task starts right away if it has a higher priority */
+    hostSchedule();
+    return pdPASS;
+}
+
+
+/*******************************************************************************/
+BaseType_t xTaskCreatePinnedToCore( TaskFunction_t fn, const char *name, uint32_t stackDepth, void *arg, UBaseType_t prio, TaskHandle_t *handle, BaseType_t core )
+{
+    /* One simulated CPU: the affinity is ignored, the tasks interleave as scheduled */
+    (void)core;
+
+    return xTaskCreate( fn, name, stackDepth, arg, prio, handle );
+}
+
+
+/*******************************************************************************/
+void vTaskPrioritySet( TaskHandle_t task, UBaseType_t prio )
+{
+    ((task != NULL) ? task : gHostCurrent)->prio = prio;
+
+    hostSchedule();
+}
+
+
+/*******************************************************************************/
+TaskHandle_t xTaskGetCurrentTaskHandle( void )
+{
+    return gHostCurrent;
+}
+
+
+/*******************************************************************************/
+void vTaskSetThreadLocalStoragePointer( TaskHandle_t task, BaseType_t index, void *value )
+{
+    if( (index >= 0) && (index < configNUM_THREAD_LOCAL_STORAGE_POINTERS) )
+    {
+        ((task != NULL) ? task : gHostCurrent)->tls[index] = value;
+    }
+}
+
+
+/*******************************************************************************/
+void *pvTaskGetThreadLocalStoragePointer( TaskHandle_t task, BaseType_t index )
+{
+    if( (index >= 0) && (index < configNUM_THREAD_LOCAL_STORAGE_POINTERS) )
+    {
+        return ((task != NULL) ? task : gHostCurrent)->tls[index];
+    }
+    return NULL;
+}
+
+
+/*******************************************************************************/
+uint32_t ulTaskNotifyTake( BaseType_t clearCountOnExit, TickType_t ticksToWait )
+{
+    hostTask *self;
+    uint32_t  count;
+
+    self = gHostCurrent;
+    hostSleep( hostNotified, self, ticksToWait );
+
+    count = self->notifyCount;
+    if( count != 0U )
+    {
+        self->notifyCount = ((clearCountOnExit != pdFALSE) ? 0U : (count - 1U));
+    }
+    return count;
+}
+
+
+/*******************************************************************************/
+BaseType_t xTaskNotifyGive( TaskHandle_t task )
+{
+    task->notifyCount++;
+    task->waiting = false;
+
+    hostSchedule();
+    return pdPASS;
+}
+
+
+/*******************************************************************************/
+void vTaskNotifyGiveFromISR( TaskHandle_t task, BaseType_t *higherPriorityTaskWoken )
+{
+    task->notifyCount++;
+    task->waiting = false;
+
+    /* The switch itself happens once the ISR returned, see hostDeliverIrq() */
+    if( higherPriorityTaskWoken != NULL )
+    {
+        *higherPriorityTaskWoken = ((task->prio > gHostCurrent->prio) ? pdTRUE : pdFALSE);
+    }
+}
+
+/*******************************************************************************/
+EventGroupHandle_t xEventGroupCreate( void )
+{
+    return new hostEventGroup();
+}
+
+
+/*******************************************************************************/
+EventBits_t xEventGroupSetBits( EventGroupHandle_t group, EventBits_t bits )
+{
+    uint32_t i;
+
+    group->bits |= bits;
+
+    for( i = 0; i < gHostTaskCnt; i++ )
+    {
+        if( (gHostTasks[i]->waitGroup == group) && ((group->bits & gHostTasks[i]->waitBits) != 0U) )
+        {
+            gHostTasks[i]->waiting = false;
+        }
+    }
+
+    hostSchedule();
+    return group->bits;
+}
+
+
+/*******************************************************************************/
+EventBits_t xEventGroupClearBits( EventGroupHandle_t group, EventBits_t bits )
+{
+    EventBits_t prev;
+
+    prev         = group->bits;
+    group->bits &= ~bits;
+    return prev;
+}
+
+
+/*******************************************************************************/
+EventBits_t xEventGroupWaitBits( EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit, BaseType_t waitForAll, TickType_t ticksToWait )
+{
+    hostTask   *self;
+    EventBits_t ret;
+
+    if( waitForAll != pdFALSE )
+    {
+        fprintf( stderr, "host: xEventGroupWaitBits: waitForAll not supported\n" );
+        abort();
+    }
+
+    self            = gHostCurrent;
+    self->waitGroup = group;
+    self->waitBits  = bits;
+    hostSleep( hostBitsSet, self, ticksToWait );
+    self->waitGroup = NULL;
+
+    ret = group->bits;
+    if( ((ret & bits) != 0U) && (clearOnExit != pdFALSE) )
+    {
+        group->bits &= ~bits;
+    }
+    return ret;
+}
+
+/*
+******************************************************************************
+* ARDUINO CORE SUBSET
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void pinMode( uint8_t pin, uint8_t mode )
+{
+    (void)pin;
+    (void)mode;
+}
+
+
+/*******************************************************************************/
+void digitalWrite( uint8_t pin, uint8_t val )
+{
+    int chip;
+
+    if( pin < HOST_PIN_COUNT )
+    {
+        gHostPins[pin] = val;
+    }
+
+    chip = hostChipOfPin( gHostSsPins, pin );
+    if( chip >= 0 )
+    {
+        simSt25r3911Select( (uint8_t)chip, (val == LOW) );
+    }
+}
+
+
+/*******************************************************************************/
+int digitalRead( uint8_t pin )
+{
+    int chip;
+
+    chip = hostChipOfPin( gHostIrqPins, pin );
+    if( chip >= 0 )
+    {
+        return (simSt25r3911IrqLine( (uint8_t)chip ) ? HIGH : LOW);
+    }
+
+    return ((pin < HOST_PIN_COUNT) ? gHostPins[pin] : LOW);
+}
+
+
+/*******************************************************************************/
+void attachInterrupt( uint8_t pin, void (*isr)(void), int mode )
+{
+    int chip;
+
+    (void)mode;
+
+    chip = hostChipOfPin( gHostIrqPins, pin );
+    if( chip >= 0 )
+    {
+        gHostIsr[chip].isr    = isr;
+        gHostIsr[chip].isrArg = NULL;
+        simClockSetIrqHook( hostDeliverIrq );
+    }
+}
+
+
+/*******************************************************************************/
+void attachInterruptArg( uint8_t pin, void (*isr)(void *arg), void *arg, int mode )
+{
+    int chip;
+
+    (void)mode;
+
+    chip = hostChipOfPin( gHostIrqPins, pin );
+    if( chip >= 0 )
+    {
+        gHostIsr[chip].isr    = NULL;
+        gHostIsr[chip].isrArg = isr;
+        gHostIsr[chip].arg    = arg;
+        simClockSetIrqHook( hostDeliverIrq );
+    }
+}
+
+
+/*******************************************************************************/
+void detachInterrupt( uint8_t pin )
+{
+    int chip;
+
+    chip = hostChipOfPin( gHostIrqPins, pin );
+    if( chip >= 0 )
+    {
+        gHostIsr[chip].isr    = NULL;
+        gHostIsr[chip].isrArg = NULL;
+    }
+}
+
+
+/*******************************************************************************/
+unsigned long millis( void )
+{
+    return (unsigned long)(simClockNowNs() / SIM_NS_PER_MS);
+}
+
+
+/*******************************************************************************/
+unsigned long micros( void )
+{
+    return (unsigned long)(simClockNowNs() / SIM_NS_PER_US);
+}
+
+
+/*******************************************************************************/
+void delay( uint32_t ms )
+{
+    simClockAdvanceNs( (uint64_t)ms * SIM_NS_PER_MS );
+}
+
+
+/*******************************************************************************/
+void delayMicroseconds( uint32_t us )
+{
+    simClockAdvanceNs( (uint64_t)us * SIM_NS_PER_US );
+}
+
+/*
+******************************************************************************
+* SPI
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void SPIClass::begin( int8_t sck, int8_t miso, int8_t mosi, int8_t ss )
+{
+    (void)sck;
+    (void)miso;
+    (void)mosi;
+    (void)ss;
+}
+
+
+/*******************************************************************************/
+void SPIClass::end( void )
+{
+}
+
+
+/*******************************************************************************/
+void SPIClass::setFrequency( uint32_t f )
+{
+    freq = ((f != 0U) ? f : 1U);
+}
+
+
+/*******************************************************************************/
+void SPIClass::beginTransaction( SPISettings settings )
+{
+    setFrequency( (clockOverride != 0U) ? clockOverride : settings.clock );
+}
+
+
+/*******************************************************************************/
+void SPIClass::endTransaction( void )
+{
+}
+
+
+/*******************************************************************************/
+uint8_t SPIClass::transfer( uint8_t data )
+{
+    uint8_t out;
+
+    transferBytes( &data, &out, 1 );
+    return out;
+}
+
+
+/*******************************************************************************/
+void SPIClass::transferBytes( const uint8_t *data, uint8_t *out, uint32_t size )
+{
+    uint32_t i;
+    uint8_t  miso;
+
+    for( i = 0; i < size; i++ )
+    {
+        /* Like the ESP32 core, clock out 0xFF when no TX data is given */
+        miso = simSt25r3911SpiByte( (data != NULL) ? data[i] : 0xFFU );
+        if( out != NULL )
+        {
+            out[i] = miso;
+        }
+    }
+
+    simClockAdvanceNs( ((uint64_t)size * 8U * 1000000000ULL) / freq );
+}
+
+/*
+******************************************************************************
+* SERIAL
+******************************************************************************
+*/
+void   HostSerial::begin( unsigned long baud )   { (void)baud; }
+size_t HostSerial::print( const char *s )        { (void)fputs( s, stdout ); return strlen( s ); }
+size_t HostSerial::print( const String &s )      { return print( s.c_str() ); }
+size_t HostSerial::print( char c )               { return (size_t)(fputc( c, stdout ) != EOF); }
+size_t HostSerial::print( int n )                { return (size_t)::printf( "%d", n ); }
+size_t HostSerial::print( unsigned int n )       { return (size_t)::printf( "%u", n ); }
+size_t HostSerial::print( long n )               { return (size_t)::printf( "%ld", n ); }
+size_t HostSerial::print( unsigned long n )      { return (size_t)::printf( "%lu", n ); }
+size_t HostSerial::println( void )               { return print( "\r\n" ); }
+size_t HostSerial::println( const char *s )      { return print( s ) + println(); }
+size_t HostSerial::println( const String &s )    { return print( s ) + println(); }
+size_t HostSerial::println( char c )             { return print( c ) + println(); }
+size_t HostSerial::println( int n )              { return print( n ) + println(); }
+size_t HostSerial::println( unsigned int n )     { return print( n ) + println(); }
+size_t HostSerial::println( long n )             { return print( n ) + println(); }
+size_t HostSerial::println( unsigned long n )    { return print( n ) + println(); }
+size_t HostSerial::write( const uint8_t *buf, size_t len ) { return fwrite( buf, 1, len, stdout ); }
+void   HostSerial::flush( void )                 { fflush( stdout ); }
+
+
+/*******************************************************************************/
+size_t HostSerial::printf( const char *fmt, ... )
+{
+    va_list args;
+    int     len;
+
+    va_start( args, fmt );
+    len = vprintf( fmt, args );
+    va_end( args );
+
+    return (size_t)((len > 0) ? len : 0);
+}
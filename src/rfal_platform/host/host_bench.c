@@ -0,0 +1,542 @@
+/*! \file host_bench.c
+ *
+ *  \brief Host micro benchmarks of RFAL hot paths
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_bench.h"
+#include "rfal_core/rfal_crc.h"
+#include "rfal_core/rfal_iso15693_2.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HOST_BENCH_HAS_TSC
+#endif
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define HOST_BENCH_CRC_CHECKS       20000U  /*!< Randomized buffers compared per engine   */
+#define HOST_BENCH_CRC_MAX_LEN      300U    /*!< Largest randomized buffer                */
+#define HOST_BENCH_CRC_BUF_LEN      256U    /*!< Benchmark buffer (typical RF frame size) */
+#define HOST_BENCH_CRC_ROUNDS       200000U /*!< Benchmark iterations                     */
+#define HOST_BENCH_SEED             0x3911U
+
+#define HOST_BENCH_V_CHECKS         100000U /*!< Randomized responses compared             */
+#define HOST_BENCH_V_MAX_LEN        140U    /*!< Largest decoded response incl. flags, CRC */
+#define HOST_BENCH_V_STREAM_LEN     ((((HOST_BENCH_V_MAX_LEN * 16U) + 5U + 8U) / 8U) + 2U)  /*!< Manchester stream size */
+#define HOST_BENCH_V_ROUNDS         20000U  /*!< Benchmark iterations per response          */
+#define HOST_BENCH_VCD_CHECKS       20000U  /*!< Randomized requests compared per coding    */
+#define HOST_BENCH_VCD_MAX_LEN      64U     /*!< Largest randomized request                 */
+#define HOST_BENCH_VCD_MAX_CHUNK    300U    /*!< Largest randomized output chunk            */
+#define HOST_BENCH_VCD_FIFO         96U     /*!< First chunk of the timed frames (FIFO size) */
+#define HOST_BENCH_VCD_WL           64U     /*!< Following chunks (FIFO free at water level) */
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static const struct
+{
+    uint8_t     engine;
+    const char *name;
+} hostBenchCrcEngines[] =
+{
+    { RFAL_CRC_ENGINE_BITWISE, "bitwise" },
+    { RFAL_CRC_ENGINE_TABLE,   "table"   },
+    { RFAL_CRC_ENGINE_SLICE4,  "slice4"  },
+    { RFAL_CRC_ENGINE_SLICE8,  "slice8"  },
+};
+
+#define HOST_BENCH_CRC_ENGINES      (sizeof(hostBenchCrcEngines) / sizeof(hostBenchCrcEngines[0]))
+
+static volatile uint16_t hostBenchSink;     /*!< Keeps the benchmark loops from being optimized out */
+
+typedef ReturnCode (*hostBenchVCode)( uint8_t *buffer, uint16_t length, bool sendCrc, bool sendFlags, bool picopassMode,
+                                      uint16_t *subbit_total_length, uint16_t *offset,
+                                      uint8_t *outbuf, uint16_t outBufSize, uint16_t *actOutBufSize );
+
+typedef ReturnCode (*hostBenchVDecode)( const uint8_t *inBuf, uint16_t inBufLen, uint8_t *outBuf, uint16_t outBufLen,
+                                        uint16_t *outBufPos, uint16_t *bitsBeforeCol, uint16_t ignoreBits, bool picopassMode );
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static uint64_t hostBenchNowNs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+/*******************************************************************************/
+static uint64_t hostBenchCycles( void )
+{
+#ifdef HOST_BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*******************************************************************************/
+static void hostBenchPutBit( uint8_t *stream, uint16_t *pos, uint8_t bit )
+{
+    if( bit != 0U )
+    {
+        stream[*pos / 8U] |= (uint8_t)(1U << (*pos % 8U));
+    }
+    (*pos)++;
+}
+
+
+/*******************************************************************************/
+static uint16_t hostBenchEncodeV( const uint8_t *data, uint16_t len, uint8_t *stream, uint16_t streamLen )
+{
+    uint16_t pos;
+    uint16_t i;
+    uint8_t  b;
+
+    /* Same layout as the ST25R3911 delivers in stream mode: SOF 11101, a 
+     * Manchester pair per bit (0 = 10, 1 = 01, LSB first) and EOF 10111000 */
+    memset( stream, 0x00, streamLen );
+    pos = 0;
+    hostBenchPutBit( stream, &pos, 1U );
+    hostBenchPutBit( stream, &pos, 1U );
+    hostBenchPutBit( stream, &pos, 1U );
+    hostBenchPutBit( stream, &pos, 0U );
+    hostBenchPutBit( stream, &pos, 1U );
+
+    for( i = 0; i < (len * 8U); i++ )
+    {
+        b = (uint8_t)((data[i / 8U] >> (i % 8U)) & 1U);
+        hostBenchPutBit( stream, &pos, (uint8_t)(b ^ 1U) );
+        hostBenchPutBit( stream, &pos, b );
+    }
+
+    hostBenchPutBit( stream, &pos, 1U );
+    hostBenchPutBit( stream, &pos, 0U );
+    hostBenchPutBit( stream, &pos, 1U );
+    hostBenchPutBit( stream, &pos, 1U );
+    hostBenchPutBit( stream, &pos, 1U );
+
+    return (uint16_t)((pos + 7U) / 8U) + 1U;
+}
+
+
+/*******************************************************************************/
+static uint16_t hostBenchMakeV( const uint8_t *payload, uint16_t len, uint8_t *frame )
+{
+    uint16_t crc;
+
+    memcpy( frame, payload, len );
+    crc = (uint16_t)~rfalCrcCalculateCcitt( 0xFFFFU, frame, len );
+    frame[len]      = (uint8_t)(crc & 0xFFU);
+    frame[len + 1U] = (uint8_t)(crc >> 8);
+    return (len + 2U);
+}
+
+
+/*******************************************************************************/
+static double hostBenchTimeV( hostBenchVDecode dec, const uint8_t *stream, uint16_t streamLen, uint16_t outLen )
+{
+    static uint8_t out[HOST_BENCH_V_MAX_LEN];
+    uint16_t       pos;
+    uint16_t       bits;
+    uint32_t       i;
+    uint64_t       t0;
+    uint64_t       t1;
+    uint16_t       acc;
+
+    acc = 0;
+    t0  = hostBenchNowNs();
+    for( i = 0; i < HOST_BENCH_V_ROUNDS; i++ )
+    {
+        acc += (uint16_t)dec( stream, streamLen, out, outLen, &pos, &bits, 0U, false );
+        acc += pos;
+    }
+    t1 = hostBenchNowNs();
+    hostBenchSink = acc;
+
+    return (double)(t1 - t0) / (double)HOST_BENCH_V_ROUNDS;
+}
+
+/*******************************************************************************/
+static void hostBenchSetVCoding( rfalIso15693VcdCoding_t coding )
+{
+    rfalIso15693PhyConfig_t              cfg;
+    const struct iso15693StreamConfig   *stream;
+
+    cfg.coding    = coding;
+    cfg.speedMode = 0;
+    rfalIso15693PhyConfigure( &cfg, &stream );
+}
+
+
+/*******************************************************************************/
+static double hostBenchTimeVCD( hostBenchVCode code, const uint8_t *frame, uint16_t len )
+{
+    static uint8_t buf[HOST_BENCH_VCD_MAX_LEN];
+    static uint8_t out[HOST_BENCH_VCD_MAX_CHUNK + 1U];
+    uint16_t       total;
+    uint16_t       offset;
+    uint16_t       act;
+    uint16_t       chunk;
+    uint32_t       i;
+    uint64_t       t0;
+    uint64_t       t1;
+    uint16_t       acc;
+    ReturnCode     err;
+
+    acc = 0;
+    t0  = hostBenchNowNs();
+    for( i = 0; i < HOST_BENCH_V_ROUNDS; i++ )
+    {
+        /* Chunked like rfalTransceiveTx(): a full FIFO first, then refills at the water level */
+        memcpy( buf, frame, len );
+        offset = 0;
+        chunk  = HOST_BENCH_VCD_FIFO;
+        do
+        {
+            err   = code( buf, len, true, true, false, &total, &offset, out, chunk, &act );
+            acc  += act;
+            chunk = HOST_BENCH_VCD_WL;
+        }
+        while( err == RFAL_ERR_AGAIN );
+        acc += out[0];
+    }
+    t1 = hostBenchNowNs();
+    hostBenchSink = acc;
+
+    return (double)(t1 - t0) / (double)HOST_BENCH_V_ROUNDS;
+}
+
+
+/*******************************************************************************/
+static bool hostBenchIso15693Coder( void )
+{
+    static uint8_t frame[HOST_BENCH_VCD_MAX_LEN];
+    static uint8_t bufNew[HOST_BENCH_VCD_MAX_LEN];
+    static uint8_t bufRef[HOST_BENCH_VCD_MAX_LEN];
+    static uint8_t outNew[HOST_BENCH_VCD_MAX_CHUNK + 1U];
+    static uint8_t outRef[HOST_BENCH_VCD_MAX_CHUNK + 1U];
+    uint32_t       i;
+    uint16_t       j;
+    uint16_t       len;
+    uint16_t       chunk;
+    uint16_t       minChunk;
+    uint16_t       offNew;
+    uint16_t       offRef;
+    uint16_t       totNew;
+    uint16_t       totRef;
+    uint16_t       actNew;
+    uint16_t       actRef;
+    uint32_t       chunks;
+    ReturnCode     errNew;
+    ReturnCode     errRef;
+    bool           crc;
+    bool           flags;
+    bool           pico;
+    bool           ok;
+    uint8_t        c;
+    double         tNew;
+    double         tRef;
+
+    ok     = true;
+    chunks = 0;
+
+    for( c = 0; c < 2U; c++ )
+    {
+        hostBenchSetVCoding( (c == 0U) ? ISO15693_VCD_CODING_1_4 : ISO15693_VCD_CODING_1_256 );
+        minChunk = ((c == 0U) ? 5U : 65U);
+
+        for( i = 0; (i < HOST_BENCH_VCD_CHECKS) && ok; i++ )
+        {
+            len = (uint16_t)((uint32_t)rand() % HOST_BENCH_VCD_MAX_LEN);
+            for( j = 0; j < len; j++ )
+            {
+                frame[j] = (uint8_t)rand();
+            }
+            crc   = ((rand() % 4) != 0);
+            flags = ((rand() % 2) != 0);
+            pico  = ((len != 0U) && ((rand() % 8) == 0));
+
+            memcpy( bufNew, frame, sizeof(frame) );
+            memcpy( bufRef, frame, sizeof(frame) );
+            offNew = 0;
+            offRef = 0;
+
+            do
+            {
+                /* Mostly minimum and FIFO sized chunks, the boundaries where the coders could differ */
+                switch( rand() % 4 )
+                {
+                    case 0:  chunk = minChunk;                                                                            break;
+                    case 1:  chunk = HOST_BENCH_VCD_FIFO;                                                                 break;
+                    default: chunk = (uint16_t)(minChunk + ((uint32_t)rand() % (HOST_BENCH_VCD_MAX_CHUNK - minChunk)));   break;
+                }
+
+                memset( outNew, 0x5A, sizeof(outNew) );
+                memset( outRef, 0x5A, sizeof(outRef) );
+                errNew = rfalIso15693VCDCode( bufNew, len, crc, flags, pico, &totNew, &offNew, outNew, chunk, &actNew );
+                errRef = rfalIso15693VCDCodeReference( bufRef, len, crc, flags, pico, &totRef, &offRef, outRef, chunk, &actRef );
+                chunks++;
+
+                if( (errNew != errRef) || (offNew != offRef) || (totNew != totRef) || (actNew != actRef)
+                    || (memcmp( outNew, outRef, sizeof(outNew) ) != 0) || (memcmp( bufNew, bufRef, sizeof(bufNew) ) != 0) )
+                {
+                    fprintf( stderr, "iso15693 coder mismatch #%u: 1of%u len %u chunk %u: err %d/%d offset %u/%u act %u/%u total %u/%u\n",
+                             (unsigned)i, ((c == 0U) ? 4U : 256U), len, chunk, errNew, errRef, offNew, offRef, actNew, actRef, totNew, totRef );
+                    ok = false;
+                }
+            }
+            while( ok && (errRef == RFAL_ERR_AGAIN) );
+        }
+    }
+    fprintf( stderr, "iso15693 coder : %u randomized requests (%u chunks) %s\n", (unsigned)(2U * HOST_BENCH_VCD_CHECKS), (unsigned)chunks, (ok ? "identical" : "MISMATCH") );
+
+    /* Write Multiple Blocks, addressed: flags, cmd, UID, first block, count, 4 blocks of 4 bytes */
+    len = (1U + 1U + 8U + 1U + 1U + (4U * 4U));
+    for( j = 0; j < len; j++ )
+    {
+        frame[j] = (uint8_t)rand();
+    }
+    hostBenchSetVCoding( ISO15693_VCD_CODING_1_4 );
+    tNew = hostBenchTimeVCD( rfalIso15693VCDCode, frame, len );
+    tRef = hostBenchTimeVCD( rfalIso15693VCDCodeReference, frame, len );
+    fprintf( stderr, "iso15693 wmb   : %7.0f ns/frame (reference %7.0f ns, x%.1f) 1 of 4\n", tNew, tRef, (tRef / tNew) );
+
+    hostBenchSetVCoding( ISO15693_VCD_CODING_1_256 );
+    tNew = hostBenchTimeVCD( rfalIso15693VCDCode, frame, len );
+    tRef = hostBenchTimeVCD( rfalIso15693VCDCodeReference, frame, len );
+    fprintf( stderr, "iso15693 wmb   : %7.0f ns/frame (reference %7.0f ns, x%.1f) 1 of 256\n", tNew, tRef, (tRef / tNew) );
+
+    return ok;
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+bool hostBenchCrc( void )
+{
+    static uint8_t buf[HOST_BENCH_CRC_MAX_LEN + 8U];
+    uint32_t       i;
+    uint32_t       e;
+    uint16_t       len;
+    uint16_t       off;
+    uint16_t       seed;
+    uint16_t       ref;
+    uint16_t       crc;
+    uint64_t       t0;
+    uint64_t       t1;
+    uint64_t       c0;
+    uint64_t       c1;
+    uint64_t       bytes;
+    bool           ok;
+
+    ok = true;
+    srand( HOST_BENCH_SEED );
+
+    /* CRC_A of 00 00 (ISO/IEC 14443-3 annex B) */
+    buf[0] = 0x00;
+    buf[1] = 0x00;
+    for( e = 0; e < HOST_BENCH_CRC_ENGINES; e++ )
+    {
+        if( rfalCrcCalculateCcittEngine( hostBenchCrcEngines[e].engine, 0x6363U, buf, 2U ) != 0x1EA0U )
+        {
+            fprintf( stderr, "crc %-8s: wrong CRC_A of 00 00\n", hostBenchCrcEngines[e].name );
+            ok = false;
+        }
+    }
+
+    /* Randomized lengths, alignments and preloads against the bit-wise reference */
+    for( i = 0; i < HOST_BENCH_CRC_CHECKS; i++ )
+    {
+        len  = (uint16_t)(rand() % (HOST_BENCH_CRC_MAX_LEN + 1U));
+        off  = (uint16_t)(rand() % 8);
+        seed = (uint16_t)rand();
+        for( e = 0; e < (uint32_t)len; e++ )
+        {
+            buf[off + e] = (uint8_t)rand();
+        }
+
+        ref = rfalCrcCalculateCcittEngine( RFAL_CRC_ENGINE_BITWISE, seed, &buf[off], len );
+        for( e = 1; e < HOST_BENCH_CRC_ENGINES; e++ )
+        {
+            crc = rfalCrcCalculateCcittEngine( hostBenchCrcEngines[e].engine, seed, &buf[off], len );
+            if( crc != ref )
+            {
+                fprintf( stderr, "crc %-8s: mismatch len %u off %u seed %04X: %04X != %04X\n", hostBenchCrcEngines[e].name,
+                         len, off, seed, crc, ref );
+                ok = false;
+                break;
+            }
+        }
+    }
+    fprintf( stderr, "crc check      : %u randomized buffers %s\n", HOST_BENCH_CRC_CHECKS, (ok ? "identical" : "MISMATCH") );
+
+    /* Throughput */
+    for( e = 0; e < HOST_BENCH_CRC_ENGINES; e++ )
+    {
+        crc = 0x6363U;
+        t0  = hostBenchNowNs();
+        c0  = hostBenchCycles();
+        for( i = 0; i < HOST_BENCH_CRC_ROUNDS; i++ )
+        {
+            crc = rfalCrcCalculateCcittEngine( hostBenchCrcEngines[e].engine, crc, buf, HOST_BENCH_CRC_BUF_LEN );
+        }
+        c1 = hostBenchCycles();
+        t1 = hostBenchNowNs();
+        hostBenchSink = crc;
+
+        bytes = (uint64_t)HOST_BENCH_CRC_ROUNDS * HOST_BENCH_CRC_BUF_LEN;
+        fprintf( stderr, "crc %-8s   : %7.3f ns/byte %8.1f MB/s", hostBenchCrcEngines[e].name,
+                 (double)(t1 - t0) / (double)bytes, ((double)bytes * 1000.0) / (double)(t1 - t0) );
+        if( c1 != c0 )
+        {
+            fprintf( stderr, " %6.3f bytes/cycle", (double)bytes / (double)(c1 - c0) );
+        }
+        fprintf( stderr, "\n" );
+    }
+
+    return ok;
+}
+
+
+/*******************************************************************************/
+bool hostBenchIso15693( void )
+{
+    static uint8_t payload[HOST_BENCH_V_MAX_LEN];
+    static uint8_t frame[HOST_BENCH_V_MAX_LEN];
+    static uint8_t stream[HOST_BENCH_V_STREAM_LEN];
+    static uint8_t outNew[HOST_BENCH_V_MAX_LEN + 4U];
+    static uint8_t outRef[HOST_BENCH_V_MAX_LEN + 4U];
+    uint32_t       i;
+    uint16_t       j;
+    uint16_t       len;
+    uint16_t       streamLen;
+    uint16_t       outLen;
+    uint16_t       ignore;
+    uint16_t       posNew;
+    uint16_t       posRef;
+    uint16_t       bitsNew;
+    uint16_t       bitsRef;
+    ReturnCode     errNew;
+    ReturnCode     errRef;
+    bool           pico;
+    bool           ok;
+    uint32_t       valid;
+    double         tNew;
+    double         tRef;
+
+    ok    = true;
+    valid = 0;
+    srand( HOST_BENCH_SEED );
+
+    for( i = 0; (i < HOST_BENCH_V_CHECKS) && ok; i++ )
+    {
+        len = (uint16_t)(1U + ((uint32_t)rand() % (HOST_BENCH_V_MAX_LEN - 2U)));
+        for( j = 0; j < len; j++ )
+        {
+            payload[j] = (uint8_t)rand();
+        }
+        streamLen = hostBenchEncodeV( frame, hostBenchMakeV( payload, len, frame ), stream, sizeof(stream) );
+
+        switch( rand() % 6 )
+        {
+            case 0:     /* Flip a few bits: collisions, broken CRC, fake EOF */
+                for( j = (uint16_t)(rand() % 4); j < 4U; j++ )
+                {
+                    stream[(uint32_t)rand() % streamLen] ^= (uint8_t)(1U << (rand() % 8));
+                }
+                break;
+            case 1:     /* Truncated */
+                streamLen = (uint16_t)(1U + ((uint32_t)rand() % streamLen));
+                break;
+            case 2:     /* Random stream behind a valid SOF */
+                for( j = 0; j < streamLen; j++ )
+                {
+                    stream[j] = (uint8_t)rand();
+                }
+                stream[0] = (uint8_t)((stream[0] & 0xE0U) | 0x17U);
+                break;
+            case 3:     /* Collision pair (00 or 11) at a random data bit */
+                j = (uint16_t)(5U + (2U * ((uint32_t)rand() % (len * 8U))));
+                stream[j / 8U]        = (uint8_t)(stream[j / 8U] & ~(1U << (j % 8U)));
+                stream[(j + 1U) / 8U] = (uint8_t)(stream[(j + 1U) / 8U] & ~(1U << ((j + 1U) % 8U)));
+                if( (rand() % 2) != 0 )
+                {
+                    stream[j / 8U]        |= (uint8_t)(1U << (j % 8U));
+                    stream[(j + 1U) / 8U] |= (uint8_t)(1U << ((j + 1U) % 8U));
+                }
+                break;
+            default:    /* Valid */
+                break;
+        }
+
+        outLen = (uint16_t)(((rand() % 4) == 0) ? ((uint32_t)rand() % (len + 4U)) : (len + 4U));
+        ignore = (uint16_t)(((rand() % 4) == 0) ? ((uint32_t)rand() % (len * 8U)) : 0U);
+        pico   = ((rand() % 8) == 0);
+
+        memset( outNew, 0x5A, sizeof(outNew) );
+        memset( outRef, 0x5A, sizeof(outRef) );
+        errNew = rfalIso15693VICCDecode( stream, streamLen, outNew, outLen, &posNew, &bitsNew, ignore, pico );
+        errRef = rfalIso15693VICCDecodeReference( stream, streamLen, outRef, outLen, &posRef, &bitsRef, ignore, pico );
+
+        if( (errNew != errRef) || (posNew != posRef) || (bitsNew != bitsRef) || (memcmp( outNew, outRef, sizeof(outNew) ) != 0) )
+        {
+            fprintf( stderr, "iso15693 mismatch #%u: len %u stream %u out %u ignore %u: err %d/%d pos %u/%u bits %u/%u\n",
+                     (unsigned)i, len, streamLen, outLen, ignore, errNew, errRef, posNew, posRef, bitsNew, bitsRef );
+            ok = false;
+        }
+        valid += (errRef == RFAL_ERR_NONE) ? 1U : 0U;
+    }
+    fprintf( stderr, "iso15693 check : %u randomized responses (%u valid) %s\n", (unsigned)i, (unsigned)valid, (ok ? "identical" : "MISMATCH") );
+
+    /* Inventory response: flags, DSFID, UID */
+    len = 10U;
+    for( j = 0; j < len; j++ )
+    {
+        payload[j] = (uint8_t)rand();
+    }
+    streamLen = hostBenchEncodeV( frame, hostBenchMakeV( payload, len, frame ), stream, sizeof(stream) );
+    tNew = hostBenchTimeV( rfalIso15693VICCDecode, stream, streamLen, (len + 4U) );
+    tRef = hostBenchTimeV( rfalIso15693VICCDecodeReference, stream, streamLen, (len + 4U) );
+    fprintf( stderr, "iso15693 inv   : %7.0f ns/frame (reference %7.0f ns, x%.1f)\n", tNew, tRef, (tRef / tNew) );
+
+    /* Read Multiple Blocks response: flags + 32 blocks of 4 bytes */
+    len = 1U + (32U * 4U);
+    for( j = 0; j < len; j++ )
+    {
+        payload[j] = (uint8_t)rand();
+    }
+    streamLen = hostBenchEncodeV( frame, hostBenchMakeV( payload, len, frame ), stream, sizeof(stream) );
+    tNew = hostBenchTimeV( rfalIso15693VICCDecode, stream, streamLen, (len + 4U) );
+    tRef = hostBenchTimeV( rfalIso15693VICCDecodeReference, stream, streamLen, (len + 4U) );
+    fprintf( stderr, "iso15693 rmb   : %7.0f ns/frame (reference %7.0f ns, x%.1f)\n", tNew, tRef, (tRef / tNew) );
+
+    return (hostBenchIso15693Coder() && ok);
+}
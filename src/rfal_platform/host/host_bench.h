@@ -0,0 +1,127 @@
+/*! \file host_bench.h
+ *
+ *  \brief Host micro benchmarks of RFAL hot paths
+ *
+ *  Run on the host CPU in real time (not on the virtual clock), so the
+ *  numbers compare implementations against each other rather than predict
+ *  ESP32-S3 timings. Every benchmark first checks that the variants give
+ *  identical results over randomized inputs.
+ *
+ */
+
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  CRC-CCITT engines
+ *
+ * Compares all RFAL_CRC_ENGINE_* variants against the bit-wise reference
+ * and prints their throughput to stderr.
+ *
+ * \return true if all variants gave identical results
+ *****************************************************************************
+ */
+bool hostBenchCrc( void );
+
+/*!
+ *****************************************************************************
+ * \brief  ISO15693 VICC response decoder and VCD request coder
+ *
+ * Fuzzes rfalIso15693VICCDecode() against the reference decoder with
+ * valid, corrupted, colliding, truncated and random responses, then times
+ * both on an inventory and a large read response.
+ * Compares rfalIso15693VCDCode() chunk by chunk with the reference coder
+ * in both codings and times both on a Write Multiple Blocks request.
+ *
+ * \return true if the implementations gave identical results
+ *****************************************************************************
+ */
+bool hostBenchIso15693( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Poll cycles of the sketch against reproducible tag populations
+ *
+ * Runs setup() and then loop() on the virtual clock: every population
+ * (NFC-A, NFC-V, mixed, colliding UIDs) enters the field a number of times
+ * at different points of the poll cycle. Prints the latency from entering
+ * the field to the tag tracker report (percentiles), tags/s, anticollision
+ * frames and the virtual time, SPI bytes and host CPU time per discovery
+ * phase. Unlike the benchmarks above, the numbers are on the virtual clock
+ * apart from the CPU time, so they are reproducible.
+ *
+ * \return true if every tag was reported
+ *****************************************************************************
+ */
+bool hostBenchPoll( void );
+
+/*!
+ *****************************************************************************
+ * \brief  FIFO water levels on frames longer than the FIFO
+ *
+ * Runs setup(), activates a T2T and then reads it whole (FAST_READ, 180
+ * bytes) and sends 250 byte frames at 106, 424 and 848kbps with every
+ * water level policy (rfalSetFifoWaterLevel()), once with a fast SPI and
+ * a short interrupt latency and once with a slow SPI and a long one
+ * (simSt25r3911SetIrqLatency()). Prints the frames received/sent intact,
+ * the water level interrupts, overflows and underflows per frame and the
+ * virtual time per frame.
+ *
+ * \return true if the automatic policy gave no FIFO error
+ *****************************************************************************
+ */
+bool hostBenchFifo( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Type 4 Tag NDEF bulk reads
+ *
+ * Runs setup() and then reads 4000 and 16000 byte NDEF messages off a
+ * simulated T4T with t4tReadNdef() at 106 and 848kbps: with a 256 byte FSD
+ * and a short Le, with the largest FSD of the I-Block buffer and a short
+ * Le, and with that FSD and an extended Le. Prints the APDUs and I-Blocks
+ * per read, the virtual time and the throughput, and the APDU pool peak.
+ *
+ * \return true if every message was read intact
+ *****************************************************************************
+ */
+bool hostBenchT4t( void );
+
+/*!
+ *****************************************************************************
+ * \brief  NDEF read engine with CC caching
+ *
+ * Runs setup() and then reads the NDEF message of a simulated T2T, T4T
+ * and T5T with ndefRead(): the first read of a tag, further reads of it
+ * with its layout cached and the first read of another tag of the same
+ * model. Prints the commands, command and response bytes and the virtual
+ * time per read of each kind, and the cache counters.
+ *
+ * \return true if every message was read intact, with the layout expected
+ *****************************************************************************
+ */
+bool hostBenchNdef( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_BENCH_H */
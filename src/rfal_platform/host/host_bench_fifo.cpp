@@ -0,0 +1,249 @@
+/*! \file host_bench_fifo.cpp
+ *
+ *  \brief FIFO water level benchmark of the chip driver on long frames
+ *
+ *  Frames longer than the 96 byte FIFO of the ST25R3911 are streamed
+ *  through it on water level interrupts (rfal_rfst25r3911.c). Whether that
+ *  keeps up depends on the bit rate, the SPI clock and the interrupt
+ *  latency: this benchmark reads a whole NFC-A T2T (FAST_READ, 180 bytes)
+ *  and sends a 250 byte frame for every water level policy
+ *  (rfalSetFifoWaterLevel()) under a fast and a slow MCU, and counts the
+ *  water level interrupts, FIFO overflows and underflows.
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <Arduino.h>
+#include <SPI.h>
+
+#include <string.h>
+
+#include "host_bench.h"
+#include "sim_clock.h"
+#include "sim_st25r3911.h"
+#include "sim_tags.h"
+extern "C" {
+#include "rfal_core/rfal_rf.h"
+#include "rfal_core/rfal_nfca.h"
+}
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define HOST_BENCH_FIFO_RUNS        8U      /*!< Frames per direction and setting                 */
+#define HOST_BENCH_FIFO_TAG         "nfca-t2t uid=04A1B2C3D4E5F6"
+#define HOST_BENCH_FIFO_PAGES       45U     /*!< FAST_READ of the whole tag ...                   */
+#define HOST_BENCH_FIFO_RX_LEN      (HOST_BENCH_FIFO_PAGES * 4U)    /*!< ... 180 bytes            */
+#define HOST_BENCH_FIFO_TX_LEN      250U    /*!< Frame sent, ignored by the tag (wrong CRC)       */
+#define HOST_BENCH_FIFO_FWT         rfalConvMsTo1fc( 5U )
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! MCU the driver runs on */
+typedef struct
+{
+    const char *name;
+    uint32_t    spiClockHz;
+    uint16_t    irqLatencyUs;
+} hostBenchMcu;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+extern void setup( void );
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static const hostBenchMcu hostBenchMcus[] =
+{
+    { "6MHz  50us",  6000000U,  50U },
+    { "1MHz 150us",  1000000U, 150U },
+};
+
+static const rfalBitRate  hostBenchBitRates[]    = { RFAL_BR_106, RFAL_BR_424, RFAL_BR_848 };
+static const char * const hostBenchBitRateNames[] = { "106", "424", "848" };
+static const char * const hostBenchPolicyNames[]  = { "auto", "margin", "bulk" };
+
+static uint8_t hostBenchFifoRef[HOST_BENCH_FIFO_RX_LEN];
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static bool hostBenchFifoActivate( void )
+{
+    rfalNfcaSensRes sensRes;
+    rfalNfcaSelRes  selRes;
+    uint8_t         nfcId[RFAL_NFCA_CASCADE_3_UID_LEN];
+    uint8_t         nfcIdLen;
+    bool            collPending;
+
+    if( (rfalNfcaPollerInitialize() != RFAL_ERR_NONE) || (rfalFieldOnAndStartGT() != RFAL_ERR_NONE) )
+    {
+        return false;
+    }
+    if( rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes ) != RFAL_ERR_NONE )
+    {
+        return false;
+    }
+    return (rfalNfcaPollerSingleCollisionResolution( 1U, &collPending, &selRes, nfcId, &nfcIdLen ) == RFAL_ERR_NONE);
+}
+
+
+/*******************************************************************************/
+static ReturnCode hostBenchFifoRead( uint8_t *rx, uint16_t *rcvdLen )
+{
+    uint8_t  req[3] = { 0x3AU, 0x00U, (uint8_t)(HOST_BENCH_FIFO_PAGES - 1U) };    /* FAST_READ */
+    uint16_t rcvd;
+    ReturnCode ret;
+
+    ret      = rfalTransceiveBlockingTxRx( req, sizeof(req), rx, HOST_BENCH_FIFO_RX_LEN, &rcvd, RFAL_TXRX_FLAGS_DEFAULT, HOST_BENCH_FIFO_FWT );
+    *rcvdLen = rcvd;
+    return ret;
+}
+
+
+/*******************************************************************************/
+static bool hostBenchFifoSetting( const hostBenchMcu *mcu, uint8_t brIdx, rfalFifoWlPolicy policy )
+{
+    static uint8_t   tx[HOST_BENCH_FIFO_TX_LEN];
+    static uint8_t   rx[HOST_BENCH_FIFO_RX_LEN];
+    rfalFifoWlConfig wl;
+    rfalFifoStats    before;
+    rfalFifoStats    rxStats;
+    rfalFifoStats    txStats;
+    uint64_t         rxNs;
+    uint64_t         txNs;
+    uint64_t         t0;
+    uint32_t         spiBytes;
+    uint32_t         rxOk;
+    uint32_t         txOk;
+    uint16_t         rcvd;
+    uint16_t         i;
+    uint32_t         run;
+
+    wl.policy       = policy;
+    wl.spiClockHz   = mcu->spiClockHz;
+    wl.irqLatencyUs = mcu->irqLatencyUs;
+    (void)rfalSetFifoWaterLevel( &wl );
+    (void)rfalSetBitRate( hostBenchBitRates[brIdx], hostBenchBitRates[brIdx] );
+
+    for( i = 0; i < HOST_BENCH_FIFO_TX_LEN; i++ )
+    {
+        tx[i] = (uint8_t)((i * 37U) + 11U);
+    }
+
+    rxOk     = 0;
+    txOk     = 0;
+    rxNs     = 0;
+    txNs     = 0;
+    spiBytes = simSt25r3911GetStats( 0 )->spiBytes;
+
+    rfalGetFifoStats( NULL, &before );
+    for( run = 0; run < HOST_BENCH_FIFO_RUNS; run++ )
+    {
+        t0 = simClockNowNs();
+        if( (hostBenchFifoRead( rx, &rcvd ) == RFAL_ERR_NONE) && (rcvd == HOST_BENCH_FIFO_RX_LEN)
+            && (memcmp( rx, hostBenchFifoRef, HOST_BENCH_FIFO_RX_LEN ) == 0) )
+        {
+            rxOk++;
+        }
+        rxNs += (simClockNowNs() - t0);
+    }
+    rfalGetFifoStats( NULL, &rxStats );
+
+    for( run = 0; run < HOST_BENCH_FIFO_RUNS; run++ )
+    {
+        /* Sent with a wrong CRC: the tag stays silent, a complete frame times out */
+        t0 = simClockNowNs();
+        if( rfalTransceiveBlockingTxRx( tx, HOST_BENCH_FIFO_TX_LEN, rx, sizeof(rx), &rcvd, RFAL_TXRX_FLAGS_CRC_TX_MANUAL, HOST_BENCH_FIFO_FWT ) == RFAL_ERR_TIMEOUT )
+        {
+            txOk++;
+        }
+        txNs += (simClockNowNs() - t0);
+    }
+    rfalGetFifoStats( NULL, &txStats );
+    spiBytes = (simSt25r3911GetStats( 0 )->spiBytes - spiBytes);
+
+    fprintf( stderr, "fifo %s %s %-6s: rx %u/%u ok %4.1f WL %4.1f ovf %6.1f us, tx %u/%u ok %4.1f WL %4.1f unf %6.1f us, %6.1f SPI bytes/frame\n",
+             mcu->name, hostBenchBitRateNames[brIdx], hostBenchPolicyNames[policy],
+             (unsigned)rxOk, (unsigned)HOST_BENCH_FIFO_RUNS,
+             ((double)(rxStats.wlIrqsRx - before.wlIrqsRx) / HOST_BENCH_FIFO_RUNS), ((double)(rxStats.overflows - before.overflows) / HOST_BENCH_FIFO_RUNS),
+             ((double)rxNs / HOST_BENCH_FIFO_RUNS / SIM_NS_PER_US),
+             (unsigned)txOk, (unsigned)HOST_BENCH_FIFO_RUNS,
+             ((double)(txStats.wlIrqsTx - rxStats.wlIrqsTx) / HOST_BENCH_FIFO_RUNS), ((double)(txStats.underflows - rxStats.underflows) / HOST_BENCH_FIFO_RUNS),
+             ((double)txNs / HOST_BENCH_FIFO_RUNS / SIM_NS_PER_US),
+             ((double)spiBytes / (2U * HOST_BENCH_FIFO_RUNS)) );
+
+    return ((rxOk == HOST_BENCH_FIFO_RUNS) && (txOk == HOST_BENCH_FIFO_RUNS));
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+bool hostBenchFifo( void )
+{
+    rfalFifoWlConfig wl;
+    uint16_t         rcvd;
+    uint8_t          m;
+    uint8_t          br;
+    uint8_t          p;
+    bool             autoOk;
+    bool             ok;
+
+    setup();
+    rfalGetFifoWaterLevel( &wl );
+
+    if( !simTagsAdd( HOST_BENCH_FIFO_TAG ) || !hostBenchFifoActivate() || (hostBenchFifoRead( hostBenchFifoRef, &rcvd ) != RFAL_ERR_NONE) )
+    {
+        fprintf( stderr, "fifo check     : tag not activated\n" );
+        return false;
+    }
+
+    autoOk = true;
+    for( m = 0; m < (sizeof(hostBenchMcus) / sizeof(hostBenchMcus[0])); m++ )
+    {
+        SPI.setClockOverride( hostBenchMcus[m].spiClockHz );
+        simSt25r3911SetIrqLatency( (uint32_t)hostBenchMcus[m].irqLatencyUs * 1000U );
+
+        for( br = 0; br < (sizeof(hostBenchBitRates) / sizeof(hostBenchBitRates[0])); br++ )
+        {
+            for( p = (uint8_t)RFAL_FIFO_WL_AUTO; p <= (uint8_t)RFAL_FIFO_WL_BULK; p++ )
+            {
+                ok = hostBenchFifoSetting( &hostBenchMcus[m], br, (rfalFifoWlPolicy)p );
+                autoOk = (autoOk && (ok || (p != (uint8_t)RFAL_FIFO_WL_AUTO)));
+            }
+        }
+    }
+
+    SPI.setClockOverride( 0U );
+    simSt25r3911SetIrqLatency( 0U );
+    (void)rfalSetFifoWaterLevel( &wl );
+    (void)rfalSetBitRate( RFAL_BR_106, RFAL_BR_106 );
+    (void)simTagsRemove( "all" );
+
+    fprintf( stderr, "fifo check     : %s\n", (autoOk ? "auto policy without FIFO errors" : "FIFO ERRORS WITH THE AUTO POLICY") );
+    return autoOk;
+}
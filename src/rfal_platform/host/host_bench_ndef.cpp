@@ -0,0 +1,281 @@
+/*! \file host_bench_ndef.cpp
+ *
+ *  \brief NDEF read engine benchmark
+ *
+ *  Reads the NDEF message of a simulated T2T (with and without FAST_READ),
+ *  T4T and T5T with ndef_read.c three ways: the first read of a tag (CC discovery), further reads of the
+ *  same tag (layout cached for its UID) and the first read of another tag
+ *  of the same model (layout of the first tag). Every message is walked
+ *  with ndefReadRecordNext() and checked against the text record the
+ *  simulated tags generate.
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "host_bench.h"
+#include "sim_clock.h"
+#include "sim_tags.h"
+#include "ndef_read.h"
+extern "C" {
+#include "rfal_core/rfal_rf.h"
+#include "rfal_core/rfal_nfca.h"
+#include "rfal_core/rfal_nfcv.h"
+#include "rfal_core/rfal_isoDep.h"
+}
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define HOST_BENCH_NDEF_RUNS        4U      /*!< Reads of the tag once its layout is cached    */
+#define HOST_BENCH_NDEF_BUF_LEN     1024U
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Simulated tag model: two tags of it */
+typedef struct
+{
+    const char   *name;
+    const char   *spec;                     /*!< Tag spec, %s for the UID                      */
+    const char   *uid[2];                   /*!< First tag, other tag of the same model        */
+    ndefReadType  type;
+    uint16_t      msgLen;                   /*!< NDEF message length                           */
+} hostBenchNdefModel;
+
+/*! Reads of one kind */
+typedef struct
+{
+    uint32_t      reads;
+    uint32_t      ok;
+    ndefReadStats stats;
+    uint64_t      ns;
+} hostBenchNdefResult;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+extern void setup( void );
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static const hostBenchNdefModel hostBenchNdefModels[] =
+{
+    { "T2T",  "nfca-t2t uid=%s ndef=141",        { "04A1B2C3D4E5F6",   "04A1B2C3D4E5F7"   }, NDEF_READ_TYPE_T2T, 141U },
+    { "T2T-", "nfca-t2t uid=%s ndef=141 nofast", { "05A1B2C3D4E5F6",   "05A1B2C3D4E5F7"   }, NDEF_READ_TYPE_T2T, 141U },     /* Without FAST_READ */
+    { "T4T",  "nfca-t4t uid=%s ndef=900",        { "04A1B2C3D4E5F1",   "04A1B2C3D4E5F2"   }, NDEF_READ_TYPE_T4T, 900U },
+    { "T5T",  "nfcv-t5t uid=%s ndef=249",        { "E002080412345678", "E002080412345679" }, NDEF_READ_TYPE_T5T, 249U },
+};
+
+static const char * const hostBenchNdefKinds[] = { "CC read   ", "tag's CC  ", "model's CC" };
+
+static uint8_t hostBenchNdefBuf[HOST_BENCH_NDEF_BUF_LEN];
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static bool hostBenchNdefCheck( const ndefReadMsg *msg, uint16_t len )
+{
+    ndefReadRecord rec;
+    uint16_t       pos;
+    uint32_t       i;
+
+    /* Single text record of the simulated tags (see simNdefText()): "en", then letters counting up */
+    pos = 0;
+    if( (msg->msgLen != len) || (msg->nlen != len) || (ndefReadRecordNext( msg->msg, msg->msgLen, &pos, &rec ) != RFAL_ERR_NONE) )
+    {
+        return false;
+    }
+    if( (rec.tnf != 0x01U) || (rec.typeLen != 1U) || (rec.type[0] != 'T') || (rec.payloadLen != (uint32_t)(len - 7U))
+        || (rec.payload[0] != 0x02U) || (rec.payload[1] != 'e') || (rec.payload[2] != 'n') )
+    {
+        return false;
+    }
+    for( i = 4U; i < rec.payloadLen; i++ )
+    {
+        if( rec.payload[i] != (uint8_t)('a' + (((rec.payload[i - 1U] - 'a') + 1U) % 26U)) )
+        {
+            return false;
+        }
+    }
+    return (ndefReadRecordNext( msg->msg, msg->msgLen, &pos, &rec ) == RFAL_ERR_NOTFOUND);
+}
+
+
+/*******************************************************************************/
+static bool hostBenchNdefActivate( ndefReadType type, rfalNfcDevice *dev )
+{
+    rfalNfcaSensRes sensRes;
+    uint16_t        rcvLen;
+    bool            collPending;
+
+    memset( dev, 0x00, sizeof(rfalNfcDevice) );
+    if( type == NDEF_READ_TYPE_T5T )
+    {
+        if( (rfalNfcvPollerInitialize() != RFAL_ERR_NONE) || (rfalFieldOnAndStartGT() != RFAL_ERR_NONE)
+            || (rfalNfcvPollerInventory( RFAL_NFCV_NUM_SLOTS_1, 0U, NULL, &dev->dev.nfcv.InvRes, &rcvLen ) != RFAL_ERR_NONE) )
+        {
+            return false;
+        }
+        dev->type        = RFAL_NFC_LISTEN_TYPE_NFCV;
+        dev->rfInterface = RFAL_NFC_INTERFACE_RF;
+        dev->nfcid       = dev->dev.nfcv.InvRes.UID;
+        dev->nfcidLen    = RFAL_NFCV_UID_LEN;
+        return true;
+    }
+
+    /* T2T and T4T: as rfal_nfc activates them */
+    if( (rfalNfcaPollerInitialize() != RFAL_ERR_NONE) || (rfalFieldOnAndStartGT() != RFAL_ERR_NONE) )
+    {
+        return false;
+    }
+    if( (rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes ) != RFAL_ERR_NONE)
+        || (rfalNfcaPollerSingleCollisionResolution( 1U, &collPending, &dev->dev.nfca.selRes, dev->dev.nfca.nfcId1, &dev->dev.nfca.nfcId1Len ) != RFAL_ERR_NONE) )
+    {
+        return false;
+    }
+    dev->type        = RFAL_NFC_LISTEN_TYPE_NFCA;
+    dev->rfInterface = RFAL_NFC_INTERFACE_RF;
+    dev->nfcid       = dev->dev.nfca.nfcId1;
+    dev->nfcidLen    = dev->dev.nfca.nfcId1Len;
+    dev->dev.nfca.type  = RFAL_NFCA_T2T;
+    if( type == NDEF_READ_TYPE_T4T )
+    {
+        dev->dev.nfca.type = RFAL_NFCA_T4T;
+        dev->rfInterface   = RFAL_NFC_INTERFACE_ISODEP;
+        rfalIsoDepInitialize();
+        return (rfalIsoDepPollAHandleActivation( RFAL_ISODEP_FSXI_256, RFAL_ISODEP_NO_DID, RFAL_BR_106, &dev->proto.isoDep ) == RFAL_ERR_NONE);
+    }
+    return true;
+}
+
+
+/*******************************************************************************/
+static void hostBenchNdefRead( const hostBenchNdefModel *model, const rfalNfcDevice *dev, ndefReadCcSrc expSrc, hostBenchNdefResult *res )
+{
+    ndefReadMsg msg;
+    uint64_t    t0;
+    ReturnCode  ret;
+
+    memset( hostBenchNdefBuf, 0x00, sizeof(hostBenchNdefBuf) );
+    t0  = simClockNowNs();
+    ret = ndefRead( dev, hostBenchNdefBuf, sizeof(hostBenchNdefBuf), &msg, &res->stats );
+    res->ns += (simClockNowNs() - t0);
+    res->reads++;
+
+    if( (ret == RFAL_ERR_NONE) && (msg.type == model->type) && (msg.ccSrc == expSrc) && hostBenchNdefCheck( &msg, model->msgLen ) )
+    {
+        res->ok++;
+    }
+}
+
+
+/*******************************************************************************/
+static bool hostBenchNdefModelRun( const hostBenchNdefModel *model )
+{
+    char                spec[96];
+    rfalNfcDevice       dev;
+    hostBenchNdefResult res[3];
+    uint32_t            run;
+    uint8_t             t;
+    uint8_t             k;
+    bool                ok;
+
+    memset( res, 0x00, sizeof(res) );
+
+    /* First tag: CC read, then its cached layout; other tag of the model: the first one's layout */
+    ok = true;
+    for( t = 0; t < 2U; t++ )
+    {
+        snprintf( spec, sizeof(spec), model->spec, model->uid[t] );
+        if( !simTagsAdd( spec ) || !hostBenchNdefActivate( model->type, &dev ) )
+        {
+            fprintf( stderr, "ndef %s %s: tag not activated\n", model->name, model->uid[t] );
+            ok = false;
+        }
+        else if( t == 0U )
+        {
+            hostBenchNdefRead( model, &dev, NDEF_READ_CC_READ, &res[0] );
+            for( run = 0; run < HOST_BENCH_NDEF_RUNS; run++ )
+            {
+                hostBenchNdefRead( model, &dev, NDEF_READ_CC_TAG, &res[1] );
+            }
+        }
+        else
+        {
+            hostBenchNdefRead( model, &dev, NDEF_READ_CC_MODEL, &res[2] );
+        }
+
+        if( model->type == NDEF_READ_TYPE_T4T )
+        {
+            (void)rfalIsoDepDeselect();
+        }
+        (void)rfalFieldOff();
+        (void)simTagsRemove( "all" );
+    }
+
+    for( k = 0; k < 3U; k++ )
+    {
+        if( res[k].reads == 0U )
+        {
+            continue;
+        }
+        fprintf( stderr, "ndef %-4s %4u B %s: %u/%u ok, %4.1f commands, %6.1f bytes, %6.2f ms per read\n",
+                 model->name, (unsigned)model->msgLen, hostBenchNdefKinds[k], (unsigned)res[k].ok, (unsigned)res[k].reads,
+                 ((double)res[k].stats.cmds / res[k].reads), ((double)res[k].stats.bytes / res[k].reads),
+                 ((double)res[k].ns / res[k].reads / SIM_NS_PER_MS) );
+        ok = ((res[k].ok == res[k].reads) && ok);
+    }
+    return ok;
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+bool hostBenchNdef( void )
+{
+    ndefReadCounters cnt;
+    uint8_t          m;
+    bool             ok;
+
+    setup();
+    ndefReadInit();
+
+    ok = true;
+    for( m = 0; m < (sizeof(hostBenchNdefModels) / sizeof(hostBenchNdefModels[0])); m++ )
+    {
+        ok = (hostBenchNdefModelRun( &hostBenchNdefModels[m] ) && ok);
+    }
+
+    ndefReadGetCounters( &cnt );
+    fprintf( stderr, "ndef cache     : %u tags, %u reads, %u tag hits, %u model hits, %u CC reads, %u stale\n",
+             (unsigned)cnt.tags, (unsigned)cnt.reads, (unsigned)cnt.tagHits, (unsigned)cnt.modelHits, (unsigned)cnt.misses, (unsigned)cnt.stale );
+    fprintf( stderr, "ndef check     : %s\n", (ok ? "all messages read intact" : "MESSAGES READ WRONG") );
+    return ok;
+}
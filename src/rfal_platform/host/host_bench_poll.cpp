@@ -0,0 +1,374 @@
+/*! \file host_bench_poll.cpp
+ *
+ *  \brief Poll cycle benchmark of the whole sketch against virtual tags
+ *
+ *  Unlike the micro benchmarks of host_bench.c, this one runs the sketch
+ *  (loop()) on the virtual clock against reproducible tag populations, so
+ *  regressions of the discovery (rfal_nfc.c) or of the chip driver
+ *  (rfal_rfst25r3911.c) show up as numbers: detection latency, tags/s,
+ *  anticollision frames, SPI bytes and time per poll phase, RF energy per
+ *  tag read (Dynamic Power Output, rfal_dpo.c).
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <Arduino.h>
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_bench.h"
+#include "sim_clock.h"
+#include "sim_st25r3911.h"
+#include "sim_tags.h"
+#include "tag_tracker.h"
+extern "C" {
+#include "rfal_core/rfal_nfc.h"
+}
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define HOST_BENCH_POLL_RUNS        16U     /*!< Runs per population                              */
+#define HOST_BENCH_POLL_TAGS_MAX    SIM_TAGS_MAX
+#define HOST_BENCH_POLL_TIMEOUT_MS  3000U   /*!< A tag not reported by then is missed             */
+#define HOST_BENCH_POLL_GAP_MS      150U    /*!< Empty field between two runs ...                 */
+#define HOST_BENCH_POLL_GAP_STEP_MS 7U      /*!< ... plus a varying offset, sweeps the cycle phase */
+#define HOST_BENCH_POLL_GAP_SPAN_MS 40U
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Phases a loop() step is accounted to, by the discovery state it starts in */
+typedef enum
+{
+    HOST_BENCH_PHASE_IDLE,                  /*!< Presence checks of known tags, field Off window  */
+    HOST_BENCH_PHASE_TECHDETECT,            /*!< Technology Detection                             */
+    HOST_BENCH_PHASE_COLLISION,             /*!< Collision Resolution                             */
+    HOST_BENCH_PHASE_ACTIVATION,            /*!< Activation                                       */
+    HOST_BENCH_PHASE_EXCHANGE,              /*!< Activated, data exchange                         */
+    HOST_BENCH_PHASE_OTHER,                 /*!< Wake-up, deactivation, listen                    */
+    HOST_BENCH_PHASE_NUM
+} hostBenchPhase;
+
+/*! Tag population */
+typedef struct
+{
+    const char *name;
+    const char *tags[HOST_BENCH_POLL_TAGS_MAX];     /*!< sim_tags.h specs, NULL terminated        */
+} hostBenchPopulation;
+
+/*! Cost of a phase */
+typedef struct
+{
+    uint64_t virtNs;                        /*!< Virtual time                                     */
+    uint64_t cpuNs;                         /*!< Host CPU time                                    */
+    uint64_t spiBytes;                      /*!< Bytes on the SPI bus                             */
+} hostBenchCost;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+extern void setup( void );
+extern void loop( void );
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static const char * const hostBenchPhaseNames[HOST_BENCH_PHASE_NUM] = { "idle", "techdetect", "collision", "activation", "exchange", "other" };
+
+static const hostBenchPopulation hostBenchPopulations[] =
+{
+    { "nfca x1",       { "nfca-t2t uid=04A1B2C3D4E5F6" } },
+    { "nfca x4",       { "nfca-t2t uid=04A1B2C3D4E5F6", "nfca-t2t uid=04112233", "nfca-t2t uid=08C0FFEE", "nfca-t2t uid=0455667788990A" } },
+    { "nfca x4 coll",  { "nfca-t2t uid=04A1B2C3D4E5F0", "nfca-t2t uid=04A1B2C3D4E5F1", "nfca-t2t uid=04A1B2C3D4E5F2", "nfca-t2t uid=04A1B2C3D4E5F4" } },
+    { "nfcv x1",       { "nfcv-t5t uid=E002080412345678" } },
+    { "nfcv x4",       { "nfcv-t5t uid=E002080412345671", "nfcv-t5t uid=E002080412345672", "nfcv-t5t uid=E002080412345673", "nfcv-t5t uid=E002080412345674" } },
+    { "nfcv x4 coll",  { "nfcv-t5t uid=E002080412345608", "nfcv-t5t uid=E002080412345618", "nfcv-t5t uid=E002080412345628", "nfcv-t5t uid=E002080412345638" } },
+    { "mixed x4",      { "nfca-t2t uid=04A1B2C3D4E5F6", "nfca-t2t uid=04112233", "nfcv-t5t uid=E002080412345678", "nfcv-t5t uid=E0020804ABCDEF01" } },
+    { "mixed x8 coll", { "nfca-t2t uid=04A1B2C3D4E5F0", "nfca-t2t uid=04A1B2C3D4E5F1", "nfca-t2t uid=04A1B2C3D4E5F2", "nfca-t2t uid=04A1B2C3D4E5F4",
+                         "nfcv-t5t uid=E002080412345608", "nfcv-t5t uid=E002080412345618", "nfcv-t5t uid=E002080412345628", "nfcv-t5t uid=E002080412345638" } },
+    { "nfca near",     { "nfca-t2t uid=04A1B2C3D4E5F6 near" } },
+    { "nfcv near",     { "nfcv-t5t uid=E002080412345678 near" } },
+    { "mixed x3 near", { "nfca-t2t uid=04A1B2C3D4E5F6 near", "nfca-t2t uid=04112233", "nfcv-t5t uid=E002080412345678" } },
+};
+
+#define HOST_BENCH_POPULATIONS      (sizeof(hostBenchPopulations) / sizeof(hostBenchPopulations[0]))
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static uint64_t hostBenchCpuNs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+/*******************************************************************************/
+static hostBenchPhase hostBenchPhaseOf( rfalNfcState st )
+{
+    switch( st )
+    {
+        case RFAL_NFC_STATE_IDLE:
+            return HOST_BENCH_PHASE_IDLE;
+        case RFAL_NFC_STATE_START_DISCOVERY:
+        case RFAL_NFC_STATE_POLL_TECHDETECT:
+            return HOST_BENCH_PHASE_TECHDETECT;
+        case RFAL_NFC_STATE_POLL_COLAVOIDANCE:
+            return HOST_BENCH_PHASE_COLLISION;
+        case RFAL_NFC_STATE_POLL_SELECT:
+        case RFAL_NFC_STATE_POLL_ACTIVATION:
+            return HOST_BENCH_PHASE_ACTIVATION;
+        case RFAL_NFC_STATE_ACTIVATED:
+        case RFAL_NFC_STATE_DATAEXCHANGE:
+        case RFAL_NFC_STATE_DATAEXCHANGE_DONE:
+            return HOST_BENCH_PHASE_EXCHANGE;
+        default:
+            return HOST_BENCH_PHASE_OTHER;
+    }
+}
+
+
+/*******************************************************************************/
+static void hostBenchStep( hostBenchCost *cost )
+{
+    hostBenchPhase ph;
+    uint64_t       virt;
+    uint64_t       cpu;
+    uint32_t       spi;
+
+    ph   = hostBenchPhaseOf( rfalNfcGetState() );
+    virt = simClockNowNs();
+    cpu  = hostBenchCpuNs();
+    spi  = simSt25r3911GetStats( 0 )->spiBytes;
+
+    loop();
+
+    cost[ph].virtNs   += (simClockNowNs() - virt);
+    cost[ph].cpuNs    += (hostBenchCpuNs() - cpu);
+    cost[ph].spiBytes += (simSt25r3911GetStats( 0 )->spiBytes - spi);
+}
+
+
+/*******************************************************************************/
+static uint8_t hostBenchUid( const char *spec, uint8_t *uid )
+{
+    const char *p;
+    uint8_t     len;
+    uint8_t     i;
+    uint8_t     b;
+
+    p = strstr( spec, "uid=" );
+    if( p == NULL )
+    {
+        return 0;
+    }
+    p += 4;
+
+    for( len = 0; (len < TAG_TRACKER_UID_MAX) && isxdigit( (unsigned char)p[0] ) && isxdigit( (unsigned char)p[1] ); len++, p += 2 )
+    {
+        char hex[3] = { p[0], p[1], '\0' };
+        uid[len] = (uint8_t)strtoul( hex, NULL, 16 );
+    }
+
+    if( strncmp( spec, "nfcv", 4 ) == 0 )                                               /* Printed MSB first, reported LSB first */
+    {
+        for( i = 0; i < (len / 2U); i++ )
+        {
+            b                  = uid[i];
+            uid[i]             = uid[len - 1U - i];
+            uid[len - 1U - i]  = b;
+        }
+    }
+    return len;
+}
+
+
+/*******************************************************************************/
+static bool hostBenchReported( const uint8_t *uid, uint8_t uidLen )
+{
+    const tagTrackerTag *tag;
+    uint8_t              i;
+
+    for( i = 0; (tag = tagTrackerGet( i )) != NULL; i++ )
+    {
+        if( (tag->uidLen == uidLen) && (memcmp( tag->uid, uid, uidLen ) == 0) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*******************************************************************************/
+static int hostBenchCmpU64( const void *a, const void *b )
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return ((x < y) ? -1 : ((x > y) ? 1 : 0));
+}
+
+
+/*******************************************************************************/
+static double hostBenchPercentileMs( const uint64_t *sorted, uint32_t n, uint32_t pct )
+{
+    return ((n != 0U) ? ((double)sorted[(((n * pct) + 99U) / 100U) - 1U] / 1e6) : 0.0);
+}
+
+
+/*******************************************************************************/
+static bool hostBenchPollPopulation( const hostBenchPopulation *pop )
+{
+    static uint64_t latency[HOST_BENCH_POLL_RUNS * HOST_BENCH_POLL_TAGS_MAX];
+    hostBenchCost   cost[HOST_BENCH_PHASE_NUM];
+    uint8_t         uid[HOST_BENCH_POLL_TAGS_MAX][TAG_TRACKER_UID_MAX];
+    uint8_t         uidLen[HOST_BENCH_POLL_TAGS_MAX];
+    uint64_t        foundNs[HOST_BENCH_POLL_TAGS_MAX];
+    uint64_t        startNs;
+    uint64_t        resolveNs;
+    uint64_t        lastNs;
+    uint32_t        anticoll;
+    uint32_t        collisions;
+    uint32_t        overloaded;
+    uint32_t        energyUs;
+    uint32_t        found;
+    uint32_t        missed;
+    uint32_t        run;
+    uint8_t         tags;
+    uint8_t         pending;
+    uint8_t         i;
+    double          totalUs;
+
+    memset( cost, 0, sizeof(cost) );
+    found      = 0;
+    missed     = 0;
+    resolveNs  = 0;
+    anticoll   = simTagsGetStats()->anticollFrames;
+    collisions = simTagsGetStats()->collisions;
+    overloaded = simTagsGetStats()->overloaded;
+    energyUs   = simSt25r3911GetStats( 0 )->fieldEnergyUs;
+
+    for( tags = 0; (tags < HOST_BENCH_POLL_TAGS_MAX) && (pop->tags[tags] != NULL); tags++ )
+    {
+        uidLen[tags] = hostBenchUid( pop->tags[tags], uid[tags] );
+    }
+
+    for( run = 0; run < HOST_BENCH_POLL_RUNS; run++ )
+    {
+        /* Empty field for a while, ending at a different point of the poll cycle every run */
+        startNs = (simClockNowNs() + ((HOST_BENCH_POLL_GAP_MS + ((run * HOST_BENCH_POLL_GAP_STEP_MS) % HOST_BENCH_POLL_GAP_SPAN_MS)) * SIM_NS_PER_MS));
+        while( simClockNowNs() < startNs )
+        {
+            hostBenchStep( cost );
+        }
+
+        for( i = 0; i < tags; i++ )
+        {
+            (void)simTagsAdd( pop->tags[i] );
+            foundNs[i] = 0;
+        }
+        startNs = simClockNowNs();
+        lastNs  = startNs;
+        pending = tags;
+
+        while( (pending != 0U) && ((simClockNowNs() - startNs) < ((uint64_t)HOST_BENCH_POLL_TIMEOUT_MS * SIM_NS_PER_MS)) )
+        {
+            hostBenchStep( cost );
+
+            for( i = 0; i < tags; i++ )
+            {
+                if( (foundNs[i] == 0U) && hostBenchReported( uid[i], uidLen[i] ) )
+                {
+                    foundNs[i]       = simClockNowNs();
+                    lastNs           = foundNs[i];
+                    latency[found++] = (foundNs[i] - startNs);
+                    pending--;
+                }
+            }
+        }
+        missed    += pending;
+        resolveNs += (lastNs - startNs);
+
+        /* Out of the field, until the poller has reported them gone */
+        (void)simTagsRemove( "all" );
+        while( tagTrackerGet( 0 ) != NULL )
+        {
+            hostBenchStep( cost );
+        }
+    }
+
+    qsort( latency, found, sizeof(latency[0]), hostBenchCmpU64 );
+
+    fprintf( stderr, "poll %-13s: %u/%u tags, latency p50 %6.1f p90 %6.1f p99 %6.1f max %6.1f ms, %6.1f tags/s, %5.1f anticoll frames %4.1f collisions/run\n",
+             pop->name, (unsigned)found, (unsigned)(found + missed),
+             hostBenchPercentileMs( latency, found, 50U ), hostBenchPercentileMs( latency, found, 90U ),
+             hostBenchPercentileMs( latency, found, 99U ), hostBenchPercentileMs( latency, found, 100U ),
+             ((resolveNs != 0U) ? (((double)found * 1e9) / (double)resolveNs) : 0.0),
+             ((double)(simTagsGetStats()->anticollFrames - anticoll) / HOST_BENCH_POLL_RUNS),
+             ((double)(simTagsGetStats()->collisions - collisions) / HOST_BENCH_POLL_RUNS) );
+
+    for( i = 0; i < HOST_BENCH_PHASE_NUM; i++ )
+    {
+        if( cost[i].virtNs == 0U )
+        {
+            continue;
+        }
+        totalUs = ((double)cost[i].virtNs / 1e3);
+        fprintf( stderr, "  %-12s : %9.0f us %8.0f SPI bytes %8.1f us CPU per run\n", hostBenchPhaseNames[i],
+                 (totalUs / HOST_BENCH_POLL_RUNS), ((double)cost[i].spiBytes / HOST_BENCH_POLL_RUNS),
+                 (((double)cost[i].cpuNs / 1e3) / HOST_BENCH_POLL_RUNS) );
+    }
+    fprintf( stderr, "  %-12s : %9.0f us at full drive per tag read, %5.1f overloaded responses per run\n", "rf energy",
+             ((found != 0U) ? ((double)(simSt25r3911GetStats( 0 )->fieldEnergyUs - energyUs) / (double)found) : 0.0),
+             ((double)(simTagsGetStats()->overloaded - overloaded) / HOST_BENCH_POLL_RUNS) );
+
+    return (missed == 0U);
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+bool hostBenchPoll( void )
+{
+    bool    ok;
+    uint8_t i;
+
+    ok = true;
+    setup();
+
+    for( i = 0; i < HOST_BENCH_POPULATIONS; i++ )
+    {
+        ok = (hostBenchPollPopulation( &hostBenchPopulations[i] ) && ok);
+    }
+
+    fprintf( stderr, "poll check     : %s\n", (ok ? "all tags reported" : "TAGS MISSED") );
+    return ok;
+}
@@ -0,0 +1,227 @@
+/*! \file host_bench_t4t.cpp
+ *
+ *  \brief Type 4 Tag NDEF bulk read benchmark
+ *
+ *  Reads large NDEF messages off a simulated T4T with t4t_read.c: with the
+ *  FSD of 256 bytes the poller used to announce and a short Le, with the
+ *  largest FSD the I-Block buffer takes (RFAL_ISODEP_FSDI_BUF_MAX) and a
+ *  short Le, and with that FSD and an extended Le (mapping 3.0 card, MLe
+ *  4096), at 106 and 848kbps. Every message is checked against the text
+ *  record the simulated card generates.
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "host_bench.h"
+#include "sim_clock.h"
+#include "sim_st25r3911.h"
+#include "sim_tags.h"
+#include "apdu_pool.h"
+#include "t4t_read.h"
+extern "C" {
+#include "rfal_core/rfal_rf.h"
+#include "rfal_core/rfal_nfca.h"
+#include "rfal_core/rfal_isoDep.h"
+}
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define HOST_BENCH_T4T_UID          "04A1B2C3D4E5F6"
+#define HOST_BENCH_T4T_UID_LAST     0xF6U   /*!< Seeds the record pattern of the card          */
+#define HOST_BENCH_T4T_MSG_MAX      16384U
+#define HOST_BENCH_T4T_RUNS         2U      /*!< Reads per setting                             */
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Reader / card frame and Le setting */
+typedef struct
+{
+    const char     *name;
+    rfalIsoDepFSxI  fsdi;                   /*!< FSD announced in RATS                         */
+    uint16_t        fsc;                    /*!< FSC of the card                               */
+    uint16_t        mle;                    /*!< MLe of the card                               */
+} hostBenchT4tSetting;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+extern void setup( void );
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static const hostBenchT4tSetting hostBenchT4tSettings[] =
+{
+    { "FSD  256 short Le", RFAL_ISODEP_FSXI_256,     256U,  255U },
+    { "FSD 1024 short Le", RFAL_ISODEP_FSDI_BUF_MAX, 1024U, 255U },
+    { "FSD 1024 ext Le  ", RFAL_ISODEP_FSDI_BUF_MAX, 1024U, 4096U },
+};
+
+static const uint16_t     hostBenchT4tSizes[]       = { 4000U, 16000U };
+static const rfalBitRate  hostBenchT4tBitRates[]    = { RFAL_BR_106, RFAL_BR_848 };
+static const char * const hostBenchT4tBitRateNames[] = { "106", "848" };
+
+static uint8_t hostBenchT4tMsg[HOST_BENCH_T4T_MSG_MAX];
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static bool hostBenchT4tCheck( const uint8_t *msg, uint16_t len )
+{
+    uint16_t payloadLen;
+    uint16_t i;
+
+    /* Single text record (long record format) of the simulated card, see simT4tInit() */
+    payloadLen = (uint16_t)(len - 7U);
+    if( (msg[0] != 0xC1U) || (msg[1] != 0x01U) || (msg[4] != (uint8_t)(payloadLen >> 8)) || (msg[5] != (uint8_t)(payloadLen & 0xFFU)) || (msg[6] != 'T') )
+    {
+        return false;
+    }
+    for( i = 10U; i < len; i++ )
+    {
+        if( msg[i] != (uint8_t)('a' + ((i + HOST_BENCH_T4T_UID_LAST) % 26U)) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*******************************************************************************/
+static bool hostBenchT4tActivate( rfalIsoDepFSxI fsdi, rfalBitRate br, rfalIsoDepDevice *isoDep )
+{
+    rfalNfcaSensRes sensRes;
+    rfalNfcaSelRes  selRes;
+    uint8_t         nfcId[RFAL_NFCA_CASCADE_3_UID_LEN];
+    uint8_t         nfcIdLen;
+    bool            collPending;
+
+    if( (rfalNfcaPollerInitialize() != RFAL_ERR_NONE) || (rfalFieldOnAndStartGT() != RFAL_ERR_NONE) )
+    {
+        return false;
+    }
+    if( (rfalNfcaPollerCheckPresence( RFAL_14443A_SHORTFRAME_CMD_WUPA, &sensRes ) != RFAL_ERR_NONE)
+        || (rfalNfcaPollerSingleCollisionResolution( 1U, &collPending, &selRes, nfcId, &nfcIdLen ) != RFAL_ERR_NONE) )
+    {
+        return false;
+    }
+    rfalIsoDepInitialize();                                                         /* As rfal_nfc does before RATS */
+    return ((rfalIsoDepPollAHandleActivation( fsdi, RFAL_ISODEP_NO_DID, br, isoDep ) == RFAL_ERR_NONE) && (isoDep->info.DSI == br));
+}
+
+
+/*******************************************************************************/
+static bool hostBenchT4tRun( const hostBenchT4tSetting *set, uint16_t size, uint8_t brIdx )
+{
+    char             spec[96];
+    rfalIsoDepDevice isoDep;
+    t4tReadInfo      info;
+    t4tReadStats     stats;
+    uint64_t         ns;
+    uint64_t         t0;
+    uint32_t         rxFrames;
+    uint32_t         okRuns;
+    uint32_t         run;
+    uint16_t         msgLen;
+
+    snprintf( spec, sizeof(spec), "nfca-t4t uid=" HOST_BENCH_T4T_UID " ndef=%u fsc=%u mle=%u", (unsigned)size, (unsigned)set->fsc, (unsigned)set->mle );
+    if( !simTagsAdd( spec ) || !hostBenchT4tActivate( set->fsdi, hostBenchT4tBitRates[brIdx], &isoDep ) )
+    {
+        fprintf( stderr, "t4t %s %s %5u: card not activated\n", set->name, hostBenchT4tBitRateNames[brIdx], (unsigned)size );
+        (void)simTagsRemove( "all" );
+        return false;
+    }
+
+    memset( &stats, 0x00, sizeof(stats) );
+    okRuns   = 0;
+    ns       = 0;
+    rxFrames = simSt25r3911GetStats( 0 )->rxFrames;
+    for( run = 0; run < HOST_BENCH_T4T_RUNS; run++ )
+    {
+        memset( hostBenchT4tMsg, 0x00, sizeof(hostBenchT4tMsg) );
+        t0 = simClockNowNs();
+        if( (t4tReadNdef( &isoDep, hostBenchT4tMsg, sizeof(hostBenchT4tMsg), &msgLen, &info, false, &stats ) == RFAL_ERR_NONE)
+            && (msgLen == size) && hostBenchT4tCheck( hostBenchT4tMsg, msgLen ) )
+        {
+            okRuns++;
+        }
+        ns += (simClockNowNs() - t0);
+    }
+    rxFrames = (simSt25r3911GetStats( 0 )->rxFrames - rxFrames);
+
+    (void)rfalIsoDepDeselect();
+    (void)rfalFieldOff();
+    (void)simTagsRemove( "all" );
+
+    fprintf( stderr, "t4t %s %s %5u: %u/%u ok, FSC %4u Le %4u, %5.1f APDUs %6.1f I-Blocks per read, %7.1f ms, %5.1f KB/s\n",
+             set->name, hostBenchT4tBitRateNames[brIdx], (unsigned)size, (unsigned)okRuns, (unsigned)HOST_BENCH_T4T_RUNS,
+             (unsigned)isoDep.info.FSx, (unsigned)info.le,
+             ((double)stats.apdus / HOST_BENCH_T4T_RUNS), ((double)rxFrames / HOST_BENCH_T4T_RUNS),
+             ((double)ns / HOST_BENCH_T4T_RUNS / SIM_NS_PER_MS),
+             (((double)size * HOST_BENCH_T4T_RUNS / 1024.0) / ((double)ns / SIM_NS_PER_MS / 1000.0)) );
+
+    return (okRuns == HOST_BENCH_T4T_RUNS);
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+bool hostBenchT4t( void )
+{
+    apduPoolStats pool;
+    uint8_t       s;
+    uint8_t       z;
+    uint8_t       br;
+    bool          ok;
+
+    setup();
+
+    ok = true;
+    for( z = 0; z < (sizeof(hostBenchT4tSizes) / sizeof(hostBenchT4tSizes[0])); z++ )
+    {
+        for( br = 0; br < (sizeof(hostBenchT4tBitRates) / sizeof(hostBenchT4tBitRates[0])); br++ )
+        {
+            for( s = 0; s < (sizeof(hostBenchT4tSettings) / sizeof(hostBenchT4tSettings[0])); s++ )
+            {
+                ok = (hostBenchT4tRun( &hostBenchT4tSettings[s], hostBenchT4tSizes[z], br ) && ok);
+            }
+        }
+    }
+
+    apduPoolGetStats( &pool );
+    (void)rfalSetBitRate( RFAL_BR_106, RFAL_BR_106 );
+
+    fprintf( stderr, "t4t pool       : %u slots of %u bytes, peak %u, %u allocations failed\n",
+             (unsigned)APDU_POOL_SLOTS, (unsigned)APDU_POOL_SLOT_LEN, (unsigned)pool.slotsPeak, (unsigned)pool.fails );
+    fprintf( stderr, "t4t check      : %s\n", (ok ? "all messages read intact" : "MESSAGES READ WRONG") );
+    return ok;
+}
@@ -0,0 +1,275 @@
+/*! \file host_main.cpp
+ *
+ *  \brief Entry point of the native (host) build
+ *
+ *  Runs the unmodified Arduino sketch (setup() once, then loop()) against
+ *  the ST25R3911 simulator and prints the SPI/RF traffic counters at the
+ *  end. All time is virtual, so runs are reproducible and independent of
+ *  the host load.
+ *
+ *  Usage: program [options]
+ *    --cycles <n>        number of loop() iterations (default 3)
+ *    --duration-ms <n>   run loop() until the virtual time reaches n ms
+ *    --tag <spec>        place a tag in the field, e.g. "nfca-t2t uid=04A1B2C3D4E5F6"
+ *    --script <file>     timed tag events, see sim_tags.h
+ *    --quiet             suppress the sketch's serial output
+ *    --bench-crc         run the CRC engine benchmark (host_bench.h) and exit
+ *    --bench-iso15693    run the ISO15693 decoder/coder check and benchmark, exit
+ *    --bench-poll        run the poll cycle benchmark (host_bench_poll.cpp), exit
+ *    --bench-fifo        run the FIFO water level benchmark (host_bench_fifo.cpp), exit
+ *    --bench-t4t         run the T4T NDEF bulk read benchmark (host_bench_t4t.cpp), exit
+ *    --bench-ndef        run the NDEF read engine benchmark (host_bench_ndef.cpp), exit
+ *    --log-decode <file> print the binary log frames of a serial capture
+ *                        (EXAMPLE_RFAL_POLLER_LOG_BINARY, "-" for stdin), exit
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <Arduino.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rfal_platform/pltf_interrupt.h"
+#include "rfal_platform/pltf_spi.h"
+#include "evt_log.h"
+extern "C" {
+#include "rfal_core/st25r3911/st25r3911_com.h"
+}
+#include "host_bench.h"
+#include "sim_clock.h"
+#include "sim_st25r3911.h"
+#include "sim_tags.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define HOST_DEFAULT_CYCLES     3UL
+#define HOST_LOG_CHUNK          4096U
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+extern void setup( void );
+extern void loop( void );
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static void hostUsage( const char *prog )
+{
+    fprintf( stderr, "usage: %s [--cycles n] [--duration-ms n] [--tag spec]... [--script file] [--quiet] [--bench-crc] [--bench-iso15693] [--bench-poll] [--bench-fifo] [--bench-t4t] [--bench-ndef] [--log-decode file]\n", prog );
+}
+
+
+/*******************************************************************************/
+static bool hostLogDecode( const char *path )
+{
+    static uint8_t buf[2U * HOST_LOG_CHUNK];
+    FILE          *f;
+    evtLogRecord   rec;
+    char           line[128];
+    size_t         len;
+    size_t         used;
+    size_t         n;
+
+    f = ((strcmp( path, "-" ) == 0) ? stdin : fopen( path, "rb" ));
+    if( f == NULL )
+    {
+        fprintf( stderr, "cannot open '%s'\n", path );
+        return false;
+    }
+
+    len = 0;
+    do
+    {
+        n    = fread( &buf[len], 1, HOST_LOG_CHUNK, f );
+        len += n;
+
+        while( evtLogDecode( buf, len, &used, &rec ) )
+        {
+            (void)evtLogFormat( &rec, line, sizeof(line) );
+            printf( "%10lu ms  reader %u  %s\n", (unsigned long)rec.timeMs, (unsigned)rec.reader, line );
+            len -= used;
+            memmove( buf, &buf[used], len );
+        }
+        len -= used;                                                                  /* Skipped bytes, a partial frame stays */
+        memmove( buf, &buf[used], len );
+    }
+    while( n != 0U );
+
+    if( f != stdin )
+    {
+        fclose( f );
+    }
+    return true;
+}
+
+
+/*******************************************************************************/
+static void hostPrintStats( unsigned long cycles )
+{
+    const simSt25r3911Stats *st;
+    const simTagsStats      *tags;
+    pltf_irq_stats_t         irq;
+    uint8_t                  reader;
+
+    tags = simTagsGetStats();
+
+    fprintf( stderr, "\n--- host simulation summary ---\n" );
+    fprintf( stderr, "virtual time   : %llu us\n", (unsigned long long)(simClockNowNs() / SIM_NS_PER_US) );
+    fprintf( stderr, "busy-wait time : %llu us (%llu%%)\n", (unsigned long long)(simClockBusyNs() / SIM_NS_PER_US),
+             (unsigned long long)((simClockNowNs() != 0U) ? ((simClockBusyNs() * 100U) / simClockNowNs()) : 0U) );
+    fprintf( stderr, "loop() cycles  : %lu\n", cycles );
+
+    for( reader = 0; reader < PLTF_READERS; reader++ )
+    {
+        /* The IRQ counters are those of the reader the calling task is bound to */
+        pltf_reader_select( reader );
+        pltf_irq_get_stats( &irq );
+        st = simSt25r3911GetStats( reader );
+
+        if( PLTF_READERS > 1 )
+        {
+            fprintf( stderr, "reader %u\n", (unsigned)reader );
+        }
+        fprintf( stderr, "SPI frames     : %lu (%lu bytes)\n", (unsigned long)st->spiFrames, (unsigned long)st->spiBytes );
+        fprintf( stderr, "  reg reads    : %lu\n", (unsigned long)st->regReads );
+        fprintf( stderr, "  reg writes   : %lu\n", (unsigned long)st->regWrites );
+        fprintf( stderr, "  FIFO reads   : %lu\n", (unsigned long)st->fifoReads );
+        fprintf( stderr, "  FIFO loads   : %lu\n", (unsigned long)st->fifoWrites );
+        fprintf( stderr, "  commands     : %lu\n", (unsigned long)st->commands );
+        fprintf( stderr, "IRQs           : %lu\n", (unsigned long)st->irqs );
+        fprintf( stderr, "  ISR edges    : %lu (max %lu us)\n", (unsigned long)irq.isr_count, (unsigned long)irq.isr_time_max_us );
+        fprintf( stderr, "  IRQ task runs: %lu (latency max %lu us, total %lu us)\n", (unsigned long)irq.handler_count,
+                 (unsigned long)irq.latency_max_us, (unsigned long)irq.latency_total_us );
+        fprintf( stderr, "RF frames      : %lu tx / %lu rx\n", (unsigned long)st->txFrames, (unsigned long)st->rxFrames );
+        fprintf( stderr, "RF field on    : %lu us\n", (unsigned long)st->fieldOnUs );
+        fprintf( stderr, "RF energy      : %lu us at full drive\n", (unsigned long)st->fieldEnergyUs );
+        fprintf( stderr, "WU measures    : %lu\n", (unsigned long)st->wutMeasures );
+    }
+    pltf_reader_select( 0 );
+
+    fprintf( stderr, "tags detected  : %lu (latency avg %llu us, max %llu us)\n", (unsigned long)tags->detected,
+             (unsigned long long)((tags->detected != 0U) ? ((tags->latencyTotalNs / tags->detected) / SIM_NS_PER_US) : 0U),
+             (unsigned long long)(tags->latencyMaxNs / SIM_NS_PER_US) );
+    fprintf( stderr, "overloaded rsp : %lu\n", (unsigned long)tags->overloaded );
+    fprintf( stderr, "rate errors    : %lu\n", (unsigned long)tags->rateErrors );
+#ifdef ST25R3911_REG_SHADOW_VERIFY
+    fprintf( stderr, "shadow errors  : %lu\n", (unsigned long)st25r3911ShadowGetMismatches() );
+#endif /* ST25R3911_REG_SHADOW_VERIFY */
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+int main( int argc, char **argv )
+{
+    unsigned long cycles;
+    unsigned long durationMs;
+    unsigned long done;
+    int           i;
+
+    cycles     = HOST_DEFAULT_CYCLES;
+    durationMs = 0;
+
+    simSt25r3911Reset();
+
+    for( i = 1; i < argc; i++ )
+    {
+        if( (strcmp( argv[i], "--cycles" ) == 0) && ((i + 1) < argc) )
+        {
+            cycles = strtoul( argv[++i], NULL, 0 );
+        }
+        else if( (strcmp( argv[i], "--duration-ms" ) == 0) && ((i + 1) < argc) )
+        {
+            durationMs = strtoul( argv[++i], NULL, 0 );
+        }
+        else if( (strcmp( argv[i], "--tag" ) == 0) && ((i + 1) < argc) )
+        {
+            if( !simTagsAdd( argv[++i] ) )
+            {
+                fprintf( stderr, "invalid tag spec '%s'\n", argv[i] );
+                return EXIT_FAILURE;
+            }
+        }
+        else if( (strcmp( argv[i], "--script" ) == 0) && ((i + 1) < argc) )
+        {
+            if( !simTagsLoadScript( argv[++i] ) )
+            {
+                fprintf( stderr, "cannot load script '%s'\n", argv[i] );
+                return EXIT_FAILURE;
+            }
+        }
+        else if( strcmp( argv[i], "--bench-crc" ) == 0 )
+        {
+            return hostBenchCrc() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        else if( strcmp( argv[i], "--bench-iso15693" ) == 0 )
+        {
+            return hostBenchIso15693() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        else if( strcmp( argv[i], "--bench-poll" ) == 0 )
+        {
+            return hostBenchPoll() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        else if( strcmp( argv[i], "--bench-fifo" ) == 0 )
+        {
+            return hostBenchFifo() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        else if( strcmp( argv[i], "--bench-t4t" ) == 0 )
+        {
+            return hostBenchT4t() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        else if( strcmp( argv[i], "--bench-ndef" ) == 0 )
+        {
+            return hostBenchNdef() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        else if( (strcmp( argv[i], "--log-decode" ) == 0) && ((i + 1) < argc) )
+        {
+            return hostLogDecode( argv[++i] ) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        else if( strcmp( argv[i], "--quiet" ) == 0 )
+        {
+            if( freopen( "/dev/null", "w", stdout ) == NULL )
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            hostUsage( argv[0] );
+            return EXIT_FAILURE;
+        }
+    }
+
+    setup();
+
+    done = 0;
+    while( (durationMs != 0U) ? ((simClockNowNs() / SIM_NS_PER_MS) < durationMs) : (done < cycles) )
+    {
+        loop();
+        done++;
+    }
+
+    fflush( stdout );
+    hostPrintStats( done );
+
+    return EXIT_SUCCESS;
+}
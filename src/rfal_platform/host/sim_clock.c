@@ -0,0 +1,112 @@
+/*! \file sim_clock.c
+ *
+ *  \brief Virtual time base of the host simulator
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stddef.h>
+
+#include "sim_clock.h"
+#include "sim_st25r3911.h"
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static uint64_t simNowNs;                                       /*!< Current virtual time           */
+static uint32_t simCpuQuantumNs = SIM_CLOCK_CPU_QUANTUM_NS;     /*!< Charged per system tick query  */
+static uint64_t simBusyNs;                                      /*!< Sum of the charged CPU quanta  */
+static void   (*simIrqHook)(void);                              /*!< IRQ delivery hook              */
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+uint64_t simClockNowNs( void )
+{
+    return simNowNs;
+}
+
+
+/*******************************************************************************/
+void simClockAdvanceNs( uint64_t ns )
+{
+    uint64_t target;
+    uint64_t next;
+
+    target = simNowNs + ns;
+
+    /* Run every chip event falling due until target at its exact time */
+    for(;;)
+    {
+        next = simSt25r3911NextEventNs();
+        if( next > target )
+        {
+            break;
+        }
+
+        if( next > simNowNs )
+        {
+            simNowNs = next;
+        }
+        simSt25r3911RunEvents( simNowNs );
+
+        if( simIrqHook != NULL )
+        {
+            simIrqHook();
+        }
+    }
+
+    simNowNs = target;
+    simClockPoll();
+}
+
+
+/*******************************************************************************/
+void simClockCpuQuantum( void )
+{
+    simBusyNs += simCpuQuantumNs;
+    simClockAdvanceNs( simCpuQuantumNs );
+}
+
+
+/*******************************************************************************/
+uint64_t simClockBusyNs( void )
+{
+    return simBusyNs;
+}
+
+
+/*******************************************************************************/
+void simClockSetCpuQuantum( uint32_t ns )
+{
+    simCpuQuantumNs = ns;
+}
+
+
+/*******************************************************************************/
+void simClockPoll( void )
+{
+    simSt25r3911RunEvents( simNowNs );
+
+    if( simIrqHook != NULL )
+    {
+        simIrqHook();
+    }
+}
+
+
+/*******************************************************************************/
+void simClockSetIrqHook( void (*hook)(void) )
+{
+    simIrqHook = hook;
+}
@@ -0,0 +1,124 @@
+/*! \file sim_clock.h
+ *
+ *  \brief Virtual time base of the host simulator
+ *
+ *  All time on the native build is simulated. It only advances when the
+ *  firmware spends it: SPI bytes on the wire, FreeRTOS/Arduino delays and a
+ *  small CPU cost charged on every system tick query (which is what RFAL's
+ *  busy-wait loops do). While advancing, due chip events are executed and
+ *  a rising ST25R3911 IRQ line is delivered to the attached ISR, so runs
+ *  are fully deterministic.
+ *
+ */
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define SIM_CLOCK_CPU_QUANTUM_NS    1000U   /*!< Default CPU time charged per system tick query */
+
+#define SIM_NS_PER_US               1000ULL
+#define SIM_NS_PER_MS               1000000ULL
+
+#define simConvFcToNs( fc )         ( ((uint64_t)(fc) * 100000ULL) / 1356ULL )    /*!< 1/fc (13.56MHz) units to ns */
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Current virtual time
+ *
+ * \return virtual time since start-up in nanoseconds
+ *****************************************************************************
+ */
+uint64_t simClockNowNs( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Advance virtual time
+ *
+ * Moves the virtual clock forward by \a ns, running every chip/tag event
+ * that falls due in between at its exact time and delivering IRQs.
+ *
+ * \param[in]  ns : amount of time to advance in nanoseconds
+ *****************************************************************************
+ */
+void simClockAdvanceNs( uint64_t ns );
+
+/*!
+ *****************************************************************************
+ * \brief  Charge the CPU quantum
+ *
+ * Called whenever the firmware polls the time (busy loops). Advances the
+ * virtual clock by the configured CPU quantum.
+ *****************************************************************************
+ */
+void simClockCpuQuantum( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Busy-wait time
+ *
+ * \return total virtual time charged through simClockCpuQuantum(), i.e.
+ *         time the firmware spent spinning on the system tick, in ns
+ *****************************************************************************
+ */
+uint64_t simClockBusyNs( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Set the CPU quantum
+ *
+ * \param[in]  ns : CPU time charged per system tick query in nanoseconds
+ *****************************************************************************
+ */
+void simClockSetCpuQuantum( uint32_t ns );
+
+/*!
+ *****************************************************************************
+ * \brief  Run pending events and IRQ delivery at the current time
+ *
+ * Used after a lock is released so a deferred IRQ is delivered as soon as
+ * the firmware allows it.
+ *****************************************************************************
+ */
+void simClockPoll( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Register the IRQ delivery hook
+ *
+ * The hook is called whenever the clock has run chip events (and on
+ * simClockPoll()). It is responsible for invoking the attached ISR when the
+ * IRQ line rose and the firmware is in a state to take the interrupt.
+ *
+ * \param[in]  hook : delivery function, NULL to disable delivery
+ *****************************************************************************
+ */
+void simClockSetIrqHook( void (*hook)(void) );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_CLOCK_H */
@@ -0,0 +1,1464 @@
+/*! \file sim_st25r3911.c
+ *
+ *  \brief ST25R3911 behavioural model of the host simulator
+ *
+ *  The model is driven from two sides: SPI bytes clocked by the firmware
+ *  (register/FIFO access and direct commands) and timed events run by the
+ *  virtual clock (oscillator start-up, direct command termination, bytes
+ *  leaving/entering the FIFO on air, NRT/GPT expiry, wake-up timer).
+ *  Only unmasked interrupts are latched; the IRQ line is high while any
+ *  latched interrupt is pending and every low to high transition is
+ *  reported once through simSt25r3911TakeIrqEdge().
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "sim_st25r3911.h"
+#include "sim_clock.h"
+#include "sim_tags.h"
+
+#include <string.h>
+
+#include "rfal_core/st25r3911/st25r3911.h"
+#include "rfal_core/st25r3911/st25r3911_com.h"
+#include "rfal_core/st25r3911/st25r3911_interrupt.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_REG_COUNT               64U
+#define SIM_IRQ_REGS                3U          /*!< Main, timer/NFC and error/wake-up         */
+#define SIM_IC_IDENTITY             0x09U       /*!< ST25R3911B, silicon rev. 1               */
+#define SIM_SPI_FIFO_LOAD           0x80U
+#define SIM_SPI_FIFO_READ           0xBFU
+#define SIM_SPI_READ_MODE           0x40U
+#define SIM_SPI_MODE_MASK           0xC0U
+#define SIM_SPI_TEST_READ           0x40U
+
+#define SIM_TX_FRAME_MAX            4096U       /*!< Raw bytes incl. stream mode coding       */
+#define SIM_RX_FRAME_MAX            8208U       /*!< Raw bytes incl. stream mode coding       */
+#define SIM_TAG_RSP_MAX             SIM_TAGS_MAX
+
+#define SIM_OSC_STARTUP_NS          (700ULL * SIM_NS_PER_US)
+#define SIM_DCT_MEASURE_NS          (25ULL * SIM_NS_PER_US)
+#define SIM_DCT_CALIBRATE_NS        (300ULL * SIM_NS_PER_US)
+
+#define SIM_AD_VDD_3V3              0x8DU       /*!< 141 x 23.4mV                              */
+#define SIM_AD_AMPLITUDE            0x78U       /*!< Unloaded antenna                          */
+#define SIM_AD_AMPLITUDE_TAG_LOAD   4U          /*!< Amplitude drop per tag in the field       */
+#define SIM_AD_AMPLITUDE_NEAR_LOAD  44U         /*!< Further drop per tag lying on the antenna */
+#define SIM_AD_AMPLITUDE_RFO_STEP   8U          /*!< Amplitude drop per RFO_AM_OFF_LEVEL step  */
+#define SIM_AD_PHASE                0x80U
+#define SIM_AD_PHASE_TAG_LOAD       3U
+#define SIM_AD_CAPACITANCE          0x10U
+#define SIM_AD_DRIFT_LSB            6U          /*!< Peak to peak antenna drift (temperature)  */
+#define SIM_AD_DRIFT_PERIOD_NS      (60000ULL * SIM_NS_PER_MS)
+#define SIM_REGULATOR_RESULT        0xC0U
+#define SIM_ANT_CAL_RESULT          0x50U
+#define SIM_AM_MOD_DEPTH_RESULT     0x80U
+
+#define SIM_NFCV_EOF                0x04U       /*!< VCD EOF, same for 1 of 4 and 1 of 256    */
+#define SIM_NFCV_SOF_1_4            0x21U
+#define SIM_NFCV_SOF_1_256          0x81U
+#define SIM_NFCV_BYTES_1_256        64U
+
+#define SIM_IRQ_REG( mask, idx )    ((uint8_t)(((mask) >> (8U * (idx))) & 0xFFU))
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! SPI frame decoder state */
+typedef enum
+{
+    SIM_SPI_IDLE,           /*!< Waiting for the mode byte          */
+    SIM_SPI_WRITE,          /*!< Register write, auto increment     */
+    SIM_SPI_READ,           /*!< Register read, auto increment      */
+    SIM_SPI_FIFO_LOAD_ST,   /*!< FIFO load                          */
+    SIM_SPI_FIFO_READ_ST,   /*!< FIFO read                          */
+    SIM_SPI_TEST_ADDR,      /*!< Test access: address byte          */
+    SIM_SPI_TEST_DATA,      /*!< Test access: data byte             */
+    SIM_SPI_DONE            /*!< Further bytes ignored              */
+} simSpiState;
+
+/*! Chip model state */
+typedef struct
+{
+    uint8_t           regs[SIM_REG_COUNT];
+    uint8_t           testRegs[SIM_REG_COUNT];
+    uint8_t           irq[SIM_IRQ_REGS];            /*!< Latched IRQs                             */
+    bool              irqLine;
+    bool              irqEdge;
+    bool              oscOk;
+    bool              fieldOn;
+    bool              rxMasked;                     /*!< MASK_RECEIVE_DATA issued                 */
+
+    uint8_t           fifo[ST25R3911_FIFO_DEPTH];
+    uint8_t           fifoLen;
+    uint16_t          fifoLoaded;                   /*!< Bytes loaded since the last clear        */
+    uint8_t           fifoStatus2;
+    uint8_t           collision;
+
+    simSpiState       spiState;
+    uint8_t           spiAddr;
+    bool              spiTestRead;
+
+    uint64_t          tOsc;
+    uint64_t          tDct;
+    uint64_t          tTxByte;
+    uint64_t          tTxEnd;
+    uint64_t          tRxStart;
+    uint64_t          tRxByte;
+    uint64_t          tRxEnd;
+    uint64_t          tNrt;
+    uint64_t          tGpt;
+    uint64_t          tWut;                         /*!< Next wake-up timer measurement           */
+    uint64_t          tIrqEdge;                     /*!< Rising IRQ line seen by the firmware     */
+    uint64_t          fieldOnNs;                    /*!< Field switched on at                     */
+    uint32_t          adSeed;                       /*!< A/D converter noise                      */
+
+    uint8_t           dctReg;                       /*!< Result register of the running command   */
+    uint8_t           dctVal;
+
+    simRfTech         txTech;
+    bool              txCrc;
+    uint16_t          txBytesTotal;
+    uint16_t          txBitsTotal;
+    uint16_t          txLen;
+    uint64_t          txByteNs;
+    uint8_t           txFrame[SIM_TX_FRAME_MAX];
+
+    uint8_t           rxFrame[SIM_RX_FRAME_MAX];
+    uint16_t          rxLen;
+    uint16_t          rxPos;
+    uint8_t           rxLastBits;                   /*!< Bits in the last byte, 0: complete       */
+    uint64_t          rxByteNs;
+    uint64_t          rxEofNs;
+    bool              rxCol;
+    uint8_t           rxColStatus;
+
+    simSt25r3911Stats stats;
+} simChip;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static simChip     gChips[SIM_ST25R3911_CHIPS];
+static uint8_t     gChipIdx;                    /*!< Chip the model functions work on      */
+static uint8_t     gSpiChip;                    /*!< Chip selected on the SPI bus          */
+static uint32_t    gIrqLatencyNs;               /*!< IRQ line rise to the firmware's ISR    */
+
+#define gChip      (gChips[gChipIdx])
+static simTagFrame gTagRsp[SIM_TAG_RSP_MAX];
+static uint8_t     gReqBuf[SIM_TX_FRAME_MAX];
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+static uint64_t  simChipNextEventNs( void );
+static void      simChipRunEvents( uint64_t nowNs );
+static void      simSetDefault( void );
+static void      simUpdateIrqLine( void );
+static void      simRaiseIrq( uint32_t mask );
+static uint8_t   simReadReg( uint8_t reg );
+static void      simWriteReg( uint8_t reg, uint8_t val );
+static void      simCommand( uint8_t cmd );
+static void      simFifoPush( uint8_t val );
+static uint8_t   simFifoPop( void );
+static void      simClearFifo( void );
+static void      simUpdateField( void );
+static void      simStartDct( uint64_t delayNs, uint8_t reg, uint8_t val );
+static void      simStartTx( uint8_t cmd );
+static void      simTxEnd( void );
+static void      simRxStart( void );
+static void      simRxByte( void );
+static void      simRxEnd( void );
+static void      simStartNrt( void );
+static void      simStartGpt( void );
+static void      simGptTrigger( uint8_t gptc );
+static uint64_t  simWutPeriodNs( void );
+static void      simWakeUpMeasure( void );
+static bool      simWakeUpCompare( uint8_t meas, uint8_t confReg, uint8_t refReg, uint8_t aaReg );
+static uint8_t   simAdMeasure( uint8_t base, int32_t load );
+static int32_t   simAmplitudeLoad( void );
+static void      simFieldAccount( void );
+static simRfTech simCurrentTech( void );
+static uint32_t  simTxBitFc( void );
+static uint32_t  simRxBitFc( void );
+static uint8_t   simBitsPerByte( simRfTech tech, bool rx );
+static uint16_t  simNfcvDecodeVcd( const uint8_t *in, uint16_t inLen, uint8_t *out );
+static void      simMergeNfca( uint8_t nRsp );
+static void      simMergeNfcv( uint8_t nRsp );
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void simSt25r3911Reset( void )
+{
+    for( gChipIdx = 0; gChipIdx < SIM_ST25R3911_CHIPS; gChipIdx++ )
+    {
+        memset( &gChip, 0x00, sizeof(gChip) );
+        simSetDefault();
+    }
+    gChipIdx = 0;
+}
+
+
+/*******************************************************************************/
+void simSt25r3911Select( uint8_t chip, bool selected )
+{
+    gChipIdx = chip;
+    gSpiChip = chip;
+
+    if( selected )
+    {
+        gChip.spiState = SIM_SPI_IDLE;
+        gChip.stats.spiFrames++;
+    }
+    else
+    {
+        gChip.spiState = SIM_SPI_DONE;
+    }
+}
+
+
+/*******************************************************************************/
+uint8_t simSt25r3911SpiByte( uint8_t mosi )
+{
+    uint8_t miso;
+
+    gChipIdx = gSpiChip;
+
+    miso = 0x00U;
+    gChip.stats.spiBytes++;
+
+    switch( gChip.spiState )
+    {
+        case SIM_SPI_IDLE:
+            if( mosi == ST25R3911_CMD_TEST_ACCESS )
+            {
+                gChip.spiState = SIM_SPI_TEST_ADDR;
+            }
+            else if( (mosi & SIM_SPI_MODE_MASK) == 0x00U )
+            {
+                gChip.spiState = SIM_SPI_WRITE;
+                gChip.spiAddr  = (uint8_t)(mosi & 0x3FU);
+                gChip.stats.regWrites++;
+            }
+            else if( (mosi & SIM_SPI_MODE_MASK) == SIM_SPI_READ_MODE )
+            {
+                gChip.spiState = SIM_SPI_READ;
+                gChip.spiAddr  = (uint8_t)(mosi & 0x3FU);
+                gChip.stats.regReads++;
+            }
+            else if( mosi == SIM_SPI_FIFO_LOAD )
+            {
+                gChip.spiState = SIM_SPI_FIFO_LOAD_ST;
+                gChip.stats.fifoWrites++;
+            }
+            else if( mosi == SIM_SPI_FIFO_READ )
+            {
+                gChip.spiState = SIM_SPI_FIFO_READ_ST;
+                gChip.stats.fifoReads++;
+            }
+            else if( (mosi & SIM_SPI_MODE_MASK) == SIM_SPI_MODE_MASK )
+            {
+                gChip.spiState = SIM_SPI_DONE;
+                gChip.stats.commands++;
+                simCommand( mosi );
+            }
+            else
+            {
+                gChip.spiState = SIM_SPI_DONE;
+            }
+            break;
+
+        case SIM_SPI_WRITE:
+            simWriteReg( gChip.spiAddr, mosi );
+            gChip.spiAddr = (uint8_t)((gChip.spiAddr + 1U) & 0x3FU);
+            break;
+
+        case SIM_SPI_READ:
+            miso          = simReadReg( gChip.spiAddr );
+            gChip.spiAddr = (uint8_t)((gChip.spiAddr + 1U) & 0x3FU);
+            break;
+
+        case SIM_SPI_FIFO_LOAD_ST:
+            simFifoPush( mosi );
+            gChip.fifoLoaded++;
+            break;
+
+        case SIM_SPI_FIFO_READ_ST:
+            miso = simFifoPop();
+            break;
+
+        case SIM_SPI_TEST_ADDR:
+            gChip.spiTestRead = ((mosi & SIM_SPI_TEST_READ) != 0U);
+            gChip.spiAddr     = (uint8_t)(mosi & 0x3FU);
+            gChip.spiState    = SIM_SPI_TEST_DATA;
+            break;
+
+        case SIM_SPI_TEST_DATA:
+            if( gChip.spiTestRead )
+            {
+                miso = gChip.testRegs[gChip.spiAddr];
+            }
+            else
+            {
+                gChip.testRegs[gChip.spiAddr] = mosi;
+            }
+            gChip.spiState = SIM_SPI_DONE;
+            break;
+
+        case SIM_SPI_DONE:
+        default:
+            break;
+    }
+
+    simUpdateIrqLine();
+    return miso;
+}
+
+
+/*******************************************************************************/
+bool simSt25r3911IrqLine( uint8_t chip )
+{
+    return gChips[chip].irqLine;
+}
+
+
+/*******************************************************************************/
+bool simSt25r3911TakeIrqEdge( uint8_t chip )
+{
+    bool edge;
+
+    edge                 = gChips[chip].irqEdge;
+    gChips[chip].irqEdge = false;
+
+    return edge;
+}
+
+
+/*******************************************************************************/
+uint64_t simSt25r3911NextEventNs( void )
+{
+    uint64_t next;
+    uint64_t chipNext;
+    uint8_t  saved;
+
+    saved = gChipIdx;
+    next  = SIM_ST25R3911_NO_EVENT;
+    for( gChipIdx = 0; gChipIdx < SIM_ST25R3911_CHIPS; gChipIdx++ )
+    {
+        chipNext = simChipNextEventNs();
+        next     = ((chipNext < next) ? chipNext : next);
+    }
+    gChipIdx = saved;
+
+    return next;
+}
+
+
+/*******************************************************************************/
+void simSt25r3911RunEvents( uint64_t nowNs )
+{
+    uint8_t saved;
+
+    saved = gChipIdx;
+    for( gChipIdx = 0; gChipIdx < SIM_ST25R3911_CHIPS; gChipIdx++ )
+    {
+        simChipRunEvents( nowNs );
+    }
+    gChipIdx = saved;
+}
+
+
+/*******************************************************************************/
+void simSt25r3911SetIrqLatency( uint32_t ns )
+{
+    gIrqLatencyNs = ns;
+}
+
+
+/*******************************************************************************/
+const simSt25r3911Stats* simSt25r3911GetStats( uint8_t chip )
+{
+    return &gChips[chip].stats;
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static uint64_t simChipNextEventNs( void )
+{
+    uint64_t next;
+
+    next = gChip.tOsc;
+    next = ((gChip.tDct     < next) ? gChip.tDct     : next);
+    next = ((gChip.tTxByte  < next) ? gChip.tTxByte  : next);
+    next = ((gChip.tTxEnd   < next) ? gChip.tTxEnd   : next);
+    next = ((gChip.tRxStart < next) ? gChip.tRxStart : next);
+    next = ((gChip.tRxByte  < next) ? gChip.tRxByte  : next);
+    next = ((gChip.tRxEnd   < next) ? gChip.tRxEnd   : next);
+    next = ((gChip.tNrt     < next) ? gChip.tNrt     : next);
+    next = ((gChip.tGpt     < next) ? gChip.tGpt     : next);
+    next = ((gChip.tWut     < next) ? gChip.tWut     : next);
+    next = ((gChip.tIrqEdge < next) ? gChip.tIrqEdge : next);
+
+    return next;
+}
+
+
+/*******************************************************************************/
+static void simChipRunEvents( uint64_t nowNs )
+{
+    while( simChipNextEventNs() <= nowNs )
+    {
+        if( gChip.tOsc <= nowNs )
+        {
+            gChip.tOsc  = SIM_ST25R3911_NO_EVENT;
+            gChip.oscOk = true;
+            simRaiseIrq( ST25R3911_IRQ_MASK_OSC );
+            simUpdateField();
+        }
+        else if( gChip.tDct <= nowNs )
+        {
+            gChip.tDct                = SIM_ST25R3911_NO_EVENT;
+            gChip.regs[gChip.dctReg]  = gChip.dctVal;
+            simRaiseIrq( ST25R3911_IRQ_MASK_DCT );
+        }
+        else if( gChip.tTxByte <= nowNs )
+        {
+            gChip.tTxByte = SIM_ST25R3911_NO_EVENT;
+
+            if( gChip.fifoLen == 0U )
+            {
+                gChip.fifoStatus2 |= ST25R3911_REG_FIFO_RX_STATUS2_fifo_unf;
+                gChip.tTxEnd       = nowNs;
+                gChip.stats.fifoUnderflows++;
+            }
+            else
+            {
+                if( gChip.txLen < SIM_TX_FRAME_MAX )
+                {
+                    gChip.txFrame[gChip.txLen] = simFifoPop();
+                }
+                gChip.txLen++;
+
+                /* Water level reached while more data is expected */
+                if( (gChip.fifoLen == ((((gChip.regs[ST25R3911_REG_IO_CONF1] & ST25R3911_REG_IO_CONF1_fifo_lt) != 0U) ? 16U : 32U)))
+                    && (gChip.fifoLoaded < gChip.txBytesTotal) )
+                {
+                    simRaiseIrq( ST25R3911_IRQ_MASK_FWL );
+                }
+
+                if( gChip.txLen < gChip.txBytesTotal )
+                {
+                    gChip.tTxByte = nowNs + gChip.txByteNs;
+                }
+                else
+                {
+                    gChip.tTxEnd = nowNs + (gChip.txCrc ? (2U * gChip.txByteNs) : 0U) + simConvFcToNs( 2U * simTxBitFc() );
+                }
+            }
+        }
+        else if( gChip.tTxEnd <= nowNs )
+        {
+            gChip.tTxEnd = SIM_ST25R3911_NO_EVENT;
+            simTxEnd();
+        }
+        else if( gChip.tRxStart <= nowNs )
+        {
+            gChip.tRxStart = SIM_ST25R3911_NO_EVENT;
+            simRxStart();
+        }
+        else if( gChip.tRxByte <= nowNs )
+        {
+            gChip.tRxByte = SIM_ST25R3911_NO_EVENT;
+            simRxByte();
+        }
+        else if( gChip.tRxEnd <= nowNs )
+        {
+            gChip.tRxEnd = SIM_ST25R3911_NO_EVENT;
+            simRxEnd();
+        }
+        else if( gChip.tNrt <= nowNs )
+        {
+            gChip.tNrt = SIM_ST25R3911_NO_EVENT;
+            simRaiseIrq( ST25R3911_IRQ_MASK_NRE );
+        }
+        else if( gChip.tGpt <= nowNs )
+        {
+            gChip.tGpt = SIM_ST25R3911_NO_EVENT;
+            simRaiseIrq( ST25R3911_IRQ_MASK_GPE );
+        }
+        else if( gChip.tIrqEdge <= nowNs )
+        {
+            gChip.tIrqEdge = SIM_ST25R3911_NO_EVENT;
+            gChip.irqEdge  = gChip.irqLine;     /* Already served (read) meanwhile: no edge */
+        }
+        else
+        {
+            gChip.tWut = nowNs + simWutPeriodNs();
+            simWakeUpMeasure();
+        }
+    }
+}
+
+
+/*******************************************************************************/
+static void simSetDefault( void )
+{
+    simSt25r3911Stats stats;
+
+    stats = gChip.stats;
+    memset( &gChip, 0x00, sizeof(gChip) );
+    gChip.stats = stats;
+
+    gChip.regs[ST25R3911_REG_MODE]              = ST25R3911_REG_MODE_om_iso14443a;
+    gChip.regs[ST25R3911_REG_REGULATOR_RESULT]  = SIM_REGULATOR_RESULT;
+    gChip.regs[ST25R3911_REG_IC_IDENTITY]       = SIM_IC_IDENTITY;
+    gChip.spiState                              = SIM_SPI_DONE;
+
+    gChip.tOsc     = SIM_ST25R3911_NO_EVENT;
+    gChip.tDct     = SIM_ST25R3911_NO_EVENT;
+    gChip.tTxByte  = SIM_ST25R3911_NO_EVENT;
+    gChip.tTxEnd   = SIM_ST25R3911_NO_EVENT;
+    gChip.tRxStart = SIM_ST25R3911_NO_EVENT;
+    gChip.tRxByte  = SIM_ST25R3911_NO_EVENT;
+    gChip.tRxEnd   = SIM_ST25R3911_NO_EVENT;
+    gChip.tNrt     = SIM_ST25R3911_NO_EVENT;
+    gChip.tGpt     = SIM_ST25R3911_NO_EVENT;
+    gChip.tWut     = SIM_ST25R3911_NO_EVENT;
+    gChip.tIrqEdge = SIM_ST25R3911_NO_EVENT;
+
+    simTagsField( gChipIdx, false );
+    simTagsSetDrive( gChipIdx, 0U );
+}
+
+
+/*******************************************************************************/
+static void simUpdateIrqLine( void )
+{
+    bool line;
+
+    line = ((gChip.irq[0] | gChip.irq[1] | gChip.irq[2]) != 0U);
+
+    if( line && !gChip.irqLine )
+    {
+        /* The firmware sees the edge after the configured latency (ISR entry, task switch) */
+        if( gIrqLatencyNs == 0U )
+        {
+            gChip.irqEdge = true;
+        }
+        else if( gChip.tIrqEdge == SIM_ST25R3911_NO_EVENT )
+        {
+            gChip.tIrqEdge = simClockNowNs() + gIrqLatencyNs;
+        }
+        gChip.stats.irqs++;
+    }
+    gChip.irqLine = line;
+}
+
+
+/*******************************************************************************/
+static void simRaiseIrq( uint32_t mask )
+{
+    uint8_t i;
+
+    for( i = 0; i < SIM_IRQ_REGS; i++ )
+    {
+        gChip.irq[i] |= (uint8_t)(SIM_IRQ_REG( mask, i ) & ~gChip.regs[ST25R3911_REG_IRQ_MASK_MAIN + i]);
+    }
+    simUpdateIrqLine();
+}
+
+
+/*******************************************************************************/
+static uint8_t simReadReg( uint8_t reg )
+{
+    uint8_t val;
+
+    switch( reg )
+    {
+        case ST25R3911_REG_IRQ_MAIN:
+            /* Main register summarizes pending timer and error IRQs */
+            val  = gChip.irq[0];
+            val |= ((gChip.irq[1] != 0U) ? (uint8_t)ST25R3911_IRQ_MASK_TIM : 0U);
+            val |= ((gChip.irq[2] != 0U) ? (uint8_t)ST25R3911_IRQ_MASK_ERR : 0U);
+            gChip.irq[0] = 0;
+            break;
+
+        case ST25R3911_REG_IRQ_TIMER_NFC:
+        case ST25R3911_REG_IRQ_ERROR_WUP:
+            val = gChip.irq[reg - ST25R3911_REG_IRQ_MAIN];
+            gChip.irq[reg - ST25R3911_REG_IRQ_MAIN] = 0;
+            break;
+
+        case ST25R3911_REG_FIFO_RX_STATUS1:
+            val = gChip.fifoLen;
+            break;
+
+        case ST25R3911_REG_FIFO_RX_STATUS2:
+            val = gChip.fifoStatus2;
+            break;
+
+        case ST25R3911_REG_COLLISION_STATUS:
+            val = gChip.collision;
+            break;
+
+        case ST25R3911_REG_REGULATOR_RESULT:
+            val  = (uint8_t)(gChip.regs[reg] & ST25R3911_REG_REGULATOR_RESULT_mask_reg);
+            val |= ((gChip.tNrt != SIM_ST25R3911_NO_EVENT) ? ST25R3911_REG_REGULATOR_RESULT_nrt_on : 0U);
+            val |= ((gChip.tGpt != SIM_ST25R3911_NO_EVENT) ? ST25R3911_REG_REGULATOR_RESULT_gpt_on : 0U);
+            break;
+
+        case ST25R3911_REG_AUX_DISPLAY:
+            val  = (gChip.oscOk ? ST25R3911_REG_AUX_DISPLAY_osc_ok : 0U);
+            val |= (gChip.fieldOn ? ST25R3911_REG_AUX_DISPLAY_tx_on : 0U);
+            val |= (((gChip.regs[ST25R3911_REG_OP_CONTROL] & ST25R3911_REG_OP_CONTROL_rx_en) != 0U) ? ST25R3911_REG_AUX_DISPLAY_rx_on : 0U);
+            val |= (((gChip.tRxByte != SIM_ST25R3911_NO_EVENT) || (gChip.tRxEnd != SIM_ST25R3911_NO_EVENT)) ? ST25R3911_REG_AUX_DISPLAY_rx_act : 0U);
+            break;
+
+        default:
+            val = gChip.regs[reg];
+            break;
+    }
+
+    return val;
+}
+
+
+/*******************************************************************************/
+static void simWriteReg( uint8_t reg, uint8_t val )
+{
+    uint8_t prev;
+
+    /* Callers mask the address already, stated here for the register file bound */
+    if( reg >= SIM_REG_COUNT )
+    {
+        return;
+    }
+
+    /* Read only registers */
+    if( ((reg >= ST25R3911_REG_IRQ_MAIN) && (reg <= ST25R3911_REG_COLLISION_STATUS)) || (reg == ST25R3911_REG_NFCIP1_BIT_RATE)
+        || (reg == ST25R3911_REG_AD_RESULT) || (reg == ST25R3911_REG_ANT_CAL_RESULT) || (reg == ST25R3911_REG_AM_MOD_DEPTH_RESULT)
+        || ((reg >= ST25R3911_REG_REGULATOR_RESULT) && (reg <= ST25R3911_REG_GAIN_RED_STATE)) || (reg == ST25R3911_REG_CAP_SENSOR_RESULT)
+        || (reg == ST25R3911_REG_AUX_DISPLAY) || (reg == ST25R3911_REG_AMPLITUDE_MEASURE_AA_RESULT) || (reg == ST25R3911_REG_AMPLITUDE_MEASURE_RESULT)
+        || (reg == ST25R3911_REG_PHASE_MEASURE_AA_RESULT) || (reg == ST25R3911_REG_PHASE_MEASURE_RESULT)
+        || (reg == ST25R3911_REG_CAPACITANCE_MEASURE_AA_RESULT) || (reg == ST25R3911_REG_CAPACITANCE_MEASURE_RESULT)
+        || (reg == ST25R3911_REG_IC_IDENTITY) )
+    {
+        return;
+    }
+
+    prev            = gChip.regs[reg];
+    gChip.regs[reg] = val;
+
+    if( reg == ST25R3911_REG_OP_CONTROL )
+    {
+        if( ((val & ST25R3911_REG_OP_CONTROL_en) != 0U) && ((prev & ST25R3911_REG_OP_CONTROL_en) == 0U) )
+        {
+            gChip.tOsc = simClockNowNs() + SIM_OSC_STARTUP_NS;
+        }
+        else if( (val & ST25R3911_REG_OP_CONTROL_en) == 0U )
+        {
+            gChip.tOsc  = SIM_ST25R3911_NO_EVENT;
+            gChip.oscOk = false;
+        }
+        else
+        {
+            /* Oscillator state unchanged */
+        }
+        simUpdateField();
+
+        /* Wake-up mode: the WU timer runs while the oscillator is off */
+        if( ((val & (ST25R3911_REG_OP_CONTROL_wu | ST25R3911_REG_OP_CONTROL_en)) == ST25R3911_REG_OP_CONTROL_wu) )
+        {
+            if( gChip.tWut == SIM_ST25R3911_NO_EVENT )
+            {
+                gChip.tWut = simClockNowNs() + simWutPeriodNs();
+            }
+        }
+        else
+        {
+            gChip.tWut = SIM_ST25R3911_NO_EVENT;
+        }
+    }
+    else if( reg == ST25R3911_REG_RFO_AM_OFF_LEVEL )
+    {
+        /* The energy so far was spent at the previous drive */
+        if( gChip.fieldOn )
+        {
+            simFieldAccount();
+        }
+        simTagsSetDrive( gChipIdx, val );
+    }
+    else
+    {
+        /* No side effect */
+    }
+}
+
+
+/*******************************************************************************/
+static void simCommand( uint8_t cmd )
+{
+    switch( cmd )
+    {
+        case ST25R3911_CMD_SET_DEFAULT:
+            simSetDefault();
+            break;
+
+        case ST25R3911_CMD_CLEAR_FIFO:
+            /* Stops all activities */
+            simClearFifo();
+            gChip.tTxByte  = SIM_ST25R3911_NO_EVENT;
+            gChip.tTxEnd   = SIM_ST25R3911_NO_EVENT;
+            gChip.tRxStart = SIM_ST25R3911_NO_EVENT;
+            gChip.tRxByte  = SIM_ST25R3911_NO_EVENT;
+            gChip.tRxEnd   = SIM_ST25R3911_NO_EVENT;
+            gChip.tNrt     = SIM_ST25R3911_NO_EVENT;
+            gChip.tGpt     = SIM_ST25R3911_NO_EVENT;
+            break;
+
+        case ST25R3911_CMD_TRANSMIT_WITH_CRC:
+        case ST25R3911_CMD_TRANSMIT_WITHOUT_CRC:
+        case ST25R3911_CMD_TRANSMIT_REQA:
+        case ST25R3911_CMD_TRANSMIT_WUPA:
+            simStartTx( cmd );
+            break;
+
+        case ST25R3911_CMD_MASK_RECEIVE_DATA:
+            gChip.rxMasked = true;
+            break;
+
+        case ST25R3911_CMD_UNMASK_RECEIVE_DATA:
+            gChip.rxMasked = false;
+            break;
+
+        case ST25R3911_CMD_MEASURE_AMPLITUDE:
+            simStartDct( SIM_DCT_MEASURE_NS, ST25R3911_REG_AD_RESULT, simAdMeasure( SIM_AD_AMPLITUDE, simAmplitudeLoad() ) );
+            break;
+
+        case ST25R3911_CMD_MEASURE_PHASE:
+            simStartDct( SIM_DCT_MEASURE_NS, ST25R3911_REG_AD_RESULT, simAdMeasure( SIM_AD_PHASE, ((int32_t)simTagsCount( gChipIdx ) * (int32_t)SIM_AD_PHASE_TAG_LOAD) ) );
+            break;
+
+        case ST25R3911_CMD_MEASURE_CAPACITANCE:
+            simStartDct( SIM_DCT_MEASURE_NS, ST25R3911_REG_AD_RESULT, SIM_AD_CAPACITANCE );
+            break;
+
+        case ST25R3911_CMD_MEASURE_VDD:
+            simStartDct( SIM_DCT_MEASURE_NS, ST25R3911_REG_AD_RESULT, SIM_AD_VDD_3V3 );
+            break;
+
+        case ST25R3911_CMD_ADJUST_REGULATORS:
+            simStartDct( SIM_DCT_CALIBRATE_NS, ST25R3911_REG_REGULATOR_RESULT, SIM_REGULATOR_RESULT );
+            break;
+
+        case ST25R3911_CMD_CALIBRATE_ANTENNA:
+            simStartDct( SIM_DCT_CALIBRATE_NS, ST25R3911_REG_ANT_CAL_RESULT, SIM_ANT_CAL_RESULT );
+            break;
+
+        case ST25R3911_CMD_CALIBRATE_MODULATION:
+            simStartDct( SIM_DCT_CALIBRATE_NS, ST25R3911_REG_AM_MOD_DEPTH_RESULT, SIM_AM_MOD_DEPTH_RESULT );
+            break;
+
+        case ST25R3911_CMD_CALIBRATE_C_SENSOR:
+            simStartDct( SIM_DCT_CALIBRATE_NS, ST25R3911_REG_CAP_SENSOR_RESULT, 0x00U );
+            break;
+
+        case ST25R3911_CMD_START_GP_TIMER:
+            simStartGpt();
+            break;
+
+        case ST25R3911_CMD_START_NO_RESPONSE_TIMER:
+            simStartNrt();
+            break;
+
+        default:
+            /* Analog preset, squelch, RSSI, test and remaining timer commands have no observable effect */
+            break;
+    }
+}
+
+
+/*******************************************************************************/
+static void simFifoPush( uint8_t val )
+{
+    if( gChip.fifoLen >= ST25R3911_FIFO_DEPTH )
+    {
+        gChip.fifoStatus2 |= ST25R3911_REG_FIFO_RX_STATUS2_fifo_ovr;
+        gChip.stats.fifoOverflows++;
+        return;
+    }
+    gChip.fifo[gChip.fifoLen++] = val;
+}
+
+
+/*******************************************************************************/
+static uint8_t simFifoPop( void )
+{
+    uint8_t val;
+
+    if( gChip.fifoLen == 0U )
+    {
+        gChip.fifoStatus2 |= ST25R3911_REG_FIFO_RX_STATUS2_fifo_unf;
+        gChip.stats.fifoUnderflows++;
+        return 0x00U;
+    }
+
+    val = gChip.fifo[0];
+    gChip.fifoLen--;
+    memmove( &gChip.fifo[0], &gChip.fifo[1], gChip.fifoLen );
+
+    return val;
+}
+
+
+/*******************************************************************************/
+static void simClearFifo( void )
+{
+    gChip.fifoLen     = 0;
+    gChip.fifoLoaded  = 0;
+    gChip.fifoStatus2 = 0;
+    gChip.collision   = 0;
+}
+
+
+/*******************************************************************************/
+static void simUpdateField( void )
+{
+    bool on;
+
+    on = (gChip.oscOk && ((gChip.regs[ST25R3911_REG_OP_CONTROL] & ST25R3911_REG_OP_CONTROL_tx_en) != 0U));
+
+    if( on != gChip.fieldOn )
+    {
+        gChip.fieldOn = on;
+        simTagsField( gChipIdx, on );
+
+        if( on )
+        {
+            gChip.fieldOnNs = simClockNowNs();
+        }
+        else
+        {
+            simFieldAccount();
+        }
+
+        /* Tags lose power: an ongoing reception stops */
+        if( !on )
+        {
+            gChip.tRxStart = SIM_ST25R3911_NO_EVENT;
+        }
+    }
+}
+
+
+/*******************************************************************************/
+static void simStartDct( uint64_t delayNs, uint8_t reg, uint8_t val )
+{
+    gChip.tDct   = simClockNowNs() + delayNs;
+    gChip.dctReg = reg;
+    gChip.dctVal = val;
+}
+
+
+/*******************************************************************************/
+static void simStartTx( uint8_t cmd )
+{
+    uint64_t now;
+    uint32_t bitFc;
+
+    now            = simClockNowNs();
+    bitFc          = simTxBitFc();
+    gChip.txTech   = simCurrentTech();
+    gChip.txCrc    = (cmd == ST25R3911_CMD_TRANSMIT_WITH_CRC);
+    gChip.txLen    = 0;
+    gChip.rxMasked = false;
+    gChip.txByteNs = simConvFcToNs( bitFc * simBitsPerByte( gChip.txTech, false ) );
+
+    /* Short frames carry a fixed 7 bit command */
+    if( (cmd == ST25R3911_CMD_TRANSMIT_REQA) || (cmd == ST25R3911_CMD_TRANSMIT_WUPA) )
+    {
+        gChip.txFrame[0]    = ((cmd == ST25R3911_CMD_TRANSMIT_REQA) ? 0x26U : 0x52U);
+        gChip.txLen         = 1;
+        gChip.txBitsTotal   = 7;
+        gChip.txBytesTotal  = 1;
+        gChip.tTxEnd        = now + simConvFcToNs( bitFc * (1U + 7U + 2U) );
+        return;
+    }
+
+    gChip.txBitsTotal  = (uint16_t)(((uint16_t)gChip.regs[ST25R3911_REG_NUM_TX_BYTES1] << 8) | gChip.regs[ST25R3911_REG_NUM_TX_BYTES2]);
+    gChip.txBytesTotal = (uint16_t)((gChip.txBitsTotal + 7U) / 8U);
+
+    if( gChip.txBytesTotal == 0U )
+    {
+        gChip.tTxEnd = now + simConvFcToNs( bitFc * 2U );
+    }
+    else
+    {
+        gChip.tTxByte = now + simConvFcToNs( bitFc ) + gChip.txByteNs;
+    }
+}
+
+
+/*******************************************************************************/
+static void simTxEnd( void )
+{
+    uint16_t reqBits;
+    uint16_t crc;
+    uint8_t  nRsp;
+    uint32_t fdtFc;
+    uint8_t  i;
+
+    gChip.stats.txFrames++;
+
+    simRaiseIrq( ST25R3911_IRQ_MASK_TXE );
+    simStartNrt();
+    simGptTrigger( ST25R3911_REG_GPT_CONTROL_gptc_etx_nfc );
+
+    if( !gChip.fieldOn || ((gChip.regs[ST25R3911_REG_OP_CONTROL] & ST25R3911_REG_OP_CONTROL_rx_en) == 0U) )
+    {
+        return;
+    }
+
+    /* Rebuild the frame as seen by the tags */
+    if( gChip.txTech == SIM_RF_TECH_NFCV )
+    {
+        reqBits = (uint16_t)(simNfcvDecodeVcd( gChip.txFrame, gChip.txLen, gReqBuf ) * 8U);
+    }
+    else
+    {
+        memcpy( gReqBuf, gChip.txFrame, gChip.txLen );
+        reqBits = gChip.txBitsTotal;
+
+        if( gChip.txCrc && ((reqBits % 8U) == 0U) && (gChip.txTech == SIM_RF_TECH_NFCA) )
+        {
+            crc = simCrc16( 0x6363U, gReqBuf, (uint16_t)(reqBits / 8U) );
+            gReqBuf[reqBits / 8U]        = (uint8_t)(crc & 0xFFU);
+            gReqBuf[(reqBits / 8U) + 1U] = (uint8_t)(crc >> 8U);
+            reqBits += 16U;
+        }
+    }
+
+    simTagsRunScript( simClockNowNs() );
+    nRsp = simTagsExchange( gChipIdx, gChip.txTech, (uint8_t)((gChip.regs[ST25R3911_REG_BIT_RATE] & ST25R3911_REG_BIT_RATE_mask_txrate) >> ST25R3911_REG_BIT_RATE_shift_txrate),
+                            gReqBuf, reqBits, gTagRsp, SIM_TAG_RSP_MAX );
+    if( (nRsp == 0U) || gChip.rxMasked )
+    {
+        return;
+    }
+
+    gChip.rxCol       = false;
+    gChip.rxColStatus = 0;
+    gChip.rxLastBits  = 0;
+    gChip.rxPos       = 0;
+
+    if( gChip.txTech == SIM_RF_TECH_NFCV )
+    {
+        simMergeNfcv( nRsp );
+    }
+    else
+    {
+        simMergeNfca( nRsp );
+    }
+
+    fdtFc = gTagRsp[0].fdtFc;
+    for( i = 1; i < nRsp; i++ )
+    {
+        fdtFc = ((gTagRsp[i].fdtFc < fdtFc) ? gTagRsp[i].fdtFc : fdtFc);
+    }
+
+    gChip.rxByteNs = simConvFcToNs( simRxBitFc() * simBitsPerByte( gChip.txTech, true ) );
+    gChip.rxEofNs  = simConvFcToNs( simRxBitFc() * 2U );
+    gChip.tRxStart = simClockNowNs() + simConvFcToNs( fdtFc );
+}
+
+
+/*******************************************************************************/
+static void simRxStart( void )
+{
+    uint8_t gptc;
+
+    simRaiseIrq( ST25R3911_IRQ_MASK_RXS );
+
+    /* A started reception stops the NRT unless in EMV mode */
+    if( (gChip.regs[ST25R3911_REG_GPT_CONTROL] & ST25R3911_REG_GPT_CONTROL_nrt_emv) == 0U )
+    {
+        gChip.tNrt = SIM_ST25R3911_NO_EVENT;
+    }
+
+    gptc = (uint8_t)(gChip.regs[ST25R3911_REG_GPT_CONTROL] & ST25R3911_REG_GPT_CONTROL_gptc_mask);
+    if( gptc == ST25R3911_REG_GPT_CONTROL_gptc_srx )
+    {
+        simStartGpt();
+    }
+
+    gChip.tRxByte = simClockNowNs() + simConvFcToNs( simRxBitFc() ) + gChip.rxByteNs;
+}
+
+
+/*******************************************************************************/
+static void simRxByte( void )
+{
+    simFifoPush( gChip.rxFrame[gChip.rxPos++] );
+
+    if( gChip.fifoLen == ((((gChip.regs[ST25R3911_REG_IO_CONF1] & ST25R3911_REG_IO_CONF1_fifo_lr) != 0U) ? 80U : 64U)) )
+    {
+        simRaiseIrq( ST25R3911_IRQ_MASK_FWL );
+    }
+
+    if( gChip.rxPos < gChip.rxLen )
+    {
+        gChip.tRxByte = simClockNowNs() + gChip.rxByteNs;
+    }
+    else
+    {
+        gChip.tRxEnd = simClockNowNs() + gChip.rxEofNs;
+    }
+}
+
+
+/*******************************************************************************/
+static void simRxEnd( void )
+{
+    uint32_t irqs;
+    bool     crcCheck;
+
+    gChip.stats.rxFrames++;
+    irqs = ST25R3911_IRQ_MASK_RXE;
+
+    gChip.fifoStatus2 = (uint8_t)((gChip.fifoStatus2 & (ST25R3911_REG_FIFO_RX_STATUS2_fifo_ovr | ST25R3911_REG_FIFO_RX_STATUS2_fifo_unf))
+                                  | ((uint32_t)gChip.rxLastBits << ST25R3911_REG_FIFO_RX_STATUS2_shift_fifo_lb));
+
+    if( gChip.rxCol )
+    {
+        gChip.collision = gChip.rxColStatus;
+        irqs |= ST25R3911_IRQ_MASK_COL;
+    }
+
+    /* Only NFC-A CRCs are checked by the model, stream mode has no framing on chip */
+    crcCheck = ((gChip.txTech == SIM_RF_TECH_NFCA) && ((gChip.regs[ST25R3911_REG_AUX] & ST25R3911_REG_AUX_no_crc_rx) == 0U));
+    if( crcCheck && !gChip.rxCol )
+    {
+        if( (gChip.rxLastBits != 0U) || (gChip.rxLen < 3U) || (simCrc16( 0x6363U, gChip.rxFrame, gChip.rxLen ) != 0U) )
+        {
+            irqs |= ST25R3911_IRQ_MASK_CRC;
+        }
+    }
+
+    simRaiseIrq( irqs );
+    simGptTrigger( ST25R3911_REG_GPT_CONTROL_gptc_erx );
+}
+
+
+/*******************************************************************************/
+static void simStartNrt( void )
+{
+    uint32_t nrt;
+    uint32_t unitFc;
+
+    nrt    = (((uint32_t)gChip.regs[ST25R3911_REG_NO_RESPONSE_TIMER1] << 8) | gChip.regs[ST25R3911_REG_NO_RESPONSE_TIMER2]);
+    unitFc = (((gChip.regs[ST25R3911_REG_GPT_CONTROL] & ST25R3911_REG_GPT_CONTROL_nrt_step) != 0U) ? 4096U : 64U);
+
+    gChip.tNrt = ((nrt == 0U) ? SIM_ST25R3911_NO_EVENT : (simClockNowNs() + simConvFcToNs( (uint64_t)nrt * unitFc )));
+}
+
+
+/*******************************************************************************/
+static void simStartGpt( void )
+{
+    uint32_t gpt;
+
+    gpt = (((uint32_t)gChip.regs[ST25R3911_REG_GPT1] << 8) | gChip.regs[ST25R3911_REG_GPT2]);
+
+    gChip.tGpt = ((gpt == 0U) ? SIM_ST25R3911_NO_EVENT : (simClockNowNs() + simConvFcToNs( (uint64_t)gpt * 8U )));
+}
+
+
+/*******************************************************************************/
+static void simGptTrigger( uint8_t gptc )
+{
+    if( (gChip.regs[ST25R3911_REG_GPT_CONTROL] & ST25R3911_REG_GPT_CONTROL_gptc_mask) == gptc )
+    {
+        simStartGpt();
+    }
+}
+
+
+/*******************************************************************************/
+static uint64_t simWutPeriodNs( void )
+{
+    uint8_t  wutc;
+    uint64_t steps;
+
+    wutc  = gChip.regs[ST25R3911_REG_WUP_TIMER_CONTROL];
+    steps = ((uint64_t)((wutc >> ST25R3911_REG_WUP_TIMER_CONTROL_shift_wut) & 0x07U) + 1U);
+
+    /* wur: 10ms resolution, 100ms otherwise */
+    return (steps * (((wutc & ST25R3911_REG_WUP_TIMER_CONTROL_wur) != 0U) ? 10ULL : 100ULL) * SIM_NS_PER_MS);
+}
+
+
+/*******************************************************************************/
+static void simWakeUpMeasure( void )
+{
+    uint8_t  wutc;
+    uint32_t irqs;
+
+    /* Tags entering the field are seen by the measurement, not only by the next frame */
+    simTagsRunScript( simClockNowNs() );
+
+    gChip.stats.wutMeasures++;
+    wutc = gChip.regs[ST25R3911_REG_WUP_TIMER_CONTROL];
+    irqs = ((wutc & ST25R3911_REG_WUP_TIMER_CONTROL_wto) != 0U) ? ST25R3911_IRQ_MASK_WT : 0U;
+
+    if( (wutc & ST25R3911_REG_WUP_TIMER_CONTROL_wam) != 0U )
+    {
+        gChip.regs[ST25R3911_REG_AMPLITUDE_MEASURE_RESULT] = simAdMeasure( SIM_AD_AMPLITUDE, simAmplitudeLoad() );
+        irqs |= (simWakeUpCompare( gChip.regs[ST25R3911_REG_AMPLITUDE_MEASURE_RESULT], ST25R3911_REG_AMPLITUDE_MEASURE_CONF,
+                                   ST25R3911_REG_AMPLITUDE_MEASURE_REF, ST25R3911_REG_AMPLITUDE_MEASURE_AA_RESULT ) ? ST25R3911_IRQ_MASK_WAM : 0U);
+    }
+
+    if( (wutc & ST25R3911_REG_WUP_TIMER_CONTROL_wph) != 0U )
+    {
+        gChip.regs[ST25R3911_REG_PHASE_MEASURE_RESULT] = simAdMeasure( SIM_AD_PHASE, ((int32_t)simTagsCount( gChipIdx ) * (int32_t)SIM_AD_PHASE_TAG_LOAD) );
+        irqs |= (simWakeUpCompare( gChip.regs[ST25R3911_REG_PHASE_MEASURE_RESULT], ST25R3911_REG_PHASE_MEASURE_CONF,
+                                   ST25R3911_REG_PHASE_MEASURE_REF, ST25R3911_REG_PHASE_MEASURE_AA_RESULT ) ? ST25R3911_IRQ_MASK_WPH : 0U);
+    }
+
+    /* Capacitive sensor not modelled: a constant result never wakes */
+    if( irqs != 0U )
+    {
+        simRaiseIrq( irqs );
+    }
+}
+
+
+/*******************************************************************************/
+static bool simWakeUpCompare( uint8_t meas, uint8_t confReg, uint8_t refReg, uint8_t aaReg )
+{
+    uint8_t conf;
+    uint8_t ref;
+    uint8_t delta;
+    bool    woke;
+
+    /* Same bit layout for amplitude and phase */
+    conf  = gChip.regs[confReg];
+    delta = (uint8_t)(conf >> ST25R3911_REG_AMPLITUDE_MEASURE_CONF_shift_am_d);
+
+    if( (conf & ST25R3911_REG_AMPLITUDE_MEASURE_CONF_am_ae) != 0U )
+    {
+        /* Auto averaging: the average is the reference, started from the first measurement */
+        ref  = ((gChip.regs[aaReg] == 0U) ? meas : gChip.regs[aaReg]);
+        woke = (((meas > ref) ? (meas - ref) : (ref - meas)) > delta);
+
+        if( !woke || ((conf & ST25R3911_REG_AMPLITUDE_MEASURE_CONF_am_aam) != 0U) )
+        {
+            ref = (uint8_t)((int16_t)ref + (((int16_t)meas - (int16_t)ref) / (int16_t)(4U << ((conf & ST25R3911_REG_AMPLITUDE_MEASURE_CONF_mask_am_aew) >> ST25R3911_REG_AMPLITUDE_MEASURE_CONF_shift_am_aew))));
+        }
+        gChip.regs[aaReg] = ref;
+        return woke;
+    }
+
+    ref = gChip.regs[refReg];
+    return (((meas > ref) ? (meas - ref) : (ref - meas)) > delta);
+}
+
+
+/*******************************************************************************/
+static void simFieldAccount( void )
+{
+    uint32_t us;
+    uint32_t amp;
+
+    /* Field on time, and the same weighted by the output power (amplitude squared) relative to full drive */
+    us  = (uint32_t)((simClockNowNs() - gChip.fieldOnNs) / SIM_NS_PER_US);
+    amp = (((uint32_t)gChip.regs[ST25R3911_REG_RFO_AM_OFF_LEVEL] * SIM_AD_AMPLITUDE_RFO_STEP) < SIM_AD_AMPLITUDE)
+          ? (SIM_AD_AMPLITUDE - ((uint32_t)gChip.regs[ST25R3911_REG_RFO_AM_OFF_LEVEL] * SIM_AD_AMPLITUDE_RFO_STEP)) : 0U;
+
+    gChip.stats.fieldOnUs     += us;
+    gChip.stats.fieldEnergyUs += (uint32_t)(((uint64_t)us * amp * amp) / (SIM_AD_AMPLITUDE * SIM_AD_AMPLITUDE));
+    gChip.fieldOnNs            = simClockNowNs();
+}
+
+
+/*******************************************************************************/
+static int32_t simAmplitudeLoad( void )
+{
+    /* Less drive (higher driver resistance) and every tag lower the amplitude, a tag on the antenna most */
+    return -(((int32_t)simTagsCount( gChipIdx ) * (int32_t)SIM_AD_AMPLITUDE_TAG_LOAD)
+             + ((int32_t)simTagsNearCount( gChipIdx ) * (int32_t)SIM_AD_AMPLITUDE_NEAR_LOAD)
+             + ((int32_t)gChip.regs[ST25R3911_REG_RFO_AM_OFF_LEVEL] * (int32_t)SIM_AD_AMPLITUDE_RFO_STEP));
+}
+
+
+/*******************************************************************************/
+static uint8_t simAdMeasure( uint8_t base, int32_t load )
+{
+    uint64_t pos;
+    int32_t  drift;
+    int32_t  noise;
+    int32_t  val;
+
+    /* Slow triangular drift (antenna detuning with temperature) plus +/-1 LSB converter noise */
+    pos   = (simClockNowNs() % SIM_AD_DRIFT_PERIOD_NS);
+    pos   = ((pos < (SIM_AD_DRIFT_PERIOD_NS / 2U)) ? pos : (SIM_AD_DRIFT_PERIOD_NS - pos));
+    drift = (int32_t)((pos * (2U * SIM_AD_DRIFT_LSB)) / SIM_AD_DRIFT_PERIOD_NS) - (int32_t)(SIM_AD_DRIFT_LSB / 2U);
+
+    gChip.adSeed = ((gChip.adSeed * 1103515245U) + 12345U);
+    noise        = (int32_t)((gChip.adSeed >> 16) % 3U) - 1;
+
+    /* The measurement drives the antenna itself: tags load it whether the field is on or not */
+    val = ((int32_t)base + load + drift + noise);
+    return (uint8_t)((val < 0) ? 0 : ((val > 0xFF) ? 0xFF : val));
+}
+
+
+/*******************************************************************************/
+static simRfTech simCurrentTech( void )
+{
+    switch( gChip.regs[ST25R3911_REG_MODE] & ST25R3911_REG_MODE_mask_om )
+    {
+        case ST25R3911_REG_MODE_om_iso14443a:
+        case ST25R3911_REG_MODE_om_topaz:
+            return SIM_RF_TECH_NFCA;
+        case ST25R3911_REG_MODE_om_iso14443b:
+            return SIM_RF_TECH_NFCB;
+        case ST25R3911_REG_MODE_om_felica:
+            return SIM_RF_TECH_NFCF;
+        case ST25R3911_REG_MODE_om_subcarrier_stream:
+        case ST25R3911_REG_MODE_om_bpsk_stream:
+            return SIM_RF_TECH_NFCV;
+        default:
+            return SIM_RF_TECH_NONE;
+    }
+}
+
+
+/*******************************************************************************/
+static uint32_t simTxBitFc( void )
+{
+    if( simCurrentTech() == SIM_RF_TECH_NFCV )
+    {
+        return (128U >> (gChip.regs[ST25R3911_REG_STREAM_MODE] & ST25R3911_REG_STREAM_MODE_mask_stx));
+    }
+    return (128U >> ((gChip.regs[ST25R3911_REG_BIT_RATE] & ST25R3911_REG_BIT_RATE_mask_txrate) >> ST25R3911_REG_BIT_RATE_shift_txrate));
+}
+
+
+/*******************************************************************************/
+static uint32_t simRxBitFc( void )
+{
+    uint8_t sm;
+
+    if( simCurrentTech() == SIM_RF_TECH_NFCV )
+    {
+        /* Subcarrier period times number of subcarrier pulses per reported bit */
+        sm = gChip.regs[ST25R3911_REG_STREAM_MODE];
+        return ((64U >> ((sm & ST25R3911_REG_STREAM_MODE_mask_scf) >> ST25R3911_REG_STREAM_MODE_shift_scf))
+                << ((sm & ST25R3911_REG_STREAM_MODE_mask_scp) >> ST25R3911_REG_STREAM_MODE_shift_scp));
+    }
+    return (128U >> ((gChip.regs[ST25R3911_REG_BIT_RATE] & ST25R3911_REG_BIT_RATE_mask_rxrate) >> ST25R3911_REG_BIT_RATE_shift_rxrate));
+}
+
+
+/*******************************************************************************/
+static uint8_t simBitsPerByte( simRfTech tech, bool rx )
+{
+    switch( tech )
+    {
+        case SIM_RF_TECH_NFCA:
+            return (uint8_t)(((gChip.regs[ST25R3911_REG_ISO14443A_NFC] & (rx ? ST25R3911_REG_ISO14443A_NFC_no_rx_par : ST25R3911_REG_ISO14443A_NFC_no_tx_par)) != 0U) ? 8U : 9U);
+        case SIM_RF_TECH_NFCB:
+            return 10U;
+        default:
+            return 8U;
+    }
+}
+
+
+/*******************************************************************************/
+static uint16_t simNfcvDecodeVcd( const uint8_t *in, uint16_t inLen, uint8_t *out )
+{
+    uint16_t i;
+    uint16_t len;
+    uint8_t  j;
+    uint8_t  b;
+
+    len = 0;
+
+    if( (inLen > 0U) && (in[0] == SIM_NFCV_SOF_1_4) )
+    {
+        /* 1 out of 4: 4 coded bytes per data byte, one pulse position per bit pair */
+        for( i = 1; (i + 4U) <= inLen; i += 4U )
+        {
+            b = 0;
+            for( j = 0; j < 4U; j++ )
+            {
+                switch( in[i + j] )
+                {
+                    case 0x02U: break;
+                    case 0x08U: b |= (uint8_t)(1U << (2U * j)); break;
+                    case 0x20U: b |= (uint8_t)(2U << (2U * j)); break;
+                    case 0x80U: b |= (uint8_t)(3U << (2U * j)); break;
+                    default:    return len;
+                }
+            }
+            out[len++] = b;
+        }
+    }
+    else if( (inLen > 0U) && (in[0] == SIM_NFCV_SOF_1_256) )
+    {
+        /* 1 out of 256: 64 coded bytes per data byte, a single pulse in one of them */
+        for( i = 1; (i + SIM_NFCV_BYTES_1_256) <= inLen; i += SIM_NFCV_BYTES_1_256 )
+        {
+            for( j = 0; j < SIM_NFCV_BYTES_1_256; j++ )
+            {
+                b = in[i + j];
+                if( b != 0U )
+                {
+                    out[len] = (uint8_t)((j * 4U) + ((b == 0x02U) ? 0U : ((b == 0x08U) ? 1U : ((b == 0x20U) ? 2U : 3U))));
+                }
+            }
+            len++;
+        }
+    }
+    else
+    {
+        /* EOF only: next inventory slot */
+    }
+
+    return len;
+}
+
+
+/*******************************************************************************/
+static void simMergeNfca( uint8_t nRsp )
+{
+    uint16_t start;
+    uint16_t end;
+    uint16_t p;
+    uint8_t  i;
+    uint8_t  ones;
+    uint8_t  present;
+    uint16_t absPos;
+
+    memset( gChip.rxFrame, 0x00, sizeof(gChip.rxFrame) );
+
+    start = gTagRsp[0].bitOffset;
+    end   = 0;
+    for( i = 0; i < nRsp; i++ )
+    {
+        end = (((gTagRsp[i].bitOffset + gTagRsp[i].nBits) > end) ? (uint16_t)(gTagRsp[i].bitOffset + gTagRsp[i].nBits) : end);
+    }
+
+    /* Wired-OR of all load modulations, first differing bit is the collision */
+    for( p = start; p < end; p++ )
+    {
+        ones    = 0;
+        present = 0;
+        for( i = 0; i < nRsp; i++ )
+        {
+            if( p < (gTagRsp[i].bitOffset + gTagRsp[i].nBits) )
+            {
+                present++;
+                ones += (uint8_t)((gTagRsp[i].data[p / 8U] >> (p % 8U)) & 0x01U);
+            }
+        }
+
+        if( ones != 0U )
+        {
+            gChip.rxFrame[p / 8U] |= (uint8_t)(1U << (p % 8U));
+        }
+
+        if( !gChip.rxCol && ((present != nRsp) || ((ones != 0U) && (ones != present))) )
+        {
+            /* Position within the whole frame, i.e. counted from the start of the request */
+            absPos            = (uint16_t)(((gChip.txBitsTotal / 8U) * 8U) + p);
+            gChip.rxCol       = true;
+            gChip.rxColStatus = (uint8_t)(((absPos / 8U) << 4) | ((absPos % 8U) << 1));
+        }
+    }
+
+    gChip.rxLen      = (uint16_t)((end + 7U) / 8U);
+    gChip.rxLastBits = (uint8_t)(end % 8U);
+}
+
+
+/*******************************************************************************/
+static void simMergeNfcv( uint8_t nRsp )
+{
+    uint8_t  stream[SIM_RX_FRAME_MAX];
+    uint16_t bytes;
+    uint16_t len;
+    uint16_t p;
+    uint16_t bit;
+    uint8_t  i;
+
+    memset( gChip.rxFrame, 0x00, sizeof(gChip.rxFrame) );
+    gChip.rxLen = 0;
+
+    for( i = 0; i < nRsp; i++ )
+    {
+        /* SOF 11101, Manchester data LSB first (0: 10, 1: 01), EOF 10111 */
+        memset( stream, 0x00, sizeof(stream) );
+        bytes = (uint16_t)(gTagRsp[i].nBits / 8U);
+        len   = (uint16_t)((2U * bytes) + 2U);
+        if( len > SIM_RX_FRAME_MAX )
+        {
+            continue;
+        }
+
+        stream[0] = 0x17U;
+        p         = 5;
+        for( bit = 0; bit < (bytes * 8U); bit++ )
+        {
+            if( ((gTagRsp[i].data[bit / 8U] >> (bit % 8U)) & 0x01U) != 0U )
+            {
+                p++;
+                stream[p / 8U] |= (uint8_t)(1U << (p % 8U));
+                p++;
+            }
+            else
+            {
+                stream[p / 8U] |= (uint8_t)(1U << (p % 8U));
+                p += 2U;
+            }
+        }
+        stream[p / 8U]         |= (uint8_t)(1U << (p % 8U));
+        stream[(p + 2U) / 8U]  |= (uint8_t)(1U << ((p + 2U) % 8U));
+        stream[(p + 3U) / 8U]  |= (uint8_t)(1U << ((p + 3U) % 8U));
+        stream[(p + 4U) / 8U]  |= (uint8_t)(1U << ((p + 4U) % 8U));
+
+        /* Subcarriers of colliding VICCs add up */
+        for( p = 0; p < len; p++ )
+        {
+            gChip.rxFrame[p] |= stream[p];
+        }
+        gChip.rxLen = ((len > gChip.rxLen) ? len : gChip.rxLen);
+    }
+}
@@ -0,0 +1,163 @@
+/*! \file sim_st25r3911.h
+ *
+ *  \brief ST25R3911 behavioural model of the host simulator
+ *
+ *  Models what RFAL observes over SPI: the register file, the 96 byte FIFO,
+ *  the IRQ/IRQ mask registers and the IRQ line, direct commands, the
+ *  No-Response and General Purpose timers and the framing of
+ *  NFC-A and stream mode (NFC-V) transmissions and receptions.
+ *  Reader frames are handed to the virtual tags (sim_tags.h) and their
+ *  answers played back into the FIFO with realistic on-air timing.
+ *
+ *  SIM_ST25R3911_CHIPS chips share the SPI bus, each with its own chip
+ *  select, IRQ line and antenna (the tags placed with ant=<n>).
+ *
+ */
+
+#ifndef SIM_ST25R3911_H
+#define SIM_ST25R3911_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define SIM_ST25R3911_NO_EVENT      UINT64_MAX  /*!< No chip event scheduled */
+#define SIM_ST25R3911_CHIPS         4U          /*!< Chips on the SPI bus    */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! SPI/RF traffic counters */
+typedef struct
+{
+    uint32_t spiFrames;         /*!< CS assertions                          */
+    uint32_t spiBytes;          /*!< Bytes clocked over SPI                 */
+    uint32_t regReads;          /*!< Register read frames                   */
+    uint32_t regWrites;         /*!< Register write frames                  */
+    uint32_t fifoReads;         /*!< FIFO read frames                       */
+    uint32_t fifoWrites;        /*!< FIFO load frames                       */
+    uint32_t commands;          /*!< Direct commands                        */
+    uint32_t irqs;              /*!< Rising edges of the IRQ line           */
+    uint32_t txFrames;          /*!< Frames transmitted on RF               */
+    uint32_t rxFrames;          /*!< Frames received from tags              */
+    uint32_t wutMeasures;       /*!< Wake-up timer measurements             */
+    uint32_t fieldOnUs;         /*!< Time with the RF field on              */
+    uint32_t fieldEnergyUs;     /*!< Field on time weighted by the output power (1: full drive) */
+    uint32_t fifoOverflows;     /*!< Bytes received on a full FIFO (lost)   */
+    uint32_t fifoUnderflows;    /*!< Reads of, or Tx from, an empty FIFO    */
+} simSt25r3911Stats;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Power-on reset of all the chips
+ *****************************************************************************
+ */
+void simSt25r3911Reset( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Chip select
+ *
+ * \param[in]  chip     : chip whose CS line changed
+ * \param[in]  selected : true when CS is driven low
+ *****************************************************************************
+ */
+void simSt25r3911Select( uint8_t chip, bool selected );
+
+/*!
+ *****************************************************************************
+ * \brief  Clock one byte over SPI, to the chip selected last
+ *
+ * \param[in]  mosi : byte sent by the MCU
+ *
+ * \return byte returned on MISO
+ *****************************************************************************
+ */
+uint8_t simSt25r3911SpiByte( uint8_t mosi );
+
+/*!
+ *****************************************************************************
+ * \brief  Level of the IRQ line
+ *
+ * \param[in]  chip : chip index
+ *****************************************************************************
+ */
+bool simSt25r3911IrqLine( uint8_t chip );
+
+/*!
+ *****************************************************************************
+ * \brief  Consume a rising edge of the IRQ line
+ *
+ * \param[in]  chip : chip index
+ *
+ * \return true if the IRQ line rose since the last call
+ *****************************************************************************
+ */
+bool simSt25r3911TakeIrqEdge( uint8_t chip );
+
+/*!
+ *****************************************************************************
+ * \brief  Time of the next scheduled event of any chip
+ *
+ * \return virtual time in ns or SIM_ST25R3911_NO_EVENT
+ *****************************************************************************
+ */
+uint64_t simSt25r3911NextEventNs( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Run all events of all chips due at \a nowNs
+ *
+ * \param[in]  nowNs : current virtual time
+ *****************************************************************************
+ */
+void simSt25r3911RunEvents( uint64_t nowNs );
+
+/*!
+ *****************************************************************************
+ * \brief  Delay between a rising IRQ line and the firmware's ISR
+ *
+ * Models the interrupt latency of the MCU (ISR entry, deferral to the IRQ
+ * task) for all chips, 0 (default) delivers the edge immediately.
+ *
+ * \param[in]  ns : latency in ns
+ *****************************************************************************
+ */
+void simSt25r3911SetIrqLatency( uint32_t ns );
+
+/*!
+ *****************************************************************************
+ * \brief  Traffic counters
+ *
+ * \param[in]  chip : chip index
+ *****************************************************************************
+ */
+const simSt25r3911Stats* simSt25r3911GetStats( uint8_t chip );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_ST25R3911_H */
@@ -0,0 +1,1570 @@
+/*! \file sim_tags.c
+ *
+ *  \brief Scriptable virtual tags of the host simulator
+ *
+ *  NFC-A Type 2 Tags follow the ISO14443-3 IDLE/READY/ACTIVE/HALT state
+ *  machine incl. bit oriented anticollision on all cascade levels.
+ *  NFC-A ISO-DEP cards add the ISO14443-4 activation (RATS/PPS) and block
+ *  protocol (I/R/S blocks with chaining in both directions, without CID
+ *  and NAD) on top of it, serving a Type 4 Tag NDEF application or a
+ *  payment application.
+ *  NFC-V Type 5 Tags follow the ISO15693-3 READY/QUIET/SELECTED state
+ *  machine incl. 1 and 16 slot inventory.
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include "sim_tags.h"
+#include "sim_clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define SIM_UID_MAX                 10U
+#define SIM_TAG_NEAR_RFO_MIN        4U      /*!< RFO from which on a near tag is not overloaded */
+
+#define SIM_NFCA_CT                 0x88U   /*!< Cascade tag                                  */
+#define SIM_NFCA_CMD_REQA           0x26U
+#define SIM_NFCA_CMD_WUPA           0x52U
+#define SIM_NFCA_CMD_SEL_CL1        0x93U
+#define SIM_NFCA_CMD_SEL_CL3        0x97U
+#define SIM_NFCA_CMD_HLTA           0x50U
+#define SIM_NFCA_NVB_SELECT         0x70U
+#define SIM_NFCA_SAK_CASCADE        0x04U
+#define SIM_NFCA_SAK_ISODEP         0x20U
+#define SIM_NFCA_CRC_PRELOAD        0x6363U
+#define SIM_NFCA_FDT_LAST_BIT_1     1172U   /*!< ISO14443-3 FDT (n=9) last bit 1 [1/fc]       */
+#define SIM_NFCA_FDT_LAST_BIT_0     1236U   /*!< ISO14443-3 FDT (n=9) last bit 0 [1/fc]       */
+
+#define SIM_T2T_CMD_READ            0x30U
+#define SIM_T2T_CMD_WRITE           0xA2U
+#define SIM_T2T_CMD_FAST_READ       0x3AU
+#define SIM_T2T_ACK                 0x0AU
+#define SIM_T2T_NAK                 0x00U
+#define SIM_T2T_PAGE_LEN            4U
+#define SIM_T2T_PAGES               45U     /*!< NTAG213                                      */
+#define SIM_T2T_READ_LEN            16U
+#define SIM_T2T_MEM_LEN             (SIM_T2T_PAGES * SIM_T2T_PAGE_LEN)
+#define SIM_T2T_NDEF_MAX            141U    /*!< Data area of 144 bytes: TLV header, terminator */
+
+#define SIM_ISODEP_CMD_RATS         0xE0U
+#define SIM_ISODEP_PPS_SB           0xD0U
+#define SIM_ISODEP_PPS0             0x11U   /*!< PPS1 present                                 */
+#define SIM_ISODEP_PCB_I            0x02U
+#define SIM_ISODEP_PCB_I_MASK       0xE2U
+#define SIM_ISODEP_PCB_R            0xA2U
+#define SIM_ISODEP_PCB_R_MASK       0xE6U
+#define SIM_ISODEP_PCB_DESELECT     0xC2U
+#define SIM_ISODEP_PCB_CHAINING     0x10U   /*!< I-block chaining, R-block NAK                */
+#define SIM_ISODEP_PCB_CID_NAD      0x0CU
+#define SIM_ISODEP_PCB_BN           0x01U
+#define SIM_ISODEP_FSC_DEFAULT      256U
+#define SIM_ISODEP_ATS_TB           0x70U   /*!< FWI 7 (38ms), SFGI 0                         */
+#define SIM_ISODEP_FDT_APDU         13560U  /*!< APDU processing time [1/fc]                  */
+
+#define SIM_T4T_APDU_MAX            261U    /*!< Short C-APDU (Lc 255 + Le)                   */
+#define SIM_T4T_RAPDU_MAX           (SIM_T4T_MLE_MAX + 2U)  /*!< R-APDU: MLe + SW         */
+#define SIM_T4T_NDEF_MAX            32765U  /*!< NDEF file of 0x7FFF bytes                    */
+#define SIM_T4T_NDEF_DEFAULT        512U
+#define SIM_T4T_NDEF_MIN            10U     /*!< Text record header, language and one char   */
+#define SIM_T4T_MLE                 0x00FFU /*!< Default MLe, short Le                        */
+#define SIM_T4T_MLE_MIN             0x000FU
+#define SIM_T4T_MLE_MAX             4096U   /*!< Largest MLe, extended Le                     */
+#define SIM_T4T_MAPPING_20          0x20U
+#define SIM_T4T_MAPPING_30          0x30U   /*!< Extended Le with a MLe above 255             */
+#define SIM_T4T_MLC                 0x00FFU
+#define SIM_T4T_FID_CC              0xE103U
+#define SIM_T4T_FID_NDEF            0xE104U
+#define SIM_T4T_CC_LEN              15U
+#define SIM_T4T_RECORD_LEN          180U    /*!< Payment card READ RECORD response            */
+#define SIM_T4T_INS_SELECT          0xA4U
+#define SIM_T4T_INS_READ_BINARY     0xB0U
+#define SIM_T4T_INS_READ_RECORD     0xB2U
+
+#define SIM_NFCV_FLAG_INVENTORY     0x04U
+#define SIM_NFCV_FLAG_SELECT        0x10U   /*!< Non inventory                                */
+#define SIM_NFCV_FLAG_AFI           0x10U   /*!< Inventory                                    */
+#define SIM_NFCV_FLAG_ADDRESS       0x20U   /*!< Non inventory                                */
+#define SIM_NFCV_FLAG_1_SLOT        0x20U   /*!< Inventory                                    */
+#define SIM_NFCV_FLAG_OPTION        0x40U
+
+#define SIM_NFCV_CMD_INVENTORY      0x01U
+#define SIM_NFCV_CMD_STAY_QUIET     0x02U
+#define SIM_NFCV_CMD_READ_SINGLE    0x20U
+#define SIM_NFCV_CMD_WRITE_SINGLE   0x21U
+#define SIM_NFCV_CMD_READ_MULTIPLE  0x23U
+#define SIM_NFCV_CMD_SELECT         0x25U
+#define SIM_NFCV_CMD_RESET_TO_READY 0x26U
+#define SIM_NFCV_CMD_GET_SYS_INFO   0x2BU
+
+#define SIM_NFCV_ERR_NOT_SUPPORTED  0x01U
+#define SIM_NFCV_ERR_BLOCK_NA       0x10U
+
+#define SIM_NFCV_UID_LEN            8U
+#define SIM_NFCV_CRC_PRELOAD        0xFFFFU
+#define SIM_NFCV_FDT                4320U   /*!< ISO15693-3 t1 nominal [1/fc]                 */
+#define SIM_T5T_BLOCK_LEN           4U
+#define SIM_T5T_BLOCKS              64U
+#define SIM_T5T_IC_REF              0x24U
+#define SIM_T5T_MEM_LEN             (SIM_T5T_BLOCKS * SIM_T5T_BLOCK_LEN)
+#define SIM_T5T_NDEF_MAX            249U    /*!< 256 bytes: CC, TLV header, terminator        */
+
+#define SIM_TAG_MEM_MAX             ((SIM_T5T_MEM_LEN > SIM_T2T_MEM_LEN) ? SIM_T5T_MEM_LEN : SIM_T2T_MEM_LEN)
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Virtual tag types */
+typedef enum
+{
+    SIM_TAG_NFCA_T2T,
+    SIM_TAG_NFCA_T4T,
+    SIM_TAG_NFCV_T5T
+} simTagType;
+
+/*! Tag states (ISO14443-3 and ISO15693-3 merged) */
+typedef enum
+{
+    SIM_TAG_ST_IDLE,        /*!< NFC-A IDLE                          */
+    SIM_TAG_ST_READY,       /*!< NFC-A READY, NFC-V READY            */
+    SIM_TAG_ST_ACTIVE,      /*!< NFC-A ACTIVE                        */
+    SIM_TAG_ST_HALT,        /*!< NFC-A HALT                          */
+    SIM_TAG_ST_PROTOCOL,    /*!< NFC-A ISO14443-4 PROTOCOL           */
+    SIM_TAG_ST_QUIET,       /*!< NFC-V QUIET                         */
+    SIM_TAG_ST_SELECTED     /*!< NFC-V SELECTED                      */
+} simTagState;
+
+/*! T4T files */
+typedef enum
+{
+    SIM_T4T_FILE_NONE,
+    SIM_T4T_FILE_CC,
+    SIM_T4T_FILE_NDEF
+} simT4tFile;
+
+/*! ISO-DEP card state on top of the ISO14443-3 one */
+typedef struct
+{
+    uint8_t     br;                                 /*!< Bit rate agreed with PPS, 0: 106 */
+    uint8_t     maxBr;                              /*!< Highest bit rate offered in ATS  */
+    uint8_t     weakBr;                             /*!< Bit rate from which on responses break, 0: none */
+    bool        pay;                                /*!< Payment instead of NDEF application */
+    bool        ppsAllowed;                         /*!< ATS sent, no block received yet  */
+    uint8_t     bn;                                 /*!< Current block number             */
+    uint16_t    fsd;                                /*!< Reader frame size from RATS      */
+    uint8_t     fsci;                               /*!< Frame size of the ATS            */
+    uint16_t    mle;                                /*!< MLe of the CC                    */
+    bool        appSelected;
+    simT4tFile  file;
+    uint8_t     capdu[SIM_T4T_APDU_MAX];            /*!< C-APDU being received (chaining) */
+    uint16_t    capduLen;
+    uint8_t     rapdu[SIM_T4T_RAPDU_MAX];           /*!< R-APDU being sent (chaining)     */
+    uint16_t    rapduLen;
+    uint16_t    rapduPos;                           /*!< Start of the last block sent     */
+    uint16_t    rapduNext;                          /*!< Start of the next block          */
+    uint8_t     last[SIM_TAG_FRAME_MAX];            /*!< Last block sent, w/o CRC         */
+    uint16_t    lastLen;
+    uint8_t     ndef[SIM_T4T_NDEF_MAX + 2U];        /*!< NDEF file: NLEN and message      */
+    uint16_t    ndefLen;                            /*!< NDEF message length              */
+} simIsoDepCard;
+
+/*! Virtual tag */
+typedef struct
+{
+    bool        used;
+    simTagType  type;
+    char        uidStr[(SIM_UID_MAX * 2U) + 1U];    /*!< UID as given in the spec         */
+    uint8_t     uid[SIM_UID_MAX];                   /*!< UID in transmission order        */
+    uint8_t     uidLen;
+    simTagState state;
+    uint8_t     cascadeLevel;                       /*!< NFC-A: current cascade level     */
+    int8_t      invSlot;                            /*!< NFC-V: pending inventory slot    */
+    uint8_t     dsfid;
+    uint8_t     afi;
+    uint8_t     mem[SIM_TAG_MEM_MAX];
+    uint8_t     ant;                                /*!< Antenna whose field it is in     */
+    bool        near;                               /*!< Strongly coupled to the antenna  */
+    bool        noFast;                             /*!< NFC-A T2T: NAKs FAST_READ        */
+    uint64_t    addedNs;                            /*!< Entered the field at             */
+    bool        answered;                           /*!< Responded at least once          */
+    simIsoDepCard isoDep;                           /*!< NFC-A ISO-DEP cards              */
+} simTag;
+
+/*! Scripted tag event */
+typedef struct
+{
+    uint64_t atNs;
+    bool     add;
+    char     arg[128];
+} simTagEvent;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static simTag      gSimTags[SIM_TAGS_MAX];
+static simTagEvent gSimScript[SIM_TAGS_SCRIPT_MAX];
+static uint8_t     gSimScriptLen;
+static uint8_t     gSimScriptPos;
+static bool        gSimFieldOn[SIM_TAGS_ANTENNAS];
+static int8_t      gSimNfcvSlot[SIM_TAGS_ANTENNAS] = { -1, -1, -1, -1 };  /*!< Current 16 slot inventory slot, -1: none */
+static simTagsStats gSimStats;
+static uint8_t     gSimDrive[SIM_TAGS_ANTENNAS];                          /*!< RFO driver resistance of each reader  */
+static const uint16_t gSimFsxiToFsx[] = { 16, 24, 32, 40, 48, 64, 96, 128, 256, 512, 1024, 2048, 4096 };  /*!< FSDI/FSCI to FSD/FSC */
+
+/*
+******************************************************************************
+* LOCAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+static bool    simTagsAddAt( const char *spec, uint64_t atNs );
+static void    simTagPowerUp( simTag *tag );
+static bool    simParseHex( const char *str, uint8_t *out, uint8_t maxLen, uint8_t *outLen );
+static uint8_t simNfcaCascadeLevels( const simTag *tag );
+static void    simNfcaCascadeData( const simTag *tag, uint8_t level, uint8_t *cl );
+static bool    simNfcaExchange( simTag *tag, const uint8_t *req, uint16_t reqBits, simTagFrame *rsp );
+static bool    simIsoDepExchange( simTag *tag, const uint8_t *req, uint16_t reqLen, simTagFrame *rsp );
+static void    simIsoDepSendBlock( simTag *tag, simTagFrame *rsp );
+static void    simT4tApdu( simTag *tag );
+static void    simT4tInit( simTag *tag );
+static void    simNdefText( const simTag *tag, uint8_t *m, uint16_t len );
+static int8_t  simParseBr( const char *spec, const char *opt, int8_t def );
+static bool    simNfcvExchange( simTag *tag, const uint8_t *req, uint16_t reqLen, simTagFrame *rsp );
+static void    simNfcvInventoryRes( const simTag *tag, simTagFrame *rsp );
+static void    simSetCrc( simTagFrame *rsp, uint16_t len, bool nfcv );
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+bool simTagsAdd( const char *spec )
+{
+    return simTagsAddAt( spec, simClockNowNs() );
+}
+
+
+/*******************************************************************************/
+bool simTagsRemove( const char *uid )
+{
+    bool    removed;
+    uint8_t i;
+
+    removed = false;
+    for( i = 0; i < SIM_TAGS_MAX; i++ )
+    {
+        if( gSimTags[i].used && ((strcmp( uid, "all" ) == 0) || (strcasecmp( uid, gSimTags[i].uidStr ) == 0)) )
+        {
+            gSimTags[i].used = false;
+            removed          = true;
+        }
+    }
+
+    return removed;
+}
+
+
+/*******************************************************************************/
+uint8_t simTagsCount( uint8_t ant )
+{
+    uint8_t i;
+    uint8_t cnt;
+
+    cnt = 0;
+    for( i = 0; i < SIM_TAGS_MAX; i++ )
+    {
+        if( gSimTags[i].used && (gSimTags[i].ant == ant) )
+        {
+            cnt++;
+        }
+    }
+
+    return cnt;
+}
+
+
+/*******************************************************************************/
+uint8_t simTagsNearCount( uint8_t ant )
+{
+    uint8_t i;
+    uint8_t cnt;
+
+    cnt = 0;
+    for( i = 0; i < SIM_TAGS_MAX; i++ )
+    {
+        if( gSimTags[i].used && gSimTags[i].near && (gSimTags[i].ant == ant) )
+        {
+            cnt++;
+        }
+    }
+
+    return cnt;
+}
+
+
+/*******************************************************************************/
+void simTagsSetDrive( uint8_t ant, uint8_t rfo )
+{
+    gSimDrive[ant] = rfo;
+}
+
+
+/*******************************************************************************/
+bool simTagsLoadScript( const char *path )
+{
+    FILE        *f;
+    char         line[128];
+    char         action[16];
+    unsigned long timeMs;
+    int          argPos;
+    simTagEvent *ev;
+
+    f = fopen( path, "r" );
+    if( f == NULL )
+    {
+        return false;
+    }
+
+    while( (fgets( line, sizeof(line), f ) != NULL) && (gSimScriptLen < SIM_TAGS_SCRIPT_MAX) )
+    {
+        line[strcspn( line, "\r\n" )] = '\0';
+        if( (line[0] == '#') || (line[0] == '\0') )
+        {
+            continue;
+        }
+
+        if( sscanf( line, "%lu %15s %n", &timeMs, action, &argPos ) < 2 )
+        {
+            fprintf( stderr, "script: ignoring '%s'\n", line );
+            continue;
+        }
+
+        ev       = &gSimScript[gSimScriptLen];
+        ev->atNs = (uint64_t)timeMs * 1000000ULL;
+        ev->add  = (strcmp( action, "add" ) == 0);
+        snprintf( ev->arg, sizeof(ev->arg), "%s", &line[argPos] );
+        gSimScriptLen++;
+    }
+
+    fclose( f );
+    return true;
+}
+
+
+/*******************************************************************************/
+void simTagsRunScript( uint64_t nowNs )
+{
+    const simTagEvent *ev;
+
+    while( (gSimScriptPos < gSimScriptLen) && (gSimScript[gSimScriptPos].atNs <= nowNs) )
+    {
+        ev = &gSimScript[gSimScriptPos++];
+        if( ev->add ? !simTagsAddAt( ev->arg, ev->atNs ) : !simTagsRemove( ev->arg ) )
+        {
+            fprintf( stderr, "script: '%s %s' failed\n", (ev->add ? "add" : "remove"), ev->arg );
+        }
+    }
+}
+
+
+/*******************************************************************************/
+void simTagsField( uint8_t ant, bool on )
+{
+    uint8_t i;
+
+    if( on == gSimFieldOn[ant] )
+    {
+        return;
+    }
+
+    gSimFieldOn[ant]  = on;
+    gSimNfcvSlot[ant] = -1;
+
+    /* Tags are field powered: any transition is a power cycle */
+    for( i = 0; i < SIM_TAGS_MAX; i++ )
+    {
+        if( gSimTags[i].ant == ant )
+        {
+            simTagPowerUp( &gSimTags[i] );
+        }
+    }
+}
+
+
+/*******************************************************************************/
+uint8_t simTagsExchange( uint8_t ant, simRfTech tech, uint8_t br, const uint8_t *req, uint16_t reqBits, simTagFrame *rsp, uint8_t maxRsp )
+{
+    uint8_t i;
+    uint8_t cnt;
+    bool    eof;
+
+    cnt = 0;
+    eof = ((tech == SIM_RF_TECH_NFCV) && (reqBits == 0U));
+
+    /* NFC-V: an EOF only frame moves to the next inventory slot, anything else ends the round */
+    if( tech == SIM_RF_TECH_NFCV )
+    {
+        gSimNfcvSlot[ant] = (eof && (gSimNfcvSlot[ant] >= 0)) ? (int8_t)(gSimNfcvSlot[ant] + 1) : -1;
+    }
+
+    for( i = 0; i < SIM_TAGS_MAX; i++ )
+    {
+        simTag *tag = &gSimTags[i];
+        bool    res = false;
+
+        if( !tag->used || (tag->ant != ant) || (cnt >= maxRsp) )
+        {
+            continue;
+        }
+
+        memset( &rsp[cnt], 0x00, sizeof(simTagFrame) );
+
+        if( (tech == SIM_RF_TECH_NFCA) && ((tag->type == SIM_TAG_NFCA_T2T) || ((tag->type == SIM_TAG_NFCA_T4T) && (br == tag->isoDep.br))) )
+        {
+            res = simNfcaExchange( tag, req, reqBits, &rsp[cnt] );
+        }
+        else if( (tech == SIM_RF_TECH_NFCV) && (tag->type == SIM_TAG_NFCV_T5T) )
+        {
+            if( eof )
+            {
+                if( (gSimNfcvSlot[ant] >= 0) && (tag->invSlot == gSimNfcvSlot[ant]) )
+                {
+                    simNfcvInventoryRes( tag, &rsp[cnt] );
+                    res = true;
+                }
+            }
+            else
+            {
+                tag->invSlot = -1;
+                res = simNfcvExchange( tag, req, (uint16_t)(reqBits / 8U), &rsp[cnt] );
+            }
+        }
+        else
+        {
+            /* Technology not supported by this tag: not modulating */
+        }
+
+        if( res && tag->near && (gSimDrive[ant] < SIM_TAG_NEAR_RFO_MIN) && (rsp[cnt].nBits >= 24U) )
+        {
+            /* Overloaded: the tag's load modulation is distorted, the end of the frame (CRC, BCC) is received wrong */
+            rsp[cnt].data[(rsp[cnt].bitOffset + rsp[cnt].nBits - 1U) / 8U] ^= 0x01U;
+            gSimStats.overloaded++;
+        }
+
+        if( res && (tag->isoDep.weakBr != 0U) && (br >= tag->isoDep.weakBr) && (rsp[cnt].nBits >= 24U) )
+        {
+            /* Too far to hold this bit rate: the response is received with a broken CRC */
+            rsp[cnt].data[(rsp[cnt].bitOffset + rsp[cnt].nBits - 1U) / 8U] ^= 0x01U;
+            gSimStats.rateErrors++;
+        }
+
+        if( res )
+        {
+            cnt++;
+
+            if( !tag->answered )
+            {
+                tag->answered = true;
+                gSimStats.detected++;
+                gSimStats.latencyTotalNs += (simClockNowNs() - tag->addedNs);
+                gSimStats.latencyMaxNs    = (((simClockNowNs() - tag->addedNs) > gSimStats.latencyMaxNs) ? (simClockNowNs() - tag->addedNs) : gSimStats.latencyMaxNs);
+            }
+        }
+    }
+
+    /* Anticollision cost: SDD (SEL with NVB below 0x70), inventory requests and slots */
+    if( (tech == SIM_RF_TECH_NFCA) && (reqBits >= 16U) && (req[0] >= SIM_NFCA_CMD_SEL_CL1) && (req[0] <= SIM_NFCA_CMD_SEL_CL3)
+        && ((req[0] & 0x01U) != 0U) && (req[1] < SIM_NFCA_NVB_SELECT) )
+    {
+        gSimStats.anticollFrames++;
+    }
+    else if( (tech == SIM_RF_TECH_NFCV) && (eof || ((reqBits >= 16U) && ((req[0] & SIM_NFCV_FLAG_INVENTORY) != 0U) && (req[1] == SIM_NFCV_CMD_INVENTORY))) )
+    {
+        gSimStats.anticollFrames++;
+    }
+    else
+    {
+        /* Not an anticollision frame */
+    }
+    gSimStats.collisions += ((cnt > 1U) ? 1U : 0U);
+
+    /* Inventory with 16 slots started */
+    if( (tech == SIM_RF_TECH_NFCV) && !eof && (reqBits >= 16U) && ((req[0] & SIM_NFCV_FLAG_INVENTORY) != 0U)
+        && ((req[0] & SIM_NFCV_FLAG_1_SLOT) == 0U) && (req[1] == SIM_NFCV_CMD_INVENTORY) )
+    {
+        gSimNfcvSlot[ant] = 0;
+    }
+
+    return cnt;
+}
+
+
+/*******************************************************************************/
+const simTagsStats* simTagsGetStats( void )
+{
+    return &gSimStats;
+}
+
+
+/*******************************************************************************/
+uint16_t simCrc16( uint16_t preload, const uint8_t *buf, uint16_t len )
+{
+    uint16_t crc;
+    uint16_t i;
+    uint8_t  b;
+
+    crc = preload;
+    for( i = 0; i < len; i++ )
+    {
+        crc ^= buf[i];
+        for( b = 0; b < 8U; b++ )
+        {
+            crc = (uint16_t)(((crc & 0x0001U) != 0U) ? ((crc >> 1) ^ 0x8408U) : (crc >> 1));
+        }
+    }
+
+    return crc;
+}
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static bool simTagsAddAt( const char *spec, uint64_t atNs )
+{
+    char        type[16];
+    const char *uidArg;
+    const char *antArg;
+    simTag     *tag;
+    uint8_t     i;
+
+    if( sscanf( spec, "%15s", type ) != 1 )
+    {
+        return false;
+    }
+
+    tag = NULL;
+    for( i = 0; i < SIM_TAGS_MAX; i++ )
+    {
+        if( !gSimTags[i].used )
+        {
+            tag = &gSimTags[i];
+            break;
+        }
+    }
+    if( tag == NULL )
+    {
+        return false;
+    }
+
+    memset( tag, 0x00, sizeof(simTag) );
+
+    if( strcmp( type, "nfca-t2t" ) == 0 )
+    {
+        tag->type = SIM_TAG_NFCA_T2T;
+        strcpy( tag->uidStr, "04A1B2C3D4E5F6" );
+    }
+    else if( strcmp( type, "nfca-t4t" ) == 0 )
+    {
+        tag->type = SIM_TAG_NFCA_T4T;
+        strcpy( tag->uidStr, "04A1B2C3D4E5F6" );
+    }
+    else if( strcmp( type, "nfcv-t5t" ) == 0 )
+    {
+        tag->type = SIM_TAG_NFCV_T5T;
+        strcpy( tag->uidStr, "E002080412345678" );
+    }
+    else
+    {
+        return false;
+    }
+
+    uidArg = strstr( spec, "uid=" );
+    if( uidArg != NULL )
+    {
+        sscanf( &uidArg[4], "%20[0-9a-fA-F]", tag->uidStr );
+    }
+    if( !simParseHex( tag->uidStr, tag->uid, SIM_UID_MAX, &tag->uidLen ) )
+    {
+        return false;
+    }
+
+    antArg = strstr( spec, "ant=" );
+    if( antArg != NULL )
+    {
+        tag->ant = (uint8_t)strtoul( &antArg[4], NULL, 10 );
+        if( tag->ant >= SIM_TAGS_ANTENNAS )
+        {
+            return false;
+        }
+    }
+
+    tag->near = (strstr( spec, " near" ) != NULL);
+
+    if( tag->type == SIM_TAG_NFCA_T4T )
+    {
+        const char    *ndefArg;
+        const char    *fscArg;
+        const char    *mleArg;
+        unsigned long  ndefLen;
+        unsigned long  fsc;
+        unsigned long  mle;
+
+        if( (tag->uidLen != 4U) && (tag->uidLen != 7U) && (tag->uidLen != 10U) )
+        {
+            return false;
+        }
+
+        ndefArg               = strstr( spec, "ndef=" );
+        ndefLen               = ((ndefArg != NULL) ? strtoul( &ndefArg[5], NULL, 10 ) : SIM_T4T_NDEF_DEFAULT);
+        fscArg                = strstr( spec, "fsc=" );
+        fsc                   = ((fscArg != NULL) ? strtoul( &fscArg[4], NULL, 10 ) : SIM_ISODEP_FSC_DEFAULT);
+        mleArg                = strstr( spec, "mle=" );
+        mle                   = ((mleArg != NULL) ? strtoul( &mleArg[4], NULL, 10 ) : SIM_T4T_MLE);
+        tag->isoDep.pay       = (strstr( spec, " pay" ) != NULL);
+        tag->isoDep.maxBr     = (uint8_t)simParseBr( spec, "maxbr=", 3 );
+        tag->isoDep.weakBr    = (uint8_t)simParseBr( spec, "weak=", 0 );
+        if( (ndefLen < SIM_T4T_NDEF_MIN) || (ndefLen > SIM_T4T_NDEF_MAX) || (mle < SIM_T4T_MLE_MIN) || (mle > SIM_T4T_MLE_MAX)
+            || (tag->isoDep.maxBr > 3U) || (tag->isoDep.weakBr > 3U) )
+        {
+            return false;
+        }
+        tag->isoDep.ndefLen = (uint16_t)ndefLen;
+        tag->isoDep.mle     = (uint16_t)mle;
+
+        for( tag->isoDep.fsci = 0; (tag->isoDep.fsci < (sizeof(gSimFsxiToFsx) / sizeof(gSimFsxiToFsx[0]))) && (gSimFsxiToFsx[tag->isoDep.fsci] != fsc); tag->isoDep.fsci++ )
+        {
+            /* FSCI of the frame size given */
+        }
+        if( tag->isoDep.fsci >= (sizeof(gSimFsxiToFsx) / sizeof(gSimFsxiToFsx[0])) )
+        {
+            return false;
+        }
+        simT4tInit( tag );
+    }
+    else if( tag->type == SIM_TAG_NFCA_T2T )
+    {
+        const char    *ndefArg;
+        unsigned long  ndefLen;
+
+        ndefArg     = strstr( spec, "ndef=" );
+        ndefLen     = ((ndefArg != NULL) ? strtoul( &ndefArg[5], NULL, 10 ) : 0U);
+        tag->noFast = (strstr( spec, " nofast" ) != NULL);
+        if( ((tag->uidLen != 4U) && (tag->uidLen != 7U) && (tag->uidLen != 10U)) || ((ndefLen != 0U) && ((ndefLen < SIM_T4T_NDEF_MIN) || (ndefLen > SIM_T2T_NDEF_MAX))) )
+        {
+            return false;
+        }
+
+        /* UID/BCC pages as laid out by a 7 byte UID NTAG, CC for 144 bytes and an NDEF TLV, empty by default */
+        memcpy( &tag->mem[0], tag->uid, 3 );
+        tag->mem[3]  = (uint8_t)(SIM_NFCA_CT ^ tag->uid[0] ^ tag->uid[1] ^ tag->uid[2]);
+        memcpy( &tag->mem[4], &tag->uid[3], (tag->uidLen > 4U) ? 4U : 1U );
+        tag->mem[8]  = (uint8_t)(tag->mem[4] ^ tag->mem[5] ^ tag->mem[6] ^ tag->mem[7]);
+        tag->mem[12] = 0xE1U;
+        tag->mem[13] = 0x10U;
+        tag->mem[14] = 0x12U;
+        tag->mem[16] = 0x03U;
+        tag->mem[17] = (uint8_t)ndefLen;
+        simNdefText( tag, &tag->mem[18], (uint16_t)ndefLen );
+        tag->mem[18U + ndefLen] = 0xFEU;
+    }
+    else
+    {
+        uint8_t        tmp[SIM_NFCV_UID_LEN];
+        const char    *ndefArg;
+        unsigned long  ndefLen;
+
+        ndefArg = strstr( spec, "ndef=" );
+        ndefLen = ((ndefArg != NULL) ? strtoul( &ndefArg[5], NULL, 10 ) : 0U);
+        if( (tag->uidLen != SIM_NFCV_UID_LEN) || ((ndefLen != 0U) && ((ndefLen < SIM_T4T_NDEF_MIN) || (ndefLen > SIM_T5T_NDEF_MAX))) )
+        {
+            return false;
+        }
+
+        /* Given MSB first, kept LSB first as transmitted */
+        memcpy( tmp, tag->uid, SIM_NFCV_UID_LEN );
+        for( i = 0; i < SIM_NFCV_UID_LEN; i++ )
+        {
+            tag->uid[i] = tmp[SIM_NFCV_UID_LEN - 1U - i];
+        }
+
+        /* CC for 256 bytes with MBREAD and an NDEF TLV, empty by default */
+        tag->mem[0] = 0xE1U;
+        tag->mem[1] = 0x40U;
+        tag->mem[2] = (uint8_t)(SIM_T5T_MEM_LEN / 8U);
+        tag->mem[3] = 0x01U;
+        tag->mem[4] = 0x03U;
+        tag->mem[5] = (uint8_t)ndefLen;
+        simNdefText( tag, &tag->mem[6], (uint16_t)ndefLen );
+        tag->mem[6U + ndefLen] = 0xFEU;
+    }
+
+    tag->used    = true;
+    tag->addedNs = atNs;
+    simTagPowerUp( tag );
+
+    return true;
+}
+
+
+/*******************************************************************************/
+static void simTagPowerUp( simTag *tag )
+{
+    tag->state        = ((tag->type == SIM_TAG_NFCV_T5T) ? SIM_TAG_ST_READY : SIM_TAG_ST_IDLE);
+    tag->cascadeLevel = 0;
+    tag->invSlot      = -1;
+
+    tag->isoDep.br          = 0;
+    tag->isoDep.ppsAllowed  = false;
+    tag->isoDep.appSelected = false;
+    tag->isoDep.file        = SIM_T4T_FILE_NONE;
+    tag->isoDep.capduLen    = 0;
+    tag->isoDep.rapduLen    = 0;
+    tag->isoDep.rapduPos    = 0;
+    tag->isoDep.rapduNext   = 0;
+    tag->isoDep.lastLen     = 0;
+}
+
+
+/*******************************************************************************/
+static bool simParseHex( const char *str, uint8_t *out, uint8_t maxLen, uint8_t *outLen )
+{
+    size_t  len;
+    uint8_t i;
+    char    byteStr[3];
+
+    len = strlen( str );
+    if( ((len % 2U) != 0U) || (len == 0U) || ((len / 2U) > maxLen) )
+    {
+        return false;
+    }
+
+    byteStr[2] = '\0';
+    for( i = 0; i < (len / 2U); i++ )
+    {
+        if( !isxdigit( (unsigned char)str[2U * i] ) || !isxdigit( (unsigned char)str[(2U * i) + 1U] ) )
+        {
+            return false;
+        }
+        byteStr[0] = str[2U * i];
+        byteStr[1] = str[(2U * i) + 1U];
+        out[i]     = (uint8_t)strtoul( byteStr, NULL, 16 );
+    }
+
+    *outLen = (uint8_t)(len / 2U);
+    return true;
+}
+
+
+/*******************************************************************************/
+static uint8_t simNfcaCascadeLevels( const simTag *tag )
+{
+    return (uint8_t)((tag->uidLen == 4U) ? 1U : ((tag->uidLen == 7U) ? 2U : 3U));
+}
+
+
+/*******************************************************************************/
+static void simNfcaCascadeData( const simTag *tag, uint8_t level, uint8_t *cl )
+{
+    uint8_t levels;
+    uint8_t pos;
+
+    levels = simNfcaCascadeLevels( tag );
+    pos    = (uint8_t)(level * 3U);
+
+    /* All but the last level carry CT + 3 UID bytes, the last one 4 UID bytes */
+    if( level < (levels - 1U) )
+    {
+        cl[0] = SIM_NFCA_CT;
+        memcpy( &cl[1], &tag->uid[pos], 3 );
+    }
+    else
+    {
+        memcpy( cl, &tag->uid[pos], 4 );
+    }
+    cl[4] = (uint8_t)(cl[0] ^ cl[1] ^ cl[2] ^ cl[3]);
+}
+
+
+/*******************************************************************************/
+static bool simNfcaExchange( simTag *tag, const uint8_t *req, uint16_t reqBits, simTagFrame *rsp )
+{
+    uint8_t  cl[5];
+    uint16_t knownBits;
+    uint16_t reqLen;
+    uint16_t i;
+    uint8_t  page;
+
+    rsp->fdtFc = ((((req[(reqBits - 1U) / 8U] >> ((reqBits - 1U) % 8U)) & 0x01U) != 0U) ? SIM_NFCA_FDT_LAST_BIT_1 : SIM_NFCA_FDT_LAST_BIT_0);
+    reqLen     = (uint16_t)(reqBits / 8U);
+
+    /* Short frames: REQA / WUPA */
+    if( reqBits == 7U )
+    {
+        if( tag->state == SIM_TAG_ST_PROTOCOL )
+        {
+            return false;
+        }
+        if( (req[0] == SIM_NFCA_CMD_WUPA) || ((req[0] == SIM_NFCA_CMD_REQA) && (tag->state != SIM_TAG_ST_HALT)) )
+        {
+            tag->state        = SIM_TAG_ST_READY;
+            tag->cascadeLevel = 0;
+
+            rsp->data[0] = ((tag->uidLen == 4U) ? 0x04U : ((tag->uidLen == 7U) ? 0x44U : 0x84U));
+            rsp->data[1] = 0x00U;
+            rsp->nBits   = 16;
+            return true;
+        }
+        return false;
+    }
+
+    if( reqBits < 16U )
+    {
+        return false;
+    }
+
+    /* Anticollision / Select */
+    if( (req[0] >= SIM_NFCA_CMD_SEL_CL1) && (req[0] <= SIM_NFCA_CMD_SEL_CL3) && ((req[0] & 0x01U) != 0U) )
+    {
+        if( (tag->state != SIM_TAG_ST_READY) || (((req[0] - SIM_NFCA_CMD_SEL_CL1) / 2U) != tag->cascadeLevel) )
+        {
+            return false;
+        }
+
+        simNfcaCascadeData( tag, tag->cascadeLevel, cl );
+
+        if( req[1] == SIM_NFCA_NVB_SELECT )
+        {
+            if( (reqBits != 72U) || (simCrc16( SIM_NFCA_CRC_PRELOAD, req, 9 ) != 0U) )
+            {
+                return false;
+            }
+            if( memcmp( &req[2], cl, sizeof(cl) ) != 0 )
+            {
+                tag->state = SIM_TAG_ST_IDLE;
+                return false;
+            }
+
+            if( (tag->cascadeLevel + 1U) < simNfcaCascadeLevels( tag ) )
+            {
+                tag->cascadeLevel++;
+                rsp->data[0] = SIM_NFCA_SAK_CASCADE;
+            }
+            else
+            {
+                tag->state   = SIM_TAG_ST_ACTIVE;
+                rsp->data[0] = ((tag->type == SIM_TAG_NFCA_T4T) ? SIM_NFCA_SAK_ISODEP : 0x00U);
+            }
+            simSetCrc( rsp, 1, false );
+            return true;
+        }
+
+        /* Compare the known part of the UID bit by bit and send the rest */
+        knownBits = (uint16_t)(reqBits - 16U);
+        if( knownBits >= 40U )
+        {
+            return false;
+        }
+        for( i = 0; i < knownBits; i++ )
+        {
+            if( (((req[2U + (i / 8U)] >> (i % 8U)) ^ (cl[i / 8U] >> (i % 8U))) & 0x01U) != 0U )
+            {
+                return false;
+            }
+        }
+
+        memcpy( rsp->data, &cl[knownBits / 8U], (size_t)(5U - (knownBits / 8U)) );
+        rsp->bitOffset = (uint8_t)(knownBits % 8U);
+        rsp->data[0]  &= (uint8_t)(0xFFU << rsp->bitOffset);
+        rsp->nBits     = (uint16_t)(40U - knownBits);
+        return true;
+    }
+
+    /* All remaining commands carry a CRC_A */
+    if( (reqLen < 3U) || ((reqBits % 8U) != 0U) || (simCrc16( SIM_NFCA_CRC_PRELOAD, req, reqLen ) != 0U) )
+    {
+        return false;
+    }
+
+    if( tag->type == SIM_TAG_NFCA_T4T )
+    {
+        return simIsoDepExchange( tag, req, (uint16_t)(reqLen - 2U), rsp );
+    }
+
+    if( tag->state != SIM_TAG_ST_ACTIVE )
+    {
+        return false;
+    }
+
+    switch( req[0] )
+    {
+        case SIM_NFCA_CMD_HLTA:
+            tag->state = SIM_TAG_ST_HALT;
+            return false;
+
+        case SIM_T2T_CMD_READ:
+            if( req[1] < SIM_T2T_PAGES )
+            {
+                for( i = 0; i < SIM_T2T_READ_LEN; i++ )
+                {
+                    rsp->data[i] = tag->mem[((req[1] * SIM_T2T_PAGE_LEN) + i) % SIM_T2T_MEM_LEN];
+                }
+                simSetCrc( rsp, SIM_T2T_READ_LEN, false );
+                return true;
+            }
+            break;
+
+        case SIM_T2T_CMD_FAST_READ:
+            if( !tag->noFast && (reqLen == 5U) && (req[1] <= req[2]) && (req[2] < SIM_T2T_PAGES) )
+            {
+                reqLen = (uint16_t)(((req[2] - req[1]) + 1U) * SIM_T2T_PAGE_LEN);
+                memcpy( rsp->data, &tag->mem[req[1] * SIM_T2T_PAGE_LEN], reqLen );
+                simSetCrc( rsp, reqLen, false );
+                return true;
+            }
+            break;
+
+        case SIM_T2T_CMD_WRITE:
+            page = req[1];
+            if( (reqLen == 8U) && (page >= 2U) && (page < SIM_T2T_PAGES) )
+            {
+                memcpy( &tag->mem[page * SIM_T2T_PAGE_LEN], &req[2], SIM_T2T_PAGE_LEN );
+                rsp->data[0] = SIM_T2T_ACK;
+                rsp->nBits   = 4;
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    /* Invalid command/argument: NAK and back to IDLE */
+    tag->state   = SIM_TAG_ST_IDLE;
+    rsp->data[0] = SIM_T2T_NAK;
+    rsp->nBits   = 4;
+    return true;
+}
+
+
+/*******************************************************************************/
+static bool simIsoDepExchange( simTag *tag, const uint8_t *req, uint16_t reqLen, simTagFrame *rsp )
+{
+    static const uint8_t  maxBrToTa[] = { 0x00U, 0x11U, 0x33U, 0x77U };     /* Same divisor in both directions not required */
+    simIsoDepCard *card;
+    uint8_t        pcb;
+    uint8_t        dsi;
+    uint8_t        dri;
+    uint16_t       infLen;
+
+    card = &tag->isoDep;
+
+    /*******************************************************************************/
+    if( tag->state == SIM_TAG_ST_ACTIVE )
+    {
+        if( (reqLen == 2U) && (req[0] == SIM_NFCA_CMD_HLTA) )
+        {
+            tag->state = SIM_TAG_ST_HALT;
+        }
+        else if( (reqLen == 2U) && (req[0] == SIM_ISODEP_CMD_RATS) )
+        {
+            card->fsd        = gSimFsxiToFsx[((req[1] >> 4) < 12U) ? (req[1] >> 4) : 12U];    /* RFU values: 4096 */
+            card->bn         = 1U;
+            card->ppsAllowed = true;
+            tag->state       = SIM_TAG_ST_PROTOCOL;
+
+            rsp->data[0] = 0x05U;                                         /* TL                     */
+            rsp->data[1] = (uint8_t)(0x70U | card->fsci);                 /* T0: TA, TB, TC present */
+            rsp->data[2] = maxBrToTa[card->maxBr];
+            rsp->data[3] = SIM_ISODEP_ATS_TB;
+            rsp->data[4] = 0x00U;                                         /* TC: no CID, no NAD     */
+            simSetCrc( rsp, 5, false );
+            return true;
+        }
+        else
+        {
+            /* Not an ISO14443-3 command of an ISO-DEP card */
+        }
+        return false;
+    }
+
+    if( (tag->state != SIM_TAG_ST_PROTOCOL) || (reqLen == 0U) )
+    {
+        return false;
+    }
+
+    pcb = req[0];
+
+    /*******************************************************************************/
+    if( card->ppsAllowed && ((pcb & 0xF0U) == SIM_ISODEP_PPS_SB) )
+    {
+        card->ppsAllowed = false;
+
+        dsi = (uint8_t)((req[2] >> 2) & 0x03U);
+        dri = (uint8_t)(req[2] & 0x03U);
+        if( (reqLen != 3U) || (req[1] != SIM_ISODEP_PPS0) || (dsi != dri) || (dri > card->maxBr) )
+        {
+            return false;
+        }
+
+        /* The response is still sent at 106, the new bit rate applies from the next frame on */
+        rsp->data[0] = pcb;
+        simSetCrc( rsp, 1, false );
+        card->br     = dri;
+        return true;
+    }
+    card->ppsAllowed = false;
+
+    /*******************************************************************************/
+    if( (reqLen == 1U) && (pcb == SIM_ISODEP_PCB_DESELECT) )
+    {
+        rsp->data[0] = pcb;
+        simSetCrc( rsp, 1, false );
+        tag->state = SIM_TAG_ST_HALT;
+        card->br   = 0;
+        return true;
+    }
+
+    /*******************************************************************************/
+    if( (pcb & SIM_ISODEP_PCB_I_MASK) == SIM_ISODEP_PCB_I )
+    {
+        if( (pcb & SIM_ISODEP_PCB_CID_NAD) != 0U )
+        {
+            return false;
+        }
+
+        card->bn = (uint8_t)(pcb & SIM_ISODEP_PCB_BN);
+        infLen   = (uint16_t)(reqLen - 1U);
+        if( (card->capduLen + infLen) <= SIM_T4T_APDU_MAX )
+        {
+            memcpy( &card->capdu[card->capduLen], &req[1], infLen );
+        }
+        card->capduLen = (uint16_t)(card->capduLen + infLen);
+
+        if( (pcb & SIM_ISODEP_PCB_CHAINING) != 0U )
+        {
+            card->last[0] = (uint8_t)(SIM_ISODEP_PCB_R | card->bn);      /* R(ACK): next block */
+            card->lastLen = 1U;
+        }
+        else
+        {
+            simT4tApdu( tag );
+            card->capduLen  = 0;
+            card->rapduNext = 0;
+            simIsoDepSendBlock( tag, rsp );
+            rsp->fdtFc += SIM_ISODEP_FDT_APDU;
+            return true;
+        }
+    }
+    /*******************************************************************************/
+    else if( (pcb & SIM_ISODEP_PCB_R_MASK) == SIM_ISODEP_PCB_R )
+    {
+        if( (pcb & SIM_ISODEP_PCB_BN) == card->bn )
+        {
+            /* Last block lost on the reader side: sent again as is */
+            if( card->lastLen == 0U )
+            {
+                return false;
+            }
+        }
+        else if( (pcb & SIM_ISODEP_PCB_CHAINING) != 0U )
+        {
+            card->last[0] = (uint8_t)(SIM_ISODEP_PCB_R | card->bn);      /* R(NAK) of another block: R(ACK) */
+            card->lastLen = 1U;
+        }
+        else if( card->rapduNext < card->rapduLen )
+        {
+            card->bn ^= SIM_ISODEP_PCB_BN;                               /* R(ACK): next chained block */
+            simIsoDepSendBlock( tag, rsp );
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    {
+        /* WTX response, CID/NAD blocks: not used by this card */
+        return false;
+    }
+
+    memcpy( rsp->data, card->last, card->lastLen );
+    simSetCrc( rsp, card->lastLen, false );
+    return true;
+}
+
+
+/*******************************************************************************/
+static void simIsoDepSendBlock( simTag *tag, simTagFrame *rsp )
+{
+    simIsoDepCard *card;
+    uint16_t       maxInf;
+    uint16_t       len;
+
+    card   = &tag->isoDep;
+    maxInf = (uint16_t)(((card->fsd < SIM_TAG_FRAME_MAX) ? card->fsd : SIM_TAG_FRAME_MAX) - 3U);    /* PCB and CRC */
+    len    = (uint16_t)(card->rapduLen - card->rapduNext);
+    len    = ((len > maxInf) ? maxInf : len);
+
+    card->last[0] = (uint8_t)(SIM_ISODEP_PCB_I | card->bn | (((card->rapduNext + len) < card->rapduLen) ? SIM_ISODEP_PCB_CHAINING : 0U));
+    memcpy( &card->last[1], &card->rapdu[card->rapduNext], len );
+    card->lastLen   = (uint16_t)(len + 1U);
+    card->rapduPos  = card->rapduNext;
+    card->rapduNext = (uint16_t)(card->rapduNext + len);
+
+    memcpy( rsp->data, card->last, card->lastLen );
+    simSetCrc( rsp, card->lastLen, false );
+}
+
+
+/*******************************************************************************/
+static void simT4tApdu( simTag *tag )
+{
+    static const uint8_t ndefAid[] = { 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01 };
+    static const uint8_t ppse[]    = "2PAY.SYS.DDF01";
+    simIsoDepCard  *card;
+    const uint8_t  *c;
+    uint8_t        *r;
+    uint8_t         cc[SIM_T4T_CC_LEN];
+    const uint8_t  *file;
+    uint16_t        fileLen;
+    uint16_t        offset;
+    uint32_t        le;
+    uint16_t        len;
+    uint16_t        sw;
+
+    card = &tag->isoDep;
+    c    = card->capdu;
+    r    = card->rapdu;
+    len  = 0;
+    sw   = 0x6D00U;                                                       /* INS not supported      */
+
+    if( (card->capduLen < 4U) || (card->capduLen > SIM_T4T_APDU_MAX) )
+    {
+        sw = 0x6700U;
+    }
+    /*******************************************************************************/
+    else if( (c[1] == SIM_T4T_INS_SELECT) && (c[2] == 0x04U) && (card->capduLen >= 5U) && (card->capduLen >= (5U + c[4])) )
+    {
+        card->appSelected = false;
+        card->file        = SIM_T4T_FILE_NONE;
+        sw                = 0x6A82U;                                      /* Not found              */
+
+        if( !card->pay && (c[4] == sizeof(ndefAid)) && (memcmp( &c[5], ndefAid, sizeof(ndefAid) ) == 0) )
+        {
+            card->appSelected = true;
+            sw                = 0x9000U;
+        }
+        else if( card->pay && (c[4] == (sizeof(ppse) - 1U)) && (memcmp( &c[5], ppse, (sizeof(ppse) - 1U) ) == 0) )
+        {
+            /* FCI: DF name and one application (Visa credit) */
+            r[len++] = 0x6FU;  r[len++] = 0x23U;
+            r[len++] = 0x84U;  r[len++] = (uint8_t)(sizeof(ppse) - 1U);
+            memcpy( &r[len], ppse, (sizeof(ppse) - 1U) );
+            len = (uint16_t)(len + (sizeof(ppse) - 1U));
+            r[len++] = 0xA5U;  r[len++] = 0x11U;
+            r[len++] = 0xBFU;  r[len++] = 0x0CU;  r[len++] = 0x0EU;
+            r[len++] = 0x61U;  r[len++] = 0x0CU;
+            r[len++] = 0x4FU;  r[len++] = 0x07U;
+            r[len++] = 0xA0U;  r[len++] = 0x00U;  r[len++] = 0x00U;  r[len++] = 0x00U;  r[len++] = 0x03U;  r[len++] = 0x10U;  r[len++] = 0x10U;
+            r[len++] = 0x87U;  r[len++] = 0x01U;  r[len++] = 0x01U;
+            card->appSelected = true;
+            sw                = 0x9000U;
+        }
+        else
+        {
+            /* Unknown application */
+        }
+    }
+    /*******************************************************************************/
+    else if( (c[1] == SIM_T4T_INS_SELECT) && (c[2] == 0x00U) && (card->capduLen >= 7U) && (c[4] == 2U) )
+    {
+        card->file = SIM_T4T_FILE_NONE;
+        sw         = 0x6A82U;
+
+        if( card->appSelected && !card->pay )
+        {
+            if( (((uint16_t)c[5] << 8) | c[6]) == SIM_T4T_FID_CC )
+            {
+                card->file = SIM_T4T_FILE_CC;
+                sw         = 0x9000U;
+            }
+            else if( (((uint16_t)c[5] << 8) | c[6]) == SIM_T4T_FID_NDEF )
+            {
+                card->file = SIM_T4T_FILE_NDEF;
+                sw         = 0x9000U;
+            }
+            else
+            {
+                /* Unknown file */
+            }
+        }
+    }
+    /*******************************************************************************/
+    else if( (c[1] == SIM_T4T_INS_READ_BINARY) && ((card->capduLen == 5U) || ((card->capduLen == 7U) && (c[4] == 0U) && (card->mle > SIM_T4T_MLE))) )
+    {
+        /* CC generated from the NDEF file: mapping 2.0 (3.0 for extended Le), MLe, MLc, NDEF file control TLV, free read and write access */
+        cc[0]  = 0x00U;  cc[1] = SIM_T4T_CC_LEN;  cc[2] = ((card->mle > SIM_T4T_MLE) ? SIM_T4T_MAPPING_30 : SIM_T4T_MAPPING_20);
+        cc[3]  = (uint8_t)(card->mle >> 8);           cc[4]  = (uint8_t)(card->mle & 0xFFU);
+        cc[5]  = (uint8_t)(SIM_T4T_MLC >> 8);         cc[6]  = (uint8_t)(SIM_T4T_MLC & 0xFFU);
+        cc[7]  = 0x04U;  cc[8] = 0x06U;
+        cc[9]  = (uint8_t)(SIM_T4T_FID_NDEF >> 8);    cc[10] = (uint8_t)(SIM_T4T_FID_NDEF & 0xFFU);
+        cc[11] = (uint8_t)((SIM_T4T_NDEF_MAX + 2U) >> 8); cc[12] = (uint8_t)((SIM_T4T_NDEF_MAX + 2U) & 0xFFU);
+        cc[13] = 0x00U;  cc[14] = 0x00U;
+
+        file    = ((card->file == SIM_T4T_FILE_CC) ? cc : card->ndef);
+        fileLen = (uint16_t)((card->file == SIM_T4T_FILE_CC) ? SIM_T4T_CC_LEN : (card->ndefLen + 2U));
+        offset  = (uint16_t)(((uint16_t)c[2] << 8) | c[3]);
+        if( card->capduLen == 7U )
+        {
+            le = (uint32_t)(((uint16_t)c[5] << 8) | c[6]);
+            le = ((le == 0U) ? 65536U : le);                              /* Extended Le            */
+        }
+        else
+        {
+            le = ((c[4] == 0U) ? 256U : c[4]);
+        }
+        le      = ((le > card->mle) ? card->mle : le);                    /* Never beyond MLe       */
+
+        if( card->file == SIM_T4T_FILE_NONE )
+        {
+            sw = 0x6986U;                                                 /* No current EF          */
+        }
+        else if( offset > fileLen )
+        {
+            sw = 0x6B00U;                                                 /* Wrong P1-P2            */
+        }
+        else
+        {
+            len = (uint16_t)(((uint32_t)(fileLen - offset) < le) ? (uint32_t)(fileLen - offset) : le);
+            memcpy( r, &file[offset], len );
+            sw  = 0x9000U;
+        }
+    }
+    /*******************************************************************************/
+    else if( (c[1] == SIM_T4T_INS_READ_RECORD) && card->pay && card->appSelected )
+    {
+        /* Record template filled with a pattern of the record number */
+        r[len++] = 0x70U;  r[len++] = 0x81U;  r[len++] = (uint8_t)(SIM_T4T_RECORD_LEN - 3U);
+        while( len < SIM_T4T_RECORD_LEN )
+        {
+            r[len] = (uint8_t)(c[2] + len);
+            len++;
+        }
+        sw = 0x9000U;
+    }
+    else
+    {
+        /* Not supported */
+    }
+
+    r[len++]       = (uint8_t)(sw >> 8);
+    r[len++]       = (uint8_t)(sw & 0xFFU);
+    card->rapduLen = len;
+}
+
+
+/*******************************************************************************/
+static void simT4tInit( simTag *tag )
+{
+    simIsoDepCard *card;
+
+    card = &tag->isoDep;
+
+    /* NLEN and the message */
+    card->ndef[0] = (uint8_t)(card->ndefLen >> 8);
+    card->ndef[1] = (uint8_t)(card->ndefLen & 0xFFU);
+    simNdefText( tag, &card->ndef[2], card->ndefLen );
+}
+
+
+/*******************************************************************************/
+static void simNdefText( const simTag *tag, uint8_t *m, uint16_t len )
+{
+    uint16_t payloadLen;
+    uint16_t i;
+
+    /* A single text record (long record format) filling the message, its text seeded by the last UID byte */
+    if( len == 0U )
+    {
+        return;
+    }
+    payloadLen = (uint16_t)(len - 7U);
+
+    m[0] = 0xC1U;                                                         /* MB, ME, TNF well known */
+    m[1] = 0x01U;
+    m[2] = 0x00U;
+    m[3] = 0x00U;
+    m[4] = (uint8_t)(payloadLen >> 8);
+    m[5] = (uint8_t)(payloadLen & 0xFFU);
+    m[6] = 'T';
+    m[7] = 0x02U;
+    m[8] = 'e';
+    m[9] = 'n';
+    for( i = 10U; i < len; i++ )
+    {
+        m[i] = (uint8_t)('a' + ((i + tag->uid[tag->uidLen - 1U]) % 26U));
+    }
+}
+
+
+/*******************************************************************************/
+static int8_t simParseBr( const char *spec, const char *opt, int8_t def )
+{
+    const char *arg;
+    unsigned long kbps;
+
+    arg = strstr( spec, opt );
+    if( arg == NULL )
+    {
+        return def;
+    }
+
+    kbps = strtoul( &arg[strlen( opt )], NULL, 10 );
+    switch( kbps )
+    {
+        case 106: return 0;
+        case 212: return 1;
+        case 424: return 2;
+        case 848: return 3;
+        default:  return 4;     /* Invalid */
+    }
+}
+
+
+/*******************************************************************************/
+static bool simNfcvExchange( simTag *tag, const uint8_t *req, uint16_t reqLen, simTagFrame *rsp )
+{
+    uint8_t  flags;
+    uint8_t  cmd;
+    uint16_t pos;
+    uint16_t len;
+    uint8_t  maskLen;
+    uint8_t  slot;
+    uint8_t  i;
+    uint8_t  first;
+    uint8_t  num;
+    bool     addressed;
+    bool     match;
+
+    if( (reqLen < 4U) || (simCrc16( SIM_NFCV_CRC_PRELOAD, req, reqLen ) != 0xF0B8U) )
+    {
+        return false;   /* Residue of the inverted CRC over data + CRC */
+    }
+
+    flags      = req[0];
+    cmd        = req[1];
+    pos        = 2;
+    rsp->fdtFc = SIM_NFCV_FDT;
+
+    /*******************************************************************************/
+    if( (flags & SIM_NFCV_FLAG_INVENTORY) != 0U )
+    {
+        if( (cmd != SIM_NFCV_CMD_INVENTORY) || (tag->state == SIM_TAG_ST_QUIET) )
+        {
+            return false;
+        }
+
+        if( (flags & SIM_NFCV_FLAG_AFI) != 0U )
+        {
+            if( (req[pos] != 0U) && (req[pos] != tag->afi) )
+            {
+                return false;
+            }
+            pos++;
+        }
+
+        maskLen = req[pos++];
+        if( maskLen > 64U )
+        {
+            return false;
+        }
+        for( i = 0; i < maskLen; i++ )
+        {
+            if( (((req[pos + (i / 8U)] >> (i % 8U)) ^ (tag->uid[i / 8U] >> (i % 8U))) & 0x01U) != 0U )
+            {
+                return false;
+            }
+        }
+
+        if( (flags & SIM_NFCV_FLAG_1_SLOT) != 0U )
+        {
+            simNfcvInventoryRes( tag, rsp );
+            return true;
+        }
+
+        /* 16 slots: the 4 UID bits following the mask select the slot */
+        slot = 0;
+        for( i = 0; i < 4U; i++ )
+        {
+            if( ((maskLen + i) < 64U) && (((tag->uid[(maskLen + i) / 8U] >> ((maskLen + i) % 8U)) & 0x01U) != 0U) )
+            {
+                slot |= (uint8_t)(1U << i);
+            }
+        }
+
+        if( slot == 0U )
+        {
+            simNfcvInventoryRes( tag, rsp );
+            return true;
+        }
+        tag->invSlot = (int8_t)slot;
+        return false;
+    }
+
+    /*******************************************************************************/
+    addressed = ((flags & SIM_NFCV_FLAG_ADDRESS) != 0U);
+    match     = true;
+    if( addressed )
+    {
+        if( reqLen < (pos + SIM_NFCV_UID_LEN + 2U) )
+        {
+            return false;
+        }
+        match = (memcmp( &req[pos], tag->uid, SIM_NFCV_UID_LEN ) == 0);
+        pos  += SIM_NFCV_UID_LEN;
+    }
+
+    /* A SELECT addressed to another VICC deselects this one */
+    if( (cmd == SIM_NFCV_CMD_SELECT) && !match && (tag->state == SIM_TAG_ST_SELECTED) )
+    {
+        tag->state = SIM_TAG_ST_READY;
+    }
+
+    if( !match )
+    {
+        return false;
+    }
+    if( ((flags & SIM_NFCV_FLAG_SELECT) != 0U) && (tag->state != SIM_TAG_ST_SELECTED) )
+    {
+        return false;
+    }
+    if( !addressed && (tag->state == SIM_TAG_ST_QUIET) )
+    {
+        return false;
+    }
+
+    len = 0;
+    rsp->data[len++] = 0x00U;
+
+    switch( cmd )
+    {
+        case SIM_NFCV_CMD_STAY_QUIET:
+            if( addressed )
+            {
+                tag->state = SIM_TAG_ST_QUIET;
+            }
+            return false;
+
+        case SIM_NFCV_CMD_SELECT:
+            if( !addressed )
+            {
+                return false;
+            }
+            tag->state = SIM_TAG_ST_SELECTED;
+            break;
+
+        case SIM_NFCV_CMD_RESET_TO_READY:
+            tag->state = SIM_TAG_ST_READY;
+            break;
+
+        case SIM_NFCV_CMD_READ_SINGLE:
+        case SIM_NFCV_CMD_READ_MULTIPLE:
+            first = req[pos];
+            num   = (uint8_t)((cmd == SIM_NFCV_CMD_READ_MULTIPLE) ? (req[pos + 1U] + 1U) : 1U);
+            if( ((uint16_t)first + num) > SIM_T5T_BLOCKS )
+            {
+                rsp->data[0]     = 0x01U;
+                rsp->data[len++] = SIM_NFCV_ERR_BLOCK_NA;
+                break;
+            }
+            for( i = 0; i < num; i++ )
+            {
+                if( (flags & SIM_NFCV_FLAG_OPTION) != 0U )
+                {
+                    rsp->data[len++] = 0x00U;       /* Block security status: unlocked */
+                }
+                memcpy( &rsp->data[len], &tag->mem[(first + i) * SIM_T5T_BLOCK_LEN], SIM_T5T_BLOCK_LEN );
+                len += SIM_T5T_BLOCK_LEN;
+            }
+            break;
+
+        case SIM_NFCV_CMD_WRITE_SINGLE:
+            if( req[pos] >= SIM_T5T_BLOCKS )
+            {
+                rsp->data[0]     = 0x01U;
+                rsp->data[len++] = SIM_NFCV_ERR_BLOCK_NA;
+                break;
+            }
+            memcpy( &tag->mem[req[pos] * SIM_T5T_BLOCK_LEN], &req[pos + 1U], SIM_T5T_BLOCK_LEN );
+            break;
+
+        case SIM_NFCV_CMD_GET_SYS_INFO:
+            rsp->data[len++] = 0x0FU;               /* DSFID, AFI, memory size and IC reference present */
+            memcpy( &rsp->data[len], tag->uid, SIM_NFCV_UID_LEN );
+            len += SIM_NFCV_UID_LEN;
+            rsp->data[len++] = tag->dsfid;
+            rsp->data[len++] = tag->afi;
+            rsp->data[len++] = (uint8_t)(SIM_T5T_BLOCKS - 1U);
+            rsp->data[len++] = (uint8_t)(SIM_T5T_BLOCK_LEN - 1U);
+            rsp->data[len++] = SIM_T5T_IC_REF;
+            break;
+
+        default:
+            if( !addressed && ((flags & SIM_NFCV_FLAG_SELECT) == 0U) )
+            {
+                return false;       /* Avoid collisions on unknown broadcast commands */
+            }
+            rsp->data[0]     = 0x01U;
+            rsp->data[len++] = SIM_NFCV_ERR_NOT_SUPPORTED;
+            break;
+    }
+
+    simSetCrc( rsp, len, true );
+    return true;
+}
+
+
+/*******************************************************************************/
+static void simNfcvInventoryRes( const simTag *tag, simTagFrame *rsp )
+{
+    rsp->data[0] = 0x00U;
+    rsp->data[1] = tag->dsfid;
+    memcpy( &rsp->data[2], tag->uid, SIM_NFCV_UID_LEN );
+    rsp->fdtFc   = SIM_NFCV_FDT;
+    simSetCrc( rsp, (2U + SIM_NFCV_UID_LEN), true );
+}
+
+
+/*******************************************************************************/
+static void simSetCrc( simTagFrame *rsp, uint16_t len, bool nfcv )
+{
+    uint16_t crc;
+
+    crc = (nfcv ? (uint16_t)~simCrc16( SIM_NFCV_CRC_PRELOAD, rsp->data, len ) : simCrc16( SIM_NFCA_CRC_PRELOAD, rsp->data, len ));
+
+    rsp->data[len]      = (uint8_t)(crc & 0xFFU);
+    rsp->data[len + 1U] = (uint8_t)(crc >> 8U);
+    rsp->nBits          = (uint16_t)((len + 2U) * 8U);
+}
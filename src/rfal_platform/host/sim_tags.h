@@ -0,0 +1,245 @@
+/*! \file sim_tags.h
+ *
+ *  \brief Scriptable virtual tags of the host simulator
+ *
+ *  Virtual PICCs/VICCs placed in the simulated RF field. The chip model
+ *  hands every decoded reader frame to simTagsExchange() and turns the
+ *  returned responses into reception events.
+ *
+ *  Supported tags:
+ *   - nfca-t2t : NFC-A Type 2 Tag (NTAG213 like, 45 pages, READ/FAST_READ/WRITE)
+ *   - nfca-t4t : NFC-A ISO-DEP card (RATS/PPS, I/R/S blocks with chaining),
+ *                Type 4 Tag NDEF application or, with "pay", a payment
+ *                application (PPSE, READ RECORD)
+ *   - nfcv-t5t : NFC-V Type 5 Tag (64 blocks of 4 bytes)
+ *
+ *  Tag specs have the form "<type> [uid=<hex>] [ant=<n>] [near]". NFC-A UIDs
+ *  are given in transmission order (4, 7 or 10 bytes), NFC-V UIDs MSB first
+ *  as printed on the tag (8 bytes, starting with E0). ant selects the antenna,
+ *  i.e. the simulated ST25R3911 whose field the tag is in (default 0). A near
+ *  tag lies on the antenna: it loads it much more than a tag at a distance
+ *  and is overloaded by a strong field, its longer responses are then
+ *  received with a broken CRC (BCC) until the reader lowers its drive (RFO).
+ *
+ *  nfca-t4t cards also take "maxbr=<106|212|424|848>", the highest bit rate
+ *  offered in the ATS (default 848), "weak=<212|424|848>", the bit rate from
+ *  which on their responses are received with a broken CRC (a card that
+ *  does not hold the higher rates at that distance), "ndef=<bytes>", the
+ *  length of the NDEF message (default 512, up to 32765), "fsc=<bytes>", the
+ *  frame size of its ATS (16 to 4096, default 256) and "mle=<bytes>", the
+ *  MLe of its CC (default 255; above it the CC is mapping 3.0 and READ
+ *  BINARY takes an extended Le). A card only understands frames sent at the
+ *  bit rate agreed with PPS.
+ *
+ *  nfca-t2t and nfcv-t5t tags take "ndef=<bytes>" as well: the length of the
+ *  message of their NDEF TLV (10 to 141 for a T2T, to 249 for a T5T; default
+ *  an empty one). A T2T given "nofast" NAKs FAST_READ like a tag without
+ *  the command (back to IDLE). T4T, T2T and T5T messages are a single text record, its
+ *  text seeded by the last UID byte.
+ *
+ */
+
+#ifndef SIM_TAGS_H
+#define SIM_TAGS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#define SIM_TAGS_MAX                8U      /*!< Max number of tags in the field              */
+#define SIM_TAGS_ANTENNAS           4U      /*!< Antennas, one per simulated ST25R3911        */
+#define SIM_TAG_FRAME_MAX           4100U   /*!< Max response length in bytes: FSD 4096 and CRC */
+#define SIM_TAGS_SCRIPT_MAX         64U     /*!< Max number of scripted tag events            */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! RF technology the reader is currently transmitting with */
+typedef enum
+{
+    SIM_RF_TECH_NONE,
+    SIM_RF_TECH_NFCA,
+    SIM_RF_TECH_NFCB,
+    SIM_RF_TECH_NFCF,
+    SIM_RF_TECH_NFCV
+} simRfTech;
+
+/*! Tag response frame */
+typedef struct
+{
+    uint8_t  data[SIM_TAG_FRAME_MAX];   /*!< Response bits, LSB first                           */
+    uint16_t nBits;                     /*!< Number of response bits following bitOffset        */
+    uint8_t  bitOffset;                 /*!< Leading bits of data[0] not sent (split frames)    */
+    uint32_t fdtFc;                     /*!< End of request to start of response in 1/fc       */
+} simTagFrame;
+
+/*! Detection ground truth: time from a tag entering the field to its first response */
+typedef struct
+{
+    uint32_t detected;                  /*!< Tags that responded at least once                  */
+    uint64_t latencyTotalNs;            /*!< Sum of the detection latencies                     */
+    uint64_t latencyMaxNs;              /*!< Longest detection latency                          */
+    uint32_t anticollFrames;            /*!< NFC-A SDD frames, NFC-V inventory requests and slots */
+    uint32_t collisions;                /*!< Reader frames answered by more than one tag        */
+    uint32_t overloaded;                /*!< Responses broken by a too strong field (near tags) */
+    uint32_t rateErrors;                /*!< Responses broken by a too high bit rate (weak cards) */
+} simTagsStats;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Place a tag in the field
+ *
+ * \param[in]  spec : tag spec, e.g. "nfca-t2t uid=04A1B2C3D4E5F6"
+ *
+ * \return true  : tag added
+ * \return false : invalid spec or no free slot
+ *****************************************************************************
+ */
+bool simTagsAdd( const char *spec );
+
+/*!
+ *****************************************************************************
+ * \brief  Remove a tag from the field
+ *
+ * \param[in]  uid : UID as given on simTagsAdd(), or "all"
+ *
+ * \return true if at least one tag was removed
+ *****************************************************************************
+ */
+bool simTagsRemove( const char *uid );
+
+/*!
+ *****************************************************************************
+ * \brief  Number of tags currently in the field of an antenna
+ *
+ * \param[in]  ant : antenna
+ *****************************************************************************
+ */
+uint8_t simTagsCount( uint8_t ant );
+
+/*!
+ *****************************************************************************
+ * \brief  Number of near tags currently in the field of an antenna
+ *
+ * \param[in]  ant : antenna
+ *****************************************************************************
+ */
+uint8_t simTagsNearCount( uint8_t ant );
+
+/*!
+ *****************************************************************************
+ * \brief  Reader drive changed
+ *
+ * \param[in]  ant : antenna
+ * \param[in]  rfo : RFO driver resistance (ST25R3911 RFO_AM_OFF_LEVEL), 0: full power
+ *****************************************************************************
+ */
+void simTagsSetDrive( uint8_t ant, uint8_t rfo );
+
+/*!
+ *****************************************************************************
+ * \brief  Load a tag script
+ *
+ * Each line reads "<time_ms> add <spec>" or "<time_ms> remove <uid|all>".
+ * Empty lines and lines starting with '#' are ignored. Events are applied
+ * once the virtual time reaches them.
+ *
+ * \param[in]  path : script file
+ *
+ * \return true if the script was loaded
+ *****************************************************************************
+ */
+bool simTagsLoadScript( const char *path );
+
+/*!
+ *****************************************************************************
+ * \brief  Apply scripted events that are due
+ *
+ * \param[in]  nowNs : current virtual time
+ *****************************************************************************
+ */
+void simTagsRunScript( uint64_t nowNs );
+
+/*!
+ *****************************************************************************
+ * \brief  Reader field switched on/off
+ *
+ * Switching the field off powers down all tags of the antenna (back to
+ * IDLE/READY).
+ *
+ * \param[in]  ant : antenna
+ * \param[in]  on  : new field state
+ *****************************************************************************
+ */
+void simTagsField( uint8_t ant, bool on );
+
+/*!
+ *****************************************************************************
+ * \brief  Deliver a reader frame to the tags of an antenna
+ *
+ * \param[in]   ant     : antenna
+ * \param[in]   tech    : technology of the reader frame
+ * \param[in]   br      : bit rate of the reader frame, 0: 106 kbit/s .. 3: 848 kbit/s
+ * \param[in]   req     : request bits, LSB first (incl. CRC if sent)
+ * \param[in]   reqBits : number of request bits (0: NFC-V EOF only)
+ * \param[out]  rsp     : responses of the tags that answered
+ * \param[in]   maxRsp  : capacity of \a rsp
+ *
+ * \return number of responses written to \a rsp
+ *****************************************************************************
+ */
+uint8_t simTagsExchange( uint8_t ant, simRfTech tech, uint8_t br, const uint8_t *req, uint16_t reqBits, simTagFrame *rsp, uint8_t maxRsp );
+
+/*!
+ *****************************************************************************
+ * \brief  Detection statistics
+ *
+ * A scripted tag enters the field at its script time, a tag given on the
+ * command line when it is added.
+ *****************************************************************************
+ */
+const simTagsStats* simTagsGetStats( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Reflected CRC-16 (poly 0x8408) as used by ISO14443A and ISO15693
+ *
+ * Kept independent from RFAL's CRC so the simulator does not validate the
+ * firmware against itself.
+ *
+ * \param[in]  preload : 0x6363 for CRC_A, 0xFFFF for ISO15693 (then inverted)
+ * \param[in]  buf     : data
+ * \param[in]  len     : data length
+ *
+ * \return CRC value
+ *****************************************************************************
+ */
+uint16_t simCrc16( uint16_t preload, const uint8_t *buf, uint16_t len );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_TAGS_H */
@@ -1,9 +1,20 @@
-
 #include "pltf_interrupt.h"
 
 #include "config.h"
+#include "pltf_spi.h"
+#include "pltf_timer.h"
 #include <Arduino.h>
 
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+#define PLTF_IRQ_TASK_STACK         4096                        /* Stack size of the IRQ handler task (bytes)       */
+#define PLTF_IRQ_TASK_PRIO          (configMAX_PRIORITIES - 1)  /* Above every RFAL user: runs right after the ISR  */
+
+#define PLTF_IRQ_EVT_READ(r)        (1U << (r))                 /* Event bit: new IRQs of reader r have been read   */
+
 /*
  ******************************************************************************
  * STATIC VARIABLES
@@ -11,6 +22,70 @@
  */
 
 static SemaphoreHandle_t rfal_irq_mtx;
+static EventGroupHandle_t rfal_irq_evt;                         /* Wakes up the RFAL task blocked on the IRQ status */
+
+static const uint8_t     rfal_irq_pins[] = READER_IRQ_PINS;
+
+/* One of each per reader, the handler task is bound to its reader */
+static TaskHandle_t      rfal_irq_task[PLTF_READERS];           /* Task draining the ST25R3911 IRQ registers        */
+static void            (*rfal_irq_handler[PLTF_READERS])(void); /* RFAL interrupt handler run by the task           */
+static volatile uint32_t rfal_irq_edge_us[PLTF_READERS];        /* Time stamp of the last IRQ edge                  */
+static pltf_irq_stats_t  rfal_irq_stats[PLTF_READERS];          /* ISR duration and IRQ to handler latency counters */
+
+/*
+ ******************************************************************************
+ * STATIC FUNCTIONS
+ ******************************************************************************
+ */
+
+/* Minimal ISR: no SPI, no mutex, only time stamp the edge and wake up the IRQ task */
+static void ARDUINO_ISR_ATTR pltf_irq_isr(void *arg)
+{
+    BaseType_t        woken  = pdFALSE;
+    uint32_t          reader = (uint32_t)(uintptr_t)arg;
+    pltf_irq_stats_t *stats  = &rfal_irq_stats[reader];
+    uint32_t          start  = micros();
+    uint32_t          duration;
+
+    rfal_irq_edge_us[reader] = start;
+    vTaskNotifyGiveFromISR(rfal_irq_task[reader], &woken);
+
+    duration = micros() - start;
+    stats->isr_count++;
+    stats->isr_time_total_us += duration;
+    if (duration > stats->isr_time_max_us) {
+        stats->isr_time_max_us = duration;
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/* Deferred part: reads the IRQ registers over SPI and updates the RFAL status in task context */
+static void pltf_irq_task(void *arg)
+{
+    uint8_t           reader = (uint8_t)(uintptr_t)arg;
+    pltf_irq_stats_t *stats  = &rfal_irq_stats[reader];
+    uint32_t          latency;
+
+    /* The handler works on the RFAL context of this task's reader */
+    pltf_reader_select(reader);
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        latency = micros() - rfal_irq_edge_us[reader];
+        stats->handler_count++;
+        stats->latency_last_us   = latency;
+        stats->latency_total_us += latency;
+        if (latency > stats->latency_max_us) {
+            stats->latency_max_us = latency;
+        }
+
+        if (rfal_irq_handler[reader] != NULL) {
+            rfal_irq_handler[reader]();
+        }
+    }
+}
 
 /*
  ******************************************************************************
@@ -20,8 +95,54 @@ static SemaphoreHandle_t rfal_irq_mtx;
 
 void interrupt_init()
 {
-    rfal_irq_mtx = xSemaphoreCreateMutex();
-    pinMode(IRQ_PIN, INPUT);
+    /* Shared by all readers, created by the first one initialized */
+    if (rfal_irq_mtx == NULL) {
+        rfal_irq_mtx = xSemaphoreCreateMutex();
+        rfal_irq_evt = xEventGroupCreate();
+    }
+    pinMode(rfal_irq_pins[pltf_reader_get()], INPUT);
+}
+
+void pltf_irq_set_callback(void (*cb)(void))
+{
+    uint8_t reader = pltf_reader_get();
+
+    rfal_irq_handler[reader] = cb;
+
+    if (rfal_irq_task[reader] == NULL) {
+        xTaskCreate(pltf_irq_task, "rfal_irq", PLTF_IRQ_TASK_STACK, (void *)(uintptr_t)reader, PLTF_IRQ_TASK_PRIO, &rfal_irq_task[reader]);
+    }
+    attachInterruptArg(digitalPinToInterrupt(rfal_irq_pins[reader]), pltf_irq_isr, (void *)(uintptr_t)reader, RISING);
+}
+
+void pltf_irq_get_stats(pltf_irq_stats_t *stats)
+{
+    *stats = rfal_irq_stats[pltf_reader_get()];
+}
+
+uint8_t pltf_irq_pin(void)
+{
+    return rfal_irq_pins[pltf_reader_get()];
+}
+
+void pltf_irq_signal(void)
+{
+    if (rfal_irq_evt == NULL) {
+        return;
+    }
+    xEventGroupSetBits(rfal_irq_evt, PLTF_IRQ_EVT_READ(pltf_reader_get()));
+}
+
+void pltf_irq_wait(uint32_t timer)
+{
+    uint32_t remaining = timerGetRemainingUs(timer);
+
+    if ((rfal_irq_evt == NULL) || (remaining == 0U)) {
+        return;
+    }
+
+    /* Sleep at most until the first tick past the timer expiry, the caller checks the timer again */
+    xEventGroupWaitBits(rfal_irq_evt, PLTF_IRQ_EVT_READ(pltf_reader_get()), pdTRUE, pdFALSE, pdMS_TO_TICKS((remaining + 999U) / 1000U));
 }
 
 void pltf_protect_interrupt_status(void)
@@ -5,6 +5,24 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
+/*
+ ******************************************************************************
+ * GLOBAL TYPES
+ ******************************************************************************
+ */
+/* Counters of the split (ISR + task) ST25R3911 interrupt handling */
+typedef struct {
+	uint32_t isr_count;             /* Number of IRQ edges seen by the ISR                   */
+	uint32_t isr_time_max_us;       /* Longest time spent in the ISR                         */
+	uint32_t isr_time_total_us;     /* Total time spent in the ISR                           */
+	uint32_t handler_count;         /* Number of times the IRQ task ran the RFAL handler     */
+	uint32_t latency_last_us;       /* IRQ edge to RFAL handler start, last one              */
+	uint32_t latency_max_us;        /* IRQ edge to RFAL handler start, worst case            */
+	uint32_t latency_total_us;      /* IRQ edge to RFAL handler start, sum (avg = total/cnt) */
+} pltf_irq_stats_t;
+
 /*! 
  *****************************************************************************
  * \brief  This function setups the Interrupt for the RFAL
@@ -14,6 +32,60 @@ extern "C" {
  */
 void interrupt_init(void);
 
+/*! 
+ *****************************************************************************
+ * \brief  Attaches the RFAL interrupt handler
+ *  
+ * The IRQ pin ISR only wakes up a high priority task, which then runs the
+ * given handler (SPI reads of the IRQ registers) in task context.
+ * 
+ * \param[in]	cb : RFAL interrupt handler (st25r3911Isr)
+ *****************************************************************************
+ */
+void pltf_irq_set_callback(void (*cb)(void));
+
+/*! 
+ *****************************************************************************
+ * \brief  Gets the interrupt handling counters
+ *  
+ * \param[out]	stats : ISR duration and IRQ to handler latency counters of
+ *                      the calling task's reader (see pltf_reader_select)
+ *****************************************************************************
+ */
+void pltf_irq_get_stats(pltf_irq_stats_t *stats);
+
+/*! 
+ *****************************************************************************
+ * \brief  Gets the IRQ pin of the calling task's reader
+ *  
+ * \return GPIO number, from READER_IRQ_PINS
+ *****************************************************************************
+ */
+uint8_t pltf_irq_pin(void);
+
+/*! 
+ *****************************************************************************
+ * \brief  Signals that new interrupts have been read
+ *  
+ * Called by RFAL after the interrupt status variable has been updated,
+ * wakes up a task blocked in pltf_irq_wait().
+ * 
+ *****************************************************************************
+ */
+void pltf_irq_signal(void);
+
+/*! 
+ *****************************************************************************
+ * \brief  Waits for new interrupts
+ *  
+ * Blocks the calling task until pltf_irq_signal() is called or the given 
+ * timer expires. Used by RFAL instead of spinning on the interrupt status.
+ * \param[in]	timer : timer as returned by timerCalculateTimer()
+ * 
+ *****************************************************************************
+ */
+void pltf_irq_wait(uint32_t timer);
+
 /*! 
  *****************************************************************************
  * \brief  To protect interrupt status variable  of RFAL 
@@ -10,13 +10,25 @@
 
 #include <Arduino.h>
 #include <SPI.h>
+#include <assert.h>
+
+#if PLTF_SPI_USE_DMA
+#include <driver/spi_master.h>
+#endif
 
 /*
  ******************************************************************************
  * DEFINES
  ******************************************************************************
  */
-const long spi_speed = 1000000;
+#if PLTF_SPI_USE_DMA
+#define PLTF_SPI_HOST           SPI3_HOST   /* SPI2 (FSPI) is owned by the Arduino SPI object */
+#define PLTF_SPI_DMA_MAX_LEN    256         /* Largest single transfer (FIFO + command byte) */
+#endif
+
+#if PLTF_READERS > 1 && !defined(PLTF_READER_TLS_INDEX)
+#define PLTF_READER_TLS_INDEX   (configNUM_THREAD_LOCAL_STORAGE_POINTERS - 1)  /* Thread local pointer holding the task's reader */
+#endif
 
 /*
  ******************************************************************************
@@ -26,6 +38,13 @@ const long spi_speed = 1000000;
 /* Lock to serialize SPI communication */
 static SemaphoreHandle_t rfal_spi_mtx;
 
+#if PLTF_SPI_USE_DMA
+static spi_device_handle_t rfal_spi_dev;
+#endif
+
+static const uint8_t rfal_ss_pins[] = READER_SS_PINS;
+static_assert(sizeof(rfal_ss_pins) >= PLTF_READERS, "READER_SS_PINS has fewer pins than PLTF_READERS");
+
 /*
  ******************************************************************************
  * GLOBAL AND HELPER FUNCTIONS
@@ -33,35 +52,118 @@ static SemaphoreHandle_t rfal_spi_mtx;
  */
 void spi_init(void)
 {
+    uint8_t i;
+
     rfal_spi_mtx = xSemaphoreCreateMutex();
+    for (i = 0; i < PLTF_READERS; i++) {
+        pinMode(rfal_ss_pins[i], OUTPUT);
+        digitalWrite(rfal_ss_pins[i], HIGH);
+    }
+
+#if PLTF_SPI_USE_DMA
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num     = SPI_MOSI;
+    bus.miso_io_num     = SPI_MISO;
+    bus.sclk_io_num     = SPI_SCK;
+    bus.quadwp_io_num   = -1;
+    bus.quadhd_io_num   = -1;
+    bus.max_transfer_sz = PLTF_SPI_DMA_MAX_LEN;
+
+    spi_device_interface_config_t dev = {};
+    dev.mode           = 1;
+    dev.clock_speed_hz = PLTF_SPI_CLOCK_HZ;
+    dev.spics_io_num   = -1;    // CS is driven by pltf_cs_select/deselect
+    dev.queue_size     = 1;
+
+    ESP_ERROR_CHECK(spi_bus_initialize(PLTF_SPI_HOST, &bus, SPI_DMA_CH_AUTO));
+    ESP_ERROR_CHECK(spi_bus_add_device(PLTF_SPI_HOST, &dev, &rfal_spi_dev));
+#else
     SPI.begin(SPI_SCK, SPI_MISO, SPI_MOSI);
-    SPI.setFrequency(spi_speed);
-    pinMode(SPI_SS, OUTPUT);
+    SPI.setFrequency(PLTF_SPI_CLOCK_HZ);
+#endif
 }
 
 void spiTxRx(const uint8_t *txData, uint8_t *rxData, uint8_t length)
-{ 
+{
+#if PLTF_SPI_USE_DMA
+    spi_transaction_t t = {};
+    t.length    = (size_t)length * 8U;
+    t.tx_buffer = txData;
+    t.rx_buffer = rxData;
+
+    // Polling transmit: no task switch, DMA moves the data
+    spi_device_polling_transmit(rfal_spi_dev, &t);
+#else
+    SPI.transferBytes(txData, rxData, length);
+#endif
+}
+
+void spiTxRxCmd(uint8_t cmd, const uint8_t *txData, uint8_t *rxData, uint8_t length)
+{
+#if PLTF_SPI_USE_DMA
+    spi_transaction_ext_t t = {};
+    t.base.flags     = SPI_TRANS_VARIABLE_CMD;
+    t.base.cmd       = cmd;
+    t.base.length    = (size_t)length * 8U;
+    t.base.tx_buffer = txData;
+    t.base.rx_buffer = rxData;
+    t.command_bits   = 8;
+
+    // Command phase then data phase: one transaction, no staging buffer
+    spi_device_polling_transmit(rfal_spi_dev, &t.base);
+#else
+    // No command phase in the Arduino API: command byte, then the data in place, CS stays low
+    SPI.transfer(cmd);
     SPI.transferBytes(txData, rxData, length);
+#endif
 }
 
 void pltf_cs_select(void)
 {
-    SPI.beginTransaction(SPISettings(spi_speed, MSBFIRST, SPI_MODE1));
-    digitalWrite(SPI_SS, LOW);
+    digitalWrite(rfal_ss_pins[pltf_reader_get()], LOW);
 }
 
 void pltf_cs_deselect(void)
 {
-    SPI.endTransaction();
-    digitalWrite(SPI_SS, HIGH);
+    digitalWrite(rfal_ss_pins[pltf_reader_get()], HIGH);
 }
 
 void pltf_protect_com(void)
 {
     xSemaphoreTake(rfal_spi_mtx, portMAX_DELAY); // enter critical section
+
+    // The bus is configured once per locked sequence, not per frame
+#if PLTF_SPI_USE_DMA
+    spi_device_acquire_bus(rfal_spi_dev, portMAX_DELAY);
+#else
+    SPI.beginTransaction(SPISettings(PLTF_SPI_CLOCK_HZ, MSBFIRST, SPI_MODE1));
+#endif
 }
 
 void pltf_unprotect_com(void)
 {
+#if PLTF_SPI_USE_DMA
+    spi_device_release_bus(rfal_spi_dev);
+#else
+    SPI.endTransaction();
+#endif
+
     xSemaphoreGive(rfal_spi_mtx); // exit critical section
 }
+
+void pltf_reader_select(uint8_t reader)
+{
+    assert(reader < PLTF_READERS);
+
+#if PLTF_READERS > 1
+    // The reader is the pointer value: a task that never selected one reads NULL, reader 0
+    vTaskSetThreadLocalStoragePointer(NULL, PLTF_READER_TLS_INDEX, (void *)(uintptr_t)reader);
+#endif
+}
+
+#if PLTF_READERS > 1
+uint8_t pltf_reader_get(void)
+{
+    return (uint8_t)(uintptr_t)pvTaskGetThreadLocalStoragePointer(NULL, PLTF_READER_TLS_INDEX);
+}
+#endif
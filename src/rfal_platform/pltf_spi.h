@@ -12,6 +12,27 @@ extern "C" {
  */
 #include <stdint.h>
 
+/*
+ ******************************************************************************
+ * DEFINES
+ ******************************************************************************
+ */
+#ifndef PLTF_SPI_CLOCK_HZ
+#define PLTF_SPI_CLOCK_HZ   6000000     /* SCLK, the ST25R3911B allows up to 6 MHz */
+#endif
+
+#ifndef PLTF_SPI_USE_DMA
+#define PLTF_SPI_USE_DMA    0           /* 1: ESP-IDF spi_master driver with DMA instead of Arduino SPI */
+#endif
+
+#ifndef PLTF_READERS
+#define PLTF_READERS        1           /* ST25R3911 front-ends on the bus, CS/IRQ pins in config.h */
+#endif
+
+#if PLTF_SPI_USE_DMA && !defined(ESP_PLATFORM)
+#error "PLTF_SPI_USE_DMA requires the ESP-IDF spi_master driver"
+#endif
+
 /*
  ******************************************************************************
  * GLOBAL FUNCTIONS
@@ -41,6 +62,30 @@ void spi_init(void);
 /* function for full duplex SPI communication */
 void spiTxRx(const uint8_t *txData, uint8_t *rxData, uint8_t length);
 
+/*! 
+ *****************************************************************************
+ * \brief  SPI command and data transfer
+ *  
+ * Sends a command byte followed by length data bytes within one chip
+ *	select frame, the data straight from txData and into rxData (either 
+ *	may be NULL). Used for the FIFO access, so that no copy through a local
+ *	buffer is needed. With PLTF_SPI_USE_DMA the command phase of the 
+ *	transaction carries the byte; otherwise the byte and the data are two
+ *	back to back transfers.
+ *
+ *****************************************************************************
+ */
+void spiTxRxCmd(uint8_t cmd, const uint8_t *txData, uint8_t *rxData, uint8_t length);
+
+/*! 
+ *****************************************************************************
+ * \brief  Chip select
+ *  
+ * Only drives SS; the bus is configured by pltf_protect_com so that a 
+ * locked sequence of frames is a single SPI transaction.
+ * 
+ *****************************************************************************
+ */
 void pltf_cs_select(void);
 
 void pltf_cs_deselect(void);
@@ -50,7 +95,8 @@ void pltf_cs_deselect(void);
  * \brief  To protect SPI communication
  *  
  * This method acquire a mutex and shall be used before communication takes 
- * place.
+ * place. It also claims and configures the SPI bus (clock, mode) for all 
+ * the frames until pltf_unprotect_com.
  * 
  *****************************************************************************
  */
@@ -60,12 +106,42 @@ void pltf_protect_com(void);
  *****************************************************************************
  * \brief  To unprotect SPI communication
  *  
- * This method release the mutex that was acquired with pltf_protect_com.
+ * This method releases the SPI bus and the mutex that were acquired with 
+ * pltf_protect_com.
  * 
  *****************************************************************************
  */
 void pltf_unprotect_com(void); 
 
+/*! 
+ *****************************************************************************
+ * \brief  Binds the calling task to a reader
+ *  
+ * Every RFAL call, chip select and IRQ wait made by the calling task from 
+ * then on goes to the given ST25R3911 (index into READER_SS_PINS and 
+ * READER_IRQ_PINS). A task that never called it works with reader 0.
+ * The reader is kept in a FreeRTOS thread local storage pointer of the 
+ * task (PLTF_READER_TLS_INDEX, the last one by default), so that 
+ * pltf_reader_get() is a single read. An index out of range asserts.
+ * 
+ * \param[in]	reader : reader index, < PLTF_READERS
+ *****************************************************************************
+ */
+void pltf_reader_select(uint8_t reader);
+
+/*! 
+ *****************************************************************************
+ * \brief  Gets the reader the calling task is bound to
+ *  
+ * \return reader index, 0 if the task never called pltf_reader_select
+ *****************************************************************************
+ */
+#if PLTF_READERS > 1
+uint8_t pltf_reader_get(void);
+#else
+#define pltf_reader_get()   0U
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,9 +25,11 @@
  *
  *  \author Gustavo Patricio
  *
- *   This module makes use of a System Tick in millisconds and provides
- *   an abstraction for SW timers.
- *   Modified to implement timers on Linux platform.	
+ *   This module makes use of a monotonic System Tick in microseconds and
+ *   provides an abstraction for SW timers.
+ *   Timers are absolute tick values, so a wall clock adjustment (SNTP)
+ *   no longer affects running timers. Delays sleep whenever they span at
+ *   least one RTOS tick instead of spinning.
  *
  */
 
@@ -36,14 +38,25 @@
 * INCLUDES
 ******************************************************************************
 */
-#include <time.h>
 #include "pltf_timer.h"
 
+#if defined(PLATFORM_HOST_SIM)
+#include "host/sim_clock.h"
+#elif defined(ESP_PLATFORM)
+#include "esp_timer.h"
+#else
+#include <time.h>
+#endif
+
+#include <Arduino.h>
+
 /*
 ******************************************************************************
 * LOCAL DEFINES
 ******************************************************************************
 */
+#define TIMER_US_PER_MS         1000U
+#define TIMER_US_PER_TICK       (portTICK_PERIOD_MS * TIMER_US_PER_MS)
 
 /*
 ******************************************************************************
@@ -51,55 +64,100 @@
 ******************************************************************************
 */
 
-/*****************************************************************************/
+/****************************************************************************/
+
+static uint64_t platformGetTimeUs64( void ) {
+#if defined(PLATFORM_HOST_SIM)
+	/* Every tick query is a spin of a busy loop: charge it and let the chip run */
+	simClockCpuQuantum();
+	return (simClockNowNs() / SIM_NS_PER_US);
+#elif defined(ESP_PLATFORM)
+	return (uint64_t)esp_timer_get_time();
+#else
+	struct timespec cur_ts;
+	clock_gettime(CLOCK_MONOTONIC, &cur_ts);
+	return (((uint64_t)cur_ts.tv_sec * 1000000U) + ((uint64_t)cur_ts.tv_nsec / 1000U));
+#endif
+}
+
+
+/****************************************************************************/
 
-uint32_t ts2milisec(struct timespec* ts) {
-	return  ((ts->tv_sec * (uint32_t)1000) + (ts->tv_nsec/1000000));
+uint32_t platformGetSysTickUs_esp32() {
+	return (uint32_t)platformGetTimeUs64();
 }
 
 
 /****************************************************************************/
 
 uint32_t platformGetSysTick_esp32() {
-	struct timespec cur_ts;
-	clock_gettime(CLOCK_REALTIME, &cur_ts);
-	return ts2milisec(&cur_ts); 
+	/* From the 64 bit time: the ms tick wraps at 2^32 like the us one, not when the us one does */
+	return (uint32_t)(platformGetTimeUs64() / TIMER_US_PER_MS);
 }
 
 
 /*******************************************************************************/
 uint32_t timerCalculateTimer( uint16_t time )
 {
-  return (platformGetSysTick_esp32() + time);
+  return timerCalculateTimerUs( (uint32_t)time * TIMER_US_PER_MS );
+}
+
+
+/*******************************************************************************/
+uint32_t timerCalculateTimerUs( uint32_t time )
+{
+  return (platformGetSysTickUs_esp32() + time);
 }
 
 
 /*******************************************************************************/
 bool timerIsExpired( uint32_t timer )
+{
+  return (timerGetRemainingUs( timer ) == 0U);
+}
+
+
+/*******************************************************************************/
+uint32_t timerGetRemainingUs( uint32_t timer )
 {
   uint32_t uDiff;
   int32_t sDiff;
   
-  uDiff = (timer - platformGetSysTick_esp32());   /* Calculate the diff between the timers */
-  sDiff = uDiff;                            /* Convert the diff to a signed var      */
+  uDiff = (timer - platformGetSysTickUs_esp32());   /* Calculate the diff between the timers */
+  sDiff = (int32_t)uDiff;                           /* Convert the diff to a signed var      */
   
   /* Check if the given timer has expired already */
-  if( sDiff < 0 )
+  if( sDiff <= 0 )
   {
-    return true;
+    return 0;
   }
   
-  return false;
+  return uDiff;
 }
 
 
 /*******************************************************************************/
 void timerDelay( uint16_t tOut )
+{
+  timerDelayUs( (uint32_t)tOut * TIMER_US_PER_MS );
+}
+
+
+/*******************************************************************************/
+void timerDelayUs( uint32_t tOut )
 {
   uint32_t t;
+  uint32_t remaining;
+  
+  t = timerCalculateTimerUs( tOut );
   
-  /* Calculate the timer and wait blocking until is running */
-  t = timerCalculateTimer( tOut );
+  /* Sleep the whole ticks: vTaskDelay(n) may return up to one tick early, so keep one tick margin */
+  remaining = timerGetRemainingUs( t );
+  if( remaining >= (2U * TIMER_US_PER_TICK) )
+  {
+    vTaskDelay( (remaining / TIMER_US_PER_TICK) - 1U );
+  }
+  
+  /* Spin only for the last sub-tick part */
   while( timerIsRunning(t) );
 }
-
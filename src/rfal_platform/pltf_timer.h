@@ -23,8 +23,8 @@
  *
  *  \brief SW Timer implementation header file
  *   
- *   This module makes use of a System Tick in millisconds and provides
- *   an abstraction for SW timers
+ *   This module makes use of a monotonic System Tick in microseconds and
+ *   provides an abstraction for SW timers
  *
  */
  
@@ -55,6 +55,27 @@ extern "C" {
 * GLOBAL DEFINES
 ******************************************************************************
 */
+/*! 
+ *****************************************************************************
+ * \brief  Get the monotonic System Tick in microseconds
+ *  
+ * esp_timer on the ESP32, CLOCK_MONOTONIC on other POSIX hosts.
+ * Wraps around every ~71 minutes, timers handle the wrap.
+ *
+ * \return u32 : microseconds since start-up
+ *****************************************************************************
+ */
+uint32_t platformGetSysTickUs_esp32();
+
+/*! 
+ *****************************************************************************
+ * \brief  Get the System Tick in milliseconds (RFAL platformGetSysTick)
+ *
+ * Taken from the same 64 bit time as the us tick, wraps around at 2^32 ms.
+ *
+ * \return u32 : milliseconds since start-up
+ *****************************************************************************
+ */
 uint32_t platformGetSysTick_esp32();
  
  /*! 
@@ -75,6 +96,19 @@ uint32_t platformGetSysTick_esp32();
  */
 uint32_t timerCalculateTimer( uint16_t time );
 
+ /*! 
+ *****************************************************************************
+ * \brief  Calculate Timer in microseconds
+ *  
+ * Same as timerCalculateTimer() with a time given in microseconds
+ *
+ * \param[in]  time : time/duration in Microseconds for the timer
+ *
+ * \return u32 : The new timer calculated based on the given time 
+ *****************************************************************************
+ */
+uint32_t timerCalculateTimerUs( uint32_t time );
+
 /*! 
  *****************************************************************************
  * \brief  Checks if a Timer is Expired
@@ -93,11 +127,24 @@ uint32_t timerCalculateTimer( uint16_t time );
  */
 bool timerIsExpired( uint32_t timer );
 
+/*! 
+ *****************************************************************************
+ * \brief  Gets the remaining time of a Timer
+ *  
+ * \param[in]  timer : the timer to check 
+ *
+ * \return u32 : microseconds until the timer expires, 0 if already expired
+ *****************************************************************************
+ */
+uint32_t timerGetRemainingUs( uint32_t timer );
+
  /*! 
  *****************************************************************************
  * \brief  Performs a Delay
  *  
- * This method performs a delay for the given amount of time in Milliseconds
+ * This method performs a delay for the given amount of time in Milliseconds.
+ * The calling task sleeps for the whole RTOS ticks and only spins for the
+ * last sub-tick part.
  * 
  * \param[in]  time : time/duration in Milliseconds of the delay
  *
@@ -105,6 +152,18 @@ bool timerIsExpired( uint32_t timer );
  */
 void timerDelay( uint16_t time );
 
+ /*! 
+ *****************************************************************************
+ * \brief  Performs a Delay in microseconds
+ *  
+ * Same as timerDelay() with a time given in microseconds
+ * 
+ * \param[in]  time : time/duration in Microseconds of the delay
+ *
+ *****************************************************************************
+ */
+void timerDelayUs( uint32_t time );
+
 #ifdef __cplusplus
 }
 #endif
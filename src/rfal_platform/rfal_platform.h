@@ -38,7 +38,11 @@ extern "C" {
 
 #define ST25R3911
 
+#if PLTF_READERS > 1
+#define ST25R_INT_PIN                     pltf_irq_pin()            /*!< GPIO pin used for ST25R3911 External Interrupt, per reader */
+#else
 #define ST25R_INT_PIN                     IRQ_PIN                   /*!< GPIO pin used for ST25R3911 External Interrupt */
+#endif
 #define ST25R_INT_PORT                    0                         /*!< GPIO port used for ST25R3911 External Interrupt */
 
 /*
@@ -46,19 +50,27 @@ extern "C" {
 * GLOBAL MACROS
 ******************************************************************************
 */
-#define ST25R391X_COM_SINGLETXRX                                        /*!< Enable single SPI frame transmission */
+#define RFAL_INSTANCES                        PLTF_READERS          /*!< One RFAL context per ST25R3911 on the bus                    */
+#if PLTF_READERS > 1
+#define platformGetInstance()                 pltf_reader_get()      /*!< Context of the reader the calling task is bound to          */
+#endif
+
+//#define ST25R_COM_SINGLETXRX                                          /*!< Single SPI frame per access, FIFO data copied through a local buffer */
+//#define ST25R_COM_TRACE                                               /*!< Enable the SPI transaction trace (st25r3911_trace.h), or -DST25R_COM_TRACE */
 
 #define platformProtectST25RComm()            pltf_protect_com()
 #define platformUnprotectST25RComm()          pltf_unprotect_com()
 
 #define platformIrqST25RPinInitialize()       interrupt_init();
-#define platformIrqST25RSetCallback(cb)       attachInterrupt(digitalPinToInterrupt(ST25R_INT_PIN), cb, RISING)
+#define platformIrqST25RSetCallback(cb)       pltf_irq_set_callback(cb)          /*!< ISR defers the handler to the RFAL IRQ task */
 
 #define platformSpiSelect()                   pltf_cs_select()       /*!< SPI SS\CS: Chip|Slave Select */
 #define platformSpiDeselect()                 pltf_cs_deselect()     /*!< SPI SS\CS: Chip|Slave Deselect */
 
 #define platformProtectST25RIrqStatus()       pltf_protect_interrupt_status()   /*!< Acquire the lock for safe access of RFAL interrupt status variable */
 #define platformUnprotectST25RIrqStatus()     pltf_unprotect_interrupt_status() /*!< Release the lock aquired for safe accessing of RFAL interrupt status variable */
+#define platformIrqST25RSignal()              pltf_irq_signal()                 /*!< Wake up the task waiting on the RFAL interrupt status */
+#define platformIrqST25RWait(timer)           pltf_irq_wait(timer)              /*!< Block until new interrupts were read or timer expires */
 
 #define platformGpioIsHigh(port, pin)         (gpio_readpin(port, pin) == GPIO_PIN_SET)                                                     /*!< Checks if the given GPIO is High */
 
@@ -67,8 +79,13 @@ extern "C" {
 #define platformTimerIsExpired(timer)         timerIsExpired(timer)     /*!< Checks if the given timer is expired        */
 #define platformDelay(t)                      timerDelay(t)             /*!< Performs a delay for the given time (ms)    */
 #define platformGetSysTick()                  platformGetSysTick_esp32()/*!< Get System Tick ( 1 tick = 1 ms)            */
+#define platformGetSysTickUs()                platformGetSysTickUs_esp32()/*!< Get System Tick in us                     */
 
 #define platformSpiTxRx(txBuf, rxBuf, len)    spiTxRx(txBuf, rxBuf, len)/*!< SPI transceive */
+#define platformSpiTxRxCmd(cmd, txBuf, rxBuf, len) spiTxRxCmd(cmd, txBuf, rxBuf, len) /*!< SPI command byte and data in one transfer, FIFO access */
+
+#define RFAL_FIFO_WL_SPI_CLOCK_HZ             PLTF_SPI_CLOCK_HZ     /*!< SPI clock for the FIFO water level policy (rfalSetFifoWaterLevel) */
+#define RFAL_FIFO_WL_IRQ_LATENCY_US           100U                  /*!< IRQ edge to RFAL worker incl. the IRQ task hop, worst case (see pltf_irq_get_stats) */
 
 #define platformI2CTx(txBuf, len)                                       /*!< I2C Transmit  */
 #define platformI2CRx(txBuf, len)                                       /*!< I2C Receive   */
@@ -94,11 +111,11 @@ extern "C" {
 
 #define RFAL_FEATURE_ST25TB                     false                   /*!< Enable/Disable RFAL support for ST25TB                                    */
 #define RFAL_FEATURE_DYNAMIC_ANALOG_CONFIG      true                    /*!< Enable/Disable Analog Configs to be dynamically updated (RAM)             */
-#define RFAL_FEATURE_DYNAMIC_POWER              false                   /*!< Enable/Disable RFAL dynamic power support                                 */
+#define RFAL_FEATURE_DPO                        true                    /*!< Enable/Disable RFAL dynamic power support                                 */
 #define RFAL_FEATURE_ISO_DEP                    true                   /*!< Enable/Disable RFAL support for ISO-DEP (ISO14443-4)                      */
 #define RFAL_FEATURE_NFC_DEP                    true                   /*!< Enable/Disable RFAL support for NFC-DEP (NFCIP1/P2P)                     */
 
-#define RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN     256                     /*!< ISO-DEP I-Block max length. Please use values as defined by rfalIsoDepFSx */
+#define RFAL_FEATURE_ISO_DEP_IBLOCK_MAX_LEN     1024                    /*!< ISO-DEP I-Block max length. Please use values as defined by rfalIsoDepFSx */
 #define RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN       1024                    /*!< ISO-DEP APDU max length. Please use multiples of I-Block max length       */
 #define RFAL_FEATURE_NFC_RF_BUF_LEN             258U                    /*!< RF buffer length used by RFAL NFC layer                                   */
 
@@ -0,0 +1,335 @@
+/*! \file t4t_read.c
+ *
+ *  \brief Type 4 Tag NDEF bulk read
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <string.h>
+
+#include "t4t_read.h"
+#include "apdu_pool.h"
+#include "rfal_platform/rfal_platform.h"
+#include "rfal_core/rfal_rf.h"
+#include "rfal_core/rfal_t4t.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define T4T_READ_CAPDU_LEN          16U     /*!< Longest C-APDU sent: SELECT of the NDEF application */
+#define T4T_READ_CTRL_RAPDU_LEN     (T4T_READ_LE_SHORT_MAX + 1U + RFAL_T4T_MAX_RAPDU_SW1SW2_LEN)  /*!< SELECT (FCI), CC and NLEN R-APDUs */
+
+#define T4T_READ_CC_LEN             15U     /*!< CC up to the NDEF File Control TLV            */
+#define T4T_READ_CC_TLV_NDEF        0x04U   /*!< NDEF File Control TLV                         */
+#define T4T_READ_CC_TLV_NDEF_LEN    0x06U
+#define T4T_READ_CC_READ_FREE       0x00U   /*!< Read access granted without security          */
+#define T4T_READ_NLEN_LEN           2U
+#define T4T_READ_MLE_MIN            0x000FU
+#define T4T_READ_FILE_MAX           0x7FFFU /*!< Largest offset of a READ BINARY w/o ODO       */
+#define T4T_READ_MAPPING_EXT_LE     0x30U   /*!< Mapping version from which on extended Le     */
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! APDU exchange context */
+typedef struct
+{
+    const rfalIsoDepDevice  *isoDep;
+    rfalIsoDepApduBufFormat *tx;
+    rfalIsoDepApduBufFormat *rx;
+    uint16_t                 rxLen;         /*!< R-APDU buffer length                          */
+    rfalIsoDepBufFormat     *tmp;
+    t4tReadStats            *stats;
+} t4tReadCtx;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static const uint8_t t4tReadNdefAid[] = { 0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01 };
+static const uint8_t t4tReadCcFid[]   = { 0xE1, 0x03 };
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static ReturnCode t4tReadApdu( t4tReadCtx *ctx, uint16_t txLen, uint16_t *dataLen )
+{
+    rfalIsoDepApduTxRxParam param;
+    rfalT4tRApduParam       rApdu;
+    uint16_t                rcvLen;
+    uint32_t                t0;
+    ReturnCode              ret;
+
+    param.txBuf    = ctx->tx;
+    param.txBufLen = txLen;
+    param.rxBuf    = ctx->rx;
+    param.rxBufLen = ctx->rxLen;
+    param.rxLen    = &rcvLen;
+    param.tmpBuf   = ctx->tmp;
+    param.FWT      = ctx->isoDep->info.FWT;
+    param.dFWT     = ctx->isoDep->info.dFWT;
+    param.FSx      = ctx->isoDep->info.FSx;
+    param.ourFSx   = RFAL_ISODEP_FSX_KEEP;
+    param.DID      = RFAL_ISODEP_NO_DID;
+    rcvLen         = 0;
+
+    t0  = platformGetSysTickUs();
+    ret = rfalIsoDepStartApduTransceive( param );
+    if( ret == RFAL_ERR_NONE )
+    {
+        do
+        {
+            rfalWorker();
+            rfalWorkerWait();
+            ret = rfalIsoDepGetApduTransceiveStatus();
+        }
+        while( ret == RFAL_ERR_BUSY );
+    }
+
+    ctx->stats->timeUs += (platformGetSysTickUs() - t0);
+    ctx->stats->apdus++;
+    if( ret != RFAL_ERR_NONE )
+    {
+        return ret;
+    }
+
+    ctx->stats->bytes += ((uint32_t)txLen + rcvLen);
+    rApdu.rApduBuf     = ctx->rx;
+    rApdu.rcvdLen      = rcvLen;
+    ret                = rfalT4TPollerParseRAPDU( &rApdu );
+    if( ret == RFAL_ERR_PROTO )
+    {
+        return ret;                                                                 /* No status word */
+    }
+
+    ctx->stats->sw = rApdu.statusWord;
+    *dataLen       = rApdu.rApduBodyLen;
+    return ret;
+}
+
+
+/*******************************************************************************/
+static ReturnCode t4tReadSelect( t4tReadCtx *ctx, const uint8_t *fid, uint8_t fidLen, bool app )
+{
+    uint16_t   txLen;
+    uint16_t   dataLen;
+    ReturnCode ret;
+
+    if( app )
+    {
+        ret = rfalT4TPollerComposeSelectAppl( ctx->tx, fid, fidLen, &txLen );
+    }
+    else
+    {
+        ret = rfalT4TPollerComposeSelectFile( ctx->tx, fid, fidLen, &txLen );
+    }
+    if( ret != RFAL_ERR_NONE )
+    {
+        return ret;
+    }
+    return t4tReadApdu( ctx, txLen, &dataLen );
+}
+
+
+/*******************************************************************************/
+static ReturnCode t4tReadBinary( t4tReadCtx *ctx, uint16_t offset, uint16_t le, bool extLe, uint16_t *dataLen )
+{
+    uint16_t   txLen;
+    ReturnCode ret;
+
+    if( extLe )
+    {
+        ret = rfalT4TPollerComposeReadDataExt( ctx->tx, offset, le, &txLen );
+    }
+    else
+    {
+        ret = rfalT4TPollerComposeReadData( ctx->tx, offset, (uint8_t)le, &txLen );
+    }
+    if( ret != RFAL_ERR_NONE )
+    {
+        return ret;
+    }
+
+    ret = t4tReadApdu( ctx, txLen, dataLen );
+    if( (ret == RFAL_ERR_NONE) && ((*dataLen == 0U) || (*dataLen > le)) )
+    {
+        return RFAL_ERR_PROTO;                                                      /* Nothing or more than asked for */
+    }
+    return ret;
+}
+
+
+/*******************************************************************************/
+static ReturnCode t4tReadCc( t4tReadCtx *ctx, t4tReadInfo *info )
+{
+    const uint8_t *cc;
+    uint16_t       dataLen;
+    ReturnCode     ret;
+
+    RFAL_EXIT_ON_ERR( ret, t4tReadSelect( ctx, t4tReadCcFid, sizeof(t4tReadCcFid), false ) );
+    RFAL_EXIT_ON_ERR( ret, t4tReadBinary( ctx, 0, T4T_READ_CC_LEN, false, &dataLen ) );
+
+    cc = ctx->rx->apdu;
+    if( (dataLen < T4T_READ_CC_LEN) || (cc[7] != T4T_READ_CC_TLV_NDEF) || (cc[8] != T4T_READ_CC_TLV_NDEF_LEN) || (cc[13] != T4T_READ_CC_READ_FREE) )
+    {
+        return RFAL_ERR_REQUEST;                                                    /* No (readable) NDEF file, or an ENDEF one */
+    }
+
+    info->version  = cc[2];
+    info->mle      = (uint16_t)(((uint16_t)cc[3] << 8) | cc[4]);
+    info->mlc      = (uint16_t)(((uint16_t)cc[5] << 8) | cc[6]);
+    info->fileId   = (uint16_t)(((uint16_t)cc[9] << 8) | cc[10]);
+    info->fileSize = (uint16_t)(((uint16_t)cc[11] << 8) | cc[12]);
+    if( (info->mle < T4T_READ_MLE_MIN) || (info->fileSize < T4T_READ_NLEN_LEN) || (info->fileSize > T4T_READ_FILE_MAX) )
+    {
+        return RFAL_ERR_REQUEST;
+    }
+
+    /* MLe above 255 with mapping 3.0: the card takes an extended Le */
+    info->extLe = ((info->version >= T4T_READ_MAPPING_EXT_LE) && (info->mle > T4T_READ_LE_SHORT_MAX));
+    info->le    = (info->extLe ? (uint16_t)RFAL_MIN( info->mle, T4T_READ_LE_MAX ) : (uint16_t)RFAL_MIN( info->mle, T4T_READ_LE_SHORT_MAX ));
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ReturnCode t4tReadRxGrow( t4tReadCtx *ctx, uint16_t le )
+{
+    if( (le + RFAL_T4T_MAX_RAPDU_SW1SW2_LEN) <= ctx->rxLen )
+    {
+        return RFAL_ERR_NONE;
+    }
+
+    apduPoolFree( ctx->rx );
+    ctx->rxLen = (uint16_t)(le + RFAL_T4T_MAX_RAPDU_SW1SW2_LEN);
+    ctx->rx    = apduPoolAllocApdu( ctx->rxLen );
+    return ((ctx->rx == NULL) ? RFAL_ERR_NOMEM : RFAL_ERR_NONE);
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+ReturnCode t4tReadNdef( const rfalIsoDepDevice *isoDep, uint8_t *msg, uint16_t msgMax, uint16_t *msgLen, t4tReadInfo *info, bool ccKnown, t4tReadStats *stats )
+{
+    t4tReadCtx                ctx;
+    uint8_t                   fid[2];
+    uint16_t                  toRead;
+    uint16_t                  dataLen;
+    uint16_t                  offset;
+    uint16_t                  le;
+    ReturnCode                ret;
+
+    *msgLen = 0;
+    if( !ccKnown )
+    {
+        RFAL_MEMSET( info, 0x00, sizeof(t4tReadInfo) );
+    }
+
+    ctx.isoDep = isoDep;
+    ctx.stats  = stats;
+    ctx.rxLen  = T4T_READ_CTRL_RAPDU_LEN;
+    ctx.tx     = apduPoolAllocApdu( T4T_READ_CAPDU_LEN );
+    ctx.rx     = apduPoolAllocApdu( ctx.rxLen );
+    ctx.tmp    = apduPoolAllocBlock();
+    ret        = RFAL_ERR_NOMEM;
+
+    do
+    {
+        if( (ctx.tx == NULL) || (ctx.rx == NULL) || (ctx.tmp == NULL) )
+        {
+            break;
+        }
+
+        /* NDEF application */
+        ret = t4tReadSelect( &ctx, t4tReadNdefAid, sizeof(t4tReadNdefAid), true );
+        if( ret != RFAL_ERR_NONE )
+        {
+            ret = ((ret == RFAL_ERR_REQUEST) ? RFAL_ERR_NOTFOUND : ret);
+            break;
+        }
+
+        /* CC, unless known, and NDEF file */
+        if( !ccKnown )
+        {
+            ret = t4tReadCc( &ctx, info );
+            if( ret != RFAL_ERR_NONE )
+            {
+                break;
+            }
+        }
+        fid[0] = (uint8_t)(info->fileId >> 8);
+        fid[1] = (uint8_t)(info->fileId & 0xFFU);
+        ret    = t4tReadSelect( &ctx, fid, sizeof(fid), false );
+        if( ret != RFAL_ERR_NONE )
+        {
+            break;
+        }
+
+        /* NLEN: alone, or with the CC known together with as much of the message as it last had */
+        le = T4T_READ_NLEN_LEN;
+        if( ccKnown )
+        {
+            le = (uint16_t)RFAL_MIN( info->le, RFAL_MIN( (T4T_READ_NLEN_LEN + (uint32_t)RFAL_MIN( info->nlen, msgMax )), info->fileSize ) );
+            le = (uint16_t)RFAL_MAX( le, T4T_READ_NLEN_LEN );
+        }
+        ret = t4tReadRxGrow( &ctx, le );
+        if( ret == RFAL_ERR_NONE )
+        {
+            ret = t4tReadBinary( &ctx, 0, le, (info->extLe && (le > T4T_READ_LE_SHORT_MAX)), &dataLen );
+        }
+        if( ret != RFAL_ERR_NONE )
+        {
+            break;
+        }
+        info->nlen = (uint16_t)(((uint16_t)ctx.rx->apdu[0] << 8) | ctx.rx->apdu[1]);
+        if( (dataLen < T4T_READ_NLEN_LEN) || (info->nlen > (info->fileSize - T4T_READ_NLEN_LEN)) )
+        {
+            ret = RFAL_ERR_REQUEST;
+            break;
+        }
+        toRead  = (uint16_t)RFAL_MIN( info->nlen, msgMax );
+        *msgLen = (uint16_t)RFAL_MIN( (dataLen - T4T_READ_NLEN_LEN), toRead );
+        RFAL_MEMCPY( msg, &ctx.rx->apdu[T4T_READ_NLEN_LEN], *msgLen );
+
+        /* Rest of the message: R-APDU buffer for the Le in use */
+        if( *msgLen < toRead )
+        {
+            ret = t4tReadRxGrow( &ctx, (uint16_t)RFAL_MIN( info->le, (toRead - *msgLen) ) );
+        }
+        while( (ret == RFAL_ERR_NONE) && (*msgLen < toRead) )
+        {
+            le     = (uint16_t)RFAL_MIN( info->le, (toRead - *msgLen) );
+            offset = (uint16_t)(T4T_READ_NLEN_LEN + *msgLen);
+            ret    = t4tReadBinary( &ctx, offset, le, (info->extLe && (le > T4T_READ_LE_SHORT_MAX)), &dataLen );
+            if( ret == RFAL_ERR_NONE )
+            {
+                RFAL_MEMCPY( &msg[*msgLen], ctx.rx->apdu, dataLen );
+                *msgLen = (uint16_t)(*msgLen + dataLen);
+            }
+        }
+    }
+    while( false );
+
+    apduPoolFree( ctx.tmp );
+    apduPoolFree( ctx.rx );
+    apduPoolFree( ctx.tx );
+    return ret;
+}
@@ -0,0 +1,120 @@
+/*! \file t4t_read.h
+ *
+ *  \brief Type 4 Tag NDEF bulk read
+ *
+ *  Reads the NDEF message of an activated T4T (NFC Forum T4T 2.0/3.0) with
+ *  as few APDUs and I-Blocks as the card allows:
+ *   - NDEF application, CC file and NDEF file selected, NLEN read
+ *   - the message read with READ BINARY asking for MLe bytes at once: with
+ *     an extended Le (up to T4T_READ_LE_MAX) if the CC announces a MLe
+ *     above 255 (mapping version 3.0), else a short one (255)
+ *   - the R-APDUs come in I-Blocks as large as the FSD negotiated by RATS /
+ *     ATTRIB (rfalNfcDiscoverParam.isoDepFS, up to RFAL_ISODEP_FSDI_BUF_MAX)
+ *
+ *  With the CC of the card known from an earlier read (same card, or same
+ *  card model) the CC file is not selected nor read again: the NDEF file is
+ *  selected with the known file ID and its first READ BINARY asks for NLEN
+ *  together with as many message bytes as the card held last time, a short
+ *  message then takes three APDUs instead of six.
+ *
+ *  The APDUs are exchanged with rfalIsoDepStartApduTransceive(), not through
+ *  rfalNfcDataExchangeStart(): the C-APDU, R-APDU and I-Block buffers come
+ *  from the reader's APDU pool (apdu_pool.h), the R-APDU one sized for the
+ *  Le in use, and are freed before returning.
+ *
+ *  NDEF files beyond 32 KB (T4T 3.0 ENDEF file, READ BINARY with ODO) are
+ *  not read.
+ *
+ */
+
+#ifndef T4T_READ_H
+#define T4T_READ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rfal_core/rfal_isoDep.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#ifndef T4T_READ_LE_MAX
+#define T4T_READ_LE_MAX             4096U   /*!< Largest extended Le asked for, bounds the R-APDU buffer */
+#endif
+
+#define T4T_READ_LE_SHORT_MAX       255U    /*!< Largest short Le asked for                     */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! NDEF file of a T4T as described by its CC */
+typedef struct
+{
+    uint8_t  version;                       /*!< Mapping version                                */
+    uint16_t mle;                           /*!< Max R-APDU data size                           */
+    uint16_t mlc;                           /*!< Max C-APDU data size                           */
+    uint16_t fileId;                        /*!< NDEF file ID                                   */
+    uint16_t fileSize;                      /*!< NDEF file size, NLEN included                  */
+    uint16_t nlen;                          /*!< NDEF message length                            */
+    uint16_t le;                            /*!< Le of the message reads                        */
+    bool     extLe;                         /*!< Le extended field coded                        */
+} t4tReadInfo;
+
+/*! Cost of a read */
+typedef struct
+{
+    uint32_t apdus;                         /*!< APDUs exchanged                                */
+    uint32_t bytes;                         /*!< C-APDU and R-APDU bytes                        */
+    uint32_t timeUs;                        /*!< Exchange time                                  */
+    uint16_t sw;                            /*!< Status word of the last R-APDU                 */
+} t4tReadStats;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Reads the NDEF message of an activated T4T
+ *
+ * \param[in]   isoDep  : activated ISO-DEP device (FSC, FWT)
+ * \param[out]  msg     : NDEF message
+ * \param[in]   msgMax  : msg size, a longer message is read up to it
+ * \param[out]  msgLen  : message bytes read
+ * \param[in,out] info  : CC and NLEN, valid as far as read. With ccKnown
+ *                       the CC of an earlier read, its nlen the number of
+ *                       message bytes asked for with NLEN
+ * \param[in]   ccKnown : info holds the CC: the CC file is not read
+ * \param[out]  stats   : APDUs, bytes and time, added to
+ *
+ * \return RFAL_ERR_NONE     : message read
+ * \return RFAL_ERR_NOTFOUND : no NDEF application
+ * \return RFAL_ERR_REQUEST  : error status word or invalid CC / NLEN, with
+ *                            ccKnown the CC may not match the card
+ * \return RFAL_ERR_NOMEM    : APDU pool exhausted
+ * \return any other         : transmission error
+ *****************************************************************************
+ */
+ReturnCode t4tReadNdef( const rfalIsoDepDevice *isoDep, uint8_t *msg, uint16_t msgMax, uint16_t *msgLen, t4tReadInfo *info, bool ccKnown, t4tReadStats *stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* T4T_READ_H */
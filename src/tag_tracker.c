@@ -0,0 +1,176 @@
+/*! \file tag_tracker.c
+ *
+ *  \brief Tag presence tracking across poll cycles
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <string.h>
+
+#include "tag_tracker.h"
+#include "rfal_platform/rfal_platform.h"
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Tracker context, one per reader */
+typedef struct
+{
+    tagTrackerTag tags[TAG_TRACKER_SIZE];           /*!< Known tags, compact      */
+    uint8_t       cnt;                              /*!< Number of known tags     */
+    tagTrackerCb  cb;                               /*!< Event callback           */
+} tagTrackerCtx;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static tagTrackerCtx gTtInstances[PLTF_READERS];
+
+#define gTt          (gTtInstances[pltf_reader_get()])  /*!< Context of the calling task's reader */
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static tagTrackerTag *tagTrackerFind( uint8_t tech, const uint8_t *uid, uint8_t uidLen )
+{
+    uint8_t i;
+
+    for( i = 0; i < gTt.cnt; i++ )
+    {
+        if( (gTt.tags[i].tech == tech) && (gTt.tags[i].uidLen == uidLen) && (memcmp( gTt.tags[i].uid, uid, uidLen ) == 0) )
+        {
+            return &gTt.tags[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void tagTrackerInit( tagTrackerCb cb )
+{
+    memset( gTt.tags, 0x00, sizeof(gTt.tags) );
+    gTt.cnt = 0;
+    gTt.cb  = cb;
+}
+
+
+/*******************************************************************************/
+void tagTrackerCycleStart( void )
+{
+    uint8_t i;
+
+    for( i = 0; i < gTt.cnt; i++ )
+    {
+        gTt.tags[i].seen = false;
+    }
+}
+
+
+/*******************************************************************************/
+bool tagTrackerMark( uint8_t tech, const uint8_t *uid, uint8_t uidLen )
+{
+    tagTrackerTag *tag;
+
+    tag = tagTrackerFind( tech, uid, uidLen );
+    if( tag == NULL )
+    {
+        return false;
+    }
+
+    tag->seen   = true;
+    tag->missed = 0;
+    return true;
+}
+
+
+/*******************************************************************************/
+bool tagTrackerAdd( uint8_t tech, const uint8_t *uid, uint8_t uidLen )
+{
+    tagTrackerTag *tag;
+
+    if( tagTrackerMark( tech, uid, uidLen ) || (uidLen > TAG_TRACKER_UID_MAX) || (gTt.cnt >= TAG_TRACKER_SIZE) )
+    {
+        return false;
+    }
+
+    tag            = &gTt.tags[gTt.cnt++];
+    tag->tech      = tech;
+    tag->uidLen    = uidLen;
+    memcpy( tag->uid, uid, uidLen );
+    tag->seen      = true;
+    tag->missed    = 0;
+    tag->arrivedMs = platformGetSysTick();
+
+    if( gTt.cb != NULL )
+    {
+        gTt.cb( TAG_TRACKER_EVT_ARRIVED, tag );
+    }
+    return true;
+}
+
+
+/*******************************************************************************/
+void tagTrackerCycleEnd( void )
+{
+    tagTrackerTag left;
+    uint8_t       i;
+
+    i = 0;
+    while( i < gTt.cnt )
+    {
+        if( !gTt.tags[i].seen && (++gTt.tags[i].missed >= TAG_TRACKER_LEAVE_CYCLES) )
+        {
+            /* Keep the table compact: the last tag takes the free slot */
+            left     = gTt.tags[i];
+            gTt.tags[i] = gTt.tags[--gTt.cnt];
+
+            if( gTt.cb != NULL )
+            {
+                gTt.cb( TAG_TRACKER_EVT_LEFT, &left );
+            }
+            continue;
+        }
+        i++;
+    }
+}
+
+
+/*******************************************************************************/
+const tagTrackerTag *tagTrackerGet( uint8_t idx )
+{
+    return ((idx < gTt.cnt) ? &gTt.tags[idx] : NULL);
+}
+
+
+/*******************************************************************************/
+uint8_t tagTrackerCount( uint8_t tech )
+{
+    uint8_t i;
+    uint8_t n;
+
+    n = 0;
+    for( i = 0; i < gTt.cnt; i++ )
+    {
+        n += ((gTt.tags[i].tech == tech) ? 1U : 0U);
+    }
+    return n;
+}
@@ -0,0 +1,168 @@
+/*! \file tag_tracker.h
+ *
+ *  \brief Tag presence tracking across poll cycles
+ *
+ *  Keeps a small table of the tags in the field, identified by technology
+ *  and UID, and turns the per cycle poll results into "arrived" and "left"
+ *  events. A poll cycle is framed by #tagTrackerCycleStart and
+ *  #tagTrackerCycleEnd; in between the poller reports
+ *   - the known tags that passed a presence check, see #tagTrackerMark
+ *   - the tags found by collision resolution, see #tagTrackerAdd
+ *
+ *  A tag is reported as left only after it was missed in
+ *  TAG_TRACKER_LEAVE_CYCLES consecutive cycles, so a single lost frame does
+ *  not produce a left/arrived pair.
+ *
+ *  The tracker has no RF dependency, the technology is an opaque value
+ *  chosen by the poller.
+ *
+ */
+
+#ifndef TAG_TRACKER_H
+#define TAG_TRACKER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#ifndef TAG_TRACKER_SIZE
+#define TAG_TRACKER_SIZE            10U     /*!< Tags tracked at the same time                  */
+#endif
+
+#ifndef TAG_TRACKER_LEAVE_CYCLES
+#define TAG_TRACKER_LEAVE_CYCLES    2U      /*!< Cycles a tag must be missed before it has left */
+#endif
+
+#define TAG_TRACKER_UID_MAX         10U     /*!< Longest UID (NFC-A triple size)                */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Tracker events */
+typedef enum
+{
+    TAG_TRACKER_EVT_ARRIVED = 0,            /*!< A tag not in the table was found               */
+    TAG_TRACKER_EVT_LEFT    = 1             /*!< A known tag was missed too long                */
+} tagTrackerEvt;
+
+/*! Tracked tag */
+typedef struct
+{
+    uint8_t  tech;                          /*!< Technology, as given by the poller             */
+    uint8_t  uidLen;                        /*!< UID length                                     */
+    uint8_t  uid[TAG_TRACKER_UID_MAX];      /*!< UID                                            */
+    uint8_t  missed;                        /*!< Consecutive cycles the tag was missed          */
+    bool     seen;                          /*!< Seen in the current cycle                      */
+    uint32_t arrivedMs;                     /*!< Time of arrival (platform ms tick)             */
+} tagTrackerTag;
+
+/*! Event callback, \a tag is only valid during the call */
+typedef void (*tagTrackerCb)( tagTrackerEvt evt, const tagTrackerTag *tag );
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Initializes the tracker with an empty table
+ *
+ * \param[in]  cb : event callback, may be NULL
+ *****************************************************************************
+ */
+void tagTrackerInit( tagTrackerCb cb );
+
+/*!
+ *****************************************************************************
+ * \brief  Starts a poll cycle, all tags are not seen yet
+ *****************************************************************************
+ */
+void tagTrackerCycleStart( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Marks a known tag as present in the current cycle
+ *
+ * \param[in]  tech   : technology
+ * \param[in]  uid    : UID
+ * \param[in]  uidLen : UID length
+ *
+ * \return true if the tag is known, false if it is not in the table
+ *****************************************************************************
+ */
+bool tagTrackerMark( uint8_t tech, const uint8_t *uid, uint8_t uidLen );
+
+/*!
+ *****************************************************************************
+ * \brief  Marks a tag as present, adding it to the table if not known
+ *
+ * A new tag raises TAG_TRACKER_EVT_ARRIVED. If the table is full the tag
+ * is dropped, it is reported again once a slot is free.
+ *
+ * \param[in]  tech   : technology
+ * \param[in]  uid    : UID
+ * \param[in]  uidLen : UID length
+ *
+ * \return true if the tag is new
+ *****************************************************************************
+ */
+bool tagTrackerAdd( uint8_t tech, const uint8_t *uid, uint8_t uidLen );
+
+/*!
+ *****************************************************************************
+ * \brief  Ends a poll cycle
+ *
+ * Tags missed for TAG_TRACKER_LEAVE_CYCLES cycles raise
+ * TAG_TRACKER_EVT_LEFT and are removed from the table.
+ *****************************************************************************
+ */
+void tagTrackerCycleEnd( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets a tag of the table
+ *
+ * The table is compact: tags are at index 0 to count - 1. Indexes stay
+ * valid until the next #tagTrackerAdd or #tagTrackerCycleEnd.
+ *
+ * \param[in]  idx : index in the table
+ *
+ * \return the tag, NULL if \a idx is beyond the last tag
+ *****************************************************************************
+ */
+const tagTrackerTag *tagTrackerGet( uint8_t idx );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the number of known tags of a technology
+ *
+ * \param[in]  tech : technology
+ *
+ * \return number of tags in the table
+ *****************************************************************************
+ */
+uint8_t tagTrackerCount( uint8_t tech );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TAG_TRACKER_H */
@@ -0,0 +1,267 @@
+/*! \file wakeup_ctrl.c
+ *
+ *  \brief Low power wake-up mode with self calibrated thresholds
+ *
+ */
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <string.h>
+
+#include "wakeup_ctrl.h"
+#include "rfal_core/rfal_chip.h"
+#include "rfal_platform/rfal_platform.h"
+
+/*
+******************************************************************************
+* LOCAL DEFINES
+******************************************************************************
+*/
+#define WAKEUP_CTRL_AVG_ONE         16      /*!< Tracked average in 1/16 LSB                    */
+
+/*
+******************************************************************************
+* LOCAL TYPES
+******************************************************************************
+*/
+
+/*! Controller context, one per reader */
+typedef struct
+{
+    rfalWakeUpConfig cfg;                   /*!< Configuration given to rfalWakeUpModeStart()   */
+    int32_t          ampAvg;                /*!< Tracked amplitude, 1/16 LSB                    */
+    int32_t          phaAvg;                /*!< Tracked phase, 1/16 LSB                        */
+    uint32_t         refMs;                 /*!< Last calibration or tracked measurement        */
+    uint32_t         sleepMs;               /*!< Time the Wake-Up mode was started              */
+    uint32_t         wokeMs;                /*!< Time of the last wake-up                       */
+    uint8_t          falseStreak;           /*!< Consecutive false wakes                        */
+    bool             calibrated;
+    bool             asleep;                /*!< Wake-Up mode started, not woken yet            */
+    bool             woke;                  /*!< Woken, discovery result pending                */
+    wakeUpCtrlStats  stats;
+} wakeUpCtrlCtx;
+
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+static wakeUpCtrlCtx gWucInstances[PLTF_READERS];
+
+#define gWuc         (gWucInstances[pltf_reader_get()])  /*!< Context of the calling task's reader */
+
+/*
+******************************************************************************
+* LOCAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+static uint8_t wakeUpCtrlDelta( uint8_t min, uint8_t max )
+{
+    uint32_t delta;
+
+    /* Half the peak to peak noise on either side of the mean, plus the margin */
+    delta = ((((uint32_t)max - min) + 1U) / 2U) + WAKEUP_CTRL_DELTA_MARGIN;
+
+    return (uint8_t)((delta == 0U) ? 1U : ((delta > WAKEUP_CTRL_DELTA_MAX) ? WAKEUP_CTRL_DELTA_MAX : delta));
+}
+
+
+/*******************************************************************************/
+static bool wakeUpCtrlFollow( int32_t *avg, uint8_t meas, uint8_t *ref )
+{
+    int32_t diff;
+
+    *avg += ((((int32_t)meas * WAKEUP_CTRL_AVG_ONE) - *avg) / (1 << WAKEUP_CTRL_TRACK_SHIFT));
+
+    /* One full LSB of hysteresis: noise around a rounding boundary does not restart the Wake-Up mode */
+    diff = (*avg - ((int32_t)*ref * WAKEUP_CTRL_AVG_ONE));
+    if( (diff < WAKEUP_CTRL_AVG_ONE) && (diff > -WAKEUP_CTRL_AVG_ONE) )
+    {
+        return false;
+    }
+
+    *ref = (uint8_t)((*avg + (WAKEUP_CTRL_AVG_ONE / 2)) / WAKEUP_CTRL_AVG_ONE);
+    return true;
+}
+
+/*
+******************************************************************************
+* GLOBAL FUNCTIONS
+******************************************************************************
+*/
+
+/*******************************************************************************/
+void wakeUpCtrlInit( void )
+{
+    memset( &gWuc, 0x00, sizeof(gWuc) );
+
+    gWuc.cfg.period         = WAKEUP_CTRL_PERIOD;
+    gWuc.cfg.irqTout        = true;                                                   /* Every WU timer measurement is reported, see wakeUpCtrlTrack() */
+    gWuc.cfg.indAmp.enabled = true;
+    gWuc.cfg.indPha.enabled = true;
+    gWuc.cfg.cap.enabled    = false;
+}
+
+
+/*******************************************************************************/
+bool wakeUpCtrlNeedsCalibration( void )
+{
+    return ( !gWuc.calibrated || (gWuc.falseStreak >= WAKEUP_CTRL_FALSE_WAKES)
+             || ((platformGetSysTick() - gWuc.refMs) > WAKEUP_CTRL_REF_MAX_AGE_MS) );
+}
+
+
+/*******************************************************************************/
+ReturnCode wakeUpCtrlCalibrate( void )
+{
+    ReturnCode err;
+    uint32_t   ampSum;
+    uint32_t   phaSum;
+    uint8_t    ampMin;
+    uint8_t    ampMax;
+    uint8_t    phaMin;
+    uint8_t    phaMax;
+    uint8_t    amp;
+    uint8_t    pha;
+    uint8_t    i;
+
+    ampSum = 0;
+    phaSum = 0;
+    ampMin = 0xFFU;
+    ampMax = 0x00U;
+    phaMin = 0xFFU;
+    phaMax = 0x00U;
+
+    for( i = 0; i < WAKEUP_CTRL_CAL_SAMPLES; i++ )
+    {
+        RFAL_EXIT_ON_ERR( err, rfalChipMeasureAmplitude( &amp ) );
+        RFAL_EXIT_ON_ERR( err, rfalChipMeasurePhase( &pha ) );
+
+        ampSum += amp;
+        phaSum += pha;
+        ampMin  = ((amp < ampMin) ? amp : ampMin);
+        ampMax  = ((amp > ampMax) ? amp : ampMax);
+        phaMin  = ((pha < phaMin) ? pha : phaMin);
+        phaMax  = ((pha > phaMax) ? pha : phaMax);
+    }
+
+    gWuc.cfg.indAmp.reference = (uint8_t)((ampSum + (WAKEUP_CTRL_CAL_SAMPLES / 2U)) / WAKEUP_CTRL_CAL_SAMPLES);
+    gWuc.cfg.indAmp.delta     = wakeUpCtrlDelta( ampMin, ampMax );
+    gWuc.cfg.indPha.reference = (uint8_t)((phaSum + (WAKEUP_CTRL_CAL_SAMPLES / 2U)) / WAKEUP_CTRL_CAL_SAMPLES);
+    gWuc.cfg.indPha.delta     = wakeUpCtrlDelta( phaMin, phaMax );
+
+    gWuc.ampAvg      = ((int32_t)gWuc.cfg.indAmp.reference * WAKEUP_CTRL_AVG_ONE);
+    gWuc.phaAvg      = ((int32_t)gWuc.cfg.indPha.reference * WAKEUP_CTRL_AVG_ONE);
+    gWuc.refMs       = platformGetSysTick();
+    gWuc.falseStreak = 0;
+    gWuc.calibrated  = true;
+    gWuc.stats.calibrations++;
+
+    return RFAL_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+const rfalWakeUpConfig *wakeUpCtrlConfig( void )
+{
+    return &gWuc.cfg;
+}
+
+
+/*******************************************************************************/
+void wakeUpCtrlTrack( void )
+{
+    rfalWakeUpInfo info;
+    bool           moved;
+
+    if( rfalWakeUpModeGetInfo( false, &info ) != RFAL_ERR_NONE )
+    {
+        return;                                                                       /* Wake-Up mode not running (anymore) */
+    }
+
+    /* Only the regular timer measurements describe the empty field */
+    if( !info.irqWut || info.indAmp.irqWu || info.indPha.irqWu )
+    {
+        return;
+    }
+
+    gWuc.stats.timerEvents++;
+    gWuc.refMs = platformGetSysTick();
+
+    moved  = wakeUpCtrlFollow( &gWuc.ampAvg, info.indAmp.lastMeas, &gWuc.cfg.indAmp.reference );
+    moved |= wakeUpCtrlFollow( &gWuc.phaAvg, info.indPha.lastMeas, &gWuc.cfg.indPha.reference );
+
+    if( moved )
+    {
+        /* The references are only written on start */
+        gWuc.stats.refUpdates++;
+        rfalWakeUpModeStop();
+        rfalWakeUpModeStart( &gWuc.cfg );
+    }
+}
+
+
+/*******************************************************************************/
+void wakeUpCtrlSleep( void )
+{
+    gWuc.asleep  = true;
+    gWuc.sleepMs = platformGetSysTick();
+}
+
+
+/*******************************************************************************/
+void wakeUpCtrlWoke( void )
+{
+    if( !gWuc.asleep )
+    {
+        return;
+    }
+
+    gWuc.asleep = false;
+    gWuc.woke   = true;
+    gWuc.wokeMs = platformGetSysTick();
+    gWuc.stats.wakes++;
+    gWuc.stats.sleepMs += (gWuc.wokeMs - gWuc.sleepMs);
+}
+
+
+/*******************************************************************************/
+bool wakeUpCtrlResult( bool found )
+{
+    uint32_t latency;
+
+    if( !gWuc.woke )
+    {
+        return false;
+    }
+    gWuc.woke = false;
+
+    if( !found )
+    {
+        gWuc.falseStreak++;
+        gWuc.stats.falseWakes++;
+        return true;
+    }
+
+    latency                    = (platformGetSysTick() - gWuc.wokeMs);
+    gWuc.falseStreak           = 0;
+    gWuc.stats.latencyTotalMs += latency;
+    gWuc.stats.latencyMaxMs    = ((latency > gWuc.stats.latencyMaxMs) ? latency : gWuc.stats.latencyMaxMs);
+    return true;
+}
+
+
+/*******************************************************************************/
+void wakeUpCtrlGetStats( wakeUpCtrlStats *stats )
+{
+    *stats          = gWuc.stats;
+    stats->ampRef   = gWuc.cfg.indAmp.reference;
+    stats->ampDelta = gWuc.cfg.indAmp.delta;
+    stats->phaRef   = gWuc.cfg.indPha.reference;
+    stats->phaDelta = gWuc.cfg.indPha.delta;
+}
@@ -0,0 +1,179 @@
+/*! \file wakeup_ctrl.h
+ *
+ *  \brief Low power wake-up mode with self calibrated thresholds
+ *
+ *  Provides the rfalWakeUpConfig used by the rfalNfcWorker when no tag is
+ *  known, so the ST25R3911 measures the antenna on its wake-up timer with
+ *  the oscillator and the field off and the MCU sleeps until the WU IRQ.
+ *
+ *  The inductive amplitude and phase references and deltas are not fixed:
+ *   - #wakeUpCtrlCalibrate takes WAKEUP_CTRL_CAL_SAMPLES measurements; the
+ *     mean is the reference, the delta is derived from the spread (noise)
+ *   - #wakeUpCtrlTrack follows the slow antenna drift (temperature) with
+ *     the measurement reported on every WU timer event, see
+ *     rfalWakeUpModeGetInfo(), and moves the reference along
+ *   - WAKEUP_CTRL_FALSE_WAKES consecutive wake-ups without any device found
+ *     (metal object, sudden detuning) or a reference not tracked for
+ *     WAKEUP_CTRL_REF_MAX_AGE_MS request a new calibration
+ *
+ *  The statistics relate the false wake rate to the wake to detection
+ *  latency, both depending on the WU period and the delta margin.
+ *
+ */
+
+#ifndef WAKEUP_CTRL_H
+#define WAKEUP_CTRL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+******************************************************************************
+* INCLUDES
+******************************************************************************
+*/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rfal_core/rfal_rf.h"
+
+/*
+******************************************************************************
+* GLOBAL DEFINES
+******************************************************************************
+*/
+#ifndef WAKEUP_CTRL_PERIOD
+#define WAKEUP_CTRL_PERIOD          RFAL_WUM_PERIOD_100MS   /*!< WU timer period, bounds the detection latency  */
+#endif
+
+#ifndef WAKEUP_CTRL_DELTA_MARGIN
+#define WAKEUP_CTRL_DELTA_MARGIN    1U      /*!< LSBs added to the noise seen at calibration        */
+#endif
+
+#define WAKEUP_CTRL_CAL_SAMPLES     8U      /*!< Measurements per channel at calibration            */
+#define WAKEUP_CTRL_DELTA_MAX       15U     /*!< am_d/pm_d register field                           */
+#define WAKEUP_CTRL_TRACK_SHIFT     3U      /*!< Drift tracking average weight 1/8                  */
+#define WAKEUP_CTRL_FALSE_WAKES     3U      /*!< Consecutive false wakes before a new calibration   */
+#define WAKEUP_CTRL_REF_MAX_AGE_MS  10000U  /*!< Untracked reference considered stale               */
+
+/*
+******************************************************************************
+* GLOBAL TYPES
+******************************************************************************
+*/
+
+/*! Wake-up statistics */
+typedef struct
+{
+    uint32_t wakes;                         /*!< Wake-ups (amplitude or phase out of the delta)     */
+    uint32_t falseWakes;                    /*!< Wake-ups after which no device was found           */
+    uint32_t timerEvents;                   /*!< WU timer measurements tracked                      */
+    uint32_t calibrations;                  /*!< Full calibrations                                  */
+    uint32_t refUpdates;                    /*!< References moved by the drift tracking             */
+    uint32_t latencyTotalMs;                /*!< Sum of wake to device report times                 */
+    uint32_t latencyMaxMs;                  /*!< Longest wake to device report time                 */
+    uint32_t sleepMs;                       /*!< Time spent in Wake-Up mode                         */
+    uint8_t  ampRef;                        /*!< Current amplitude reference                        */
+    uint8_t  ampDelta;                      /*!< Current amplitude delta                            */
+    uint8_t  phaRef;                        /*!< Current phase reference                            */
+    uint8_t  phaDelta;                      /*!< Current phase delta                                */
+} wakeUpCtrlStats;
+
+/*
+******************************************************************************
+* GLOBAL FUNCTION PROTOTYPES
+******************************************************************************
+*/
+
+/*!
+ *****************************************************************************
+ * \brief  Initializes the controller, a calibration is needed before use
+ *****************************************************************************
+ */
+void wakeUpCtrlInit( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Tells whether a calibration is due
+ *
+ * \return true if never calibrated, after too many false wakes or when the
+ *         reference has not been tracked for WAKEUP_CTRL_REF_MAX_AGE_MS
+ *****************************************************************************
+ */
+bool wakeUpCtrlNeedsCalibration( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Calibrates the references and deltas
+ *
+ * Must be called with the oscillator on and the field off, no device in
+ * the field (i.e. outside of the Wake-Up mode).
+ *
+ * \return RFAL_ERR_NONE or the error of the measurement
+ *****************************************************************************
+ */
+ReturnCode wakeUpCtrlCalibrate( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the Wake-Up mode configuration
+ *
+ * \return the configuration to be given to rfalWakeUpModeStart(), e.g.
+ *         through rfalNfcDiscoverParam.wakeupConfig
+ *****************************************************************************
+ */
+const rfalWakeUpConfig *wakeUpCtrlConfig( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Tracks the drift while in Wake-Up mode
+ *
+ * To be called after every ST25R3911 IRQ while the Wake-Up mode is running.
+ * The measurement of a WU timer event moves the tracked references; once
+ * one of them is an LSB off the Wake-Up mode is restarted with it.
+ *****************************************************************************
+ */
+void wakeUpCtrlTrack( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Signals that the Wake-Up mode has started
+ *****************************************************************************
+ */
+void wakeUpCtrlSleep( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Signals that the Wake-Up mode has woken
+ *
+ * Ignored unless #wakeUpCtrlSleep was signalled before.
+ *****************************************************************************
+ */
+void wakeUpCtrlWoke( void );
+
+/*!
+ *****************************************************************************
+ * \brief  Signals the end of the discovery, only counted after a wake-up
+ *
+ * \param[in]  found : a device was found
+ *
+ * \return true if the discovery followed a wake-up and was counted
+ *****************************************************************************
+ */
+bool wakeUpCtrlResult( bool found );
+
+/*!
+ *****************************************************************************
+ * \brief  Gets the statistics
+ *
+ * \param[out]  stats : statistics since #wakeUpCtrlInit
+ *****************************************************************************
+ */
+void wakeUpCtrlGetStats( wakeUpCtrlStats *stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WAKEUP_CTRL_H */